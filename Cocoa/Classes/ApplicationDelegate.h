@@ -67,6 +67,12 @@
 */
 - (void)initUserDefaults;
 
+/*!
+@method			insertThumbnailsMenuItem
+@abstract		Adds the Show Thumbnails item, which isn't in <b>Application.nib</b>, to the menu with Show Toolbar in it.
+*/
+- (void)insertThumbnailsMenuItem;
+
 /* accessors */
 
 /*!
@@ -8,6 +8,7 @@
 #import "ResourceDocument.h"
 #import "ResourceDataSource.h"
 #import "RKEditorRegistry.h"
+#import "RKExporter.h"
 
 #import "ResKnifePluginProtocol.h"
 #import "RKSupportResourceRegistry.h"
@@ -27,6 +28,34 @@
 	// instanciate my own subclass of NSDocumentController so I can override the open dialog
 	[[RKDocumentController alloc] init];
 	[RKSupportResourceRegistry scanForSupportResources];
+	[self insertThumbnailsMenuItem];
+}
+
+/*!
+@method		insertThumbnailsMenuItem
+@abstract	Puts Show Thumbnails after Show Toolbar, or at the end of the Window menu if that's been moved; the document validates it and ticks it while its window has the thumbnail column.
+*/
+
+- (void)insertThumbnailsMenuItem
+{
+	NSEnumerator *enumerator = [[[NSApp mainMenu] itemArray] objectEnumerator];
+	NSMenu *menu = [NSApp windowsMenu];
+	NSMenuItem *item;
+	int index = [menu numberOfItems];
+	while(item = [enumerator nextObject])
+	{
+		int found = [[item submenu] indexOfItemWithTarget:nil andAction:@selector(toggleToolbarShown:)];
+		if(found >= 0)
+		{
+			menu = [item submenu];
+			index = found + 1;
+			break;
+		}
+	}
+	if(!menu) return;
+	
+	item = [[[NSMenuItem alloc] initWithTitle:NSLocalizedString(@"Show Thumbnails", nil) action:@selector(toggleThumbnails:) keyEquivalent:@""] autorelease];
+	[menu insertItem:item atIndex:index];
 }
 
 /*!
@@ -116,11 +145,51 @@
 	return forks;
 }
 
+/*!
+@method		applicationDidFinishLaunching:
+@abstract	Launched with <tt>-ExportFile <i>path</i></tt>, exports every resource in the file to the folder given by <tt>-ExportFolder</tt> (or the current directory) and quits, opening no windows. <tt>-ConvertExportedResources NO</tt> exports the resources' data as it is.
+*/
+
+- (void)applicationDidFinishLaunching:(NSNotification *)notification
+{
+	NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+	NSString *file = [defaults stringForKey:@"ExportFile"];
+	NSString *folder = [defaults stringForKey:@"ExportFolder"];
+	ResourceDocument *document;
+	RKExporter *exporter;
+	BOOL exported = NO;
+	if(!file) return;
+	
+	if(!folder) folder = [[NSFileManager defaultManager] currentDirectoryPath];
+	if(![[NSFileManager defaultManager] fileExistsAtPath:folder])
+		[[NSFileManager defaultManager] createDirectoryAtPath:folder attributes:nil];
+	document = [[NSDocumentController sharedDocumentController] openDocumentWithContentsOfFile:file display:NO];
+	if(document)
+	{
+		// resources are looked up through the window's data source, so its nib is loaded, though the window's never shown
+		[document makeWindowControllers];
+		[[[document windowControllers] lastObject] window];
+		exporter = [[[RKExporter alloc] initWithResources:[document resources] folder:folder convert:[defaults boolForKey:@"ConvertExportedResources"]] autorelease];
+		[exporter setDelegate:self];
+		exported = [exporter runUntilDone];
+		fprintf(stderr, "\n%u of %u resources exported to %s\n", [exporter writtenCount], [exporter count], [folder fileSystemRepresentation]);
+	}
+	else fprintf(stderr, "%s couldn't be opened\n", [file fileSystemRepresentation]);
+	exit(exported? 0 : 1);
+}
+
+- (void)exporterDidProgress:(RKExporter *)exporter
+{
+	fprintf(stderr, "\r%u of %u", [exporter writtenCount] + [exporter failedCount], [exporter count]);
+}
+
 - (BOOL)applicationShouldOpenUntitledFile:(NSApplication *)sender
 {
 #pragma unused(sender)
 	NSString *launchAction = [[NSUserDefaults standardUserDefaults] stringForKey:@"LaunchAction"];
-	if([launchAction isEqualToString:@"OpenUntitledFile"])
+	if([[NSUserDefaults standardUserDefaults] stringForKey:@"ExportFile"])
+		return NO;	// exporting without windows
+	else if([launchAction isEqualToString:@"OpenUntitledFile"])
 		return YES;
 	else if([launchAction isEqualToString:@"DisplayOpenPanel"])
 	{
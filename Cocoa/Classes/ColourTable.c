@@ -0,0 +1,154 @@
+#include "ColourTable.h"
+#include <string.h>
+
+#define COLOUR_TYPE(a, b, c, d)	(((UInt32) (a) << 24) | ((UInt32) (b) << 16) | ((UInt32) (c) << 8) | (UInt32) (d))
+
+enum
+{
+	kColourLookup = COLOUR_TYPE( 'c','l','u','t' ),
+	kPalette = COLOUR_TYPE( 'p','l','t','t' ),
+
+	kLookupHeaderSize = 8,
+	kLookupEntrySize = 8,
+	kPaletteHeaderSize = 16,
+	kPaletteEntrySize = 16,
+
+	kGreys = 32		// added to a depth for the System's grey tables
+};
+
+// the standard 16 colour table, as RGB
+static const UInt8 kFourBitColours[16][3] =
+{
+	{ 0xFF, 0xFF, 0xFF }, { 0xFC, 0xF3, 0x05 }, { 0xFF, 0x64, 0x02 }, { 0xDD, 0x08, 0x06 },
+	{ 0xF2, 0x08, 0x84 }, { 0x46, 0x00, 0xA5 }, { 0x00, 0x00, 0xD4 }, { 0x02, 0xAB, 0xEA },
+	{ 0x1F, 0xB7, 0x14 }, { 0x00, 0x64, 0x11 }, { 0x56, 0x2C, 0x05 }, { 0x90, 0x71, 0x3A },
+	{ 0xC0, 0xC0, 0xC0 }, { 0x80, 0x80, 0x80 }, { 0x40, 0x40, 0x40 }, { 0x00, 0x00, 0x00 }
+};
+
+static UInt32 ReadShort( const UInt8 *bytes )
+{
+	return ((UInt32) bytes[0] << 8) | bytes[1];
+}
+
+static void SetColour( ColourTable *table, UInt32 index, UInt8 red, UInt8 green, UInt8 blue )
+{
+	table->rgba[index][0] = red;
+	table->rgba[index][1] = green;
+	table->rgba[index][2] = blue;
+	table->rgba[index][3] = 0xFF;
+}
+
+Boolean ColourTableSystem(SInt16 resID, ColourTable *table)
+{
+	static const UInt8 ramp[10] = { 0xEE, 0xDD, 0xBB, 0xAA, 0x88, 0x77, 0x55, 0x44, 0x22, 0x11 };
+	UInt32 depth = (resID > kGreys)? resID - kGreys : resID, colours, i;
+	if( resID <= 0 || (depth != 1 && depth != 2 && depth != 4 && depth != 8) )
+		return false;
+	colours = 1UL << depth;
+
+	// what the depth can't reach is left black
+	memset( table, 0, sizeof(ColourTable) );
+	for( i = 0; i < 256; i++ )
+		table->rgba[i][3] = 0xFF;
+	if( resID > kGreys || depth == 1 )
+	{
+		// even steps from white to black
+		for( i = 0; i < colours; i++ )
+		{
+			UInt8 level = (UInt8) (255 - i * 255 / (colours - 1));
+			SetColour( table, i, level, level, level );
+		}
+	}
+	else if( depth == 2 )
+	{
+		SetColour( table, 0, 0xFF, 0xFF, 0xFF );
+		SetColour( table, 1, 0xAC, 0xAC, 0xAC );
+		SetColour( table, 2, 0x55, 0x55, 0x55 );
+	}
+	else if( depth == 4 )
+	{
+		for( i = 0; i < 16; i++ )
+			SetColour( table, i, kFourBitColours[i][0], kFourBitColours[i][1], kFourBitColours[i][2] );
+	}
+	else
+	{
+		// a 6x6x6 cube from white down, then ramps of red, green, blue and grey skipping the cube's levels, then black
+		for( i = 0; i < 215; i++ )
+			SetColour( table, i, (UInt8) ((5 - i / 36) * 0x33), (UInt8) ((5 - (i / 6) % 6) * 0x33), (UInt8) ((5 - i % 6) * 0x33) );
+		for( i = 0; i < 10; i++ )
+		{
+			SetColour( table, 215 + i, ramp[i], 0, 0 );
+			SetColour( table, 225 + i, 0, ramp[i], 0 );
+			SetColour( table, 235 + i, 0, 0, ramp[i] );
+			SetColour( table, 245 + i, ramp[i], ramp[i], ramp[i] );
+		}
+	}
+	return true;
+}
+
+Boolean ColourTableRead(UInt32 type, const UInt8 *bytes, UInt32 length, ColourTable *table)
+{
+	UInt32 count, i, header, size;
+	Boolean device = true;
+	if( type == kColourLookup )
+	{
+		if( length < kLookupHeaderSize ) return false;
+		device = (bytes[4] & 0x80) != 0;
+		count = ReadShort( bytes + 6 ) + 1UL;
+		header = kLookupHeaderSize;
+		size = kLookupEntrySize;
+	}
+	else if( type == kPalette )
+	{
+		if( length < kPaletteHeaderSize ) return false;
+		count = ReadShort( bytes );
+		header = kPaletteHeaderSize;
+		size = kPaletteEntrySize;
+	}
+	else return false;
+
+	for( i = 0; i < count; i++ )
+	{
+		const UInt8 *entry, *colour;
+		UInt32 index;
+		if( header + (i + 1) * size > length ) return false;
+		entry = bytes + header + i * size;
+		colour = (type == kColourLookup)? entry + 2 : entry;
+		index = device? i : ReadShort( entry );
+		if( index > 255 ) continue;
+		SetColour( table, index, colour[0], colour[2], colour[4] );
+	}
+	return true;
+}
+
+/*	The gather: each index is looked up as one word and stored as one, four at a time for 8-bit pixels. There's no
+	gather instruction to do better on the processors this runs on, and the table, at 1K, stays in the cache. */
+
+void ColourTableExpand(const ColourTable *table, const UInt8 *indices, UInt32 count, UInt32 depth, UInt8 *rgba)
+{
+	const UInt32 *words = table->words;
+	UInt32 i = 0;
+	if( depth == 8 )
+	{
+		for( ; i + 4 <= count; i += 4 )
+		{
+			UInt32 quad[4];
+			quad[0] = words[indices[i]];
+			quad[1] = words[indices[i + 1]];
+			quad[2] = words[indices[i + 2]];
+			quad[3] = words[indices[i + 3]];
+			memcpy( rgba + i * 4, quad, sizeof(quad) );
+		}
+		for( ; i < count; i++ )
+			memcpy( rgba + i * 4, &words[indices[i]], 4 );
+	}
+	else if( depth == 1 || depth == 2 || depth == 4 )
+	{
+		UInt32 perByte = 8 / depth, mask = (1UL << depth) - 1;
+		for( ; i < count; i++ )
+		{
+			UInt32 shift = 8 - depth - (i % perByte) * depth;
+			memcpy( rgba + i * 4, &words[(indices[i / perByte] >> shift) & mask], 4 );
+		}
+	}
+}
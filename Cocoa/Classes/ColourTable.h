@@ -0,0 +1,50 @@
+/* Colour tables */
+
+/*	Reads 'clut' and 'pltt' resources into 256-entry tables of RGBA, 8 bits per sample in R, G, B, A order, and makes
+	the standard Macintosh tables the System file keeps as 'clut's of its own: 1, 2, 4 and 8 for the colour tables of
+	each depth, and 33, 34, 36 and 40 for the greys. Indexed pixels are then turned into RGBA by looking each up in a
+	table as a single 32-bit word.
+
+	A 'clut' is an 8-byte header (seed, flags, count less one) and 8-byte entries (value, then 16-bit red, green and
+	blue); device tables, with the flags' top bit set, are in index order, and others give each entry's index as its
+	value. A 'pltt' is a 16-byte header starting with the count, and 16-byte entries starting with the colour; its
+	entries are in index order. */
+
+#ifndef COLOUR_TABLE_H
+#define COLOUR_TABLE_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef union ColourTable
+{
+	UInt8	rgba[256][4];
+	UInt32	words[256];		// the same, a word at a time, so a lookup is one load
+} ColourTable;
+
+/*!
+@function	ColourTableSystem
+@abstract	Fills in the System's 'clut' of the ID given. Returns false, leaving the table alone, if there isn't one.
+*/
+Boolean ColourTableSystem(SInt16 resID, ColourTable *table);
+
+/*!
+@function	ColourTableRead
+@abstract	Replaces the entries of the table given by a 'clut' or 'pltt' resource, leaving the rest alone. Returns false if the data's too short for the entries it claims, though those before the end are still read.
+*/
+Boolean ColourTableRead(UInt32 type, const UInt8 *bytes, UInt32 length, ColourTable *table);
+
+/*!
+@function	ColourTableExpand
+@abstract	Turns count pixels of 1, 2, 4 or 8 bits, packed from the top of each byte, into RGBA through the table.
+*/
+void ColourTableExpand(const ColourTable *table, const UInt8 *indices, UInt32 count, UInt32 depth, UInt8 *rgba);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
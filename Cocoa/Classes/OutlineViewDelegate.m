@@ -86,7 +86,7 @@ int compareResourcesDescending(Resource *r1, Resource *r2, void *context)
 
 - (BOOL)outlineView:(NSOutlineView *)outlineView shouldEditTableColumn:(NSTableColumn *)tableColumn item:(id)item
 {
-	if([[tableColumn identifier] isEqualToString:@"size"] || [[tableColumn identifier] isEqualToString:@"attributes"])
+	if([[tableColumn identifier] isEqualToString:@"size"] || [[tableColumn identifier] isEqualToString:@"attributes"] || [[tableColumn identifier] isEqualToString:@"thumbnail"])
 		return NO;
 	else return YES;
 }
@@ -250,6 +250,7 @@ int compareResourcesDescending(Resource *r1, Resource *r2, void *context)
 	{
 		NSTableColumn *tableColumn = [[self tableColumns] objectAtIndex:columnIndex];
 		NSImage *indicator = [self indicatorImageInTableColumn:tableColumn];
+		if([[tableColumn identifier] isEqualToString:@"thumbnail"]) return;	// nothing to sort by
 		NSImage *upArrow = [NSTableView _defaultTableHeaderSortImage];
 		NSImage *downArrow = [NSTableView _defaultTableHeaderReverseSortImage];
 		if(indicator)
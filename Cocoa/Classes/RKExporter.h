@@ -0,0 +1,98 @@
+#import <Cocoa/Cocoa.h>
+
+/*!
+@class			RKExporter
+@abstract		Exports many resources to files in a folder at once, on a small pool of worker threads which ask each resource's editor for the data to write, converted to a common format if asked for, and one thread which writes the files.
+@description	Workers hand the files they've made to the writer, and wait while it has more than a fixed number of them, or of bytes, still to write, so conversions never run far ahead of the disk. The delegate is told of progress, and of the end, on the main thread. An export can be cancelled at any time; files already written are kept. Nothing here touches the user interface, so resources can be exported with no windows open, as the ExportFile launch argument does.
+*/
+
+@interface RKExporter : NSObject
+{
+	NSArray				*jobs;			// [resource, editor class or NSNull, filename without extension]
+	NSString			*folder;
+	BOOL				convert;
+	id					delegate;		// not retained
+	unsigned			next;			// index of the next job for a worker to take
+	unsigned			workers;		// still running
+	unsigned			written;
+	unsigned			failed;
+	BOOL				cancelled;
+	BOOL				progressPending;	// a progress message is on its way to the main thread
+	BOOL				finished;
+	NSMutableArray		*files;			// made by the workers for the writer: [filename, extension, data]
+	unsigned long		fileBytes;		// held by files
+	NSMutableSet		*filenames;		// written so far, in lower case as the file system compares them
+	NSLock				*lock;			// held while using the counts, cancelled or progressPending
+	NSConditionLock		*filesLock;		// held while using files; condition is whether workers may add to it
+	NSConditionLock		*writerLock;	// condition is whether the writer has anything to do
+}
+
+/*!
+@method		filenameExtensionForType:
+@abstract	The extension given to a resource of the type given whose editor doesn't name one.
+*/
++ (NSString *)filenameExtensionForType:(NSString *)type;
+
+/*!
+@method		initWithResources:folder:convert:
+@abstract	Readies an export of the resources to the folder given, which must exist. If convert is YES, editors are asked for their dataForFileConversion: first.
+*/
+- (id)initWithResources:(NSArray *)resources folder:(NSString *)path convert:(BOOL)flag;
+
+/*!
+@method		setDelegate:
+@abstract	Sets the object sent exporterDidProgress: and exporterDidFinish:. It isn't retained.
+*/
+- (void)setDelegate:(id)object;
+
+/*!
+@method		start
+@abstract	Starts the workers and writer, and returns.
+*/
+- (void)start;
+
+/*!
+@method		cancel
+@abstract	Stops the export once the files being made are done, writing none of them.
+*/
+- (void)cancel;
+
+/*!
+@method		runUntilDone
+@abstract	Starts the export and returns once it's finished, running the main thread's run loop meanwhile, as resources are looked up on it. Returns NO if any resource couldn't be exported.
+*/
+- (BOOL)runUntilDone;
+
+/*!
+@method		count
+@abstract	The number of resources being exported.
+*/
+- (unsigned)count;
+
+/*!
+@method		writtenCount
+*/
+- (unsigned)writtenCount;
+
+/*!
+@method		failedCount
+@abstract	The number of resources which had no data, or whose files couldn't be written.
+*/
+- (unsigned)failedCount;
+
+/*!
+@method		isFinished
+*/
+- (BOOL)isFinished;
+
+/*!
+@method		isCancelled
+*/
+- (BOOL)isCancelled;
+
+@end
+
+@interface NSObject (RKExporterDelegate)
+- (void)exporterDidProgress:(RKExporter *)exporter;
+- (void)exporterDidFinish:(RKExporter *)exporter;
+@end
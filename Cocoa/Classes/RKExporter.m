@@ -0,0 +1,302 @@
+#import "RKExporter.h"
+#import "RKEditorRegistry.h"
+#import "Resource.h"
+#import "ResKnifePluginProtocol.h"
+#import <CoreServices/CoreServices.h>
+#import <sys/stat.h>
+
+enum
+{
+	kExportMaxWorkers = 4,
+	kExportFilesWaiting = 32,				// made but not yet written, before workers wait
+	kExportBytesWaiting = 16 * 1024 * 1024,
+
+	// jobs entries
+	kJobResource = 0,
+	kJobEditor,
+	kJobFilename,
+
+	// files entries
+	kFileFilename = 0,
+	kFileExtension,
+	kFileData
+};
+
+@interface RKExporter (Private)
+- (NSArray *)fileForJob:(NSArray *)job;
+- (NSString *)pathForFilename:(NSString *)filename extension:(NSString *)extension;
+- (void)workThread:(id)unused;
+- (void)writeThread:(id)unused;
+- (void)postProgress;
+- (void)didProgress;
+- (void)didFinish;
+@end
+
+@implementation RKExporter
+
++ (NSString *)filenameExtensionForType:(NSString *)type
+{
+	// basic overrides for file name extensions (assume no plug-ins installed)
+	NSDictionary *adjustments = [NSDictionary dictionaryWithObjectsAndKeys: @"ttf", @"sfnt", @"png", @"PNGf", nil];
+	if([adjustments objectForKey:type])
+		return [adjustments objectForKey:type];
+	return [[type lowercaseString] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+}
+
+- (id)initWithResources:(NSArray *)resources folder:(NSString *)path convert:(BOOL)flag
+{
+	NSMutableArray *newJobs = [NSMutableArray arrayWithCapacity:[resources count]];
+	NSEnumerator *enumerator = [resources objectEnumerator];
+	Resource *resource;
+	unsigned untitled = 1;
+	self = [super init];
+	if(!self) return nil;
+
+	// editors are found here, on the main thread, and the workers only use what's found
+	while(resource = [enumerator nextObject])
+	{
+		Class editor = [[RKEditorRegistry defaultRegistry] editorForType:[resource type]];
+		NSString *filename = [resource name];
+		if(!filename || [filename isEqualToString:@""])
+			filename = [NSString stringWithFormat:NSLocalizedString(@"Untitled '%@' Resource %d",nil), [resource type], untitled++];
+		else filename = [[filename componentsSeparatedByString:@"/"] componentsJoinedByString:@":"];
+		[newJobs addObject:[NSArray arrayWithObjects:resource, editor? (id) editor : (id) [NSNull null], filename, nil]];
+	}
+	jobs = [newJobs copy];
+	folder = [path copy];
+	convert = flag;
+	files = [[NSMutableArray alloc] init];
+	filenames = [[NSMutableSet alloc] init];
+	lock = [[NSLock alloc] init];
+	filesLock = [[NSConditionLock alloc] initWithCondition:1];
+	writerLock = [[NSConditionLock alloc] initWithCondition:0];
+	return self;
+}
+
+- (void)dealloc
+{
+	[jobs release];
+	[folder release];
+	[files release];
+	[filenames release];
+	[lock release];
+	[filesLock release];
+	[writerLock release];
+	[super dealloc];
+}
+
+- (void)setDelegate:(id)object
+{
+	delegate = object;
+}
+
+- (void)start
+{
+	unsigned i;
+	workers = MPProcessors();
+	if(workers > kExportMaxWorkers) workers = kExportMaxWorkers;
+	if(workers < 1) workers = 1;
+	for(i = 0; i < workers; i++)
+		[NSThread detachNewThreadSelector:@selector(workThread:) toTarget:self withObject:nil];
+	[NSThread detachNewThreadSelector:@selector(writeThread:) toTarget:self withObject:nil];
+}
+
+- (void)cancel
+{
+	[lock lock];
+	cancelled = YES;
+	[lock unlock];
+}
+
+- (BOOL)runUntilDone
+{
+	[self start];
+	while(![self isFinished])
+		[[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
+	return !cancelled && failed == 0;
+}
+
+- (unsigned)count
+{
+	return [jobs count];
+}
+
+- (unsigned)writtenCount
+{
+	return written;
+}
+
+- (unsigned)failedCount
+{
+	return failed;
+}
+
+- (BOOL)isFinished
+{
+	return finished;
+}
+
+- (BOOL)isCancelled
+{
+	return cancelled;
+}
+
+#pragma mark -
+
+/* Called on the workers: the file's data, converted if it can be and that's wanted, and its extension. Nil if there's
+	nothing to write. */
+- (NSArray *)fileForJob:(NSArray *)job
+{
+	Resource *resource = [job objectAtIndex:kJobResource];
+	id editor = [job objectAtIndex:kJobEditor];
+	NSData *data = nil;
+	NSString *extension = nil;
+
+	if(convert && [editor respondsToSelector:@selector(dataForFileConversion:)])
+		data = [editor dataForFileConversion:resource];
+	if(data)
+	{
+		if([editor respondsToSelector:@selector(filenameExtensionForFileConversion:)])
+			extension = [editor filenameExtensionForFileConversion:resource];
+	}
+	else
+	{
+		// ask for data
+		if([editor respondsToSelector:@selector(dataForFileExport:)])
+			data = [editor dataForFileExport:resource];
+		else data = [resource data];
+
+		// ask for file extension
+		if([editor respondsToSelector:@selector(filenameExtensionForFileExport:)])
+			extension = [editor filenameExtensionForFileExport:resource];
+	}
+	if(!data) return nil;
+	if(!extension) extension = [RKExporter filenameExtensionForType:[resource type]];
+	return [NSArray arrayWithObjects:[job objectAtIndex:kJobFilename], extension, data, nil];
+}
+
+/* Called on the writer: a path in the folder not already taken, by this export or anything else. */
+- (NSString *)pathForFilename:(NSString *)filename extension:(NSString *)extension
+{
+	NSString *name = [filename stringByAppendingPathExtension:extension];
+	NSString *path = [folder stringByAppendingPathComponent:name];
+	unsigned i = 1;
+	struct stat info;
+	while([filenames containsObject:[name lowercaseString]] || lstat([path fileSystemRepresentation], &info) == 0)
+	{
+		name = [[filename stringByAppendingFormat:@" (%u)", i++] stringByAppendingPathExtension:extension];
+		path = [folder stringByAppendingPathComponent:name];
+	}
+	[filenames addObject:[name lowercaseString]];
+	return path;
+}
+
+- (void)workThread:(id)unused
+{
+	while(YES)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		NSArray *job = nil, *file;
+		[lock lock];
+		if(!cancelled && next < [jobs count])
+			job = [jobs objectAtIndex:next++];
+		[lock unlock];
+		if(!job)
+		{
+			[pool release];
+			break;
+		}
+
+		file = [self fileForJob:job];
+		if(file)
+		{
+			// wait for the writer to catch up if it's too far behind
+			[filesLock lockWhenCondition:1];
+			[files addObject:file];
+			fileBytes += [[file objectAtIndex:kFileData] length];
+			[filesLock unlockWithCondition:([files count] < kExportFilesWaiting && fileBytes < kExportBytesWaiting)? 1:0];
+			[writerLock lock];
+			[writerLock unlockWithCondition:1];
+		}
+		else
+		{
+			[lock lock];
+			failed++;
+			[lock unlock];
+		}
+		[pool release];
+	}
+
+	[lock lock];
+	workers--;
+	[lock unlock];
+	[writerLock lock];
+	[writerLock unlockWithCondition:1];
+}
+
+- (void)writeThread:(id)unused
+{
+	BOOL done = NO;
+	while(!done)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		NSEnumerator *enumerator;
+		NSArray *batch, *file;
+		[writerLock lockWhenCondition:1];
+
+		// workers add their files before they finish, so once they all have, this batch is the last
+		[lock lock];
+		done = (workers == 0);
+		[lock unlock];
+		[filesLock lock];
+		batch = [[files copy] autorelease];
+		[files removeAllObjects];
+		fileBytes = 0;
+		[filesLock unlockWithCondition:1];
+		[writerLock unlockWithCondition:0];
+
+		enumerator = [batch objectEnumerator];
+		while(file = [enumerator nextObject])
+		{
+			BOOL ok;
+			if([self isCancelled]) break;
+			ok = [[file objectAtIndex:kFileData] writeToFile:[self pathForFilename:[file objectAtIndex:kFileFilename] extension:[file objectAtIndex:kFileExtension]] atomically:YES];
+			[lock lock];
+			if(ok) written++;
+			else failed++;
+			[lock unlock];
+		}
+		[self postProgress];
+		[pool release];
+	}
+	[self performSelectorOnMainThread:@selector(didFinish) withObject:nil waitUntilDone:NO];
+}
+
+- (void)postProgress
+{
+	// at most one on its way at a time, however quickly files are written
+	BOOL post;
+	[lock lock];
+	post = !progressPending;
+	progressPending = YES;
+	[lock unlock];
+	if(post) [self performSelectorOnMainThread:@selector(didProgress) withObject:nil waitUntilDone:NO];
+}
+
+- (void)didProgress
+{
+	[lock lock];
+	progressPending = NO;
+	[lock unlock];
+	if([delegate respondsToSelector:@selector(exporterDidProgress:)])
+		[delegate exporterDidProgress:self];
+}
+
+- (void)didFinish
+{
+	finished = YES;
+	if([delegate respondsToSelector:@selector(exporterDidFinish:)])
+		[delegate exporterDidFinish:self];
+}
+
+@end
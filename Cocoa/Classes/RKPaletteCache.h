@@ -0,0 +1,28 @@
+#import <Cocoa/Cocoa.h>
+#import "ColourTable.h"
+
+/*!
+@class			RKPaletteCache
+@abstract		Colour tables for indexed images, decoded once from a document's 'clut' and 'pltt' resources and shared by every editor and thumbnail drawing them.
+@description	Tables are kept by document, ID and depth, with the data they were read from. Each request looks the resource up again, and the table is only read again if the data has been replaced since, or edited in place. IDs with no 'clut' or 'pltt' in the document fall back to the System's tables of that ID, or of the depth given. Safe to use from any thread.
+*/
+
+@interface RKPaletteCache : NSObject
+{
+	NSMutableDictionary	*tables;	// [NSValue of document, ID, depth] -> [data read or NSNull, NSData of a ColourTable]
+	NSMutableArray		*recent;	// keys of tables, least recently used first
+	NSLock				*lock;		// held while using either of the above, never while looking up or reading resources
+}
+
+/*!
+@method		sharedCache
+*/
++ (RKPaletteCache *)sharedCache;
+
+/*!
+@method		colourTableWithID:depth:inDocument:
+@abstract	Returns an NSData holding the ColourTable of the 'clut' or 'pltt' given, or the System's 'clut' with that ID, or else the System's table for the depth given.
+*/
+- (NSData *)colourTableWithID:(short)resID depth:(int)depth inDocument:(NSDocument *)document;
+
+@end
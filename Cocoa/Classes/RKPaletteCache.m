@@ -0,0 +1,123 @@
+#import "RKPaletteCache.h"
+#import "Resource.h"
+
+enum
+{
+	kPaletteCacheSize = 64,
+
+	// tables entries
+	kEntryData = 0,
+	kEntryTable
+};
+
+static RKPaletteCache *gSharedCache = nil;
+
+@interface RKPaletteCache (Private)
+- (void)resourceDataDidChange:(NSNotification *)notification;
+@end
+
+@implementation RKPaletteCache
+
++ (void)initialize
+{
+	// made here, as the runtime makes sure only one thread does this
+	if(self == [RKPaletteCache class]) gSharedCache = [[RKPaletteCache alloc] init];
+}
+
++ (RKPaletteCache *)sharedCache
+{
+	return gSharedCache;
+}
+
+- (id)init
+{
+	self = [super init];
+	if(!self) return nil;
+	tables = [[NSMutableDictionary alloc] init];
+	recent = [[NSMutableArray alloc] init];
+	lock = [[NSLock alloc] init];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[tables release];
+	[recent release];
+	[lock release];
+	[super dealloc];
+}
+
+- (NSData *)colourTableWithID:(short)resID depth:(int)depth inDocument:(NSDocument *)document
+{
+	NSNumber *number = [NSNumber numberWithShort:resID];
+	NSArray *key = [NSArray arrayWithObjects:[NSValue valueWithNonretainedObject:document], number, [NSNumber numberWithInt:depth], nil];
+	NSString *type = @"clut";
+	NSData *data = nil, *table;
+	NSArray *entry;
+	ColourTable colours;
+
+	// the document's own, if it has one
+	if(document)
+	{
+		data = [[Resource resourceOfType:type andID:number inDocument:document] data];
+		if(!data)
+		{
+			type = @"pltt";
+			data = [[Resource resourceOfType:type andID:number inDocument:document] data];
+		}
+	}
+
+	[lock lock];
+	entry = [[[tables objectForKey:key] retain] autorelease];
+	[recent removeObject:key];
+	if(entry) [recent addObject:key];
+	[lock unlock];
+	if(entry && [entry objectAtIndex:kEntryData] == (data? (id) data : (id) [NSNull null]))
+		return [entry objectAtIndex:kEntryTable];
+
+	// entries the document's table doesn't give are the System's
+	if(!ColourTableSystem(resID, &colours) && !ColourTableSystem(depth, &colours))
+		ColourTableSystem(8, &colours);
+	if(data && !ColourTableRead([type isEqualToString:@"clut"]? 'clut' : 'pltt', [data bytes], [data length], &colours))
+		NSLog(@"The '%@' %d is cut short; only the colours before its end are used.", type, resID);
+	table = [NSData dataWithBytes:&colours length:sizeof(colours)];
+
+	[lock lock];
+	[tables setObject:[NSArray arrayWithObjects:data? (id) data : (id) [NSNull null], table, nil] forKey:key];
+	[recent removeObject:key];
+	[recent addObject:key];
+	if([recent count] > kPaletteCacheSize)
+	{
+		[tables removeObjectForKey:[recent objectAtIndex:0]];
+		[recent removeObjectAtIndex:0];
+	}
+	[lock unlock];
+	return table;
+}
+
+#pragma mark -
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	// data edited in place is still the same object, so its tables have to be dropped here
+	Resource *resource = [notification object];
+	NSEnumerator *enumerator;
+	NSArray *key;
+	if(![[resource type] isEqualToString:@"clut"] && ![[resource type] isEqualToString:@"pltt"]) return;
+
+	[lock lock];
+	enumerator = [[tables allKeys] objectEnumerator];
+	while(key = [enumerator nextObject])
+	{
+		if([[key objectAtIndex:0] nonretainedObjectValue] == [resource document] && [[key objectAtIndex:1] isEqual:[resource resID]])
+		{
+			[tables removeObjectForKey:key];
+			[recent removeObject:key];
+		}
+	}
+	[lock unlock];
+}
+
+@end
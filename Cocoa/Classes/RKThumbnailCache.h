@@ -0,0 +1,46 @@
+#import <Cocoa/Cocoa.h>
+
+@class Resource;
+
+extern NSString *RKThumbnailDidLoadNotification;
+
+/*!
+@class			RKThumbnailCache
+@abstract		Thumbnails for the resource list's thumbnail column, drawn by the resources' editors on a small pool of worker threads.
+@description	Asking for a thumbnail which isn't ready yet returns nil and queues it, newest first; RKThumbnailDidLoadNotification is posted with the resource once it's drawn. Requests for rows which have scrolled out of view are taken off the queue before they're started. Thumbnails are kept, least recently used first out, until the pixels they hold exceed a fixed budget, and are dropped when their resource's data changes.
+*/
+
+@interface RKThumbnailCache : NSObject
+{
+	NSMutableDictionary	*thumbnails;	// NSValue of resource -> [data drawn, NSImage or NSNull if it can't be drawn, NSNumber of bytes]
+	NSMutableArray		*recent;		// keys of thumbnails, least recently used first
+	unsigned long		bytes;			// held by all thumbnails
+	NSMutableArray		*queue;			// jobs waiting for a worker: [key, resource, data, editor class, NSValue of document]
+	NSMutableSet		*pending;		// keys queued or being drawn
+	NSConditionLock		*queueLock;		// condition is whether the queue has anything in it
+}
+
+/*!
+@method		sharedCache
+*/
++ (RKThumbnailCache *)sharedCache;
+
+/*!
+@method		thumbnailSize
+@abstract	The size thumbnails are drawn to fit.
+*/
++ (NSSize)thumbnailSize;
+
+/*!
+@method		thumbnailForResource:inDocument:
+@abstract	Returns the resource's thumbnail, or nil if it has none or it's still to be drawn.
+*/
+- (NSImage *)thumbnailForResource:(Resource *)resource inDocument:(NSDocument *)document;
+
+/*!
+@method		cancelRequestsInDocument:except:
+@abstract	Takes the document's queued thumbnails off the queue, other than those of the resources given (all of them if nil).
+*/
+- (void)cancelRequestsInDocument:(NSDocument *)document except:(NSArray *)resources;
+
+@end
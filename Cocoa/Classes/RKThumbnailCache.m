@@ -0,0 +1,216 @@
+#import "RKThumbnailCache.h"
+#import "RKEditorRegistry.h"
+#import "Resource.h"
+
+NSString *RKThumbnailDidLoadNotification = @"RKThumbnailDidLoadNotification";
+
+enum
+{
+	kThumbnailWorkers = 2,
+	kThumbnailBudget = 8 * 1024 * 1024,	// bytes of pixels
+	kThumbnailEntryCost = 256,			// counted for every entry, so ones which can't be drawn are eventually dropped too
+
+	// thumbnails entries
+	kEntryData = 0,
+	kEntryImage,
+	kEntryBytes,
+
+	// jobs for the workers
+	kJobKey = 0,
+	kJobResource,
+	kJobData,
+	kJobEditor,
+	kJobDocument
+};
+
+static RKThumbnailCache *gSharedCache = nil;
+
+@interface RKThumbnailCache (Private)
+- (void)removeThumbnailForKey:(NSValue *)key;
+- (void)resourceDataDidChange:(NSNotification *)notification;
+- (void)workThread:(id)unused;
+- (void)finishJob:(NSArray *)jobAndThumbnail;
+@end
+
+@implementation RKThumbnailCache
+
++ (RKThumbnailCache *)sharedCache
+{
+	if(!gSharedCache) gSharedCache = [[RKThumbnailCache alloc] init];
+	return gSharedCache;
+}
+
++ (NSSize)thumbnailSize
+{
+	return NSMakeSize(32, 32);
+}
+
+- (id)init
+{
+	int i;
+	self = [super init];
+	if(!self) return nil;
+	thumbnails = [[NSMutableDictionary alloc] init];
+	recent = [[NSMutableArray alloc] init];
+	bytes = 0;
+	queue = [[NSMutableArray alloc] init];
+	pending = [[NSMutableSet alloc] init];
+	queueLock = [[NSConditionLock alloc] initWithCondition:0];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	for(i = 0; i < kThumbnailWorkers; i++)
+		[NSThread detachNewThreadSelector:@selector(workThread:) toTarget:self withObject:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[thumbnails release];
+	[recent release];
+	[queue release];
+	[pending release];
+	[queueLock release];
+	[super dealloc];
+}
+
+- (NSImage *)thumbnailForResource:(Resource *)resource inDocument:(NSDocument *)document
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	NSArray *entry = [thumbnails objectForKey:key];
+	NSData *data = [resource data];
+	Class editor;
+
+	if(entry && [entry objectAtIndex:kEntryData] == data)
+	{
+		id image = [entry objectAtIndex:kEntryImage];
+		[recent removeObject:key];
+		[recent addObject:key];
+		return (image == [NSNull null])? nil : image;
+	}
+	else if(entry) [self removeThumbnailForKey:key];
+
+	// already waiting: move it to the front, as it's been looked at again
+	if([pending containsObject:key])
+	{
+		unsigned i;
+		[queueLock lock];
+		for(i = 0; i < [queue count]; i++)
+		{
+			NSArray *job = [queue objectAtIndex:i];
+			if([[job objectAtIndex:kJobKey] isEqual:key])
+			{
+				[[job retain] autorelease];
+				[queue removeObjectAtIndex:i];
+				[queue addObject:job];
+				break;
+			}
+		}
+		[queueLock unlockWithCondition:[queue count]? 1:0];
+		return nil;
+	}
+
+	editor = [[RKEditorRegistry defaultRegistry] editorForType:[resource type]];
+	if(!data || ![editor respondsToSelector:@selector(thumbnailForResource:size:)])
+		return nil;
+
+	[pending addObject:key];
+	[queueLock lock];
+	[queue addObject:[NSArray arrayWithObjects:key, resource, data, editor, [NSValue valueWithNonretainedObject:document], nil]];
+	[queueLock unlockWithCondition:1];
+	return nil;
+}
+
+- (void)cancelRequestsInDocument:(NSDocument *)document except:(NSArray *)resources
+{
+	int i;
+	[queueLock lock];
+	for(i = [queue count] -1; i >= 0; i--)
+	{
+		NSArray *job = [queue objectAtIndex:i];
+		if([[job objectAtIndex:kJobDocument] nonretainedObjectValue] == document && (!resources || [resources indexOfObjectIdenticalTo:[job objectAtIndex:kJobResource]] == NSNotFound))
+		{
+			[pending removeObject:[job objectAtIndex:kJobKey]];
+			[queue removeObjectAtIndex:i];
+		}
+	}
+	[queueLock unlockWithCondition:[queue count]? 1:0];
+}
+
+#pragma mark -
+
+- (void)removeThumbnailForKey:(NSValue *)key
+{
+	NSArray *entry = [thumbnails objectForKey:key];
+	if(!entry) return;
+	bytes -= [[entry objectAtIndex:kEntryBytes] unsignedLongValue];
+	[thumbnails removeObjectForKey:key];
+	[recent removeObject:key];
+}
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:[notification object]];
+	int i;
+	[self removeThumbnailForKey:key];
+
+	// a queued job would draw the old data
+	[queueLock lock];
+	for(i = [queue count] -1; i >= 0; i--)
+	{
+		if([[[queue objectAtIndex:i] objectAtIndex:kJobKey] isEqual:key])
+		{
+			[pending removeObject:key];
+			[queue removeObjectAtIndex:i];
+		}
+	}
+	[queueLock unlockWithCondition:[queue count]? 1:0];
+}
+
+- (void)workThread:(id)unused
+{
+	while(YES)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		NSArray *job;
+		NSImage *thumbnail;
+		[queueLock lockWhenCondition:1];
+		job = [[[queue lastObject] retain] autorelease];
+		[queue removeLastObject];
+		[queueLock unlockWithCondition:[queue count]? 1:0];
+
+		thumbnail = [[job objectAtIndex:kJobEditor] thumbnailForResource:[job objectAtIndex:kJobResource] size:[RKThumbnailCache thumbnailSize]];
+		[self performSelectorOnMainThread:@selector(finishJob:) withObject:[NSArray arrayWithObjects:job, thumbnail? (id) thumbnail : (id) [NSNull null], nil] waitUntilDone:NO];
+		[pool release];
+	}
+}
+
+- (void)finishJob:(NSArray *)jobAndThumbnail
+{
+	NSArray *job = [jobAndThumbnail objectAtIndex:0];
+	id thumbnail = [jobAndThumbnail objectAtIndex:1];
+	NSValue *key = [job objectAtIndex:kJobKey];
+	Resource *resource = [job objectAtIndex:kJobResource];
+	unsigned long cost = kThumbnailEntryCost;
+
+	// given new data while it was being drawn: have the row ask again, so it's redrawn
+	[pending removeObject:key];
+	if([resource data] != [job objectAtIndex:kJobData])
+	{
+		[[NSNotificationCenter defaultCenter] postNotificationName:RKThumbnailDidLoadNotification object:resource];
+		return;
+	}
+
+	if(thumbnail != [NSNull null])
+		cost += (unsigned long) ([thumbnail size].width * [thumbnail size].height * 4);
+	[self removeThumbnailForKey:key];
+	[thumbnails setObject:[NSArray arrayWithObjects:[job objectAtIndex:kJobData], thumbnail, [NSNumber numberWithUnsignedLong:cost], nil] forKey:key];
+	[recent addObject:key];
+	bytes += cost;
+	while(bytes > kThumbnailBudget && [recent count] > 1)
+		[self removeThumbnailForKey:[recent objectAtIndex:0]];
+
+	if(thumbnail != [NSNull null])
+		[[NSNotificationCenter defaultCenter] postNotificationName:RKThumbnailDidLoadNotification object:resource];
+}
+
+@end
@@ -1,9 +1,45 @@
 #import "Resource.h"
 #import "ResourceDocument.h"
 #import "ResourceDataSource.h"
+#import <pthread.h>
 
 NSString *RKResourcePboardType = @"RKResourcePboardType";
 
+@interface Resource (MainThread)
++ (void)invokeRetainingResult:(NSInvocation *)invocation;
+@end
+
+/* Plug-ins drawing thumbnails look resources up from the host's worker threads, but the documents' resource lists
+	may only be read on the main thread, so lookups from anywhere else are made there and waited for. */
+static id ResultOnMainThread(id target, SEL selector, id first, id second, id third)
+{
+	NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[target methodSignatureForSelector:selector]];
+	unsigned arguments = [[invocation methodSignature] numberOfArguments];
+	id result;
+	[invocation setTarget:target];
+	[invocation setSelector:selector];
+	if(arguments > 2) [invocation setArgument:&first atIndex:2];
+	if(arguments > 3) [invocation setArgument:&second atIndex:3];
+	if(arguments > 4) [invocation setArgument:&third atIndex:4];
+	[invocation retainArguments];
+	[Resource performSelectorOnMainThread:@selector(invokeRetainingResult:) withObject:invocation waitUntilDone:YES];
+	[invocation getReturnValue:&result];
+	return [result autorelease];
+}
+
+@implementation Resource (MainThread)
+
+// the result is retained so it outlives the main thread's autorelease pool
++ (void)invokeRetainingResult:(NSInvocation *)invocation
+{
+	id result;
+	[invocation invoke];
+	[invocation getReturnValue:&result];
+	[result retain];
+}
+
+@end
+
 @implementation Resource
 
 - (id)init
@@ -60,6 +96,7 @@ NSString *RKResourcePboardType = @"RKResourcePboardType";
 
 + (Resource *)getResourceOfType:(NSString *)typeValue andID:(NSNumber *)resIDValue inDocument:(NSDocument *)searchDoc
 {
+	if(!pthread_main_np()) return ResultOnMainThread(self, _cmd, typeValue, resIDValue, searchDoc);
 	NSDocument *doc;
 	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
 	while(doc = [enumerator nextObject])
@@ -78,6 +115,7 @@ NSString *RKResourcePboardType = @"RKResourcePboardType";
 
 + (NSArray *)allResourcesOfType:(NSString *)typeValue inDocument:(NSDocument *)searchDoc
 {
+	if(!pthread_main_np()) return ResultOnMainThread(self, _cmd, typeValue, searchDoc, nil);
 	NSMutableArray *array = [NSMutableArray array];
 	NSDocument *doc;
 	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
@@ -92,6 +130,7 @@ NSString *RKResourcePboardType = @"RKResourcePboardType";
 
 + (Resource *)resourceOfType:(NSString *)typeValue withName:(NSString *)nameValue inDocument:(NSDocument *)searchDoc
 {
+	if(!pthread_main_np()) return ResultOnMainThread(self, _cmd, typeValue, nameValue, searchDoc);
 	NSDocument *doc;
 	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
 	while(doc = [enumerator nextObject])
@@ -108,6 +147,7 @@ NSString *RKResourcePboardType = @"RKResourcePboardType";
 
 + (Resource *)resourceOfType:(NSString *)typeValue andID:(NSNumber *)resIDValue inDocument:(NSDocument *)searchDoc
 {
+	if(!pthread_main_np()) return ResultOnMainThread(self, _cmd, typeValue, resIDValue, searchDoc);
 	NSDocument *doc;
 	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
 	while(doc = [enumerator nextObject])
@@ -125,6 +165,7 @@ NSString *RKResourcePboardType = @"RKResourcePboardType";
 // should probably be in resource document, not resource, but it fits in with the above methods quite well
 + (NSDocument *)documentForResource:(Resource *)resource
 {
+	if(!pthread_main_np()) return ResultOnMainThread(self, _cmd, resource, nil, nil);
 	NSDocument *doc;
 	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
 	while(doc = [enumerator nextObject])
@@ -306,7 +347,8 @@ NSString *RKResourcePboardType = @"RKResourcePboardType";
 
 - (NSData *)data
 {
-	return data;
+	// retained for plug-ins reading it from other threads, in case it's replaced meanwhile
+	return [[data retain] autorelease];
 }
 
 - (void)setData:(NSData *)newData
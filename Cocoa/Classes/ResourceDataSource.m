@@ -1,13 +1,9 @@
 #import "ResourceDataSource.h"
 #import "ResourceDocument.h"
 #import "Resource.h"
+#import "RKThumbnailCache.h"
 #import <limits.h>
 
-NSString *DataSourceWillAddResourceNotification = @"DataSourceWillAddResource";
-NSString *DataSourceDidAddResourceNotification = @"DataSourceDidAddResource";
-NSString *DataSourceWillRemoveResourceNotification = @"DataSourceWillRemoveResource";
-NSString *DataSourceDidRemoveResourceNotification = @"DataSourceDidRemoveResource";
-
 extern NSString *RKResourcePboardType;
 
 @implementation ResourceDataSource
@@ -19,6 +15,14 @@ extern NSString *RKResourcePboardType;
 	return self;
 }
 
+- (void)awakeFromNib
+{
+	// thumbnails wanted for rows scrolled out of view aren't drawn
+	[[[outlineView enclosingScrollView] contentView] setPostsBoundsChangedNotifications:YES];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(visibleRowsDidChange:) name:NSViewBoundsDidChangeNotification object:[[outlineView enclosingScrollView] contentView]];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(thumbnailDidLoad:) name:RKThumbnailDidLoadNotification object:nil];
+}
+
 - (void)dealloc
 {
 	[[NSNotificationCenter defaultCenter] removeObserver:self];
@@ -76,6 +80,24 @@ extern NSString *RKResourcePboardType;
 	[outlineView reloadItem:[notification object]];
 }
 
+- (void)visibleRowsDidChange:(NSNotification *)notification
+{
+	NSRange rows = [outlineView rowsInRect:[outlineView visibleRect]];
+	NSMutableArray *visible = [NSMutableArray arrayWithCapacity:rows.length];
+	unsigned row;
+	if(![outlineView tableColumnWithIdentifier:@"thumbnail"]) return;
+	for(row = rows.location; row < NSMaxRange(rows); row++)
+		[visible addObject:[outlineView itemAtRow:row]];
+	[[RKThumbnailCache sharedCache] cancelRequestsInDocument:document except:visible];
+}
+
+- (void)thumbnailDidLoad:(NSNotification *)notification
+{
+	int row = [outlineView rowForItem:[notification object]];
+	if(row != -1 && [outlineView tableColumnWithIdentifier:@"thumbnail"])
+		[outlineView setNeedsDisplayInRect:[outlineView rectOfRow:row]];
+}
+
 /* Data source protocol implementation */
 
 - (id)outlineView:(NSOutlineView *)outlineView child:(int)index ofItem:(id)item
@@ -99,6 +121,9 @@ extern NSString *RKResourcePboardType;
 - (id)outlineView:(NSOutlineView *)outlineView objectValueForTableColumn:(NSTableColumn *)tableColumn byItem:(id)item
 {
 	#pragma unused(outlineView)
+	// only asked for rows being drawn, so it's just those that get queued
+	if([[tableColumn identifier] isEqualToString:@"thumbnail"])
+		return [[RKThumbnailCache sharedCache] thumbnailForResource:item inDocument:document];
 	return [item valueForKey:[tableColumn identifier]];
 }
 
@@ -1,7 +1,7 @@
 #import <Cocoa/Cocoa.h>
 #import <Carbon/Carbon.h>	// Actually I only need CarbonCore.framework
 
-@class ResourceWindowController, ResourceDataSource, Resource;
+@class ResourceWindowController, ResourceDataSource, Resource, RKExporter;
 
 @interface ResourceDocument : NSDocument
 {
@@ -15,6 +15,11 @@
 	NSData			*creator;
 	NSData			*type;
 	BOOL			_createFork;	// file had no existing resource map when opened
+	float			_rowHeight;		// the outline view's own, for when thumbnails are hidden
+	RKExporter		*exporter;		// of the selected resources to a folder, while one's in progress
+	NSWindow		*exportSheet;	// showing its progress
+	NSProgressIndicator	*exportProgress;
+	NSTextField		*exportStatus;
 }
 
 - (BOOL)readFork:(NSString *)forkName asStreamFromFile:(FSRef *)fileRef;
@@ -25,6 +30,9 @@
 - (IBAction)exportResources:(id)sender;
 - (void)exportResource:(Resource *)resource;
 - (void)exportPanelDidEnd:(NSSavePanel *)sheet returnCode:(int)returnCode contextInfo:(void *)contextInfo;
+- (void)folderChoosePanelDidEnd:(NSSavePanel *)sheet returnCode:(int)returnCode contextInfo:(void *)contextInfo;
+- (void)beginExportSheet;
+- (IBAction)cancelExport:(id)sender;
 
 - (void)setupToolbar:(NSWindowController *)windowController;
 
@@ -36,6 +44,8 @@
 - (void)openResourceUsingEditor:(Resource *)resource;
 - (void)openResource:(Resource *)resource usingTemplate:(NSString *)templateName;
 - (void)openResourceAsHex:(Resource *)resource;
+- (IBAction)toggleThumbnails:(id)sender;
+- (void)setShowsThumbnails:(BOOL)flag;
 - (IBAction)playSound:(id)sender;
 - (void)sound:(NSSound *)sound didFinishPlaying:(BOOL)finished;
 
@@ -14,6 +14,9 @@
 
 #import "../Plug-Ins/ResKnifePluginProtocol.h"
 #import "RKEditorRegistry.h"
+#import "RKThumbnailCache.h"
+#import "RKExporter.h"
+#import "SoundPlayer.h"
 
 
 NSString *DocumentInfoWillChangeNotification		= @"DocumentInfoWillChangeNotification";
@@ -37,6 +40,10 @@ extern NSString *RKResourcePboardType;
 - (void)dealloc
 {
 	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[exporter setDelegate:nil];
+	[exporter cancel];
+	[exporter release];
+	[exportSheet release];
 	if(fork) DisposePtr((Ptr) fork);
 	[resources release];
 	[toolbarItems release];
@@ -519,6 +526,12 @@ extern NSString *RKResourcePboardType;
 	if ([outlineView numberOfSelectedRows] > 1)
 	{
 		NSOpenPanel *panel = [NSOpenPanel openPanel];
+		NSButton *convertButton = [[[NSButton alloc] initWithFrame:NSMakeRect(0, 0, 360, 24)] autorelease];
+		[convertButton setButtonType:NSSwitchButton];
+		[convertButton setTitle:NSLocalizedString(@"Convert pictures, icons and sounds to PNG and WAV files", nil)];
+		[convertButton setState:[[NSUserDefaults standardUserDefaults] boolForKey:@"ConvertExportedResources"]? NSOnState : NSOffState];
+		[convertButton sizeToFit];
+		[panel setAccessoryView:convertButton];
 		[panel setAllowsMultipleSelection:NO];
 		[panel setCanChooseDirectories:YES];
 		[panel setCanChooseFiles:NO];
@@ -542,13 +555,7 @@ extern NSString *RKResourcePboardType;
 {
 	Class		editorClass = [[RKEditorRegistry defaultRegistry] editorForType:[resource type]];
 	NSData		*exportData = [resource data];
-	NSString	*extension = [[[resource type] lowercaseString] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-	
-	// basic overrides for file name extensions (assume no plug-ins installed)
-	NSString *newExtension;
-	NSDictionary *adjustments = [NSDictionary dictionaryWithObjectsAndKeys: @"ttf", @"sfnt", nil];
-	if(newExtension = [adjustments objectForKey:extension])
-		extension = newExtension;
+	NSString	*extension = [RKExporter filenameExtensionForType:[resource type]];
 	
 	// ask for data
 	if([editorClass respondsToSelector:@selector(dataForFileExport:)])
@@ -577,52 +584,76 @@ extern NSString *RKResourcePboardType;
 {
 	if(returnCode == NSOKButton)
 	{
-		unsigned int i = 1;
-		Resource *resource;
-		NSString *path, *filename, *extension;
-		NSDictionary *adjustments = [NSDictionary dictionaryWithObjectsAndKeys: @"ttf", @"sfnt", @"png", @"PNGf", nil];
-		NSEnumerator *enumerator = [[outlineView selectedItems] objectEnumerator];
-		while(resource = [enumerator nextObject])
-		{
-			Class editorClass = [[RKEditorRegistry defaultRegistry] editorForType:[resource type]];
-			NSData *exportData = [resource data];
-			extension = [[[resource type] lowercaseString] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-			
-			// basic overrides for file name extensions (assume no plug-ins installed)
-			if([adjustments objectForKey:[resource type]])
-				extension = [adjustments objectForKey:[resource type]];
-			
-			// ask for data
-			if([editorClass respondsToSelector:@selector(dataForFileExport:)])
-				exportData = [editorClass dataForFileExport:resource];
-			
-			// ask for file extension
-			if([editorClass respondsToSelector:@selector(filenameExtensionForFileExport:)])
-				extension = [editorClass filenameExtensionForFileExport:resource];
-			
-			filename = [resource name];
-			if (!filename || [filename isEqualToString:@""])
-			{
-				filename = [NSString stringWithFormat:NSLocalizedString(@"Untitled '%@' Resource %d",nil), [resource type], i++];
-				filename = [filename stringByAppendingPathExtension:extension];
-			}
-			else
-			{
-				unsigned int j = 1;
-				NSString *tempname = [filename stringByAppendingPathExtension:extension];
-				while ([[NSFileManager defaultManager] fileExistsAtPath:tempname])
-				{
-					tempname = [filename stringByAppendingFormat:@" (%d)", j++];
-					tempname = [tempname stringByAppendingPathExtension:extension];
-				}
-				filename = tempname;
-			}
-			path = [[sheet filename] stringByAppendingPathComponent:filename];
-			[exportData writeToFile:path atomically:YES];
-		}
+		BOOL convert = ([(NSButton *)[sheet accessoryView] state] == NSOnState);
+		[[NSUserDefaults standardUserDefaults] setBool:convert forKey:@"ConvertExportedResources"];
+		[sheet orderOut:nil];
+		
+		exporter = [[RKExporter alloc] initWithResources:[outlineView selectedItems] folder:[sheet filename] convert:convert];
+		[exporter setDelegate:self];
+		[self beginExportSheet];
+		[exporter start];
 	}
 }
 
+- (void)beginExportSheet
+{
+	NSView *content;
+	NSButton *cancelButton;
+	exportSheet = [[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 400, 104) styleMask:NSTitledWindowMask backing:NSBackingStoreBuffered defer:YES];
+	content = [exportSheet contentView];
+	
+	exportStatus = [[[NSTextField alloc] initWithFrame:NSMakeRect(20, 70, 360, 17)] autorelease];
+	[exportStatus setEditable:NO];
+	[exportStatus setBordered:NO];
+	[exportStatus setDrawsBackground:NO];
+	[exportStatus setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Exporting %u resources", nil), [exporter count]]];
+	[content addSubview:exportStatus];
+	
+	exportProgress = [[[NSProgressIndicator alloc] initWithFrame:NSMakeRect(20, 48, 360, 20)] autorelease];
+	[exportProgress setIndeterminate:NO];
+	[exportProgress setMinValue:0];
+	[exportProgress setMaxValue:[exporter count]];
+	[content addSubview:exportProgress];
+	
+	cancelButton = [[[NSButton alloc] initWithFrame:NSMakeRect(298, 8, 88, 32)] autorelease];
+	[cancelButton setTitle:NSLocalizedString(@"Cancel", nil)];
+	[cancelButton setBezelStyle:NSRoundedBezelStyle];
+	[cancelButton setKeyEquivalent:@"\033"];
+	[cancelButton setTarget:self];
+	[cancelButton setAction:@selector(cancelExport:)];
+	[content addSubview:cancelButton];
+	
+	[NSApp beginSheet:exportSheet modalForWindow:mainWindow modalDelegate:nil didEndSelector:NULL contextInfo:NULL];
+}
+
+- (IBAction)cancelExport:(id)sender
+{
+	[exporter cancel];
+	[sender setEnabled:NO];
+	[exportStatus setStringValue:NSLocalizedString(@"Cancelling export", nil)];
+}
+
+- (void)exporterDidProgress:(RKExporter *)sender
+{
+	if([sender isCancelled]) return;
+	[exportProgress setDoubleValue:[sender writtenCount] + [sender failedCount]];
+	[exportStatus setStringValue:[NSString stringWithFormat:NSLocalizedString(@"Exported %u of %u resources", nil), [sender writtenCount] + [sender failedCount], [sender count]]];
+}
+
+- (void)exporterDidFinish:(RKExporter *)sender
+{
+	unsigned failed = [sender isCancelled]? 0 : [sender failedCount];
+	[NSApp endSheet:exportSheet];
+	[exportSheet orderOut:nil];
+	[exportSheet release];
+	exportSheet = nil;
+	[exporter autorelease];
+	exporter = nil;
+	
+	if(failed)
+		NSBeginAlertSheet(NSLocalizedString(@"Export Error", nil), nil, nil, nil, mainWindow, nil, NULL, NULL, NULL, NSLocalizedString(@"%u of the resources couldn't be exported, as they have no data or their files couldn't be written.", nil), failed);
+}
+
 #pragma mark -
 #pragma mark Window Management
 
@@ -665,7 +696,56 @@ extern NSString *RKResourcePboardType;
 	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceAttributesWillChange:) name:ResourceAttributesWillChangeNotification object:nil];
 	
 //	[[controller window] setResizeIncrements:NSMakeSize(1,18)];
+	_rowHeight = [outlineView rowHeight];
+	[self setShowsThumbnails:[[NSUserDefaults standardUserDefaults] boolForKey:@"ShowThumbnails"]];
 	[dataSource setResources:resources];
+	
+	// resources loaded from a file aren't announced one by one, so plug-ins keeping track of them look now
+	[[NSNotificationCenter defaultCenter] postNotificationName:DocumentDidOpenNotification object:self];
+}
+
+- (void)close
+{
+	// stop drawing thumbnails nobody will see
+	[self setShowsThumbnails:NO];
+	[[NSNotificationCenter defaultCenter] postNotificationName:DocumentWillCloseNotification object:self];
+	[super close];
+}
+
+- (IBAction)toggleThumbnails:(id)sender
+{
+	BOOL show = ([outlineView tableColumnWithIdentifier:@"thumbnail"] == nil);
+	[[NSUserDefaults standardUserDefaults] setBool:show forKey:@"ShowThumbnails"];
+	[self setShowsThumbnails:show];
+}
+
+/*!
+@method		setShowsThumbnails:
+@abstract	Adds or removes the thumbnail column, which sits before the name and is drawn by RKThumbnailCache.
+*/
+
+- (void)setShowsThumbnails:(BOOL)flag
+{
+	NSTableColumn *column = [outlineView tableColumnWithIdentifier:@"thumbnail"];
+	if(flag && !column)
+	{
+		NSSize size = [RKThumbnailCache thumbnailSize];
+		column = [[[NSTableColumn alloc] initWithIdentifier:@"thumbnail"] autorelease];
+		[column setDataCell:[[[NSImageCell alloc] initImageCell:nil] autorelease]];
+		[column setWidth:size.width +4];
+		[column setMinWidth:size.width +4];
+		[column setResizable:NO];
+		[column setEditable:NO];
+		[outlineView addTableColumn:column];
+		[outlineView moveColumn:[outlineView numberOfColumns] -1 toColumn:0];
+		[outlineView setRowHeight:MAX(_rowHeight, size.height +2)];
+	}
+	else if(!flag && column)
+	{
+		[outlineView removeTableColumn:column];
+		[outlineView setRowHeight:_rowHeight];
+		[[RKThumbnailCache sharedCache] cancelRequestsInDocument:self except:nil];
+	}
 }
 
 - (void)printShowingPrintPanel:(BOOL)flag
@@ -710,6 +790,13 @@ extern NSString *RKResourcePboardType;
 	}
 	else if([item action] == @selector(playSound:))				return selectedRows == 1 && [[resource type] isEqualToString:@"snd "];
 	else if([item action] == @selector(revertResourceToSaved:))	return selectedRows == 1 && [resource isDirty];
+	
+	// view menu
+	else if([item action] == @selector(toggleThumbnails:))
+	{
+		[item setState:[outlineView tableColumnWithIdentifier:@"thumbnail"]? NSOnState:NSOffState];
+		return YES;
+	}
 	else return [super validateMenuItem:item];
 }
 
@@ -1009,7 +1096,12 @@ static NSString *RKExportItemIdentifier		= @"com.nickshanks.resknife.toolbar.exp
 	NSData *data = [(Resource *)[outlineView itemAtRow:[outlineView selectedRow]] data];
 	if(data && [data length] != 0)
 	{
-		[NSThread detachNewThreadSelector:@selector(playSoundThreadController:) toTarget:self withObject:data];
+		// sounds the decoder can't read are left to the Sound Manager
+		SoundPlayer *player = [SoundPlayer sharedPlayer];
+		if(![player canPlaySoundData:data])
+			[NSThread detachNewThreadSelector:@selector(playSoundThreadController:) toTarget:self withObject:data];
+		else if(![player playSoundData:data])
+			NSBeep();
 	}
 	else NSBeep();
 }
@@ -1020,7 +1112,7 @@ static NSString *RKExportItemIdentifier		= @"com.nickshanks.resknife.toolbar.exp
 @author			Nicholas Shanks
 @created		2003-10-22
 @pending		should really be moved to a 'snd ' editor, but first we'd need to extend the plugin protocol to call the class so it can add such menu items. Of course, we could just make the 'snd ' editor have a button in its window that plays the sound.
-@description	This method was added to prevent having to use AsynchSoundHelper to play them asynchronously in the main thread and all the associated idle checking, which since we have no event loop, would have to have been called from a timer. I'm not sure if the autorelease pool is necessary, as no cocoa objects are created, but an NSData is passed in and messages sent to it, and NSBeep() might need one.
+@description	This method was added to prevent having to use AsynchSoundHelper to play them asynchronously in the main thread and all the associated idle checking, which since we have no event loop, would have to have been called from a timer. Sounds are now played by SoundPlayer, which mixes them all on one thread; this is only used for those its decoder can't read (those without their own sound header, or compressed some other way), which SndPlay() plays synchronously, so the thread exits when they're done.
 @param	data	An NSData object containing the snd resource data to be played.
 */
 
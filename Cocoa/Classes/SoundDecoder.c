@@ -0,0 +1,523 @@
+#include "SoundDecoder.h"
+#include <string.h>
+
+#define SOUND_TYPE(a, b, c, d)	(((UInt32) (a) << 24) | ((UInt32) (b) << 16) | ((UInt32) (c) << 8) | (UInt32) (d))
+
+enum
+{
+	kRaw = SOUND_TYPE( 'r','a','w',' ' ),
+	kTwos = SOUND_TYPE( 't','w','o','s' ),
+	kSowt = SOUND_TYPE( 's','o','w','t' ),
+	kULaw = SOUND_TYPE( 'u','l','a','w' ),
+	kALaw = SOUND_TYPE( 'a','l','a','w' ),
+	kIMA4 = SOUND_TYPE( 'i','m','a','4' ),
+	kMACE3 = SOUND_TYPE( 'M','A','C','3' ),
+	kMACE6 = SOUND_TYPE( 'M','A','C','6' ),
+	kNone = SOUND_TYPE( 'N','O','N','E' ),
+
+	// commands which point to a sound header, with the flag saying param2 is an offset into the resource
+	kSoundCmd = 0x8050,
+	kBufferCmd = 0x8051,
+
+	// encode byte of the sound header
+	kStandardHeader = 0x00,
+	kCompressedHeader = 0xFE,
+	kExtendedHeader = 0xFF,
+	kStandardHeaderSize = 22,
+	kLongHeaderSize = 64,		// extended and compressed alike
+
+	kThreeToOne = 3,			// compressionIDs which stand for MACE whatever the format
+	kSixToOne = 4,
+
+	kIMA4PacketBytes = 34,
+	kIMA4PacketFrames = 64,
+	kMACEPacketFrames = 6
+};
+
+static const SInt8 kIMAIndexChange[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+static const UInt16 kIMAStep[89] =
+{
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+	118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+	1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+	6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+	32767
+};
+
+/* MACE's codebooks. Each 2 or 3-bit code moves the step index by its entry in the first table of its pair, and picks a
+	value from the row of the second the index is at: codes below the row's width pick that column, the others the
+	mirror image of one, negated. */
+static const SInt16 kMACEIndexChange3[8] = { -13, 8, 76, 222, 222, 76, 8, -13 };
+static const SInt16 kMACEIndexChange2[4] = { -18, 140, 140, -18 };
+static const SInt16 kMACEStep3[128][4] =
+{
+	{ 37, 116, 206, 330 }, { 39, 121, 216, 346 }, { 41, 127, 225, 361 }, { 42, 132, 235, 377 },
+	{ 44, 137, 245, 392 }, { 46, 144, 256, 410 }, { 48, 150, 267, 428 }, { 51, 157, 280, 449 },
+	{ 53, 165, 293, 470 }, { 55, 172, 306, 490 }, { 58, 181, 321, 514 }, { 61, 190, 337, 540 },
+	{ 64, 199, 353, 566 }, { 67, 208, 370, 593 }, { 70, 218, 388, 621 }, { 73, 229, 407, 652 },
+	{ 77, 240, 426, 683 }, { 80, 251, 446, 715 }, { 84, 263, 468, 750 }, { 88, 276, 490, 785 },
+	{ 92, 289, 513, 823 }, { 96, 303, 538, 862 }, { 101, 317, 563, 903 }, { 106, 332, 590, 946 },
+	{ 111, 348, 618, 991 }, { 116, 365, 648, 1038 }, { 122, 382, 679, 1088 }, { 128, 400, 711, 1139 },
+	{ 134, 419, 745, 1193 }, { 140, 439, 780, 1250 }, { 147, 460, 817, 1310 }, { 154, 482, 856, 1372 },
+	{ 161, 505, 897, 1437 }, { 169, 529, 940, 1506 }, { 177, 554, 985, 1577 }, { 186, 581, 1032, 1652 },
+	{ 195, 608, 1081, 1731 }, { 204, 637, 1132, 1813 }, { 214, 668, 1186, 1899 }, { 224, 699, 1242, 1990 },
+	{ 235, 733, 1301, 2084 }, { 246, 768, 1363, 2183 }, { 258, 804, 1428, 2287 }, { 270, 842, 1496, 2396 },
+	{ 283, 882, 1568, 2510 }, { 296, 924, 1642, 2630 }, { 310, 968, 1720, 2755 }, { 325, 1014, 1802, 2886 },
+	{ 341, 1063, 1888, 3023 }, { 357, 1113, 1978, 3167 }, { 374, 1166, 2072, 3318 }, { 392, 1222, 2171, 3476 },
+	{ 410, 1280, 2274, 3641 }, { 430, 1341, 2382, 3814 }, { 450, 1405, 2496, 3996 }, { 472, 1472, 2615, 4186 },
+	{ 494, 1542, 2739, 4385 }, { 518, 1615, 2870, 4594 }, { 542, 1692, 3006, 4813 }, { 568, 1773, 3150, 5042 },
+	{ 595, 1857, 3300, 5282 }, { 624, 1946, 3457, 5533 }, { 653, 2038, 3622, 5797 }, { 684, 2135, 3794, 6072 },
+	{ 717, 2237, 3975, 6361 }, { 751, 2343, 4164, 6664 }, { 787, 2455, 4362, 6982 }, { 824, 2572, 4570, 7314 },
+	{ 864, 2694, 4788, 7662 }, { 905, 2822, 5016, 8027 }, { 948, 2957, 5255, 8409 }, { 993, 3097, 5505, 8810 },
+	{ 1040, 3245, 5767, 9229 }, { 1090, 3399, 6042, 9669 }, { 1142, 3561, 6329, 10129 }, { 1196, 3731, 6631, 10611 },
+	{ 1253, 3909, 6947, 11116 }, { 1313, 4095, 7277, 11645 }, { 1375, 4290, 7624, 12200 }, { 1441, 4494, 7987, 12780 },
+	{ 1509, 4708, 8367, 13389 }, { 1581, 4932, 8765, 14026 }, { 1657, 5167, 9183, 14694 }, { 1735, 5413, 9620, 15394 },
+	{ 1818, 5671, 10078, 16127 }, { 1905, 5941, 10558, 16895 }, { 1995, 6224, 11061, 17700 }, { 2090, 6520, 11588, 18543 },
+	{ 2190, 6831, 12140, 19426 }, { 2294, 7156, 12718, 20351 }, { 2403, 7497, 13323, 21320 }, { 2518, 7854, 13958, 22335 },
+	{ 2638, 8228, 14623, 23399 }, { 2763, 8620, 15319, 24513 }, { 2895, 9030, 16048, 25680 }, { 3033, 9460, 16812, 26903 },
+	{ 3177, 9910, 17613, 28184 }, { 3329, 10382, 18451, 29526 }, { 3487, 10876, 19330, 30932 }, { 3653, 11394, 20250, 32404 },
+	{ 3827, 11937, 21214, 32767 }, { 4010, 12505, 22224, 32767 }, { 4200, 13101, 23282, 32767 }, { 4400, 13724, 24391, 32767 },
+	{ 4610, 14378, 25552, 32767 }, { 4829, 15063, 26768, 32767 }, { 5059, 15780, 28043, 32767 }, { 5300, 16531, 29378, 32767 },
+	{ 5553, 17318, 30777, 32767 }, { 5817, 18143, 32242, 32767 }, { 6094, 19007, 32767, 32767 }, { 6385, 19912, 32767, 32767 },
+	{ 6689, 20860, 32767, 32767 }, { 7007, 21853, 32767, 32767 }, { 7341, 22894, 32767, 32767 }, { 7690, 23984, 32767, 32767 },
+	{ 8057, 25126, 32767, 32767 }, { 8440, 26322, 32767, 32767 }, { 8842, 27576, 32767, 32767 }, { 9263, 28889, 32767, 32767 },
+	{ 9704, 30264, 32767, 32767 }, { 10166, 31705, 32767, 32767 }, { 10650, 32767, 32767, 32767 }, { 11157, 32767, 32767, 32767 },
+	{ 11688, 32767, 32767, 32767 }, { 12245, 32767, 32767, 32767 }, { 12828, 32767, 32767, 32767 }, { 13439, 32767, 32767, 32767 }
+};
+static const SInt16 kMACEStep2[128][2] =
+{
+	{ 64, 216 }, { 67, 226 }, { 70, 236 }, { 74, 246 }, { 77, 257 }, { 80, 268 }, { 84, 280 },
+	{ 88, 294 }, { 92, 307 }, { 96, 321 }, { 100, 334 }, { 104, 350 }, { 109, 365 }, { 114, 382 },
+	{ 119, 399 }, { 124, 416 }, { 130, 434 }, { 136, 454 }, { 142, 475 }, { 148, 495 }, { 155, 519 },
+	{ 162, 541 }, { 169, 565 }, { 176, 590 }, { 185, 617 }, { 193, 644 }, { 201, 673 }, { 210, 703 },
+	{ 220, 735 }, { 230, 767 }, { 240, 801 }, { 251, 838 }, { 262, 875 }, { 274, 914 }, { 286, 955 },
+	{ 299, 997 }, { 312, 1041 }, { 326, 1088 }, { 341, 1138 }, { 356, 1188 }, { 372, 1241 }, { 388, 1297 },
+	{ 406, 1354 }, { 424, 1415 }, { 443, 1478 }, { 462, 1544 }, { 483, 1613 }, { 505, 1684 }, { 527, 1760 },
+	{ 551, 1838 }, { 576, 1921 }, { 601, 2007 }, { 628, 2097 }, { 656, 2190 }, { 686, 2288 }, { 716, 2389 },
+	{ 748, 2496 }, { 781, 2607 }, { 816, 2724 }, { 853, 2846 }, { 891, 2973 }, { 930, 3104 }, { 972, 3243 },
+	{ 1016, 3389 }, { 1061, 3539 }, { 1108, 3698 }, { 1158, 3862 }, { 1209, 4035 }, { 1264, 4216 }, { 1320, 4403 },
+	{ 1379, 4599 }, { 1441, 4806 }, { 1505, 5021 }, { 1572, 5245 }, { 1642, 5479 }, { 1715, 5722 }, { 1792, 5978 },
+	{ 1872, 6245 }, { 1955, 6522 }, { 2043, 6813 }, { 2134, 7118 }, { 2229, 7436 }, { 2329, 7767 }, { 2432, 8114 },
+	{ 2541, 8477 }, { 2655, 8854 }, { 2773, 9250 }, { 2897, 9663 }, { 3026, 10094 }, { 3162, 10546 }, { 3303, 11016 },
+	{ 3450, 11508 }, { 3604, 12020 }, { 3765, 12556 }, { 3933, 13118 }, { 4108, 13703 }, { 4292, 14315 }, { 4483, 14953 },
+	{ 4683, 15621 }, { 4892, 16318 }, { 5111, 17046 }, { 5339, 17807 }, { 5577, 18602 }, { 5826, 19433 }, { 6086, 20300 },
+	{ 6358, 21205 }, { 6642, 22152 }, { 6938, 23141 }, { 7248, 24173 }, { 7571, 25252 }, { 7909, 26380 }, { 8262, 27557 },
+	{ 8631, 28786 }, { 9016, 30072 }, { 9419, 31413 }, { 9839, 32767 }, { 10278, 32767 }, { 10737, 32767 }, { 11216, 32767 },
+	{ 11717, 32767 }, { 12240, 32767 }, { 12786, 32767 }, { 13356, 32767 }, { 13953, 32767 }, { 14576, 32767 }, { 15226, 32767 },
+	{ 15906, 32767 }, { 16615, 32767 }
+};
+
+static UInt16 ReadShort(const UInt8 *bytes)
+{
+	return (UInt16) ((bytes[0] << 8) | bytes[1]);
+}
+
+static UInt32 ReadLong(const UInt8 *bytes)
+{
+	return ((UInt32) bytes[0] << 24) | ((UInt32) bytes[1] << 16) | ((UInt32) bytes[2] << 8) | bytes[3];
+}
+
+static void WriteLittleShort(UInt8 *bytes, UInt16 value)
+{
+	bytes[0] = (UInt8) value;
+	bytes[1] = (UInt8) (value >> 8);
+}
+
+static void WriteLittleLong(UInt8 *bytes, UInt32 value)
+{
+	bytes[0] = (UInt8) value;
+	bytes[1] = (UInt8) (value >> 8);
+	bytes[2] = (UInt8) (value >> 16);
+	bytes[3] = (UInt8) (value >> 24);
+}
+
+/* G.711, as the CCITT's reference code expands it */
+static SInt16 ExpandULaw(UInt8 value)
+{
+	int sample;
+	value = ~value;
+	sample = (((value & 0x0F) << 3) + 0x84) << ((value & 0x70) >> 4);
+	return (SInt16) ((value & 0x80)? 0x84 - sample : sample - 0x84);
+}
+
+static SInt16 ExpandALaw(UInt8 value)
+{
+	int sample, segment;
+	value ^= 0x55;
+	sample = (value & 0x0F) << 4;
+	segment = (value & 0x70) >> 4;
+	if( segment == 0 ) sample += 8;
+	else sample = (sample + 0x108) << (segment - 1);
+	return (SInt16) ((value & 0x80)? sample : -sample);
+}
+
+#pragma mark -
+
+/* Bytes of samples for a number of frames (packets, for compressed formats) of each channel. */
+static UInt32 BytesPerFrame(const SoundInfo *info)
+{
+	switch( info->format )
+	{
+		case kTwos:
+		case kSowt:		return info->channels * (info->sampleSize / 8);
+		case kIMA4:		return info->channels * kIMA4PacketBytes;
+		case kMACE3:	return info->channels * 2;
+		default:		return info->channels;
+	}
+}
+
+static int ReadHeader(const UInt8 *bytes, UInt32 length, UInt32 offset, SoundInfo *info)
+{
+	const UInt8 *header = bytes + offset;
+	UInt32 headerSize = kStandardHeaderSize, frames, available;
+	UInt8 encode;
+	if( offset > length || length - offset < kStandardHeaderSize ) return kSoundTruncated;
+	if( ReadLong( header ) != 0 ) return kSoundNoSamples;		// samples somewhere else in memory
+	info->sampleRate = ReadLong( header + 8 ) / 65536.0;
+	info->loopStart = ReadLong( header + 12 );
+	info->loopEnd = ReadLong( header + 16 );
+	encode = header[20];
+	info->baseNote = header[21];
+
+	if( encode == kStandardHeader )
+	{
+		info->format = kRaw;
+		info->channels = 1;
+		info->sampleSize = 8;
+		frames = ReadLong( header + 4 );
+	}
+	else if( encode == kExtendedHeader || encode == kCompressedHeader )
+	{
+		headerSize = kLongHeaderSize;
+		if( length - offset < kLongHeaderSize ) return kSoundTruncated;
+		info->channels = ReadLong( header + 4 );
+		frames = ReadLong( header + 22 );
+		if( encode == kExtendedHeader )
+		{
+			info->sampleSize = ReadShort( header + 48 );
+			info->format = (info->sampleSize == 8)? kRaw : kTwos;
+		}
+		else
+		{
+			SInt16 compression = (SInt16) ReadShort( header + 56 );
+			info->sampleSize = ReadShort( header + 62 );
+			info->format = ReadLong( header + 40 );
+			if( compression == kThreeToOne ) info->format = kMACE3;
+			else if( compression == kSixToOne ) info->format = kMACE6;
+			else if( info->format == 0 || info->format == kNone )
+				info->format = (info->sampleSize == 8)? kRaw : kTwos;
+		}
+	}
+	else return kSoundUnsupported;
+
+	if( info->channels == 0 || info->channels > kSoundMaxChannels ) return kSoundUnsupported;
+	if( (info->format == kTwos || info->format == kSowt) && info->sampleSize != 8 && info->sampleSize != 16 ) return kSoundUnsupported;
+
+	// a sound longer than its resource plays what there is of it
+	info->samples = header + headerSize;
+	available = (length - offset - headerSize) / BytesPerFrame( info );
+	if( frames > available ) frames = available;
+	info->samplesLength = frames * BytesPerFrame( info );
+	switch( info->format )
+	{
+		case kIMA4:		info->frames = frames * kIMA4PacketFrames;	break;
+		case kMACE3:
+		case kMACE6:	info->frames = frames * kMACEPacketFrames;	break;
+		case kRaw:
+		case kTwos:
+		case kSowt:
+		case kULaw:
+		case kALaw:		info->frames = frames;	break;
+		default:		return kSoundUnsupported;
+	}
+	return kSoundNoError;
+}
+
+int SoundReadInfo(const UInt8 *bytes, UInt32 length, SoundInfo *info)
+{
+	UInt32 offset, commands, i;
+	memset( info, 0, sizeof(SoundInfo) );
+	if( !bytes || length < 6 ) return kSoundTruncated;
+
+	// format 1 lists the synthesizers to use before its commands, format 2 a reference count
+	switch( ReadShort( bytes ) )
+	{
+		case 1:		offset = 4 + ReadShort( bytes + 2 ) * 6UL;	break;
+		case 2:		offset = 4;	break;
+		default:	return kSoundUnsupported;
+	}
+	if( offset > length - 2 ) return kSoundTruncated;
+	commands = ReadShort( bytes + offset );
+	offset += 2;
+	for( i = 0; i < commands; i++, offset += 8 )
+	{
+		UInt16 command;
+		if( offset + 8 > length ) return kSoundTruncated;
+		command = ReadShort( bytes + offset );
+		if( command == kSoundCmd || command == kBufferCmd )
+			return ReadHeader( bytes, length, ReadLong( bytes + offset + 4 ), info );
+	}
+	return kSoundNoSamples;
+}
+
+int SoundDecoderOpen(const UInt8 *bytes, UInt32 length, SoundDecoder *decoder)
+{
+	int error = SoundReadInfo( bytes, length, &decoder->info );
+	SoundDecoderRewind( decoder );
+	return error;
+}
+
+void SoundDecoderRewind(SoundDecoder *decoder)
+{
+	decoder->position = 0;
+	decoder->packetFrames = 0;
+	decoder->packetOffset = 0;
+	memset( decoder->mace, 0, sizeof(decoder->mace) );
+}
+
+#pragma mark -
+
+/* Each channel has its own 34 bytes in turn: the predictor's top nine bits and the step index, then 64 nibbles, low
+	nibble first. */
+static void DecodeIMA4Packet(SoundDecoder *decoder)
+{
+	UInt32 channels = decoder->info.channels, channel, i;
+	for( channel = 0; channel < channels; channel++ )
+	{
+		const UInt8 *packet = decoder->info.samples + (decoder->position * channels + channel) * kIMA4PacketBytes;
+		SInt16 *out = decoder->packet + channel;
+		UInt16 header = ReadShort( packet );
+		int predictor = (SInt16) (header & 0xFF80), index = header & 0x7F;
+		if( index > 88 ) index = 88;
+		for( i = 0; i < kIMA4PacketFrames; i++ )
+		{
+			int nibble = (packet[2 + i / 2] >> ((i & 1) * 4)) & 0x0F;
+			int step = kIMAStep[index], difference = step >> 3;
+			if( nibble & 1 ) difference += step >> 2;
+			if( nibble & 2 ) difference += step >> 1;
+			if( nibble & 4 ) difference += step;
+			predictor += (nibble & 8)? -difference : difference;
+			if( predictor > 32767 ) predictor = 32767;
+			else if( predictor < -32768 ) predictor = -32768;
+			index += kIMAIndexChange[nibble];
+			if( index < 0 ) index = 0;
+			else if( index > 88 ) index = 88;
+			out[i * channels] = (SInt16) predictor;
+		}
+	}
+	decoder->position++;
+	decoder->packetFrames = kIMA4PacketFrames;
+	decoder->packetOffset = 0;
+}
+
+/* A MACE code's value, moving the channel's step index on. */
+static SInt32 MACEStep(SoundMACEChannel *channel, UInt8 code, Boolean twoBits)
+{
+	UInt32 row = (channel->index & 0x7F0) >> 4;
+	SInt32 value;
+	if( twoBits )
+	{
+		value = (code < 2)? kMACEStep2[row][code] : -1 - kMACEStep2[row][3 - code];
+		channel->index += kMACEIndexChange2[code] - (channel->index >> 5);
+	}
+	else
+	{
+		value = (code < 4)? kMACEStep3[row][code] : -1 - kMACEStep3[row][7 - code];
+		channel->index += kMACEIndexChange3[code] - (channel->index >> 5);
+	}
+	if( channel->index < 0 ) channel->index = 0;
+	return value;
+}
+
+/* Clipped as the Sound Manager clips, to -32767 rather than -32768, so sounds decode to the very same samples. */
+static SInt32 MACEClip(SInt32 value)
+{
+	if( value > 32767 ) return 32767;
+	if( value < -32768 ) return -32767;
+	return value;
+}
+
+/* MACE's samples are 8-bit values in the high byte; the low byte repeats them, as the Sound Manager's do. */
+static SInt16 MACESample(SInt32 value)
+{
+	return (SInt16) (UInt16) ((value & 0xFF00) | ((value >> 8) & 0xFF));
+}
+
+/* Each channel has its own byte or two in turn. 3:1 bytes hold three codes, low bits first, each giving a sample;
+	6:1 bytes hold three, high bits first, each giving two samples either side of the last value. */
+static void DecodeMACEPacket(SoundDecoder *decoder)
+{
+	UInt32 channels = decoder->info.channels, channel, i, code;
+	Boolean threeToOne = (decoder->info.format == kMACE3);
+	UInt32 bytes = threeToOne? 2:1;
+	for( channel = 0; channel < channels; channel++ )
+	{
+		const UInt8 *packet = decoder->info.samples + (decoder->position * channels + channel) * bytes;
+		SoundMACEChannel *state = decoder->mace + channel;
+		SInt16 *out = decoder->packet + channel;
+		for( i = 0; i < bytes; i++ )
+		{
+			UInt8 codes[3];
+			if( threeToOne )
+			{
+				codes[0] = packet[i] & 7;
+				codes[1] = (packet[i] >> 3) & 3;
+				codes[2] = packet[i] >> 5;
+			}
+			else
+			{
+				codes[0] = packet[i] >> 5;
+				codes[1] = (packet[i] >> 3) & 3;
+				codes[2] = packet[i] & 7;
+			}
+			for( code = 0; code < 3; code++ )
+			{
+				SInt32 current = MACEStep( state, codes[code], code == 1 );
+				if( threeToOne )
+				{
+					current = MACEClip( current + state->level );
+					state->level = current - (current >> 3);
+					*out = MACESample( current );
+					out += channels;
+				}
+				else
+				{
+					if( (state->previous ^ current) >= 0 )
+						state->factor = (state->factor + 506 > 32767)? 32767 : state->factor + 506;
+					else state->factor = (state->factor - 314 < -32768)? -32767 : state->factor - 314;
+					current = MACEClip( current + state->level );
+					state->level = (current * state->factor) >> 15;
+					current >>= 1;
+					out[0] = MACESample( state->previous + state->previous2 - ((state->previous2 - current) >> 2) );
+					out[channels] = MACESample( state->previous + current + ((state->previous2 - current) >> 2) );
+					out += channels * 2;
+					state->previous2 = state->previous;
+					state->previous = current;
+				}
+			}
+		}
+	}
+	decoder->position++;
+	decoder->packetFrames = kMACEPacketFrames;
+	decoder->packetOffset = 0;
+}
+
+/* IMA4 packets each start afresh from their own header, so seeking only means decoding the packet the frame is in.
+	MACE packets follow on from the ones before, which have to be decoded first. */
+void SoundDecoderSeek(SoundDecoder *decoder, UInt32 frame)
+{
+	if( frame > decoder->info.frames ) frame = decoder->info.frames;
+	SoundDecoderRewind( decoder );
+	if( decoder->info.format == kIMA4 )
+	{
+		if( frame < decoder->info.frames )
+		{
+			decoder->position = frame / kIMA4PacketFrames;
+			DecodeIMA4Packet( decoder );
+			decoder->packetOffset = frame % kIMA4PacketFrames;
+			decoder->packetFrames -= decoder->packetOffset;
+		}
+		else decoder->position = decoder->info.frames / kIMA4PacketFrames;
+	}
+	else if( decoder->info.format == kMACE3 || decoder->info.format == kMACE6 )
+	{
+		UInt32 packets = frame / kMACEPacketFrames;
+		while( decoder->position < packets )
+			DecodeMACEPacket( decoder );
+		decoder->packetFrames = 0;
+		if( frame < decoder->info.frames && frame % kMACEPacketFrames )
+		{
+			DecodeMACEPacket( decoder );
+			decoder->packetOffset = frame % kMACEPacketFrames;
+			decoder->packetFrames -= decoder->packetOffset;
+		}
+	}
+	else decoder->position = frame;
+}
+
+UInt32 SoundDecode(SoundDecoder *decoder, SInt16 *pcm, UInt32 frames)
+{
+	const SoundInfo *info = &decoder->info;
+	UInt32 channels = info->channels, count, samples, i;
+	const UInt8 *source;
+
+	if( info->format == kIMA4 || info->format == kMACE3 || info->format == kMACE6 )
+	{
+		UInt32 done = 0, packets = info->samplesLength / BytesPerFrame( info );
+		while( done < frames )
+		{
+			if( decoder->packetFrames == 0 )
+			{
+				if( decoder->position >= packets ) break;
+				if( info->format == kIMA4 ) DecodeIMA4Packet( decoder );
+				else DecodeMACEPacket( decoder );
+			}
+			count = frames - done;
+			if( count > decoder->packetFrames ) count = decoder->packetFrames;
+			memcpy( pcm + done * channels, decoder->packet + decoder->packetOffset * channels, count * channels * sizeof(SInt16) );
+			decoder->packetOffset += count;
+			decoder->packetFrames -= count;
+			done += count;
+		}
+		return done;
+	}
+
+	count = info->frames - decoder->position;
+	if( count > frames ) count = frames;
+	samples = count * channels;
+	source = info->samples + decoder->position * BytesPerFrame( info );
+	switch( info->format )
+	{
+		case kRaw:
+			for( i = 0; i < samples; i++ )
+				pcm[i] = (SInt16) ((source[i] - 128) * 256);
+			break;
+
+		case kTwos:
+		case kSowt:
+			if( info->sampleSize == 8 )
+				for( i = 0; i < samples; i++ )
+					pcm[i] = (SInt16) ((SInt8) source[i] * 256);
+			else if( info->format == kTwos )
+				for( i = 0; i < samples; i++ )
+					pcm[i] = (SInt16) ((source[i * 2] << 8) | source[i * 2 + 1]);
+			else
+				for( i = 0; i < samples; i++ )
+					pcm[i] = (SInt16) ((source[i * 2 + 1] << 8) | source[i * 2]);
+			break;
+
+		case kULaw:
+			for( i = 0; i < samples; i++ )
+				pcm[i] = ExpandULaw( source[i] );
+			break;
+
+		case kALaw:
+			for( i = 0; i < samples; i++ )
+				pcm[i] = ExpandALaw( source[i] );
+			break;
+
+		default:
+			return 0;
+	}
+	decoder->position += count;
+	return count;
+}
+
+void SoundWriteWAVHeader(const SoundInfo *info, UInt8 *header)
+{
+	UInt32 rate = (UInt32) (info->sampleRate + 0.5);
+	UInt32 dataLength = info->frames * info->channels * 2;
+	if( rate == 0 ) rate = 1;
+	memcpy( header, "RIFF", 4 );
+	WriteLittleLong( header + 4, 36 + dataLength );
+	memcpy( header + 8, "WAVEfmt ", 8 );
+	WriteLittleLong( header + 16, 16 );
+	WriteLittleShort( header + 20, 1 );		// linear PCM
+	WriteLittleShort( header + 22, (UInt16) info->channels );
+	WriteLittleLong( header + 24, rate );
+	WriteLittleLong( header + 28, rate * info->channels * 2 );
+	WriteLittleShort( header + 32, (UInt16) (info->channels * 2) );
+	WriteLittleShort( header + 34, 16 );
+	memcpy( header + 36, "data", 4 );
+	WriteLittleLong( header + 40, dataLength );
+}
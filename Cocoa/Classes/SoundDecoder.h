@@ -0,0 +1,111 @@
+/* 'snd ' resource decoder */
+
+/*	Finds the sampled sound in a format 1 or 2 'snd ' resource, through its first sound or buffer command, and decodes
+	it into 16-bit signed linear PCM, channels interleaved, in host byte order. Nothing is copied up front: a
+	SoundDecoder reads from the resource's own data as it goes, so a long sound can be decoded a block at a time into a
+	buffer of any size.
+
+	All three sound headers are understood. Standard headers are 8-bit offset binary mono. Extended headers are 8-bit
+	offset binary or 16-bit big-endian signed, with any number of channels. Compressed headers add 'twos', 'sowt',
+	'ulaw', 'alaw', 'ima4' (Apple's IMA ADPCM, 64 frames per 34-byte packet per channel), and MACE 3:1 and 6:1 (6
+	frames per 2-byte or 1-byte packet per channel). MACE's predictor carries on from one packet to the next, so
+	seeking in a MACE sound decodes everything before the frame sought.
+
+	Also writes the header of a WAV file to hold the decoded sound, so a sound can be exported, or handed to something
+	which plays files, without the Sound Manager. */
+
+#ifndef SOUND_DECODER_H
+#define SOUND_DECODER_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	kSoundNoError = 0,
+	kSoundTruncated,		// the data ends within a header, or before the samples it claims
+	kSoundNoSamples,		// there's no sound or buffer command pointing into the resource
+	kSoundUnsupported,		// a compression this can't decode
+
+	kSoundMaxChannels = 8,
+	kSoundBlockFrames = 4096,	// a good number of frames to decode at a time
+	kSoundWAVHeaderSize = 44
+};
+
+typedef struct SoundInfo
+{
+	UInt32			format;			// 'raw ', 'twos', 'sowt', 'ulaw', 'alaw', 'ima4', 'MAC3' or 'MAC6'
+	UInt32			channels;
+	double			sampleRate;		// frames per second
+	UInt32			frames;			// once decoded
+	UInt32			loopStart;		// frames
+	UInt32			loopEnd;
+	UInt8			baseNote;		// MIDI note the sound plays at its own rate
+	UInt16			sampleSize;		// bits per sample as stored, before expanding or decompressing
+	const UInt8		*samples;		// within the resource
+	UInt32			samplesLength;
+} SoundInfo;
+
+typedef struct SoundMACEChannel
+{
+	SInt32			index;			// into the step tables
+	SInt32			factor;			// 6:1 only
+	SInt32			level;
+	SInt32			previous;		// 6:1's last two half samples
+	SInt32			previous2;
+} SoundMACEChannel;
+
+typedef struct SoundDecoder
+{
+	SoundInfo		info;
+	UInt32			position;		// frames of PCM, or packets of IMA4 and MACE, read so far
+	SInt16			packet[64 * kSoundMaxChannels];		// the rest of the last packet
+	UInt32			packetFrames;	// left in it
+	UInt32			packetOffset;
+	SoundMACEChannel	mace[kSoundMaxChannels];
+} SoundDecoder;
+
+/*!
+@function	SoundReadInfo
+@abstract	Finds the resource's sound header and reads it, checking its samples are within the data.
+*/
+int SoundReadInfo(const UInt8 *bytes, UInt32 length, SoundInfo *info);
+
+/*!
+@function	SoundDecoderOpen
+@abstract	Readies a decoder to decode the resource's sound from its start. The data must outlive the decoder.
+*/
+int SoundDecoderOpen(const UInt8 *bytes, UInt32 length, SoundDecoder *decoder);
+
+/*!
+@function	SoundDecode
+@abstract	Decodes up to frames more frames into pcm, which holds frames * channels samples. Returns how many it decoded, zero at the end.
+*/
+UInt32 SoundDecode(SoundDecoder *decoder, SInt16 *pcm, UInt32 frames);
+
+/*!
+@function	SoundDecoderRewind
+@abstract	Goes back to the sound's start.
+*/
+void SoundDecoderRewind(SoundDecoder *decoder);
+
+/*!
+@function	SoundDecoderSeek
+@abstract	Goes to the frame given, or the end if it's past it, so decoding can start anywhere without decoding what's before.
+*/
+void SoundDecoderSeek(SoundDecoder *decoder, UInt32 frame);
+
+/*!
+@function	SoundWriteWAVHeader
+@abstract	Writes the kSoundWAVHeaderSize byte header of a WAV file holding the sound's frames, decoded.
+*/
+void SoundWriteWAVHeader(const SoundInfo *info, UInt8 *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,322 @@
+#include "SoundMixer.h"
+#include <string.h>
+
+#ifdef __APPLE__
+#include <libkern/OSAtomic.h>
+#define MemoryBarrier()	OSMemoryBarrier()
+#else
+#define MemoryBarrier()	__sync_synchronize()
+#endif
+
+enum
+{
+	kSoundMixerPlay = 1,
+	kSoundMixerPause,
+	kSoundMixerResume,
+	kSoundMixerStop,
+	kSoundMixerSeek
+};
+
+/*	Both queues have one thread putting in and one taking out, each only ever moving its own count on, so neither
+	needs a lock: the barrier before a count's moved on makes sure the entry it covers is seen whole. The counts
+	wrap, and the queues' sizes being powers of two keeps them right when they do. */
+
+static Boolean Post( SoundMixer *mixer, const SoundMixerCommand *command )
+{
+	UInt32 in = mixer->commandsIn;
+	if( in - mixer->commandsOut >= kSoundMixerCommands ) return false;
+	mixer->commands[in % kSoundMixerCommands] = *command;
+	MemoryBarrier();
+	mixer->commandsIn = in + 1;
+	return true;
+}
+
+static void HandBack( SoundMixer *mixer, SoundVoiceID voice, void *owner )
+{
+	// can't overflow, as no more sounds are let in than it holds
+	UInt32 in = mixer->finishedIn;
+	mixer->finished[in % kSoundMixerFinished].voice = voice;
+	mixer->finished[in % kSoundMixerFinished].owner = owner;
+	MemoryBarrier();
+	mixer->finishedIn = in + 1;
+}
+
+void SoundMixerInit(SoundMixer *mixer)
+{
+	memset( mixer, 0, sizeof(SoundMixer) );
+}
+
+#pragma mark -
+
+SoundVoiceID SoundMixerPlay(SoundMixer *mixer, const UInt8 *bytes, UInt32 length, void *owner)
+{
+	SoundMixerCommand command;
+	SoundInfo info;
+	if( mixer->playing >= kSoundMixerCommands + kSoundMixerVoices ) return 0;
+	if( SoundReadInfo( bytes, length, &info ) != kSoundNoError ) return 0;
+
+	if( ++mixer->nextVoice == 0 ) mixer->nextVoice = 1;
+	memset( &command, 0, sizeof(command) );
+	command.command = kSoundMixerPlay;
+	command.voice = mixer->nextVoice;
+	command.bytes = bytes;
+	command.length = length;
+	command.owner = owner;
+	if( !Post( mixer, &command ) ) return 0;
+	mixer->playing++;
+	return command.voice;
+}
+
+Boolean SoundMixerPause(SoundMixer *mixer, SoundVoiceID voice, Boolean paused)
+{
+	SoundMixerCommand command;
+	memset( &command, 0, sizeof(command) );
+	command.command = paused? kSoundMixerPause : kSoundMixerResume;
+	command.voice = voice;
+	return Post( mixer, &command );
+}
+
+Boolean SoundMixerStop(SoundMixer *mixer, SoundVoiceID voice)
+{
+	SoundMixerCommand command;
+	memset( &command, 0, sizeof(command) );
+	command.command = kSoundMixerStop;
+	command.voice = voice;
+	return Post( mixer, &command );
+}
+
+Boolean SoundMixerSeek(SoundMixer *mixer, SoundVoiceID voice, UInt32 frame)
+{
+	SoundMixerCommand command;
+	memset( &command, 0, sizeof(command) );
+	command.command = kSoundMixerSeek;
+	command.voice = voice;
+	command.frame = frame;
+	return Post( mixer, &command );
+}
+
+Boolean SoundMixerNextFinished(SoundMixer *mixer, SoundMixerFinished *finished)
+{
+	UInt32 out = mixer->finishedOut;
+	if( out == mixer->finishedIn ) return false;
+	MemoryBarrier();
+	*finished = mixer->finished[out % kSoundMixerFinished];
+	MemoryBarrier();
+	mixer->finishedOut = out + 1;
+	mixer->playing--;
+	return true;
+}
+
+#pragma mark -
+
+static SoundVoice *FindVoice( SoundMixer *mixer, SoundVoiceID id )
+{
+	UInt32 i;
+	if( id == 0 ) return NULL;
+	for( i = 0; i < kSoundMixerVoices; i++ )
+		if( mixer->voices[i].id == id )
+			return &mixer->voices[i];
+	return NULL;
+}
+
+static void FinishVoice( SoundMixer *mixer, SoundVoice *voice )
+{
+	HandBack( mixer, voice->id, voice->owner );
+	voice->id = 0;
+	voice->owner = NULL;
+}
+
+static void StartVoice( SoundMixer *mixer, const SoundMixerCommand *command )
+{
+	SoundVoice *voice = NULL;
+	double step;
+	UInt32 i;
+
+	// a free voice, or else the one playing longest
+	for( i = 0; i < kSoundMixerVoices; i++ )
+	{
+		SoundVoice *candidate = &mixer->voices[i];
+		if( candidate->id == 0 )
+		{
+			voice = candidate;
+			break;
+		}
+		if( !voice || (SInt32) (candidate->started - voice->started) < 0 )
+			voice = candidate;
+	}
+	if( voice->id ) FinishVoice( mixer, voice );
+
+	if( SoundDecoderOpen( command->bytes, command->length, &voice->decoder ) != kSoundNoError )
+	{
+		HandBack( mixer, command->voice, command->owner );
+		return;
+	}
+	step = voice->decoder.info.sampleRate / kSoundMixerRate * 65536.0 + 0.5;
+	voice->id = command->voice;
+	voice->owner = command->owner;
+	voice->paused = false;
+	voice->ended = false;
+	voice->started = mixer->starts++;
+	voice->step = (step >= 1.0 && step < 65536.0 * 256)? (UInt32) step : 65536;
+	voice->cursor = 0;
+	voice->bufferFrames = 0;
+}
+
+static void DoCommand( SoundMixer *mixer, const SoundMixerCommand *command )
+{
+	SoundVoice *voice = FindVoice( mixer, command->voice );
+	UInt32 i;
+	switch( command->command )
+	{
+		case kSoundMixerPlay:
+			StartVoice( mixer, command );
+			break;
+
+		case kSoundMixerPause:
+		case kSoundMixerResume:
+			if( voice ) voice->paused = (command->command == kSoundMixerPause);
+			break;
+
+		case kSoundMixerStop:
+			if( voice ) FinishVoice( mixer, voice );
+			else if( command->voice == 0 )
+			{
+				for( i = 0; i < kSoundMixerVoices; i++ )
+					if( mixer->voices[i].id )
+						FinishVoice( mixer, &mixer->voices[i] );
+			}
+			break;
+
+		case kSoundMixerSeek:
+			if( voice )
+			{
+				SoundDecoderSeek( &voice->decoder, command->frame );
+				voice->ended = false;
+				voice->cursor = 0;
+				voice->bufferFrames = 0;
+			}
+			break;
+	}
+}
+
+static void TakeCommands( SoundMixer *mixer )
+{
+	UInt32 out = mixer->commandsOut;
+	while( out != mixer->commandsIn )
+	{
+		SoundMixerCommand command;
+		MemoryBarrier();
+		command = mixer->commands[out % kSoundMixerCommands];
+		MemoryBarrier();
+		mixer->commandsOut = ++out;
+		DoCommand( mixer, &command );
+	}
+}
+
+/*	Refills a voice's buffer once its cursor is on or past the last frame decoded, keeping that frame to interpolate
+	from. Sounds end with a silent frame, so their last sample fades rather than stops. Returns false once the voice
+	has played to the end. */
+
+static Boolean FillVoice( SoundMixer *mixer, SoundVoice *voice )
+{
+	UInt32 index = voice->cursor >> 16, channels = voice->decoder.info.channels;
+	UInt32 keep = (index < voice->bufferFrames)? voice->bufferFrames - index : 0;
+	UInt32 skip = (index > voice->bufferFrames)? index - voice->bufferFrames : 0;
+	UInt32 frames = 0, i;
+	SInt16 *out;
+
+	if( keep ) memmove( voice->buffer, voice->buffer + index * kSoundMixerChannels, keep * kSoundMixerChannels * sizeof(SInt16) );
+	voice->cursor &= 0xFFFF;
+	voice->bufferFrames = keep;
+	if( voice->ended ) return (keep > 1);
+
+	// frames stepped over entirely when the sound's rate is higher than the mixer's
+	while( skip )
+	{
+		UInt32 skipped = SoundDecode( &voice->decoder, mixer->decoded, (skip < kSoundMixerVoiceFrames)? skip : kSoundMixerVoiceFrames );
+		if( !skipped ) break;
+		skip -= skipped;
+	}
+	if( !skip ) frames = SoundDecode( &voice->decoder, mixer->decoded, kSoundMixerVoiceFrames );
+
+	out = voice->buffer + keep * kSoundMixerChannels;
+	if( frames == 0 )
+	{
+		voice->ended = true;
+		if( keep == 0 ) return false;
+		out[0] = out[1] = 0;
+		voice->bufferFrames++;
+		return true;
+	}
+	for( i = 0; i < frames; i++ )
+	{
+		const SInt16 *in = mixer->decoded + i * channels;
+		out[i * 2] = in[0];
+		out[i * 2 + 1] = (channels > 1)? in[1] : in[0];
+	}
+	voice->bufferFrames += frames;
+	return true;
+}
+
+static void MixVoice( SoundMixer *mixer, SoundVoice *voice, UInt32 frames )
+{
+	SInt32 *mix = mixer->mix;
+	UInt32 frame;
+	for( frame = 0; frame < frames; frame++ )
+	{
+		UInt32 index = voice->cursor >> 16;
+		SInt32 fraction;
+		const SInt16 *a;
+		if( index + 1 >= voice->bufferFrames )
+		{
+			if( !FillVoice( mixer, voice ) )
+			{
+				FinishVoice( mixer, voice );
+				return;
+			}
+			index = voice->cursor >> 16;
+		}
+		fraction = (SInt32) (voice->cursor & 0xFFFF) >> 1;		// 15 bits, so the products fit
+		a = voice->buffer + index * kSoundMixerChannels;
+		mix[frame * 2] += a[0] + (((a[2] - a[0]) * fraction) >> 15);
+		mix[frame * 2 + 1] += a[1] + (((a[3] - a[1]) * fraction) >> 15);
+		voice->cursor += voice->step;
+	}
+}
+
+void SoundMixerRender(SoundMixer *mixer, SInt16 *pcm, UInt32 frames)
+{
+	TakeCommands( mixer );
+	while( frames )
+	{
+		UInt32 count = (frames < kSoundMixerVoiceFrames)? frames : kSoundMixerVoiceFrames, i;
+		memset( mixer->mix, 0, count * kSoundMixerChannels * sizeof(SInt32) );
+		for( i = 0; i < kSoundMixerVoices; i++ )
+			if( mixer->voices[i].id && !mixer->voices[i].paused )
+				MixVoice( mixer, &mixer->voices[i], count );
+
+		// voices added together can go past what 16 bits hold
+		for( i = 0; i < count * kSoundMixerChannels; i++ )
+		{
+			SInt32 sample = mixer->mix[i];
+			pcm[i] = (SInt16) ((sample > 32767)? 32767 : (sample < -32768)? -32768 : sample);
+		}
+		pcm += count * kSoundMixerChannels;
+		frames -= count;
+	}
+}
+
+void SoundMixerReset(SoundMixer *mixer)
+{
+	UInt32 i;
+	while( mixer->commandsOut != mixer->commandsIn )
+	{
+		const SoundMixerCommand *command = &mixer->commands[mixer->commandsOut % kSoundMixerCommands];
+		if( command->command == kSoundMixerPlay )
+			HandBack( mixer, command->voice, command->owner );
+		mixer->commandsOut++;
+	}
+	for( i = 0; i < kSoundMixerVoices; i++ )
+		if( mixer->voices[i].id )
+			FinishVoice( mixer, &mixer->voices[i] );
+}
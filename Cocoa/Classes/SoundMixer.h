@@ -0,0 +1,142 @@
+/* Sound mixer */
+
+/*	Plays several decoded 'snd ' resources at once, through a fixed pool of voices mixed into one 16-bit stereo
+	stream. Whatever drives the output calls SoundMixerRender() from its one thread, for as many frames as it wants;
+	everyone else talks to the mixer through a queue of commands it picks up at the start of each render. Neither side
+	ever waits on the other, so a render can't be held up by a lock the main thread holds, and starting a sound never
+	costs a thread.
+
+	Commands are posted from a single thread, and each returns at once. A sound played is given an ID straight away,
+	which later commands name; if every voice is busy when it's picked up, the one playing longest is stopped to make
+	room. Each sound played is handed back, through a second queue, once it's finished, stopped or couldn't be played,
+	along with the owner pointer it was posted with, so the data it points into can be let go.
+
+	Voices are resampled to the mixer's rate by linear interpolation. Mono voices play in both channels; voices of more
+	than two channels play only their first two. What renders the mixer is up to the SoundOutput it's given to. */
+
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+#include <CoreFoundation/CoreFoundation.h>
+#include "SoundDecoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	kSoundMixerVoices = 16,
+	kSoundMixerCommands = 64,		// posted but not yet picked up
+	kSoundMixerFinished = 128,		// handed back but not yet taken; at least commands and voices together
+	kSoundMixerChannels = 2,
+	kSoundMixerRate = 44100,
+	kSoundMixerVoiceFrames = 512	// decoded ahead by each voice
+};
+
+typedef UInt32 SoundVoiceID;		// never zero
+
+typedef struct SoundMixerCommand
+{
+	UInt32			command;
+	SoundVoiceID	voice;
+	const UInt8		*bytes;			// for kSoundMixerPlay
+	UInt32			length;
+	void			*owner;
+	UInt32			frame;			// for kSoundMixerSeek
+} SoundMixerCommand;
+
+typedef struct SoundMixerFinished
+{
+	SoundVoiceID	voice;
+	void			*owner;
+} SoundMixerFinished;
+
+typedef struct SoundVoice
+{
+	SoundVoiceID	id;				// zero if free
+	Boolean			paused;
+	Boolean			ended;			// decoded to the end
+	UInt32			started;		// order it started playing in
+	void			*owner;
+	SoundDecoder	decoder;
+	UInt32			step;			// source frames per mixer frame, 16.16 fixed point
+	UInt32			cursor;			// within buffer, 16.16
+	UInt32			bufferFrames;
+	SInt16			buffer[(kSoundMixerVoiceFrames + 1) * kSoundMixerChannels];	// decoded and made stereo, after the frame carried from the last fill
+} SoundVoice;
+
+typedef struct SoundMixer
+{
+	// written by the posting thread, read by the renderer
+	SoundMixerCommand	commands[kSoundMixerCommands];
+	volatile UInt32		commandsIn;
+	SoundVoiceID		nextVoice;
+	UInt32				playing;		// posted and not yet taken back
+
+	// written by the renderer, read by the posting thread
+	volatile UInt32		commandsOut;
+	SoundMixerFinished	finished[kSoundMixerFinished];
+	volatile UInt32		finishedIn;
+	volatile UInt32		finishedOut;
+
+	// the renderer's own
+	SoundVoice			voices[kSoundMixerVoices];
+	UInt32				starts;
+	SInt32				mix[kSoundMixerVoiceFrames * kSoundMixerChannels];
+	SInt16				decoded[kSoundMixerVoiceFrames * kSoundMaxChannels];
+} SoundMixer;
+
+/*!
+@function	SoundMixerInit
+@abstract	Readies a mixer with every voice free. Mixers are large, so are best allocated.
+*/
+void SoundMixerInit(SoundMixer *mixer);
+
+/*!
+@function	SoundMixerPlay
+@abstract	Starts the 'snd ' resource data given playing from its start, and returns the ID of the voice playing it, or zero if it can't be decoded or too many sounds are waiting to be picked up or taken back. The data must be kept until it's handed back with the owner given.
+*/
+SoundVoiceID SoundMixerPlay(SoundMixer *mixer, const UInt8 *bytes, UInt32 length, void *owner);
+
+/*!
+@function	SoundMixerPause
+@abstract	Pauses the voice, or resumes it if paused is false. Returns false if the queue's full.
+*/
+Boolean SoundMixerPause(SoundMixer *mixer, SoundVoiceID voice, Boolean paused);
+
+/*!
+@function	SoundMixerStop
+@abstract	Stops the voice, or every voice if it's zero. Returns false if the queue's full.
+*/
+Boolean SoundMixerStop(SoundMixer *mixer, SoundVoiceID voice);
+
+/*!
+@function	SoundMixerSeek
+@abstract	Moves the voice to the frame of its sound given, in the sound's own frames. Returns false if the queue's full.
+*/
+Boolean SoundMixerSeek(SoundMixer *mixer, SoundVoiceID voice, UInt32 frame);
+
+/*!
+@function	SoundMixerNextFinished
+@abstract	Takes the next sound handed back by the renderer, if there is one. Called on the thread commands are posted from.
+*/
+Boolean SoundMixerNextFinished(SoundMixer *mixer, SoundMixerFinished *finished);
+
+/*!
+@function	SoundMixerRender
+@abstract	Picks up the commands posted, then mixes so many frames of every voice playing into pcm, interleaved stereo in host byte order. Called by the output alone.
+*/
+void SoundMixerRender(SoundMixer *mixer, SInt16 *pcm, UInt32 frames);
+
+/*!
+@function	SoundMixerReset
+@abstract	Hands back every sound, playing or posted. Only while nothing's rendering, such as after the output's stopped.
+*/
+void SoundMixerReset(SoundMixer *mixer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,253 @@
+/* nanosleep() is POSIX, which strict C99 hides elsewhere; Apple's headers declare it anyway, and need what this would hide. */
+#ifndef __APPLE__
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "SoundOutput.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+#ifdef __APPLE__
+#include <AudioUnit/AudioUnit.h>
+#endif
+
+Boolean SoundOutputStart(SoundOutput *output, SoundMixer *mixer)
+{
+	return output->start( output, mixer );
+}
+
+void SoundOutputStop(SoundOutput *output)
+{
+	output->stop( output );
+}
+
+void SoundOutputClose(SoundOutput *output)
+{
+	if( output ) output->close( output );
+}
+
+#pragma mark -
+
+/*	The file output's thread renders a block at a time, sleeping between blocks so it never gets ahead of the clock,
+	and never more than a block behind it. */
+
+typedef struct FileOutput
+{
+	SoundOutput		output;
+	FILE			*file;			// NULL if rendering to nowhere
+	UInt32			frames;			// written to it
+	SoundMixer		*mixer;
+	pthread_t		thread;
+	volatile Boolean running;
+	SInt16			pcm[kSoundMixerVoiceFrames * kSoundMixerChannels];
+	UInt8			bytes[kSoundMixerVoiceFrames * kSoundMixerChannels * 2];
+} FileOutput;
+
+static double Now( void )
+{
+	struct timeval now;
+	gettimeofday( &now, NULL );
+	return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+static void *FileOutputThread( void *context )
+{
+	FileOutput *output = (FileOutput *) context;
+	double start = Now(), rendered = 0;
+	UInt32 i;
+	while( output->running )
+	{
+		double ahead;
+		SoundMixerRender( output->mixer, output->pcm, kSoundMixerVoiceFrames );
+		if( output->file )
+		{
+			// WAV samples are little-endian
+			for( i = 0; i < kSoundMixerVoiceFrames * kSoundMixerChannels; i++ )
+			{
+				output->bytes[i * 2] = (UInt8) output->pcm[i];
+				output->bytes[i * 2 + 1] = (UInt8) ((UInt16) output->pcm[i] >> 8);
+			}
+			if( fwrite( output->bytes, sizeof(output->bytes), 1, output->file ) == 1 )
+				output->frames += kSoundMixerVoiceFrames;
+		}
+		rendered += (double) kSoundMixerVoiceFrames / kSoundMixerRate;
+		ahead = start + rendered - Now();
+		if( ahead > 0 )
+		{
+			struct timespec wait;
+			wait.tv_sec = (time_t) ahead;
+			wait.tv_nsec = (long) ((ahead - wait.tv_sec) * 1000000000.0);
+			nanosleep( &wait, NULL );
+		}
+		else if( ahead < -(double) kSoundMixerVoiceFrames / kSoundMixerRate )
+			rendered -= ahead;		// fell behind; don't rush to catch up
+	}
+	return NULL;
+}
+
+static Boolean FileOutputStart( SoundOutput *base, SoundMixer *mixer )
+{
+	FileOutput *output = (FileOutput *) base;
+	if( output->running ) return true;
+	output->mixer = mixer;
+	output->running = true;
+	if( pthread_create( &output->thread, NULL, FileOutputThread, output ) != 0 )
+		output->running = false;
+	return output->running;
+}
+
+static void FileOutputStop( SoundOutput *base )
+{
+	FileOutput *output = (FileOutput *) base;
+	if( !output->running ) return;
+	output->running = false;
+	pthread_join( output->thread, NULL );
+}
+
+static void FileOutputClose( SoundOutput *base )
+{
+	FileOutput *output = (FileOutput *) base;
+	FileOutputStop( base );
+	if( output->file )
+	{
+		SoundInfo info;
+		UInt8 header[kSoundWAVHeaderSize];
+		memset( &info, 0, sizeof(info) );
+		info.channels = kSoundMixerChannels;
+		info.sampleRate = kSoundMixerRate;
+		info.frames = output->frames;
+		SoundWriteWAVHeader( &info, header );
+		fseek( output->file, 0, SEEK_SET );
+		fwrite( header, sizeof(header), 1, output->file );
+		fclose( output->file );
+	}
+	free( output );
+}
+
+SoundOutput *SoundOutputOpenFile(const char *path)
+{
+	FileOutput *output = (FileOutput *) calloc( 1, sizeof(FileOutput) );
+	if( !output ) return NULL;
+	output->output.start = FileOutputStart;
+	output->output.stop = FileOutputStop;
+	output->output.close = FileOutputClose;
+	if( path )
+	{
+		// the header's filled in once the length's known
+		UInt8 header[kSoundWAVHeaderSize];
+		memset( header, 0, sizeof(header) );
+		output->file = fopen( path, "wb" );
+		if( !output->file || fwrite( header, sizeof(header), 1, output->file ) != 1 )
+		{
+			if( output->file ) fclose( output->file );
+			free( output );
+			return NULL;
+		}
+	}
+	return &output->output;
+}
+
+#pragma mark -
+
+#ifdef __APPLE__
+
+/*	The default output unit calls back on Core Audio's own thread for each buffer it wants, in the format it's been
+	told the mixer renders, converting it to the device's itself. */
+
+typedef struct DeviceOutput
+{
+	SoundOutput		output;
+	AudioUnit		unit;
+	SoundMixer		*mixer;
+	Boolean			running;
+} DeviceOutput;
+
+static OSStatus DeviceOutputRender( void *context, AudioUnitRenderActionFlags *flags, const AudioTimeStamp *timeStamp, UInt32 bus, UInt32 frames, AudioBufferList *data )
+{
+	DeviceOutput *output = (DeviceOutput *) context;
+	UInt32 fits = data->mBuffers[0].mDataByteSize / (kSoundMixerChannels * sizeof(SInt16));
+	SoundMixerRender( output->mixer, (SInt16 *) data->mBuffers[0].mData, (frames < fits)? frames : fits );
+	return noErr;
+}
+
+static Boolean DeviceOutputStart( SoundOutput *base, SoundMixer *mixer )
+{
+	DeviceOutput *output = (DeviceOutput *) base;
+	if( output->running ) return true;
+	output->mixer = mixer;
+	output->running = (AudioOutputUnitStart( output->unit ) == noErr);
+	return output->running;
+}
+
+static void DeviceOutputStop( SoundOutput *base )
+{
+	// doesn't return while the unit's calling back
+	DeviceOutput *output = (DeviceOutput *) base;
+	if( !output->running ) return;
+	AudioOutputUnitStop( output->unit );
+	output->running = false;
+}
+
+static void DeviceOutputClose( SoundOutput *base )
+{
+	DeviceOutput *output = (DeviceOutput *) base;
+	DeviceOutputStop( base );
+	AudioUnitUninitialize( output->unit );
+	CloseComponent( output->unit );
+	free( output );
+}
+
+SoundOutput *SoundOutputOpenDefault(void)
+{
+	ComponentDescription description = { kAudioUnitType_Output, kAudioUnitSubType_DefaultOutput, kAudioUnitManufacturer_Apple, 0, 0 };
+	AudioStreamBasicDescription format;
+	AURenderCallbackStruct callback;
+	Component component = FindNextComponent( NULL, &description );
+	DeviceOutput *output;
+	if( !component ) return NULL;
+	output = (DeviceOutput *) calloc( 1, sizeof(DeviceOutput) );
+	if( !output ) return NULL;
+	if( OpenAComponent( component, &output->unit ) != noErr )
+	{
+		free( output );
+		return NULL;
+	}
+
+	memset( &format, 0, sizeof(format) );
+	format.mSampleRate = kSoundMixerRate;
+	format.mFormatID = kAudioFormatLinearPCM;
+	format.mFormatFlags = kLinearPCMFormatFlagIsSignedInteger | kLinearPCMFormatFlagIsPacked;
+#if TARGET_RT_BIG_ENDIAN
+	format.mFormatFlags |= kLinearPCMFormatFlagIsBigEndian;
+#endif
+	format.mBytesPerPacket = format.mBytesPerFrame = kSoundMixerChannels * sizeof(SInt16);
+	format.mFramesPerPacket = 1;
+	format.mChannelsPerFrame = kSoundMixerChannels;
+	format.mBitsPerChannel = 16;
+	callback.inputProc = DeviceOutputRender;
+	callback.inputProcRefCon = output;
+	if( AudioUnitSetProperty( output->unit, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 0, &format, sizeof(format) ) != noErr
+		|| AudioUnitSetProperty( output->unit, kAudioUnitProperty_SetRenderCallback, kAudioUnitScope_Input, 0, &callback, sizeof(callback) ) != noErr
+		|| AudioUnitInitialize( output->unit ) != noErr )
+	{
+		CloseComponent( output->unit );
+		free( output );
+		return NULL;
+	}
+	output->output.start = DeviceOutputStart;
+	output->output.stop = DeviceOutputStop;
+	output->output.close = DeviceOutputClose;
+	return &output->output;
+}
+
+#else
+
+SoundOutput *SoundOutputOpenDefault(void)
+{
+	return NULL;
+}
+
+#endif
@@ -0,0 +1,63 @@
+/* Sound outputs */
+
+/*	Somewhere for a SoundMixer to play to. Each output renders the mixer, once started, on a thread of its own, and is
+	the only thing that does while it runs.
+
+	Two are provided. The default output device renders on Core Audio's thread, as the device asks for frames. A file
+	output renders on a thread it makes, paced to real time as a device would be, and writes what it renders to a WAV
+	file, or throws it away; playback can then be run, and checked, with no sound hardware at all. Others can be added
+	by filling in a SoundOutput's functions, with the output's own state after it. */
+
+#ifndef SOUND_OUTPUT_H
+#define SOUND_OUTPUT_H
+
+#include <CoreFoundation/CoreFoundation.h>
+#include "SoundMixer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SoundOutput SoundOutput;
+struct SoundOutput
+{
+	Boolean	(*start)(SoundOutput *output, SoundMixer *mixer);
+	void	(*stop)(SoundOutput *output);
+	void	(*close)(SoundOutput *output);		// stops it first if need be
+};
+
+/*!
+@function	SoundOutputOpenDefault
+@abstract	Opens the default output device. Returns NULL if there isn't one.
+*/
+SoundOutput *SoundOutputOpenDefault(void);
+
+/*!
+@function	SoundOutputOpenFile
+@abstract	Opens an output which writes what it renders to a WAV file at the path given, or nowhere if it's NULL. Returns NULL if the file can't be created.
+*/
+SoundOutput *SoundOutputOpenFile(const char *path);
+
+/*!
+@function	SoundOutputStart
+@abstract	Starts rendering the mixer. Returns false if it couldn't be started.
+*/
+Boolean SoundOutputStart(SoundOutput *output, SoundMixer *mixer);
+
+/*!
+@function	SoundOutputStop
+@abstract	Stops rendering, once the render in progress is done.
+*/
+void SoundOutputStop(SoundOutput *output);
+
+/*!
+@function	SoundOutputClose
+@abstract	Stops the output and frees it, finishing any file it's writing.
+*/
+void SoundOutputClose(SoundOutput *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
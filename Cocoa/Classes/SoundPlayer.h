@@ -0,0 +1,63 @@
+#import <Cocoa/Cocoa.h>
+#import "SoundMixer.h"
+#import "SoundOutput.h"
+
+extern NSString *SoundPlayerVoiceDidFinishNotification;
+
+/*!
+@class			SoundPlayer
+@abstract		Plays 'snd ' resources, as many at once as there are voices, all mixed on the output's one thread.
+@description	Each sound played gets a voice, named by the ID returned, which can be paused, moved or stopped while it plays. Playing a sound never starts a thread; if every voice is busy, the one playing longest is cut short. Sounds are retained until they've finished, when SoundPlayerVoiceDidFinishNotification is posted with the voice's ID under "voice". Only to be used from the main thread.
+*/
+
+@interface SoundPlayer : NSObject
+{
+	SoundMixer			*mixer;
+	SoundOutput			*output;
+	NSMutableSet		*voices;		// NSNumbers of voices playing
+	NSTimer				*finishTimer;	// collects finished voices, while any are playing
+	BOOL				running;		// the output's only kept running while there's something to play
+}
+
+/*!
+@method		sharedPlayer
+@abstract	Plays to the default output device, or to the WAV file at the path in the SoundOutputFile user default, if it's set.
+*/
++ (SoundPlayer *)sharedPlayer;
+
+/*!
+@method		initWithOutputFile:
+@abstract	Plays to a WAV file at the path given, in real time, or to nowhere if it's nil, for listening to sounds without sound hardware.
+*/
+- (id)initWithOutputFile:(NSString *)path;
+
+/*!
+@method		canPlaySoundData:
+@abstract	Whether the 'snd ' resource data given can be decoded, so played here.
+*/
+- (BOOL)canPlaySoundData:(NSData *)data;
+
+/*!
+@method		playSoundData:
+@abstract	Starts the 'snd ' resource data given playing, and returns its voice, or zero if it can't be decoded or too many sounds are waiting to start or be collected.
+*/
+- (SoundVoiceID)playSoundData:(NSData *)data;
+
+- (void)pauseVoice:(SoundVoiceID)voice;
+- (void)resumeVoice:(SoundVoiceID)voice;
+- (void)stopVoice:(SoundVoiceID)voice;
+- (void)stopAllVoices;
+
+/*!
+@method		seekVoice:toFrame:
+@abstract	Moves the voice to the frame of its sound given.
+*/
+- (void)seekVoice:(SoundVoiceID)voice toFrame:(UInt32)frame;
+
+/*!
+@method		isVoicePlaying:
+@abstract	Whether the voice hasn't yet finished, paused or not.
+*/
+- (BOOL)isVoicePlaying:(SoundVoiceID)voice;
+
+@end
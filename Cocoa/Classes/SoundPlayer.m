@@ -0,0 +1,167 @@
+#import "SoundPlayer.h"
+
+NSString *SoundPlayerVoiceDidFinishNotification = @"SoundPlayerVoiceDidFinishNotification";
+
+static SoundPlayer *gSharedPlayer = nil;
+
+@interface SoundPlayer (Private)
+- (id)initWithOutput:(SoundOutput *)newOutput;
+- (void)collectFinished:(NSTimer *)timer;
+@end
+
+@implementation SoundPlayer
+
++ (SoundPlayer *)sharedPlayer
+{
+	if(!gSharedPlayer)
+	{
+		NSString *path = [[NSUserDefaults standardUserDefaults] stringForKey:@"SoundOutputFile"];
+		if(path) gSharedPlayer = [[SoundPlayer alloc] initWithOutputFile:path];
+		else gSharedPlayer = [[SoundPlayer alloc] init];
+	}
+	return gSharedPlayer;
+}
+
+- (id)init
+{
+	// with no sound hardware, sounds play to nowhere rather than not at all
+	SoundOutput *device = SoundOutputOpenDefault();
+	if(!device)
+	{
+		NSLog(@"Couldn't open the default sound output; sounds won't be heard.");
+		device = SoundOutputOpenFile(NULL);
+	}
+	return [self initWithOutput:device];
+}
+
+- (id)initWithOutputFile:(NSString *)path
+{
+	SoundOutput *file = SoundOutputOpenFile(path? [path fileSystemRepresentation] : NULL);
+	if(!file) NSLog(@"Couldn't create the sound output file %@.", path);
+	return [self initWithOutput:file];
+}
+
+- (void)dealloc
+{
+	[finishTimer invalidate];
+	if(output)
+	{
+		SoundMixerFinished finished;
+		SoundOutputStop(output);
+		SoundMixerReset(mixer);
+		while(SoundMixerNextFinished(mixer, &finished))
+			[(NSData *) finished.owner release];
+		SoundOutputClose(output);
+	}
+	free(mixer);
+	[voices release];
+	[super dealloc];
+}
+
+- (BOOL)canPlaySoundData:(NSData *)data
+{
+	SoundInfo info;
+	return (output && data && SoundReadInfo((const UInt8 *)[data bytes], [data length], &info) == kSoundNoError);
+}
+
+- (SoundVoiceID)playSoundData:(NSData *)data
+{
+	SoundVoiceID voice;
+	if(!output || !data) return 0;
+
+	// the mixer reads from the data until it hands it back, so it mustn't change meanwhile
+	data = [data copy];
+	voice = SoundMixerPlay(mixer, (const UInt8 *)[data bytes], [data length], data);
+	if(!voice)
+	{
+		[data release];
+		return 0;
+	}
+	[voices addObject:[NSNumber numberWithUnsignedLong:voice]];
+	if(!running)
+	{
+		// if it can't be heard, it's finished
+		running = SoundOutputStart(output, mixer);
+		if(!running) SoundMixerReset(mixer);
+	}
+	if(!finishTimer)
+		finishTimer = [NSTimer scheduledTimerWithTimeInterval:0.1 target:self selector:@selector(collectFinished:) userInfo:nil repeats:YES];
+	return voice;
+}
+
+- (void)pauseVoice:(SoundVoiceID)voice
+{
+	if(voice) SoundMixerPause(mixer, voice, true);
+}
+
+- (void)resumeVoice:(SoundVoiceID)voice
+{
+	if(voice) SoundMixerPause(mixer, voice, false);
+}
+
+- (void)stopVoice:(SoundVoiceID)voice
+{
+	if(voice) SoundMixerStop(mixer, voice);
+}
+
+- (void)stopAllVoices
+{
+	if(mixer) SoundMixerStop(mixer, 0);
+}
+
+- (void)seekVoice:(SoundVoiceID)voice toFrame:(UInt32)frame
+{
+	if(voice) SoundMixerSeek(mixer, voice, frame);
+}
+
+- (BOOL)isVoicePlaying:(SoundVoiceID)voice
+{
+	return [voices containsObject:[NSNumber numberWithUnsignedLong:voice]];
+}
+
+#pragma mark -
+
+- (id)initWithOutput:(SoundOutput *)newOutput
+{
+	self = [super init];
+	if(!self || !newOutput)
+	{
+		SoundOutputClose(newOutput);
+		[self release];
+		return nil;
+	}
+	mixer = (SoundMixer *) malloc(sizeof(SoundMixer));
+	if(!mixer)
+	{
+		SoundOutputClose(newOutput);
+		[self release];
+		return nil;
+	}
+	SoundMixerInit(mixer);
+	output = newOutput;
+	voices = [[NSMutableSet alloc] init];
+	return self;
+}
+
+- (void)collectFinished:(NSTimer *)timer
+{
+	SoundMixerFinished finished;
+	while(SoundMixerNextFinished(mixer, &finished))
+	{
+		NSNumber *voice = [NSNumber numberWithUnsignedLong:finished.voice];
+		[(NSData *) finished.owner release];
+		[voices removeObject:voice];
+		[[NSNotificationCenter defaultCenter] postNotificationName:SoundPlayerVoiceDidFinishNotification object:self userInfo:[NSDictionary dictionaryWithObject:voice forKey:@"voice"]];
+	}
+
+	// nothing left to play, so no need to keep rendering silence
+	if(![voices count])
+	{
+		[finishTimer invalidate];
+		finishTimer = nil;
+		SoundOutputStop(output);
+		running = NO;
+	}
+}
+
+@end
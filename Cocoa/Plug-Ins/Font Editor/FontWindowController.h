@@ -4,6 +4,8 @@
 #import "ResKnifePluginProtocol.h"
 #import "ResKnifeResourceProtocol.h"
 
+@class GlyphGridView;
+
 @interface FontWindowController : NSWindowController <ResKnifePluginProtocol>
 {
 	id <ResKnifeResourceProtocol>	resource;
@@ -14,6 +16,8 @@
 	UInt16 entrySelector;
 	UInt16 rangeShift;
 	NSMutableArray *headerTable;
+	NSDrawer *glyphDrawer;
+	GlyphGridView *glyphGrid;
 }
 - (void)loadFontFromResource;
 - (IBAction)saveResource:(id)sender;
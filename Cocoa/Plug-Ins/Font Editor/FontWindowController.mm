@@ -1,18 +1,59 @@
 #import "FontWindowController.h"
 #import "NGSCategories.h"
+#import "SfntDirectory.h"
+#import "GlyphGridView.h"
+#import "GlyphWindowController.h"
 #import <stdarg.h>
 
-UInt32 TableChecksum(UInt32 *table, UInt32 length)
+/* A table's bytes, left where they are in the font's data, which it keeps hold of. */
+@interface SfntTableData : NSData
 {
-	UInt32 sum = 0, nLongs = (length+3) >> 2;
-	while(nLongs-- > 0) sum += *table++;
-	return sum;
+	NSData *font;
+	NSRange range;
+}
+- (id)initWithFont:(NSData *)fontData range:(NSRange)tableRange;
+@end
+
+@implementation SfntTableData
+
+- (id)initWithFont:(NSData *)fontData range:(NSRange)tableRange
+{
+	self = [super init];
+	if(!self) return nil;
+	font = [fontData retain];
+	range = tableRange;
+	return self;
+}
+
+- (void)dealloc
+{
+	[font release];
+	[super dealloc];
+}
+
+- (unsigned)length
+{
+	return range.length;
+}
+
+- (const void *)bytes
+{
+	return (const char *)[font bytes] + range.location;
 }
 
+@end
+
 @implementation FontWindowController
 
 - (id)initWithResource:(id <ResKnifeResourceProtocol>)inResource
 {
+	// bitmap fonts have no tables, only glyphs
+	if([[inResource type] isEqualToString:@"NFNT"] || [[inResource type] isEqualToString:@"FONT"])
+	{
+		[self release];
+		return [[GlyphWindowController alloc] initWithResource:inResource];
+	}
+	
 	self = [self initWithWindowNibName:@"FontDocument"];
 	if(!self) return nil;
 	
@@ -27,40 +68,38 @@ UInt32 TableChecksum(UInt32 *table, UInt32 length)
 
 - (void)loadFontFromResource
 {
-	char *start = (char *)[[resource data] bytes];
-	if (start != 0x0)
+	NSData *data = [resource data];
+	const UInt8 *start = (const UInt8 *)[data bytes];
+	SfntDirectory directory;
+	if(SfntReadDirectory(start, [data length], &directory) != kSfntNoError)
 	{
-		arch = *(OSType*)start;
-		numTables = *(UInt16*)(start+4);
-		searchRange = *(UInt16*)(start+6);
-		entrySelector = *(UInt16*)(start+8);
-		rangeShift = *(UInt16*)(start+10);
-		UInt32 *pos = (UInt32 *)(start+12);
-/*		printf("%s\n", [[self displayName] cString]);
-		printf("  architecture: %#lx '%.4s'\n", arch, &arch);
-		printf("  number of tables: %hu\n", numTables);
-		printf("  searchRange: %hu\n", searchRange);
-		printf("  entrySelector: %hu\n", entrySelector);
-		printf("  rangeShift: %hu\n\n", rangeShift);
-*/		for(int i = 0; i < numTables; i++)
-		{
-			OSType name = *pos++;
-			UInt32 checksum = *pos++;
-			UInt32 offset = *pos++;
-			UInt32 length = *pos++;
-			[headerTable addObject:[NSMutableDictionary dictionaryWithObjectsAndKeys:
-				[[[NSString alloc] initWithBytes:&name length:4 encoding:NSMacOSRomanStringEncoding] autorelease], @"name",
-				[NSNumber numberWithUnsignedLong: checksum], @"checksum",
-				[NSNumber numberWithUnsignedLong: offset], @"offset",
-				[NSNumber numberWithUnsignedLong: length], @"length",
-				[NSData dataWithBytes:start+offset length:length], @"data",
-				nil]];
-		}
+		NSLog(@"Invalid sfnt, aborting parse.");
+		return;
 	}
-	else
+	arch = directory.version;
+	searchRange = directory.searchRange;
+	entrySelector = directory.entrySelector;
+	rangeShift = directory.rangeShift;
+	
+	// tables are only looked at when opened, so just note where they are
+	for(UInt16 i = 0; i < directory.numTables; i++)
 	{
-		NSLog(@"Invalid sfnt, aborting parse.");
+		SfntTable table;
+		if(SfntReadTable(start, [data length], i, &table) != kSfntNoError)
+		{
+			NSLog(@"Table %hu lies outside the sfnt, skipping it.", i);
+			continue;
+		}
+		UInt8 name[4] = { (UInt8) (table.tag >> 24), (UInt8) (table.tag >> 16), (UInt8) (table.tag >> 8), (UInt8) table.tag };
+		[headerTable addObject:[NSMutableDictionary dictionaryWithObjectsAndKeys:
+			[[[NSString alloc] initWithBytes:name length:4 encoding:NSMacOSRomanStringEncoding] autorelease], @"name",
+			[NSNumber numberWithUnsignedLong: table.checksum], @"checksum",
+			[NSNumber numberWithUnsignedLong: table.offset], @"offset",
+			[NSNumber numberWithUnsignedLong: table.length], @"length",
+			[[[SfntTableData alloc] initWithFont:data range:NSMakeRange(table.offset, table.length)] autorelease], @"data",
+			nil]];
 	}
+	numTables = [headerTable count];
 }
 
 - (void)dealloc
@@ -68,6 +107,7 @@ UInt32 TableChecksum(UInt32 *table, UInt32 length)
 	[[NSNotificationCenter defaultCenter] removeObserver:self];
 	[(id)resource release];
 	[headerTable release];
+	[glyphDrawer release];
 	[super dealloc];
 }
 
@@ -87,6 +127,20 @@ UInt32 TableChecksum(UInt32 *table, UInt32 length)
 	
 	// finally, show the window
 	[self showWindow:self];
+	
+	// with the glyphs in a drawer beside it, if they're TrueType
+	glyphDrawer = [[NSDrawer alloc] initWithContentSize:NSMakeSize(320, 400) preferredEdge:NSMaxXEdge];
+	[glyphDrawer setContentView:[[[NSView alloc] initWithFrame:NSMakeRect(0, 0, 320, 400)] autorelease]];
+	[glyphDrawer setParentWindow:[self window]];
+	glyphGrid = [GlyphGridView gridInView:[glyphDrawer contentView] sizeControl:YES];
+	if([glyphGrid setFontData:[resource data] type:@"sfnt"])
+		[glyphDrawer open];
+}
+
+- (void)windowWillClose:(NSNotification *)notification
+{
+	// nothing more for the workers to draw
+	[glyphGrid setFontData:nil type:nil];
 }
 
 - (void)windowDidBecomeKey:(NSNotification *)notification
@@ -111,6 +165,7 @@ UInt32 TableChecksum(UInt32 *table, UInt32 length)
 {
 	[headerTable removeAllObjects];
 	[self loadFontFromResource];
+	[glyphGrid setFontData:[resource data] type:@"sfnt"];
 }
 
 - (BOOL)windowShouldClose:(id)sender
@@ -143,13 +198,15 @@ UInt32 TableChecksum(UInt32 *table, UInt32 length)
 
 - (void)saveResource:(id)sender
 {
-	// write header fields
+	// write header fields, big-endian
 	NSMutableData *data = [NSMutableData data];
-	[data appendBytes:&arch length:4];
-	[data appendBytes:&numTables length:2];
-	[data appendBytes:&searchRange length:2];
-	[data appendBytes:&entrySelector length:2];
-	[data appendBytes:&rangeShift length:2];
+	UInt32 bigLong = EndianU32_NtoB(arch);
+	UInt16 bigShort = EndianU16_NtoB(numTables);
+	[data appendBytes:&bigLong length:4];
+	[data appendBytes:&bigShort length:2];
+	bigShort = EndianU16_NtoB(searchRange);		[data appendBytes:&bigShort length:2];
+	bigShort = EndianU16_NtoB(entrySelector);	[data appendBytes:&bigShort length:2];
+	bigShort = EndianU16_NtoB(rangeShift);		[data appendBytes:&bigShort length:2];
 	UInt32 offset = 12 + ([headerTable count] << 4);
 	
 	// add table index
@@ -158,14 +215,14 @@ UInt32 TableChecksum(UInt32 *table, UInt32 length)
 		NSMutableDictionary *table = [headerTable objectAtIndex:i];
 		NSData *tableData = [table valueForKey:@"data"];
 		UInt32 length = [tableData length];
-		UInt32 checksum = TableChecksum((UInt32 *)[tableData bytes], length);
+		UInt32 checksum = SfntChecksum((const UInt8 *)[tableData bytes], length);
 		[table setValue:[NSNumber numberWithUnsignedLong:checksum] forKey:@"checksum"];
 		[table setValue:[NSNumber numberWithUnsignedLong:offset] forKey:@"offset"];
 		[table setValue:[NSNumber numberWithUnsignedLong:length] forKey:@"length"];
 		[data appendBytes:[[table valueForKey:@"name"] cStringUsingEncoding:NSMacOSRomanStringEncoding] length:4];
-		[data appendBytes:&checksum length:4];
-		[data appendBytes:&offset length:4];
-		[data appendBytes:&length length:4];
+		bigLong = EndianU32_NtoB(checksum);	[data appendBytes:&bigLong length:4];
+		bigLong = EndianU32_NtoB(offset);	[data appendBytes:&bigLong length:4];
+		bigLong = EndianU32_NtoB(length);	[data appendBytes:&bigLong length:4];
 		offset += length;
 		if(offset % 4)
 			offset += 4-(offset%4);
@@ -181,14 +238,14 @@ UInt32 TableChecksum(UInt32 *table, UInt32 length)
 			[data appendBytes:&align length:4-([data length]%4)];
 	}
 	
-	// write checksum adjustment to head table
+	// write checksum adjustment to head table, such that the whole font sums to 0xB1B0AFBA
 	NSDictionary *head = [headerTable firstObjectReturningValue:@"head" forKey:@"name"];
-	if(head)
+	if(head && [[head valueForKey:@"length"] unsignedLongValue] >= 12)
 	{
 		UInt32 fontChecksum = 0;
 		NSRange csRange = NSMakeRange([[head valueForKey:@"offset"] unsignedLongValue]+8,4);
 		[data replaceBytesInRange:csRange withBytes:&fontChecksum length:4];
-		fontChecksum = TableChecksum((UInt32 *)[data bytes], [data length]);
+		fontChecksum = EndianU32_NtoB(0xB1B0AFBA - SfntChecksum((const UInt8 *)[data bytes], [data length]));
 		[data replaceBytesInRange:csRange withBytes:&fontChecksum length:4];
 	}
 //	[[NSNotificationCenter defaultCenter] removeObserver:self name:ResourceDataDidChangeNotification object:backup];
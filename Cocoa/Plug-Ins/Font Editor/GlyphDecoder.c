@@ -0,0 +1,703 @@
+#include "GlyphDecoder.h"
+#include "SfntDirectory.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLYPH_TAG(a, b, c, d)	(((UInt32) (a) << 24) | ((UInt32) (b) << 16) | ((UInt32) (c) << 8) | (UInt32) (d))
+
+enum
+{
+	kMaxComponentDepth = 8,		// composites of composites, as deep as anyone sensible nests them
+	kMaxPixels = 4096 * 4096,	// a glyph bigger than this is a damaged one
+	kMaxCurveLines = 32,
+
+	// simple glyph flags
+	kOnCurve = 0x01,
+	kXShort = 0x02,
+	kYShort = 0x04,
+	kRepeat = 0x08,
+	kXSame = 0x10,
+	kYSame = 0x20,
+
+	// component flags
+	kArgsAreWords = 0x0001,
+	kArgsAreXY = 0x0002,
+	kHaveScale = 0x0008,
+	kMoreComponents = 0x0020,
+	kHaveXYScale = 0x0040,
+	kHaveTwoByTwo = 0x0080
+};
+
+/* Points in font units, with the contours they make up. */
+typedef struct Outline
+{
+	float	*x, *y;
+	UInt8	*onCurve;
+	UInt32	count, capacity;
+	UInt32	*ends;			// index of each contour's last point
+	UInt32	contours, contourCapacity;
+} Outline;
+
+/* x' = a*x + c*y + e, y' = b*x + d*y + f */
+typedef struct Transform
+{
+	float a, b, c, d, e, f;
+} Transform;
+
+static UInt16 ReadShort(const UInt8 *bytes)
+{
+	return (UInt16) ((bytes[0] << 8) | bytes[1]);
+}
+
+static UInt32 ReadLong(const UInt8 *bytes)
+{
+	return ((UInt32) bytes[0] << 24) | ((UInt32) bytes[1] << 16) | ((UInt32) bytes[2] << 8) | bytes[3];
+}
+
+#pragma mark -
+
+static Boolean OutlineReserve(Outline *outline, UInt32 points, UInt32 contours)
+{
+	if( outline->count + points > outline->capacity )
+	{
+		UInt32 capacity = (outline->count + points) * 2;
+		float *x = (float *) realloc( outline->x, capacity * sizeof(float) );
+		float *y = x? (float *) realloc( outline->y, capacity * sizeof(float) ) : NULL;
+		UInt8 *onCurve = y? (UInt8 *) realloc( outline->onCurve, capacity ) : NULL;
+		if( x ) outline->x = x;
+		if( y ) outline->y = y;
+		if( onCurve ) outline->onCurve = onCurve;
+		if( !onCurve ) return false;
+		outline->capacity = capacity;
+	}
+	if( outline->contours + contours > outline->contourCapacity )
+	{
+		UInt32 capacity = (outline->contours + contours) * 2;
+		UInt32 *ends = (UInt32 *) realloc( outline->ends, capacity * sizeof(UInt32) );
+		if( !ends ) return false;
+		outline->ends = ends;
+		outline->contourCapacity = capacity;
+	}
+	return true;
+}
+
+static void OutlineFree(Outline *outline)
+{
+	free( outline->x );
+	free( outline->y );
+	free( outline->onCurve );
+	free( outline->ends );
+}
+
+static int GlyphRange(const GlyphFont *font, UInt32 glyph, UInt32 *start, UInt32 *end)
+{
+	if( glyph >= font->glyphCount ) return kGlyphBadGlyph;
+	if( font->longOffsets )
+	{
+		if( (glyph + 2) * 4 > font->locaLength ) return kGlyphBadGlyph;
+		*start = ReadLong( font->loca + glyph * 4 );
+		*end = ReadLong( font->loca + glyph * 4 + 4 );
+	}
+	else
+	{
+		if( (glyph + 2) * 2 > font->locaLength ) return kGlyphBadGlyph;
+		*start = ReadShort( font->loca + glyph * 2 ) * 2UL;
+		*end = ReadShort( font->loca + glyph * 2 + 2 ) * 2UL;
+	}
+	if( *start > *end || *end > font->glyfLength ) return kGlyphBadGlyph;
+	return kGlyphNoError;
+}
+
+/* Appends the glyph's points to the outline, through the transform. Composites add their components in turn. */
+static int DecodeGlyph(const GlyphFont *font, UInt32 glyph, const Transform *transform, Outline *outline, int depth)
+{
+	const UInt8 *data, *end;
+	UInt8 *flags;
+	UInt32 start, stop, points, i, axis, first = outline->count;
+	SInt16 contours;
+	int error = GlyphRange( font, glyph, &start, &stop );
+	if( error ) return error;
+	if( start == stop ) return kGlyphNoError;		// no outline, like a space
+	if( stop - start < 10 ) return kGlyphBadGlyph;
+	data = font->glyf + start;
+	end = font->glyf + stop;
+	contours = (SInt16) ReadShort( data );
+	data += 10;
+
+	if( contours < 0 )
+	{
+		UInt16 componentFlags;
+		if( depth >= kMaxComponentDepth ) return kGlyphBadGlyph;
+		do
+		{
+			Transform component = { 1, 0, 0, 1, 0, 0 }, combined;
+			UInt16 componentGlyph;
+			if( end - data < 4 ) return kGlyphBadGlyph;
+			componentFlags = ReadShort( data );
+			componentGlyph = ReadShort( data + 2 );
+			data += 4;
+			if( componentFlags & kArgsAreWords )
+			{
+				if( end - data < 4 ) return kGlyphBadGlyph;
+				if( componentFlags & kArgsAreXY )
+				{
+					component.e = (SInt16) ReadShort( data );
+					component.f = (SInt16) ReadShort( data + 2 );
+				}
+				data += 4;
+			}
+			else
+			{
+				if( end - data < 2 ) return kGlyphBadGlyph;
+				if( componentFlags & kArgsAreXY )
+				{
+					component.e = (SInt8) data[0];
+					component.f = (SInt8) data[1];
+				}
+				data += 2;
+			}
+			// components placed by matching points are left where they are
+
+			if( componentFlags & kHaveScale )
+			{
+				if( end - data < 2 ) return kGlyphBadGlyph;
+				component.a = component.d = (SInt16) ReadShort( data ) / 16384.0f;
+				data += 2;
+			}
+			else if( componentFlags & kHaveXYScale )
+			{
+				if( end - data < 4 ) return kGlyphBadGlyph;
+				component.a = (SInt16) ReadShort( data ) / 16384.0f;
+				component.d = (SInt16) ReadShort( data + 2 ) / 16384.0f;
+				data += 4;
+			}
+			else if( componentFlags & kHaveTwoByTwo )
+			{
+				if( end - data < 8 ) return kGlyphBadGlyph;
+				component.a = (SInt16) ReadShort( data ) / 16384.0f;
+				component.b = (SInt16) ReadShort( data + 2 ) / 16384.0f;
+				component.c = (SInt16) ReadShort( data + 4 ) / 16384.0f;
+				component.d = (SInt16) ReadShort( data + 6 ) / 16384.0f;
+				data += 8;
+			}
+
+			combined.a = transform->a * component.a + transform->c * component.b;
+			combined.b = transform->b * component.a + transform->d * component.b;
+			combined.c = transform->a * component.c + transform->c * component.d;
+			combined.d = transform->b * component.c + transform->d * component.d;
+			combined.e = transform->a * component.e + transform->c * component.f + transform->e;
+			combined.f = transform->b * component.e + transform->d * component.f + transform->f;
+			error = DecodeGlyph( font, componentGlyph, &combined, outline, depth + 1 );
+			if( error ) return error;
+		}
+		while( componentFlags & kMoreComponents );
+		return kGlyphNoError;
+	}
+
+	// simple glyph: the contours' last points, instructions, then flags, xs and ys, each packed
+	if( contours == 0 ) return kGlyphNoError;
+	if( end - data < contours * 2 + 2 ) return kGlyphBadGlyph;
+	points = ReadShort( data + (contours - 1) * 2 ) + 1UL;
+	if( !OutlineReserve( outline, points, contours ) ) return kGlyphMemoryFull;
+	for( i = 0; i < (UInt32) contours; i++ )
+	{
+		UInt32 last = ReadShort( data + i * 2 );
+		if( last >= points || (i > 0 && last <= outline->ends[outline->contours - 1] - first) ) return kGlyphBadGlyph;
+		outline->ends[outline->contours++] = first + last;
+	}
+	data += contours * 2;
+	i = ReadShort( data );
+	data += 2;
+	if( (UInt32) (end - data) < i ) return kGlyphBadGlyph;
+	data += i;
+
+	// flags, each perhaps followed by a count of times it repeats; kept whole until the coordinates are read
+	flags = outline->onCurve + first;
+	for( i = 0; i < points; )
+	{
+		UInt8 flag;
+		UInt32 repeat = 1;
+		if( data >= end ) return kGlyphBadGlyph;
+		flag = *data++;
+		if( flag & kRepeat )
+		{
+			if( data >= end ) return kGlyphBadGlyph;
+			repeat += *data++;
+		}
+		while( repeat-- && i < points )
+			flags[i++] = flag;
+	}
+
+	// then the xs and the ys, as deltas: a byte with its sign in the flags, none at all, or a word
+	for( axis = 0; axis < 2; axis++ )
+	{
+		UInt8 shortFlag = axis? kYShort : kXShort, sameFlag = axis? kYSame : kXSame;
+		float value = 0, *coordinates = (axis? outline->y : outline->x) + first;
+		for( i = 0; i < points; i++ )
+		{
+			if( flags[i] & shortFlag )
+			{
+				if( data >= end ) return kGlyphBadGlyph;
+				value += (flags[i] & sameFlag)? (float) *data : -(float) *data;
+				data++;
+			}
+			else if( !(flags[i] & sameFlag) )
+			{
+				if( end - data < 2 ) return kGlyphBadGlyph;
+				value += (SInt16) ReadShort( data );
+				data += 2;
+			}
+			coordinates[i] = value;
+		}
+	}
+
+	for( i = first; i < first + points; i++ )
+	{
+		float x = outline->x[i], y = outline->y[i];
+		outline->x[i] = transform->a * x + transform->c * y + transform->e;
+		outline->y[i] = transform->b * x + transform->d * y + transform->f;
+		outline->onCurve[i] &= kOnCurve;
+	}
+	outline->count += points;
+	return kGlyphNoError;
+}
+
+#pragma mark -
+
+/* Adds the signed area the line covers to each pixel it passes through, and what's left of the row's to the pixel
+	after. Summing the buffer in order afterwards gives each pixel's coverage. Lines must lie within it. */
+static void AddLine(float *area, int width, int height, float x0, float y0, float x1, float y1)
+{
+	float direction = 1, dxdy, x;
+	int y, yEnd;
+	if( y0 == y1 ) return;
+	if( y0 > y1 )
+	{
+		float t;
+		direction = -1;
+		t = x0; x0 = x1; x1 = t;
+		t = y0; y0 = y1; y1 = t;
+	}
+	dxdy = (x1 - x0) / (y1 - y0);
+	x = x0;
+	yEnd = (int) ceilf( y1 );
+	if( yEnd > height ) yEnd = height;
+	for( y = (int) y0; y < yEnd; y++ )
+	{
+		float *row = area + y * width;
+		float dy = ((y + 1 < y1)? y + 1 : y1) - ((y > y0)? y : y0);
+		float xNext = x + dxdy * dy, d = dy * direction;
+		float left = (x < xNext)? x : xNext, right = (x < xNext)? xNext : x;
+		float leftFloor = floorf( left ), rightCeil = ceilf( right );
+		int leftPixel = (int) leftFloor, rightPixel = (int) rightCeil;
+		if( rightPixel <= leftPixel + 1 )
+		{
+			// within one pixel: split by where the line crosses it on average
+			float middle = 0.5f * (x + xNext) - leftFloor;
+			row[leftPixel] += d - d * middle;
+			row[leftPixel + 1] += d * middle;
+		}
+		else
+		{
+			float scale = 1.0f / (right - left);
+			float leftFraction = left - leftFloor, rightFraction = right - rightCeil + 1.0f;
+			float firstArea = 0.5f * scale * (1.0f - leftFraction) * (1.0f - leftFraction);
+			float lastArea = 0.5f * scale * rightFraction * rightFraction;
+			row[leftPixel] += d * firstArea;
+			if( rightPixel == leftPixel + 2 )
+				row[leftPixel + 1] += d * (1.0f - firstArea - lastArea);
+			else
+			{
+				float secondArea = scale * (1.5f - leftFraction), areaBefore;
+				int pixel;
+				row[leftPixel + 1] += d * (secondArea - firstArea);
+				for( pixel = leftPixel + 2; pixel < rightPixel - 1; pixel++ )
+					row[pixel] += d * scale;
+				areaBefore = secondArea + (rightPixel - leftPixel - 3) * scale;
+				row[rightPixel - 1] += d * (1.0f - areaBefore - lastArea);
+			}
+			row[rightPixel] += d * lastArea;
+		}
+		x = xNext;
+	}
+}
+
+static void AddCurve(float *area, int width, int height, float x0, float y0, float cx, float cy, float x1, float y1)
+{
+	float dx = x0 - 2 * cx + x1, dy = y0 - 2 * cy + y1;
+	float deviation = dx * dx + dy * dy, t, lastX = x0, lastY = y0;
+	int lines, i;
+	if( deviation < 0.333f )
+	{
+		AddLine( area, width, height, x0, y0, x1, y1 );
+		return;
+	}
+	lines = 1 + (int) sqrtf( sqrtf( 3.0f * deviation ) );
+	if( lines > kMaxCurveLines ) lines = kMaxCurveLines;
+	for( i = 1; i <= lines; i++ )
+	{
+		float x, y;
+		t = (float) i / lines;
+		x = (1 - t) * (1 - t) * x0 + 2 * t * (1 - t) * cx + t * t * x1;
+		y = (1 - t) * (1 - t) * y0 + 2 * t * (1 - t) * cy + t * t * y1;
+		AddLine( area, width, height, lastX, lastY, x, y );
+		lastX = x;
+		lastY = y;
+	}
+}
+
+/* Off-curve points between two others imply an on-curve point half way between them. */
+static void AddContour(float *area, int width, int height, const float *x, const float *y, const UInt8 *onCurve, UInt32 first, UInt32 last)
+{
+	float startX, startY, currentX, currentY, controlX = 0, controlY = 0;
+	Boolean haveControl = false;
+	UInt32 i, from, to;
+	if( last <= first ) return;
+	if( onCurve[first] )
+	{
+		startX = x[first]; startY = y[first];
+		from = first + 1; to = last;
+	}
+	else if( onCurve[last] )
+	{
+		startX = x[last]; startY = y[last];
+		from = first; to = last - 1;
+	}
+	else
+	{
+		startX = (x[first] + x[last]) / 2; startY = (y[first] + y[last]) / 2;
+		from = first; to = last;
+	}
+
+	currentX = startX; currentY = startY;
+	for( i = from; i <= to; i++ )
+	{
+		if( onCurve[i] )
+		{
+			if( haveControl ) AddCurve( area, width, height, currentX, currentY, controlX, controlY, x[i], y[i] );
+			else AddLine( area, width, height, currentX, currentY, x[i], y[i] );
+			currentX = x[i]; currentY = y[i];
+			haveControl = false;
+		}
+		else
+		{
+			if( haveControl )
+			{
+				float middleX = (controlX + x[i]) / 2, middleY = (controlY + y[i]) / 2;
+				AddCurve( area, width, height, currentX, currentY, controlX, controlY, middleX, middleY );
+				currentX = middleX; currentY = middleY;
+			}
+			controlX = x[i]; controlY = y[i];
+			haveControl = true;
+		}
+	}
+	if( haveControl ) AddCurve( area, width, height, currentX, currentY, controlX, controlY, startX, startY );
+	else AddLine( area, width, height, currentX, currentY, startX, startY );
+}
+
+static int DrawTrueType(const GlyphFont *font, UInt32 glyph, float pixelsPerEm, GlyphBitmap *bitmap)
+{
+	Outline outline;
+	Transform identity = { 1, 0, 0, 1, 0, 0 };
+	float scale = pixelsPerEm / font->unitsPerEm, minX, minY, maxX, maxY, *area;
+	UInt32 i, contour, first;
+	int error;
+
+	memset( &outline, 0, sizeof(outline) );
+	error = DecodeGlyph( font, glyph, &identity, &outline, 0 );
+	if( error || outline.count == 0 )
+	{
+		OutlineFree( &outline );
+		return error;
+	}
+
+	// into pixels, y down, with a pixel's margin either side so no line reaches the edge
+	minX = maxX = outline.x[0] * scale;
+	minY = maxY = outline.y[0] * scale;
+	for( i = 0; i < outline.count; i++ )
+	{
+		outline.x[i] *= scale;
+		outline.y[i] *= scale;
+		if( outline.x[i] < minX ) minX = outline.x[i];
+		if( outline.x[i] > maxX ) maxX = outline.x[i];
+		if( outline.y[i] < minY ) minY = outline.y[i];
+		if( outline.y[i] > maxY ) maxY = outline.y[i];
+	}
+	if( maxX - minX > 4096 || maxY - minY > 4096 )
+	{
+		OutlineFree( &outline );
+		return kGlyphBadGlyph;
+	}
+	bitmap->left = (int) floorf( minX ) - 1;
+	bitmap->top = (int) ceilf( maxY ) + 1;
+	bitmap->width = (int) ceilf( maxX ) - bitmap->left + 1;
+	bitmap->height = bitmap->top - (int) floorf( minY ) + 1;
+	for( i = 0; i < outline.count; i++ )
+	{
+		outline.x[i] -= bitmap->left;
+		outline.y[i] = bitmap->top - outline.y[i];
+	}
+
+	area = (float *) calloc( bitmap->width * bitmap->height + 2, sizeof(float) );
+	bitmap->pixels = (UInt8 *) malloc( bitmap->width * bitmap->height );
+	if( !area || !bitmap->pixels )
+	{
+		free( area );
+		GlyphBitmapFree( bitmap );
+		OutlineFree( &outline );
+		return kGlyphMemoryFull;
+	}
+	for( contour = 0, first = 0; contour < outline.contours; contour++ )
+	{
+		AddContour( area, bitmap->width, bitmap->height, outline.x, outline.y, outline.onCurve, first, outline.ends[contour] );
+		first = outline.ends[contour] + 1;
+	}
+
+	// sum the areas to coverage; contours overlapping the same way add up past full, and are held there
+	{
+		float sum = 0;
+		for( i = 0; i < (UInt32) (bitmap->width * bitmap->height); i++ )
+		{
+			float coverage;
+			sum += area[i];
+			coverage = fabsf( sum );
+			bitmap->pixels[i] = (coverage >= 1.0f)? 255 : (UInt8) (coverage * 255.0f + 0.5f);
+		}
+	}
+	free( area );
+	OutlineFree( &outline );
+	return kGlyphNoError;
+}
+
+#pragma mark -
+
+static int DrawBitmap(const GlyphFont *font, UInt32 glyph, GlyphBitmap *bitmap)
+{
+	UInt16 offsetWidth, start, stop;
+	int x, y;
+	if( glyph >= font->glyphCount ) return kGlyphBadGlyph;
+	offsetWidth = ReadShort( font->offsetWidths + glyph * 2 );
+	if( offsetWidth == 0xFFFF ) return kGlyphNoError;		// not in the font
+	start = ReadShort( font->locations + glyph * 2 );
+	stop = ReadShort( font->locations + glyph * 2 + 2 );
+	if( start > stop || stop > font->rowBytes * 8 ) return kGlyphBadGlyph;
+	if( start == stop || font->rectHeight <= 0 ) return kGlyphNoError;
+
+	bitmap->width = stop - start;
+	bitmap->height = font->rectHeight;
+	bitmap->left = font->kernMax + (offsetWidth >> 8);
+	bitmap->top = font->ascent;
+	bitmap->pixels = (UInt8 *) malloc( bitmap->width * bitmap->height );
+	if( !bitmap->pixels ) return kGlyphMemoryFull;
+	for( y = 0; y < bitmap->height; y++ )
+	{
+		const UInt8 *row = font->image + y * font->rowBytes;
+		for( x = 0; x < bitmap->width; x++ )
+		{
+			int bit = start + x;
+			bitmap->pixels[y * bitmap->width + x] = ((row[bit >> 3] >> (7 - (bit & 7))) & 1)? 255 : 0;
+		}
+	}
+	return kGlyphNoError;
+}
+
+#pragma mark -
+
+int GlyphFontOpenSfnt(const UInt8 *bytes, UInt32 length, GlyphFont *font)
+{
+	SfntTable head, maxp, loca, glyf, cmap;
+	SInt16 indexFormat;
+	memset( font, 0, sizeof(GlyphFont) );
+	font->kind = kGlyphFontTrueType;
+	if( !SfntFindTable( bytes, length, GLYPH_TAG( 'h','e','a','d' ), &head ) || head.length < 54 ) return kGlyphBadFont;
+	if( !SfntFindTable( bytes, length, GLYPH_TAG( 'm','a','x','p' ), &maxp ) || maxp.length < 6 ) return kGlyphBadFont;
+	if( !SfntFindTable( bytes, length, GLYPH_TAG( 'l','o','c','a' ), &loca ) ) return kGlyphBadFont;
+	if( !SfntFindTable( bytes, length, GLYPH_TAG( 'g','l','y','f' ), &glyf ) ) return kGlyphBadFont;
+
+	font->unitsPerEm = ReadShort( bytes + head.offset + 18 );
+	indexFormat = (SInt16) ReadShort( bytes + head.offset + 50 );
+	font->glyphCount = ReadShort( bytes + maxp.offset + 4 );
+	if( font->unitsPerEm == 0 ) return kGlyphBadFont;
+	font->longOffsets = (indexFormat != 0);
+	font->loca = bytes + loca.offset;
+	font->locaLength = loca.length;
+	font->glyf = bytes + glyf.offset;
+	font->glyfLength = glyf.length;
+
+	// glyphs loca can't find can't be drawn
+	if( font->glyphCount > loca.length / (font->longOffsets? 4:2) - (loca.length? 1:0) )
+		font->glyphCount = loca.length / (font->longOffsets? 4:2) - (loca.length? 1:0);
+
+	// the cmap is optional, only used to label glyphs
+	if( SfntFindTable( bytes, length, GLYPH_TAG( 'c','m','a','p' ), &cmap ) && cmap.length >= 4 )
+	{
+		UInt16 tables = ReadShort( bytes + cmap.offset + 2 ), i;
+		int bestScore = 0;
+		for( i = 0; i < tables && 4 + (i + 1) * 8UL <= cmap.length; i++ )
+		{
+			const UInt8 *record = bytes + cmap.offset + 4 + i * 8;
+			UInt16 platform = ReadShort( record ), encoding = ReadShort( record + 2 ), format;
+			UInt32 offset = ReadLong( record + 4 );
+			int score = 0;
+			if( offset > cmap.length - 2 ) continue;
+			format = ReadShort( bytes + cmap.offset + offset );
+			if( format != 0 && format != 4 && format != 6 && format != 12 ) continue;
+			if( (platform == 3 && encoding == 10) || (platform == 0 && encoding >= 4) ) score = 3;
+			else if( platform == 3 && encoding == 1 ) score = 2;
+			else if( platform == 0 ) score = 2;
+			else if( platform == 1 && encoding == 0 ) score = 1;
+			if( score > bestScore )
+			{
+				bestScore = score;
+				font->cmap = bytes + cmap.offset + offset;
+				font->cmapLength = cmap.length - offset;
+				font->unicode = (platform != 1);
+			}
+		}
+	}
+	return kGlyphNoError;
+}
+
+/* NFNT and FONT: a FontRec header, the strike, the location table and the offset/width table. */
+int GlyphFontOpenBitmap(const UInt8 *bytes, UInt32 length, GlyphFont *font)
+{
+	UInt16 fontType, firstChar, lastChar, rowWords;
+	UInt32 entries, imageLength, tableOffset;
+	SInt16 descentHigh;
+	memset( font, 0, sizeof(GlyphFont) );
+	font->kind = kGlyphFontBitmap;
+	if( length < 26 ) return kGlyphBadFont;
+	fontType = ReadShort( bytes );
+	if( fontType & 0x000C ) return kGlyphBadFont;		// colour fonts
+	firstChar = ReadShort( bytes + 2 );
+	lastChar = ReadShort( bytes + 4 );
+	if( lastChar < firstChar || lastChar > 255 ) return kGlyphBadFont;
+	font->firstChar = firstChar;
+	font->kernMax = (SInt16) ReadShort( bytes + 8 );
+	descentHigh = (SInt16) ReadShort( bytes + 10 );
+	font->rectHeight = (SInt16) ReadShort( bytes + 14 );
+	font->ascent = (SInt16) ReadShort( bytes + 18 );
+	rowWords = ReadShort( bytes + 24 );
+	if( font->rectHeight < 0 ) return kGlyphBadFont;
+	font->rowBytes = (SInt16) (rowWords * 2);
+
+	// one more glyph than characters, for the missing glyph, and one more location than that
+	entries = lastChar - firstChar + 3UL;
+	imageLength = (UInt32) font->rowBytes * font->rectHeight;
+	if( 26 + imageLength + entries * 2 > length ) return kGlyphBadFont;
+	font->image = bytes + 26;
+	font->locations = font->image + imageLength;
+
+	// the offset/width table's offset is in words from its own field, with its high word in nDescent if that's positive
+	tableOffset = ReadShort( bytes + 16 );
+	if( descentHigh > 0 ) tableOffset |= (UInt32) descentHigh << 16;
+	tableOffset = 16 + tableOffset * 2;
+	if( tableOffset > length || entries * 2 > length - tableOffset ) return kGlyphBadFont;
+	font->offsetWidths = bytes + tableOffset;
+	font->glyphCount = entries - 1;
+	return kGlyphNoError;
+}
+
+void GlyphFontCharacters(const GlyphFont *font, UInt32 *characters)
+{
+	const UInt8 *cmap = font->cmap, *end = font->cmap + font->cmapLength;
+	UInt32 i;
+	for( i = 0; i < font->glyphCount; i++ )
+		characters[i] = kGlyphNoCharacter;
+
+	if( font->kind == kGlyphFontBitmap )
+	{
+		// the last is the missing glyph
+		for( i = 0; i + 1 < font->glyphCount; i++ )
+			if( ReadShort( font->offsetWidths + i * 2 ) != 0xFFFF )
+				characters[i] = font->firstChar + i;
+		return;
+	}
+	if( !cmap ) return;
+
+#define MAP(character, glyph)	do { UInt32 g = (glyph); if( g != 0 && g < font->glyphCount && characters[g] == kGlyphNoCharacter ) characters[g] = (character); } while( 0 )
+	switch( ReadShort( cmap ) )
+	{
+		case 0:		// a byte for each of 256 characters
+			if( end - cmap < 6 + 256 ) return;
+			for( i = 0; i < 256; i++ )
+				MAP( i, cmap[6 + i] );
+			break;
+
+		case 4:		// segments of characters, each mapped by a delta or through an array
+		{
+			UInt32 segments, segment;
+			const UInt8 *ends, *starts, *deltas, *rangeOffsets;
+			if( end - cmap < 14 ) return;
+			segments = ReadShort( cmap + 6 ) / 2;
+			if( (UInt32) (end - cmap) < 16 + segments * 8 ) return;
+			ends = cmap + 14;
+			starts = ends + segments * 2 + 2;
+			deltas = starts + segments * 2;
+			rangeOffsets = deltas + segments * 2;
+			for( segment = 0; segment < segments; segment++ )
+			{
+				UInt32 first = ReadShort( starts + segment * 2 ), last = ReadShort( ends + segment * 2 ), c;
+				UInt16 delta = ReadShort( deltas + segment * 2 ), rangeOffset = ReadShort( rangeOffsets + segment * 2 );
+				for( c = first; c <= last && c != 0xFFFF; c++ )
+				{
+					if( rangeOffset == 0 ) MAP( c, (c + delta) & 0xFFFF );
+					else
+					{
+						const UInt8 *glyph = rangeOffsets + segment * 2 + rangeOffset + (c - first) * 2;
+						if( glyph < cmap || end - glyph < 2 ) break;
+						if( ReadShort( glyph ) ) MAP( c, (ReadShort( glyph ) + delta) & 0xFFFF );
+					}
+				}
+			}
+			break;
+		}
+
+		case 6:		// a run of characters
+		{
+			UInt32 first, count;
+			if( end - cmap < 10 ) return;
+			first = ReadShort( cmap + 6 );
+			count = ReadShort( cmap + 8 );
+			if( (UInt32) (end - cmap) < 10 + count * 2 ) return;
+			for( i = 0; i < count; i++ )
+				MAP( first + i, ReadShort( cmap + 10 + i * 2 ) );
+			break;
+		}
+
+		case 12:	// groups of characters mapped to runs of glyphs
+		{
+			UInt32 groups;
+			if( end - cmap < 16 ) return;
+			groups = ReadLong( cmap + 12 );
+			if( (UInt32) (end - cmap - 16) / 12 < groups ) return;
+			for( i = 0; i < groups; i++ )
+			{
+				const UInt8 *group = cmap + 16 + i * 12;
+				UInt32 first = ReadLong( group ), last = ReadLong( group + 4 ), glyph = ReadLong( group + 8 ), c;
+				for( c = first; c <= last && glyph < font->glyphCount; c++, glyph++ )
+				{
+					MAP( c, glyph );
+					if( c == 0xFFFFFFFF ) break;
+				}
+			}
+			break;
+		}
+	}
+#undef MAP
+}
+
+int GlyphFontDraw(const GlyphFont *font, UInt32 glyph, float pixelsPerEm, GlyphBitmap *bitmap)
+{
+	memset( bitmap, 0, sizeof(GlyphBitmap) );
+	if( font->kind == kGlyphFontBitmap ) return DrawBitmap( font, glyph, bitmap );
+	if( pixelsPerEm <= 0 ) return kGlyphBadGlyph;
+	return DrawTrueType( font, glyph, pixelsPerEm, bitmap );
+}
+
+void GlyphBitmapFree(GlyphBitmap *bitmap)
+{
+	free( bitmap->pixels );
+	bitmap->pixels = NULL;
+}
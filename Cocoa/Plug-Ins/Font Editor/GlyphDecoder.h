@@ -0,0 +1,99 @@
+/* Glyph decoder */
+
+/*	Draws the glyphs of TrueType sfnts and of bitmap fonts (NFNT and FONT) into 8-bit coverage maps, straight out of
+	the font's data, so the font editor can show them without the font being installed or activated.
+
+	TrueType glyphs are read from glyf through loca, simple and composite, with their quadratic curves flattened into
+	lines, and filled with exact area coverage: each line adds the area it covers to a buffer of signed areas which is
+	summed along the rows afterwards. They are drawn unhinted. Characters are found for glyphs through cmap formats
+	0, 4, 6 and 12, preferring a Unicode subtable.
+
+	Bitmap fonts' glyphs are copied from their strike through the location and offset/width tables. Only black and
+	white fonts are drawn.
+
+	A GlyphFont only points into the data it's opened on and is never changed by drawing, so any number of threads
+	may draw from one at once. */
+
+#ifndef GLYPH_DECODER_H
+#define GLYPH_DECODER_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	kGlyphNoError = 0,
+	kGlyphBadFont,			// tables missing or too short for what they claim to hold
+	kGlyphBadGlyph,			// the glyph's data is damaged; it's left empty
+	kGlyphMemoryFull,
+
+	kGlyphFontTrueType = 0,
+	kGlyphFontBitmap
+};
+
+#define kGlyphNoCharacter	0xFFFFFFFFUL
+
+typedef struct GlyphFont
+{
+	int				kind;
+	UInt32			glyphCount;
+	Boolean			unicode;		// characters are Unicode, rather than Mac OS Roman
+
+	// TrueType
+	const UInt8		*glyf, *loca, *cmap;
+	UInt32			glyfLength, locaLength, cmapLength;
+	UInt16			unitsPerEm;
+	Boolean			longOffsets;
+
+	// bitmap fonts
+	const UInt8		*image, *locations, *offsetWidths;
+	UInt16			firstChar;
+	SInt16			kernMax, ascent, rectHeight, rowBytes;
+} GlyphFont;
+
+typedef struct GlyphBitmap
+{
+	UInt8	*pixels;		// width * height, top row first, 0 where nothing is drawn to 255 where it's covered
+	int		width;
+	int		height;
+	int		left;			// pixels from the origin to the bitmap's left edge
+	int		top;			// pixels from the baseline up to its top edge
+} GlyphBitmap;
+
+/*!
+@function	GlyphFontOpenSfnt
+@abstract	Finds the tables to draw a TrueType sfnt's glyphs from.
+*/
+int GlyphFontOpenSfnt(const UInt8 *bytes, UInt32 length, GlyphFont *font);
+
+/*!
+@function	GlyphFontOpenBitmap
+@abstract	Reads an NFNT or FONT's header and finds its strike and tables.
+*/
+int GlyphFontOpenBitmap(const UInt8 *bytes, UInt32 length, GlyphFont *font);
+
+/*!
+@function	GlyphFontCharacters
+@abstract	Fills characters (glyphCount long) with the first character mapped to each glyph, or kGlyphNoCharacter.
+*/
+void GlyphFontCharacters(const GlyphFont *font, UInt32 *characters);
+
+/*!
+@function	GlyphFontDraw
+@abstract	Draws the glyph at pixelsPerEm (bitmap fonts are drawn at their own size), allocating its pixels, which GlyphBitmapFree frees. Empty glyphs have no pixels.
+*/
+int GlyphFontDraw(const GlyphFont *font, UInt32 glyph, float pixelsPerEm, GlyphBitmap *bitmap);
+
+/*!
+@function	GlyphBitmapFree
+*/
+void GlyphBitmapFree(GlyphBitmap *bitmap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+#import <Cocoa/Cocoa.h>
+#import "GlyphDecoder.h"
+
+/*!
+@class			GlyphGridView
+@abstract		A grid of every glyph in a font, labelled with the character each is mapped to, for use as a scroll view's document view.
+@description	Only the rows in view are drawn. Glyphs not yet drawn are queued, newest first, for a worker thread per processor to rasterize, and are shown once they're ready; glyphs scrolled out of view are taken off the queue before they're started. Drawn glyphs are kept for the current size only, up to a few thousand, those out of view being let go first.
+*/
+
+@interface GlyphGridView : NSView
+{
+	NSData				*fontData;		// the font points into this
+	GlyphFont			font;
+	UInt32				*characters;	// for each glyph, or kGlyphNoCharacter
+	float				pixelsPerEm;
+	unsigned			generation;		// counts changes of font and size, so glyphs drawn for an old one are ignored
+	NSMutableDictionary	*glyphs;		// NSNumber of glyph -> [NSBitmapImageRep or NSNull if empty, NSNumber of top]
+	NSMutableArray		*queue;			// NSNumbers of glyphs waiting to be drawn
+	NSMutableSet		*pending;		// glyphs queued or being drawn
+	NSLock				*queueLock;		// held while using the queue, the font, the size or generation off the main thread
+	unsigned			workers;		// threads drawing; each leaves when the queue's empty
+}
+
+/*!
+@method		gridInView:sizeControl:
+@abstract	Fills the view with a scrolling grid, with a slider above it to set the size of TrueType glyphs if asked for.
+*/
++ (GlyphGridView *)gridInView:(NSView *)container sizeControl:(BOOL)sizeControl;
+
+/*!
+@method		setFontData:type:
+@abstract	Shows the glyphs of the sfnt, NFNT or FONT data given, or of none if it's nil or can't be read. Returns whether it could be.
+*/
+- (BOOL)setFontData:(NSData *)data type:(NSString *)type;
+
+/*!
+@method		setPixelsPerEm:
+@abstract	Sets the size TrueType glyphs are drawn at. Bitmap fonts are always drawn at their own.
+*/
+- (void)setPixelsPerEm:(float)size;
+- (float)pixelsPerEm;
+- (IBAction)takePixelsPerEmFrom:(id)sender;
+
+@end
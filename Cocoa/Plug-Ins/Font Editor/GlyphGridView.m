@@ -0,0 +1,362 @@
+#import "GlyphGridView.h"
+#import <CoreServices/CoreServices.h>	// for MPProcessorsScheduled()
+
+enum
+{
+	kMaxCachedGlyphs = 4096,
+	kLabelHeight = 14,
+	kMinCellWidth = 36,
+	kSliderHeight = 24,
+
+	// glyphs entries
+	kGlyphImage = 0,
+	kGlyphTop
+};
+
+@interface GlyphGridView (Private)
+- (void)tile;
+- (float)cellWidth;
+- (unsigned)columns;
+- (NSRange)visibleGlyphs;
+- (void)superviewFrameDidChange:(NSNotification *)notification;
+- (void)queueGlyph:(NSNumber *)glyph;
+- (void)pruneQueueOutside:(NSRange)visible;
+- (void)drawThread:(id)unused;
+- (void)finishGlyph:(NSArray *)glyphAndEntry;
+@end
+
+@implementation GlyphGridView
+
++ (GlyphGridView *)gridInView:(NSView *)container sizeControl:(BOOL)sizeControl
+{
+	NSRect bounds = [container bounds];
+	NSScrollView *scrollView;
+	NSSlider *slider = nil;
+	GlyphGridView *grid;
+	if(sizeControl)
+	{
+		slider = [[[NSSlider alloc] initWithFrame:NSMakeRect(8, NSMaxY(bounds) - kSliderHeight, NSWidth(bounds) - 16, kSliderHeight)] autorelease];
+		[slider setAutoresizingMask:NSViewWidthSizable | NSViewMinYMargin];
+		[slider setMinValue:8];
+		[slider setMaxValue:128];
+		[slider setFloatValue:32];
+		[slider setContinuous:NO];
+		[container addSubview:slider];
+		bounds.size.height -= kSliderHeight;
+	}
+	scrollView = [[[NSScrollView alloc] initWithFrame:bounds] autorelease];
+	[scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+	[scrollView setHasVerticalScroller:YES];
+	[scrollView setBorderType:NSBezelBorder];
+	grid = [[[GlyphGridView alloc] initWithFrame:NSMakeRect(0, 0, [scrollView contentSize].width, 0)] autorelease];
+	[scrollView setDocumentView:grid];
+	[container addSubview:scrollView];
+	[slider setTarget:grid];
+	[slider setAction:@selector(takePixelsPerEmFrom:)];
+	return grid;
+}
+
+- (id)initWithFrame:(NSRect)frame
+{
+	self = [super initWithFrame:frame];
+	if(!self) return nil;
+	pixelsPerEm = 32;
+	glyphs = [[NSMutableDictionary alloc] init];
+	queue = [[NSMutableArray alloc] init];
+	pending = [[NSMutableSet alloc] init];
+	queueLock = [[NSLock alloc] init];
+	memset(&font, 0, sizeof(font));
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[fontData release];
+	free(characters);
+	[glyphs release];
+	[queue release];
+	[pending release];
+	[queueLock release];
+	[super dealloc];
+}
+
+- (BOOL)isFlipped
+{
+	return YES;
+}
+
+- (BOOL)isOpaque
+{
+	return YES;
+}
+
+- (void)viewDidMoveToSuperview
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self name:NSViewFrameDidChangeNotification object:nil];
+	if([self superview])
+	{
+		[[self superview] setPostsFrameChangedNotifications:YES];
+		[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(superviewFrameDidChange:) name:NSViewFrameDidChangeNotification object:[self superview]];
+		[self tile];
+	}
+}
+
+- (BOOL)setFontData:(NSData *)data type:(NSString *)type
+{
+	GlyphFont newFont;
+	int error = kGlyphBadFont;
+	if(data && [type isEqualToString:@"sfnt"])
+		error = GlyphFontOpenSfnt((const UInt8 *)[data bytes], [data length], &newFont);
+	else if(data && ([type isEqualToString:@"NFNT"] || [type isEqualToString:@"FONT"]))
+		error = GlyphFontOpenBitmap((const UInt8 *)[data bytes], [data length], &newFont);
+	if(error) memset(&newFont, 0, sizeof(newFont));
+
+	// workers copy the font and retain its data under the lock, so both can be swapped under it
+	[queueLock lock];
+	[queue removeAllObjects];
+	[data retain];
+	[fontData release];
+	fontData = data;
+	font = newFont;
+	generation++;
+	[queueLock unlock];
+
+	free(characters);
+	characters = (UInt32 *) malloc((font.glyphCount + 1) * sizeof(UInt32));
+	if(characters) GlyphFontCharacters(&font, characters);
+	[pending removeAllObjects];
+	[glyphs removeAllObjects];
+	[self tile];
+	[self setNeedsDisplay:YES];
+	return (error == kGlyphNoError);
+}
+
+- (void)setPixelsPerEm:(float)size
+{
+	if(size == pixelsPerEm || size < 1) return;
+
+	[queueLock lock];
+	pixelsPerEm = size;
+	if(font.kind == kGlyphFontTrueType)
+	{
+		[queue removeAllObjects];
+		generation++;
+	}
+	[queueLock unlock];
+
+	// bitmap fonts have the one size, which is already drawn
+	if(font.kind == kGlyphFontBitmap) return;
+	[pending removeAllObjects];
+	[glyphs removeAllObjects];
+	[self tile];
+	[self setNeedsDisplay:YES];
+}
+
+- (float)pixelsPerEm
+{
+	return pixelsPerEm;
+}
+
+- (IBAction)takePixelsPerEmFrom:(id)sender
+{
+	[self setPixelsPerEm:floorf([sender floatValue])];
+}
+
+- (void)drawRect:(NSRect)rect
+{
+	NSDictionary *labelAttributes = [NSDictionary dictionaryWithObjectsAndKeys:[NSFont labelFontOfSize:9], NSFontAttributeName, [NSColor grayColor], NSForegroundColorAttributeName, nil];
+	float cellWidth = [self cellWidth], cellHeight = cellWidth + kLabelHeight;
+	float em = (font.kind == kGlyphFontBitmap)? font.rectHeight : pixelsPerEm;
+	float ascent = (font.kind == kGlyphFontBitmap)? font.ascent : pixelsPerEm * 0.8f;
+	unsigned columns = [self columns], glyph, row, lastRow;
+	NSRange visible = [self visibleGlyphs];
+
+	[[NSColor whiteColor] set];
+	NSRectFill(rect);
+	if(font.glyphCount == 0) return;
+	[self pruneQueueOutside:visible];
+
+	// only the rows within the rect
+	lastRow = (unsigned) ceilf(NSMaxY(rect) / cellHeight);
+	for(row = (unsigned) floorf(NSMinY(rect) / cellHeight); row < lastRow; row++)
+	{
+		for(glyph = row * columns; glyph < (row +1) * columns && glyph < font.glyphCount; glyph++)
+		{
+			NSNumber *key = [NSNumber numberWithUnsignedInt:glyph];
+			NSRect cell = NSMakeRect((glyph % columns) * cellWidth, row * cellHeight, cellWidth, cellHeight);
+			NSArray *entry = [glyphs objectForKey:key];
+			NSString *label;
+			UInt32 character = characters? characters[glyph] : kGlyphNoCharacter;
+
+			[[NSColor lightGrayColor] set];
+			NSFrameRect(cell);
+			if(character == kGlyphNoCharacter)	label = [NSString stringWithFormat:@"#%u", glyph];
+			else if(font.unicode)				label = [NSString stringWithFormat:@"U+%04lX", (unsigned long) character];
+			else								label = [NSString stringWithFormat:@"$%02lX", (unsigned long) character];
+			[label drawAtPoint:NSMakePoint(NSMinX(cell) + 3, NSMaxY(cell) - kLabelHeight) withAttributes:labelAttributes];
+
+			if(!entry)
+			{
+				[self queueGlyph:key];
+				continue;
+			}
+			if([entry objectAtIndex:kGlyphImage] != [NSNull null])
+			{
+				// centred across the cell, on a baseline the same for every glyph
+				NSBitmapImageRep *image = [entry objectAtIndex:kGlyphImage];
+				float baseline = NSMinY(cell) + (cellWidth - em) / 2 + ascent;
+				NSRect imageRect = NSMakeRect(floorf(NSMidX(cell) - [image pixelsWide] / 2.0f), baseline - [[entry objectAtIndex:kGlyphTop] intValue], [image pixelsWide], [image pixelsHigh]);
+				[image drawInRect:imageRect];
+			}
+		}
+	}
+}
+
+#pragma mark -
+
+- (float)cellWidth
+{
+	float em = (font.kind == kGlyphFontBitmap)? font.rectHeight : pixelsPerEm;
+	return MAX(ceilf(em * 1.25f), kMinCellWidth);
+}
+
+- (unsigned)columns
+{
+	unsigned columns = (unsigned) floorf(NSWidth([self bounds]) / [self cellWidth]);
+	return columns? columns : 1;
+}
+
+- (void)tile
+{
+	NSView *clipView = [self superview];
+	unsigned rows = (font.glyphCount + [self columns] -1) / [self columns];
+	NSSize size = NSMakeSize(clipView? NSWidth([clipView frame]) : NSWidth([self frame]), rows * ([self cellWidth] + kLabelHeight));
+	if(clipView && size.height < NSHeight([clipView frame]))
+		size.height = NSHeight([clipView frame]);
+	if(!NSEqualSizes(size, [self frame].size))
+		[self setFrameSize:size];
+}
+
+- (NSRange)visibleGlyphs
+{
+	NSRect visible = [self visibleRect];
+	float cellHeight = [self cellWidth] + kLabelHeight;
+	unsigned columns = [self columns];
+	unsigned first = (unsigned) floorf(NSMinY(visible) / cellHeight) * columns;
+	unsigned last = (unsigned) ceilf(NSMaxY(visible) / cellHeight) * columns;
+	if(last > font.glyphCount) last = font.glyphCount;
+	if(first > last) first = last;
+	return NSMakeRange(first, last - first);
+}
+
+- (void)superviewFrameDidChange:(NSNotification *)notification
+{
+	[self tile];
+}
+
+- (void)queueGlyph:(NSNumber *)glyph
+{
+	if([pending containsObject:glyph]) return;
+	[pending addObject:glyph];
+
+	// one more worker for each glyph queued, up to one per processor
+	[queueLock lock];
+	[queue addObject:glyph];
+	if(workers < MPProcessorsScheduled())
+	{
+		workers++;
+		[NSThread detachNewThreadSelector:@selector(drawThread:) toTarget:self withObject:nil];
+	}
+	[queueLock unlock];
+}
+
+- (void)pruneQueueOutside:(NSRange)visible
+{
+	int i;
+	[queueLock lock];
+	for(i = [queue count] -1; i >= 0; i--)
+	{
+		NSNumber *glyph = [queue objectAtIndex:i];
+		if(!NSLocationInRange([glyph unsignedIntValue], visible))
+		{
+			[pending removeObject:glyph];
+			[queue removeObjectAtIndex:i];
+		}
+	}
+	[queueLock unlock];
+}
+
+- (void)drawThread:(id)unused
+{
+	while(YES)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		NSNumber *glyph;
+		NSData *data;
+		GlyphFont drawFont;
+		GlyphBitmap bitmap;
+		float size;
+		unsigned drawGeneration;
+		id image = [NSNull null];
+
+		[queueLock lock];
+		if(![queue count])
+		{
+			workers--;
+			[queueLock unlock];
+			[pool release];
+			break;
+		}
+		glyph = [[[queue lastObject] retain] autorelease];
+		[queue removeLastObject];
+		data = [[fontData retain] autorelease];
+		drawFont = font;
+		size = pixelsPerEm;
+		drawGeneration = generation;
+		[queueLock unlock];
+
+		if(GlyphFontDraw(&drawFont, [glyph unsignedIntValue], size, &bitmap) == kGlyphNoError && bitmap.pixels)
+		{
+			// coverage is ink, drawn black on white
+			NSBitmapImageRep *rep = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:bitmap.width pixelsHigh:bitmap.height bitsPerSample:8 samplesPerPixel:1 hasAlpha:NO isPlanar:NO colorSpaceName:NSCalibratedWhiteColorSpace bytesPerRow:bitmap.width bitsPerPixel:8] autorelease];
+			unsigned char *pixels = [rep bitmapData];
+			int i;
+			for(i = 0; i < bitmap.width * bitmap.height; i++)
+				pixels[i] = 255 - bitmap.pixels[i];
+			image = rep;
+		}
+		GlyphBitmapFree(&bitmap);
+
+		[self performSelectorOnMainThread:@selector(finishGlyph:) withObject:[NSArray arrayWithObjects:glyph, [NSNumber numberWithUnsignedInt:drawGeneration], [NSArray arrayWithObjects:image, [NSNumber numberWithInt:bitmap.top], nil], nil] waitUntilDone:NO];
+		[pool release];
+	}
+}
+
+- (void)finishGlyph:(NSArray *)glyphAndEntry
+{
+	NSNumber *glyph = [glyphAndEntry objectAtIndex:0];
+	NSRange visible;
+	float cellWidth = [self cellWidth];
+	unsigned columns = [self columns], index = [glyph unsignedIntValue];
+
+	// drawn for a font or size since replaced
+	if([[glyphAndEntry objectAtIndex:1] unsignedIntValue] != generation) return;
+	[pending removeObject:glyph];
+	[glyphs setObject:[glyphAndEntry objectAtIndex:2] forKey:glyph];
+
+	// over the limit, let go of glyphs out of view
+	visible = [self visibleGlyphs];
+	if([glyphs count] > kMaxCachedGlyphs)
+	{
+		NSEnumerator *enumerator = [[glyphs allKeys] objectEnumerator];
+		NSNumber *key;
+		while(key = [enumerator nextObject])
+			if(!NSLocationInRange([key unsignedIntValue], visible))
+				[glyphs removeObjectForKey:key];
+	}
+	if(NSLocationInRange(index, visible))
+		[self setNeedsDisplayInRect:NSMakeRect((index % columns) * cellWidth, (index / columns) * (cellWidth + kLabelHeight), cellWidth, cellWidth + kLabelHeight)];
+}
+
+@end
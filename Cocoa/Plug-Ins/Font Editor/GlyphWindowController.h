@@ -0,0 +1,19 @@
+#import <Cocoa/Cocoa.h>
+#import <Carbon/Carbon.h>
+
+#import "ResKnifePluginProtocol.h"
+#import "ResKnifeResourceProtocol.h"
+
+@class GlyphGridView;
+
+/*!
+@class			GlyphWindowController
+@abstract		Shows the glyphs of an NFNT or FONT resource. Bitmap fonts have no tables to list, so this is all the font editor opens for them.
+*/
+
+@interface GlyphWindowController : NSWindowController <ResKnifePluginProtocol>
+{
+	id <ResKnifeResourceProtocol>	resource;
+	GlyphGridView					*grid;
+}
+@end
@@ -0,0 +1,61 @@
+#import "GlyphWindowController.h"
+#import "GlyphGridView.h"
+
+@implementation GlyphWindowController
+
+- (id)initWithResource:(id <ResKnifeResourceProtocol>)inResource
+{
+	NSWindow *window = [[[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 480, 360) styleMask:NSTitledWindowMask | NSClosableWindowMask | NSMiniaturizableWindowMask | NSResizableWindowMask backing:NSBackingStoreBuffered defer:YES] autorelease];
+	self = [self initWithWindow:window];
+	if(!self) return nil;
+
+	resource = [(id)inResource retain];
+	[window setReleasedWhenClosed:NO];
+	[window setDelegate:self];
+	[window center];
+	grid = [GlyphGridView gridInView:[window contentView] sizeControl:NO];
+	if(![grid setFontData:[resource data] type:[resource type]])
+		NSLog(@"Couldn't read the glyphs of %@ %@.", [resource type], [resource resID]);
+	[self windowDidLoad];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[(id)resource release];
+	[super dealloc];
+}
+
+- (void)windowDidLoad
+{
+	[super windowDidLoad];
+
+	// set the window's title
+	if([[resource name] isEqualToString:@""])
+		[[self window] setTitle:[NSString stringWithFormat:@"%@ %@", [resource type], [resource resID]]];
+	else
+	{
+		[[self window] setTitle:[resource name]];
+		SetWindowAlternateTitle((WindowRef) [[self window] windowRef], (CFStringRef) [NSString stringWithFormat:NSLocalizedString(@"%@ %@: '%@'", nil), [resource type], [resource resID], [resource name]]);
+	}
+
+	// we don't want this notification until we have a window! (Only register for notifications on the resource we're editing)
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:resource];
+
+	// finally, show the window
+	[self showWindow:self];
+}
+
+- (void)windowWillClose:(NSNotification *)notification
+{
+	// nothing more for the workers to draw
+	[grid setFontData:nil type:nil];
+}
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	[grid setFontData:[resource data] type:[resource type]];
+}
+
+@end
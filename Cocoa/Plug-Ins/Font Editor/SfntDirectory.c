@@ -0,0 +1,77 @@
+#include "SfntDirectory.h"
+
+enum
+{
+	kSfntHeaderSize = 12,
+	kSfntEntrySize = 16
+};
+
+static UInt16 ReadShort(const UInt8 *bytes)
+{
+	return (UInt16) ((bytes[0] << 8) | bytes[1]);
+}
+
+static UInt32 ReadLong(const UInt8 *bytes)
+{
+	return ((UInt32) bytes[0] << 24) | ((UInt32) bytes[1] << 16) | ((UInt32) bytes[2] << 8) | bytes[3];
+}
+
+int SfntReadDirectory(const UInt8 *bytes, UInt32 length, SfntDirectory *directory)
+{
+	if( !bytes || length < kSfntHeaderSize ) return kSfntTruncated;
+	directory->version = ReadLong( bytes );
+	directory->numTables = ReadShort( bytes + 4 );
+	directory->searchRange = ReadShort( bytes + 6 );
+	directory->entrySelector = ReadShort( bytes + 8 );
+	directory->rangeShift = ReadShort( bytes + 10 );
+	if( (UInt32) directory->numTables * kSfntEntrySize > length - kSfntHeaderSize ) return kSfntTruncated;
+	return kSfntNoError;
+}
+
+int SfntReadTable(const UInt8 *bytes, UInt32 length, UInt16 index, SfntTable *table)
+{
+	const UInt8 *entry = bytes + kSfntHeaderSize + (UInt32) index * kSfntEntrySize;
+	table->tag = ReadLong( entry );
+	table->checksum = ReadLong( entry + 4 );
+	table->offset = ReadLong( entry + 8 );
+	table->length = ReadLong( entry + 12 );
+	if( table->offset > length || table->length > length - table->offset ) return kSfntBadTable;
+	return kSfntNoError;
+}
+
+Boolean SfntFindTable(const UInt8 *bytes, UInt32 length, UInt32 tag, SfntTable *table)
+{
+	SfntDirectory directory;
+	UInt16 i;
+	if( SfntReadDirectory( bytes, length, &directory ) != kSfntNoError ) return false;
+	for( i = 0; i < directory.numTables; i++ )
+		if( ReadLong( bytes + kSfntHeaderSize + (UInt32) i * kSfntEntrySize ) == tag )
+			return SfntReadTable( bytes, length, i, table ) == kSfntNoError;
+	return false;
+}
+
+/* Four independent sums, so successive longs don't wait on each other's additions; they're folded together at the
+	end, which gives the same result as addition is modulo 2^32 either way. */
+UInt32 SfntChecksum(const UInt8 *bytes, UInt32 length)
+{
+	UInt32 sums[4] = { 0, 0, 0, 0 };
+	UInt8 last[4] = { 0, 0, 0, 0 };
+	UInt32 i;
+	for( i = 0; i + 16 <= length; i += 16 )
+	{
+		sums[0] += ReadLong( bytes + i );
+		sums[1] += ReadLong( bytes + i + 4 );
+		sums[2] += ReadLong( bytes + i + 8 );
+		sums[3] += ReadLong( bytes + i + 12 );
+	}
+	for( ; i + 4 <= length; i += 4 )
+		sums[0] += ReadLong( bytes + i );
+	if( i < length )
+	{
+		UInt32 j;
+		for( j = 0; i + j < length; j++ )
+			last[j] = bytes[i + j];
+		sums[0] += ReadLong( last );
+	}
+	return sums[0] + sums[1] + sums[2] + sums[3];
+}
@@ -0,0 +1,72 @@
+/* sfnt table directory */
+
+/*	Reads the table directory at the start of an sfnt (TrueType, OpenType or the like) straight out of its data, with
+	every field read big-endian whatever the host, and every table checked to lie within the data before it's
+	returned. Nothing is copied: tables are returned as offsets into the font, so opening one with thousands of glyphs
+	costs no more than opening one with ten. Also sums tables as the directory's checksums are, a big-endian long at a
+	time, four at once.
+
+	See http://developer.apple.com/fonts/TTRefMan/RM06/Chap6.html */
+
+#ifndef SFNT_DIRECTORY_H
+#define SFNT_DIRECTORY_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	kSfntNoError = 0,
+	kSfntTruncated,			// the data ends within the directory
+	kSfntBadTable			// a table lies outside the data; the tables before it are still good
+};
+
+typedef struct SfntDirectory
+{
+	UInt32	version;		// 'true', 'OTTO', 'typ1' or 0x00010000
+	UInt16	numTables;
+	UInt16	searchRange;
+	UInt16	entrySelector;
+	UInt16	rangeShift;
+} SfntDirectory;
+
+typedef struct SfntTable
+{
+	UInt32	tag;
+	UInt32	checksum;
+	UInt32	offset;			// from the start of the font
+	UInt32	length;			// unpadded
+} SfntTable;
+
+/*!
+@function	SfntReadDirectory
+@abstract	Reads the directory's header, checking all its table entries are there.
+*/
+int SfntReadDirectory(const UInt8 *bytes, UInt32 length, SfntDirectory *directory);
+
+/*!
+@function	SfntReadTable
+@abstract	Reads the entry for table index (which must be less than numTables), checking the table lies within the data.
+*/
+int SfntReadTable(const UInt8 *bytes, UInt32 length, UInt16 index, SfntTable *table);
+
+/*!
+@function	SfntFindTable
+@abstract	Finds the table with the tag given. Returns false if there's none, or it lies outside the data.
+*/
+Boolean SfntFindTable(const UInt8 *bytes, UInt32 length, UInt32 tag, SfntTable *table);
+
+/*!
+@function	SfntChecksum
+@abstract	Sums the bytes as big-endian longs, the last padded with zeros. They needn't be aligned.
+*/
+UInt32 SfntChecksum(const UInt8 *bytes, UInt32 length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+/*	Drawing benchmark for GlyphDecoder, buildable with any C compiler:
+
+		cc -std=c99 -O2 -Wall -Wno-unknown-pragmas -I.. -I../../../Tests GlyphDecoderBench.c ../GlyphDecoder.c ../SfntDirectory.c -lm -o GlyphDecoderBench && ./GlyphDecoderBench [font.ttf]
+
+	Cocoa/Tests supplies just the MacTypes the decoder needs in place of CoreFoundation, so this builds the same anywhere.
+	Draws every glyph of a TrueType font over and over for a couple of seconds at each of the sizes the font editor's
+	grid and glyph window use, reporting glyphs per second. Without a font it makes one: 512 glyphs of rings traced in
+	quadratic curves, every fourth a composite of the two before it, as accented letters are. */
+
+#include "GlyphDecoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+enum
+{
+	kGlyphs = 512,
+	kUnitsPerEm = 2048,
+	kRingPoints = 16,		// per contour, alternately on and off the curve
+	kSeconds = 2
+};
+
+static UInt8 *Put(UInt8 *p, UInt32 value, UInt32 size)
+{
+	while( size-- ) *p++ = (UInt8) (value >> (8 * size));
+	return p;
+}
+
+// two contours the opposite way round to each other, with every coordinate a word delta
+static UInt8 *PutRing(UInt8 *p, UInt32 glyph)
+{
+	float outer = 400 + glyph % 37 * 12, inner = outer * (0.5f + glyph % 5 * 0.05f);
+	SInt16 x[kRingPoints * 2], y[kRingPoints * 2], lastX = 0, lastY = 0;
+	UInt32 i;
+	for( i = 0; i < kRingPoints * 2; i++ )
+	{
+		float angle = (float) (i % kRingPoints) / kRingPoints * 6.2831853f * (i < kRingPoints? 1:-1);
+		float radius = (i < kRingPoints? outer : inner) * ((i & 1)? 1.08f : 1.0f);
+		x[i] = (SInt16) (1024 + radius * cosf( angle ));
+		y[i] = (SInt16) (700 + radius * sinf( angle ));
+	}
+	p = Put( p, 2, 2 );
+	p = Put( Put( p, (UInt16) (SInt16) (1024 - outer * 1.1f), 2 ), (UInt16) (SInt16) (700 - outer * 1.1f), 2 );
+	p = Put( Put( p, (UInt16) (SInt16) (1024 + outer * 1.1f), 2 ), (UInt16) (SInt16) (700 + outer * 1.1f), 2 );
+	p = Put( Put( p, kRingPoints - 1, 2 ), kRingPoints * 2 - 1, 2 );
+	p = Put( p, 0, 2 );
+	for( i = 0; i < kRingPoints * 2; i++ )
+		*p++ = (i & 1)? 0x00 : 0x01;
+	for( i = 0; i < kRingPoints * 2; i++ ) { p = Put( p, (UInt16) (SInt16) (x[i] - lastX), 2 ); lastX = x[i]; }
+	for( i = 0; i < kRingPoints * 2; i++ ) { p = Put( p, (UInt16) (SInt16) (y[i] - lastY), 2 ); lastY = y[i]; }
+	return p;
+}
+
+// the two glyphs before, the second scaled down and put above the first
+static UInt8 *PutComposite(UInt8 *p, UInt32 glyph)
+{
+	p = Put( p, 0xFFFF, 2 );
+	p = Put( Put( p, 0, 4 ), 0, 4 );
+	p = Put( Put( p, 0x0001 | 0x0002 | 0x0020, 2 ), glyph - 2, 2 );
+	p = Put( Put( p, 0, 2 ), 0, 2 );
+	p = Put( Put( p, 0x0001 | 0x0002 | 0x0008, 2 ), glyph - 1, 2 );
+	p = Put( Put( p, 0, 2 ), 1200, 2 );
+	return Put( p, 0x2000, 2 );
+}
+
+static UInt32 MakeFont(UInt8 *bytes)
+{
+	static const char tags[4][5] = { "glyf", "head", "loca", "maxp" };
+	UInt8 *glyf = bytes + 12 + 4 * 16, *p = glyf, *loca, *head, *maxp;
+	UInt32 offsets[4], lengths[4], glyph, i;
+
+	loca = malloc( (kGlyphs + 1) * 4 );
+	for( glyph = 0; glyph < kGlyphs; glyph++ )
+	{
+		Put( loca + glyph * 4, (UInt32) (p - glyf), 4 );
+		p = (glyph % 4 == 3)? PutComposite( p, glyph ) : PutRing( p, glyph );
+		while( (p - glyf) & 3 ) *p++ = 0;
+	}
+	Put( loca + kGlyphs * 4, (UInt32) (p - glyf), 4 );
+	offsets[0] = (UInt32) (glyf - bytes);
+	lengths[0] = (UInt32) (p - glyf);
+
+	head = p;
+	memset( head, 0, 56 );
+	Put( head, 0x00010000, 4 );
+	Put( head + 18, kUnitsPerEm, 2 );
+	Put( head + 50, 1, 2 );			// long loca offsets
+	offsets[1] = (UInt32) (head - bytes);
+	lengths[1] = 54;
+	p = head + 56;
+
+	memcpy( p, loca, (kGlyphs + 1) * 4 );
+	offsets[2] = (UInt32) (p - bytes);
+	lengths[2] = (kGlyphs + 1) * 4;
+	p += lengths[2];
+	free( loca );
+
+	maxp = p;
+	Put( Put( Put( maxp, 0x00005000, 4 ), kGlyphs, 2 ), 0, 2 );
+	offsets[3] = (UInt32) (maxp - bytes);
+	lengths[3] = 6;
+	p += 8;
+
+	memset( Put( Put( bytes, 0x00010000, 4 ), 4, 2 ), 0, 6 );
+	for( i = 0; i < 4; i++ )
+	{
+		UInt8 *entry = bytes + 12 + i * 16;
+		Put( entry, ((UInt32) tags[i][0] << 24) | ((UInt32) tags[i][1] << 16) | ((UInt32) tags[i][2] << 8) | (UInt32) tags[i][3], 4 );
+		Put( entry + 4, 0, 4 );
+		Put( entry + 8, offsets[i], 4 );
+		Put( entry + 12, lengths[i], 4 );
+	}
+	return (UInt32) (p - bytes);
+}
+
+static void Bench(const GlyphFont *font, float pixelsPerEm)
+{
+	unsigned long drawn = 0, pixels = 0;
+	clock_t start = clock(), elapsed;
+	UInt32 glyph;
+	do
+	{
+		for( glyph = 0; glyph < font->glyphCount; glyph++ )
+		{
+			GlyphBitmap bitmap;
+			memset( &bitmap, 0, sizeof(bitmap) );
+			if( GlyphFontDraw( font, glyph, pixelsPerEm, &bitmap ) == kGlyphNoError )
+			{
+				drawn++;
+				pixels += (unsigned long) bitmap.width * bitmap.height;
+			}
+			GlyphBitmapFree( &bitmap );
+		}
+		elapsed = clock() - start;
+	}
+	while( elapsed < kSeconds * CLOCKS_PER_SEC );
+	printf( "%5.0f ppem: %9.0f glyphs/s, %7.1f Mpixels/s\n", pixelsPerEm, drawn / ((double) elapsed / CLOCKS_PER_SEC),
+		pixels / ((double) elapsed / CLOCKS_PER_SEC) / 1e6 );
+}
+
+int main(int argc, char *argv[])
+{
+	static const float sizes[] = { 12, 24, 48, 128 };
+	UInt8 *bytes;
+	UInt32 length, i;
+	GlyphFont font;
+	int error;
+
+	if( argc > 1 )
+	{
+		FILE *file = fopen( argv[1], "rb" );
+		if( !file ) { perror( argv[1] ); return 1; }
+		fseek( file, 0, SEEK_END );
+		length = (UInt32) ftell( file );
+		rewind( file );
+		bytes = malloc( length );
+		if( fread( bytes, 1, length, file ) != length ) { perror( argv[1] ); return 1; }
+		fclose( file );
+	}
+	else
+	{
+		bytes = malloc( 12 + 4 * 16 + kGlyphs * 256 + 56 + (kGlyphs + 1) * 4 + 8 );
+		length = MakeFont( bytes );
+	}
+
+	if( (error = GlyphFontOpenSfnt( bytes, length, &font )) != kGlyphNoError )
+	{
+		printf( "the font didn't open (error %d)\n", error );
+		return 1;
+	}
+	printf( "%u glyphs\n", (unsigned) font.glyphCount );
+	for( i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++ )
+		Bench( &font, sizes[i] );
+	free( bytes );
+	return 0;
+}
@@ -0,0 +1,174 @@
+/*	Fuzz driver for SfntDirectory, buildable with any C compiler:
+
+		cc -std=c99 -g -O1 -Wno-multichar -fsanitize=address,undefined -I.. -I../../../Tests SfntDirectoryFuzz.c ../SfntDirectory.c -o SfntDirectoryFuzz && ./SfntDirectoryFuzz
+
+	Cocoa/Tests supplies just the MacTypes the reader needs in place of CoreFoundation, so this builds the same anywhere.
+	Given files, it reads each as a font; given none, it makes a small sfnt and reads a million damaged copies of it
+	(bytes changed, directory fields set to extremes, the end cut off), seeded from -seed n if given. Every input is
+	copied to a block of exactly its length, so the sanitizers catch any read past its end. It stops at the first
+	table returned outside the data, or checksum that differs from one summed a long at a time.
+
+	With clang, -DSFNT_LIBFUZZER -fsanitize=fuzzer builds LLVMFuzzerTestOneInput into a libFuzzer target instead. */
+
+#include "SfntDirectory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+	kSeedTables = 6,
+	kRuns = 1000000
+};
+
+static UInt32 ReferenceChecksum(const UInt8 *bytes, UInt32 length)
+{
+	UInt32 sum = 0, i;
+	for( i = 0; i < length; i++ )
+		sum += (UInt32) bytes[i] << (24 - 8 * (i & 3));
+	return sum;
+}
+
+static void Fail(const char *problem, UInt32 index)
+{
+	fprintf( stderr, "SfntDirectoryFuzz: %s (table %u)\n", problem, index );
+	abort();
+}
+
+int LLVMFuzzerTestOneInput(const UInt8 *data, size_t size)
+{
+	UInt32 length = (UInt32) size;
+	UInt8 *bytes;
+	SfntDirectory directory;
+	SfntTable table, found;
+	UInt16 i;
+	if( size > 0x10000000 ) return 0;
+	bytes = malloc( size? size : 1 );
+	memcpy( bytes, data, size );
+
+	if( SfntReadDirectory( bytes, length, &directory ) == kSfntNoError )
+	{
+		for( i = 0; i < directory.numTables; i++ )
+		{
+			if( SfntReadTable( bytes, length, i, &table ) != kSfntNoError ) continue;
+			if( table.offset > length || table.length > length - table.offset )
+				Fail( "table lies outside the data", i );
+			if( SfntChecksum( bytes + table.offset, table.length ) != ReferenceChecksum( bytes + table.offset, table.length ) )
+				Fail( "checksum differs from the reference", i );
+			// an earlier entry with the same tag is found first, so it may not be this one, but it must be good
+			if( SfntFindTable( bytes, length, table.tag, &found ) && (found.offset > length || found.length > length - found.offset) )
+				Fail( "found table lies outside the data", i );
+		}
+	}
+	SfntFindTable( bytes, length, 'glyf', &found );
+	free( bytes );
+	return 0;
+}
+
+#ifndef SFNT_LIBFUZZER
+
+static UInt8 *Put(UInt8 *p, UInt32 value, UInt32 size)
+{
+	while( size-- ) *p++ = (UInt8) (value >> (8 * size));
+	return p;
+}
+
+// a directory of kSeedTables tables of odd lengths, each padded to a long
+static UInt32 MakeFont(UInt8 *bytes)
+{
+	static const UInt32 tags[kSeedTables] = { 'cmap', 'glyf', 'head', 'hhea', 'loca', 'maxp' };
+	UInt32 offset = 12 + kSeedTables * 16, i, j;
+	UInt8 *p = Put( Put( bytes, 0x00010000, 4 ), kSeedTables, 2 );
+	p = Put( Put( Put( p, 64, 2 ), 2, 2 ), kSeedTables * 16 - 64, 2 );
+	for( i = 0; i < kSeedTables; i++ )
+	{
+		UInt32 length = 13 + i * 7;
+		for( j = 0; j < length; j++ ) bytes[offset + j] = (UInt8) (i * 31 + j);
+		for( ; j & 3; j++ ) bytes[offset + j] = 0;
+		p = Put( p, tags[i], 4 );
+		p = Put( p, ReferenceChecksum( bytes + offset, length ), 4 );
+		p = Put( p, offset, 4 );
+		p = Put( p, length, 4 );
+		offset += j;
+	}
+	return offset;
+}
+
+static void Mutate(UInt8 *bytes, UInt32 *length)
+{
+	static const UInt32 extremes[] = { 0, 1, 3, 0x7FFFFFFF, 0x80000000, 0xFFFFFFF0, 0xFFFFFFFC, 0xFFFFFFFF };
+	int changes = 1 + rand() % 4;
+	while( changes-- ) switch( rand() % 4 )
+	{
+		case 0:		// any byte
+			bytes[rand() % *length] = (UInt8) rand();
+			break;
+
+		case 1:		// the table count
+			Put( bytes + 4, (rand() & 1)? 0xFFFF : (UInt32) (rand() % (kSeedTables * 2)), 2 );
+			break;
+
+		case 2:		// an entry's offset or length
+		{
+			UInt32 at = 12 + (rand() % kSeedTables) * 16 + ((rand() & 1)? 8:12);
+			Put( bytes + at, extremes[rand() % (sizeof(extremes) / sizeof(extremes[0]))] + (rand() % 3), 4 );
+			break;
+		}
+
+		case 3:		// the end, sometimes into the directory
+			*length = rand() % (*length + 1);
+			if( !*length ) return;
+			break;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	UInt8 seed[1024], bytes[1024];
+	UInt32 seedLength, length;
+	long run;
+	int arg;
+
+	if( argc > 2 && strcmp( argv[1], "-seed" ) == 0 )
+	{
+		srand( (unsigned) atoi( argv[2] ) );
+		argc -= 2;
+		argv += 2;
+	}
+	else srand( 1 );
+
+	if( argc > 1 )
+	{
+		for( arg = 1; arg < argc; arg++ )
+		{
+			FILE *file = fopen( argv[arg], "rb" );
+			UInt8 *data;
+			long size;
+			if( !file ) { perror( argv[arg] ); return 1; }
+			fseek( file, 0, SEEK_END );
+			size = ftell( file );
+			rewind( file );
+			data = malloc( size? size : 1 );
+			if( fread( data, 1, size, file ) != (size_t) size ) { perror( argv[arg] ); return 1; }
+			fclose( file );
+			LLVMFuzzerTestOneInput( data, size );
+			free( data );
+		}
+		printf( "%d files read\n", argc - 1 );
+		return 0;
+	}
+
+	seedLength = MakeFont( seed );
+	LLVMFuzzerTestOneInput( seed, seedLength );
+	for( run = 0; run < kRuns; run++ )
+	{
+		memcpy( bytes, seed, seedLength );
+		length = seedLength;
+		Mutate( bytes, &length );
+		LLVMFuzzerTestOneInput( bytes, length );
+	}
+	printf( "%ld damaged fonts read\n", run );
+	return 0;
+}
+
+#endif
@@ -24,6 +24,7 @@
    -------------------------------------------------------------------------- */
 
 #import "ICONWindowController.h"
+#import "IconCache.h"
 
 
 
@@ -74,49 +75,53 @@
 
 -(void) reloadResData
 {
-	unsigned char*			planes[2] = { 0, 0 };
 	NSBitmapImageRep*		bir;
-	NSString*				resType = [resource type];
 	
 	[resImage autorelease];
 	resImage = [[NSImage alloc] init];
 	
+	[resData release];
 	resData = [[resource data] retain];
-	planes[0] = (unsigned char*) [resData bytes];
 	
-	if( [resType isEqualToString: @"ICN#"] )
-	{
-		planes[1] = planes[0] + (4 * 32);   // 32 lines a 4 bytes.
-		bir = [[[NSBitmapImageRep alloc] autorelease] initWithBitmapDataPlanes:planes pixelsWide:32 pixelsHigh:32
-				bitsPerSample:1 samplesPerPixel:2 hasAlpha:YES isPlanar:YES colorSpaceName:NSCalibratedBlackColorSpace
-				bytesPerRow:4 bitsPerPixel:1];
-	}
-	else if( [resType isEqualToString: @"ics#"] || [resType isEqualToString: @"CURS"] )
-	{
-		planes[1] = planes[0] + (2 * 16);   // 16 lines a 2 bytes.
-		bir = [[[NSBitmapImageRep alloc] autorelease] initWithBitmapDataPlanes:planes pixelsWide:16 pixelsHigh:16
-				bitsPerSample:1 samplesPerPixel:2 hasAlpha:YES isPlanar:YES colorSpaceName:NSCalibratedBlackColorSpace
-				bytesPerRow:2 bitsPerPixel:1];
-	}
-	else if( [resType isEqualToString: @"icm#"] )
-	{
-		planes[1] = planes[0] + (2 * 12);   // 12 lines a 2 bytes.
-		bir = [[[NSBitmapImageRep alloc] autorelease] initWithBitmapDataPlanes:planes pixelsWide:16 pixelsHigh:12
-				bitsPerSample:1 samplesPerPixel:2 hasAlpha:YES isPlanar:YES colorSpaceName:NSCalibratedBlackColorSpace
-				bytesPerRow:2 bitsPerPixel:1];
-	}
-	else
-		bir = [[[NSBitmapImageRep alloc] autorelease] initWithBitmapDataPlanes:planes pixelsWide:32 pixelsHigh:32
-				bitsPerSample:1 samplesPerPixel:1 hasAlpha:NO isPlanar:NO colorSpaceName:NSCalibratedBlackColorSpace
-				bytesPerRow:4 bitsPerPixel:1]; 
-	
-	[resImage addRepresentation:bir];
+	// copied, as drawing into resImage would otherwise change the cached one
+	bir = [[[[IconCache sharedCache] bitmapForResource:resource largest:128] copy] autorelease];
+	if( bir )
+		[resImage addRepresentation:bir];
 	[imageView setImage: resImage];
 	
 	//[[self window] setContentSize:[resImage size]];
 }
 
 
+/* -----------------------------------------------------------------------------
+	thumbnailForResource:size:
+		Icons for the resource list, from the cache we share with it.
+   -------------------------------------------------------------------------- */
+
++(NSImage*)		thumbnailForResource: (id <ResKnifeResourceProtocol>)res size: (NSSize)size
+{
+	return [[IconCache sharedCache] thumbnailForResource:res size:size];
+}
+
+
+/* -----------------------------------------------------------------------------
+	dataForFileConversion:
+		The icon as a PNG, for exports. For an icns this is its largest
+		member. Called on the host's export workers, like the above.
+   -------------------------------------------------------------------------- */
+
++(NSData*)		dataForFileConversion: (id <ResKnifeResourceProtocol>)res
+{
+	return [[[IconCache sharedCache] bitmapForResource:res largest:1024] representationUsingType:NSPNGFileType properties:nil];
+}
+
+
++(NSString*)	filenameExtensionForFileConversion: (id <ResKnifeResourceProtocol>)res
+{
+	return @"png";
+}
+
+
 /* -----------------------------------------------------------------------------
 	windowDidLoad:
 		Our window is there, stuff the image in it.
@@ -0,0 +1,39 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		IconCache.h
+
+	PURPOSE:	Decoded icons, shared by every icon editor and the host's
+				resource list. Each is kept by document, type and ID with the
+				data it was decoded from, and its mask's (the 1-bit or alpha
+				mask of the same ID which colour icons take theirs from), so an
+				icon is only decoded again once one of those has changed.
+				Decoding itself is done by IconDecoder. The host asks for
+				thumbnails from its worker threads, so the cache is locked.
+   ========================================================================== */
+
+/* -----------------------------------------------------------------------------
+	Headers:
+   -------------------------------------------------------------------------- */
+
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+
+
+/* -----------------------------------------------------------------------------
+	Interface:
+   -------------------------------------------------------------------------- */
+
+@interface IconCache : NSObject
+{
+	NSMutableDictionary		*bitmaps;	// [document, type, ID, largest] -> [data decoded, mask data or NSNull, NSBitmapImageRep]
+	NSMutableArray			*recent;	// keys of bitmaps, least recently used first
+	NSLock					*lock;		// held while using either of the above, never while decoding or looking up masks
+}
+
++(IconCache*)			sharedCache;
++(BOOL)					canDecodeType: (NSString*)type;
+
+-(NSBitmapImageRep*)	bitmapForResource: (id <ResKnifeResourceProtocol>)resource largest: (int)largest;	// largest only matters for icns
+-(NSImage*)				thumbnailForResource: (id <ResKnifeResourceProtocol>)resource size: (NSSize)size;
+
+@end
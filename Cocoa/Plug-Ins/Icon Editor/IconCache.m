@@ -0,0 +1,205 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		IconCache.m
+
+	PURPOSE:	Decoded icons, shared by every icon editor and the host's
+				resource list.
+   ========================================================================== */
+
+/* -----------------------------------------------------------------------------
+	Headers:
+   -------------------------------------------------------------------------- */
+
+#import "IconCache.h"
+#import "IconDecoder.h"
+
+
+/* -----------------------------------------------------------------------------
+	Constants:
+   -------------------------------------------------------------------------- */
+
+enum
+{
+	kIconCacheSize = 256,
+
+	kEntryData = 0,
+	kEntryMaskData,
+	kEntryBitmap
+};
+
+static IconCache	*gSharedCache = nil;
+
+
+/* -----------------------------------------------------------------------------
+	TypeCode:
+		The four MacRoman characters of a type, as IconDecoder wants them.
+   -------------------------------------------------------------------------- */
+
+static UInt32	TypeCode( NSString* type )
+{
+	NSData*			bytes = [type dataUsingEncoding:NSMacOSRomanStringEncoding];
+	const UInt8*	chars = [bytes bytes];
+	if( [bytes length] != 4 ) return 0;
+	return ((UInt32) chars[0] << 24) | ((UInt32) chars[1] << 16) | ((UInt32) chars[2] << 8) | chars[3];
+}
+
+static NSString*	TypeString( UInt32 code )
+{
+	UInt8	chars[4] = { code >> 24, code >> 16, code >> 8, code };
+	return [[[NSString alloc] initWithBytes:chars length:4 encoding:NSMacOSRomanStringEncoding] autorelease];
+}
+
+
+@implementation IconCache
+
+/* -----------------------------------------------------------------------------
+	initialize:
+		Made here, as the runtime makes sure only one thread does this.
+   -------------------------------------------------------------------------- */
+
++(void)		initialize
+{
+	if( self == [IconCache class] ) gSharedCache = [[IconCache alloc] init];
+}
+
+
+/* -----------------------------------------------------------------------------
+	sharedCache:
+   -------------------------------------------------------------------------- */
+
++(IconCache*)	sharedCache
+{
+	return gSharedCache;
+}
+
+
+/* -----------------------------------------------------------------------------
+	canDecodeType:
+		Whether this is an icon type, or an icon family, we can draw.
+   -------------------------------------------------------------------------- */
+
++(BOOL)		canDecodeType: (NSString*)type
+{
+	IconFormat		format;
+	return [type isEqualToString:@"icns"] || IconGetFormat( TypeCode( type ), &format );
+}
+
+
+/* -----------------------------------------------------------------------------
+	* CONSTRUCTOR / DESTRUCTOR
+   -------------------------------------------------------------------------- */
+
+-(id)	init
+{
+	self = [super init];
+	if( !self ) return nil;
+	bitmaps = [[NSMutableDictionary alloc] init];
+	recent = [[NSMutableArray alloc] init];
+	lock = [[NSLock alloc] init];
+	return self;
+}
+
+-(void)	dealloc
+{
+	[bitmaps release];
+	[recent release];
+	[lock release];
+	[super dealloc];
+}
+
+
+/* -----------------------------------------------------------------------------
+	bitmapForResource:largest:
+		The icon, decoded if it hasn't been since it or its mask last
+		changed. For an icns this is its largest member of at most the size
+		given, with the most colours. Nil if it can't be drawn.
+   -------------------------------------------------------------------------- */
+
+-(NSBitmapImageRep*)	bitmapForResource: (id <ResKnifeResourceProtocol>)resource largest: (int)largest
+{
+	NSData*				data = [resource data];
+	NSData*				maskData = nil;
+	BOOL				family = [[resource type] isEqualToString:@"icns"];
+	NSArray*			key;
+	NSArray*			entry;
+	IconFormat			format;
+	IconElement			image, mask;
+	NSBitmapImageRep*	bitmap;
+
+	if( !data ) return nil;
+	if( family )
+	{
+		// the mask is in the same data, so that's all there is to compare
+		if( !IconFamilyFind( [data bytes], [data length], largest, &image, &mask ) ) return nil;
+		if( !IconGetFormat( image.type, &format ) ) return nil;
+	}
+	else
+	{
+		int		i;
+		if( !IconGetFormat( TypeCode( [resource type] ), &format ) ) return nil;
+		image.type = format.type;
+		image.bytes = [data bytes];
+		image.length = [data length];
+
+		// colour icons take their mask from another resource with the same ID
+		for( i = 0; i < 2 && format.masks[i] && !maskData; i++ )
+		{
+			maskData = [(id <ResKnifeResourceProtocol>)[NSClassFromString(@"Resource") resourceOfType:TypeString( format.masks[i] ) andID:[resource resID] inDocument:[resource document]] data];
+			mask.type = format.masks[i];
+		}
+		mask.bytes = [maskData bytes];
+		mask.length = [maskData length];
+	}
+
+	key = [NSArray arrayWithObjects:[NSValue valueWithNonretainedObject:[resource document]], [resource type], [resource resID], [NSNumber numberWithInt:family? largest : 0], nil];
+	[lock lock];
+	entry = [[[bitmaps objectForKey:key] retain] autorelease];
+	[recent removeObject:key];
+	[recent addObject:key];
+	[lock unlock];
+	if( entry && [entry objectAtIndex:kEntryData] == data && [entry objectAtIndex:kEntryMaskData] == (maskData? (id) maskData : (id) [NSNull null]) )
+		return [entry objectAtIndex:kEntryBitmap];
+
+	bitmap = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:format.width pixelsHigh:format.height bitsPerSample:8 samplesPerPixel:4 hasAlpha:YES isPlanar:NO colorSpaceName:NSDeviceRGBColorSpace bytesPerRow:format.width * 4 bitsPerPixel:32] autorelease];
+	if( !IconDecode( &format, image.bytes, image.length, mask.bytes? &mask : NULL, [bitmap bitmapData] ) )
+	{
+		[lock lock];
+		[bitmaps removeObjectForKey:key];
+		[recent removeObject:key];
+		[lock unlock];
+		return nil;
+	}
+
+	[lock lock];
+	[bitmaps setObject:[NSArray arrayWithObjects:data, maskData? (id) maskData : (id) [NSNull null], bitmap, nil] forKey:key];
+	if( ![recent containsObject:key] ) [recent addObject:key];
+	if( [recent count] > kIconCacheSize )
+	{
+		[bitmaps removeObjectForKey:[recent objectAtIndex:0]];
+		[recent removeObjectAtIndex:0];
+	}
+	[lock unlock];
+	return bitmap;
+}
+
+
+/* -----------------------------------------------------------------------------
+	thumbnailForResource:size:
+		The icon as an image no larger than the size given; icons smaller
+		than it are left at their own size.
+   -------------------------------------------------------------------------- */
+
+-(NSImage*)		thumbnailForResource: (id <ResKnifeResourceProtocol>)resource size: (NSSize)size
+{
+	NSBitmapImageRep*	bitmap = [self bitmapForResource:resource largest:(int) MAX( size.width, size.height )];
+	NSImage*			image;
+	float				scale;
+	if( !bitmap ) return nil;
+
+	scale = MIN( 1.0, MIN( size.width / [bitmap pixelsWide], size.height / [bitmap pixelsHigh] ) );
+	image = [[[NSImage alloc] initWithSize:NSMakeSize( [bitmap pixelsWide] * scale, [bitmap pixelsHigh] * scale )] autorelease];
+	[image addRepresentation:bitmap];
+	return image;
+}
+
+@end
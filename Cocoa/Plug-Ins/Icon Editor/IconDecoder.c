@@ -0,0 +1,249 @@
+#include "IconDecoder.h"
+#include "../../Classes/ColourTable.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ICON_TYPE(a, b, c, d)	(((UInt32) (a) << 24) | ((UInt32) (b) << 16) | ((UInt32) (c) << 8) | (UInt32) (d))
+
+enum
+{
+	kICON = ICON_TYPE( 'I','C','O','N' ),
+	kCURS = ICON_TYPE( 'C','U','R','S' ),
+	kLargeMono = ICON_TYPE( 'I','C','N','#' ),
+	kSmallMono = ICON_TYPE( 'i','c','s','#' ),
+	kMiniMono = ICON_TYPE( 'i','c','m','#' ),
+	kHugeMono = ICON_TYPE( 'i','c','h','#' ),
+	kLargeAlpha = ICON_TYPE( 'l','8','m','k' ),
+	kSmallAlpha = ICON_TYPE( 's','8','m','k' ),
+	kHugeAlpha = ICON_TYPE( 'h','8','m','k' ),
+	kThumbnailAlpha = ICON_TYPE( 't','8','m','k' ),
+	kThumbnail = ICON_TYPE( 'i','t','3','2' ),
+	kIconFamily = ICON_TYPE( 'i','c','n','s' )
+};
+
+static const IconFormat kFormats[] =
+{
+	{ kICON,						32, 32, 1,	{ 0, 0 } },
+	{ kCURS,						16, 16, 1,	{ 0, 0 } },
+	{ kLargeMono,					32, 32, 1,	{ 0, 0 } },
+	{ ICON_TYPE( 'i','c','l','4' ),	32, 32, 4,	{ kLargeMono, 0 } },
+	{ ICON_TYPE( 'i','c','l','8' ),	32, 32, 8,	{ kLargeMono, 0 } },
+	{ ICON_TYPE( 'i','l','3','2' ),	32, 32, 32,	{ kLargeAlpha, kLargeMono } },
+	{ kSmallMono,					16, 16, 1,	{ 0, 0 } },
+	{ ICON_TYPE( 'i','c','s','4' ),	16, 16, 4,	{ kSmallMono, 0 } },
+	{ ICON_TYPE( 'i','c','s','8' ),	16, 16, 8,	{ kSmallMono, 0 } },
+	{ ICON_TYPE( 'i','s','3','2' ),	16, 16, 32,	{ kSmallAlpha, kSmallMono } },
+	{ kMiniMono,					16, 12, 1,	{ 0, 0 } },
+	{ ICON_TYPE( 'i','c','m','4' ),	16, 12, 4,	{ kMiniMono, 0 } },
+	{ ICON_TYPE( 'i','c','m','8' ),	16, 12, 8,	{ kMiniMono, 0 } },
+	{ kHugeMono,					48, 48, 1,	{ 0, 0 } },
+	{ ICON_TYPE( 'i','c','h','4' ),	48, 48, 4,	{ kHugeMono, 0 } },
+	{ ICON_TYPE( 'i','c','h','8' ),	48, 48, 8,	{ kHugeMono, 0 } },
+	{ ICON_TYPE( 'i','h','3','2' ),	48, 48, 32,	{ kHugeAlpha, kHugeMono } },
+	{ kThumbnail,					128, 128, 32, { kThumbnailAlpha, 0 } }
+};
+
+static UInt32 ReadLong(const UInt8 *bytes)
+{
+	return ((UInt32) bytes[0] << 24) | ((UInt32) bytes[1] << 16) | ((UInt32) bytes[2] << 8) | bytes[3];
+}
+
+/* 32-bit planes: a byte under 0x80 is followed by that many plus one bytes to copy; any other is followed by one byte
+	to repeat that many less 0x80, plus 3, times. */
+static Boolean UnpackPlane(const UInt8 **bytes, const UInt8 *end, UInt8 *plane, UInt32 count)
+{
+	const UInt8 *in = *bytes;
+	UInt32 out = 0;
+	while( out < count )
+	{
+		UInt32 run;
+		if( in >= end ) return false;
+		if( *in < 0x80 )
+		{
+			run = *in++ + 1UL;
+			if( run > (UInt32) (end - in) || run > count - out ) return false;
+			memcpy( plane + out, in, run );
+			in += run;
+		}
+		else
+		{
+			run = *in++ - 0x80UL + 3;
+			if( in >= end || run > count - out ) return false;
+			memset( plane + out, *in++, run );
+		}
+		out += run;
+	}
+	*bytes = in;
+	return true;
+}
+
+Boolean IconGetFormat(UInt32 type, IconFormat *format)
+{
+	unsigned i;
+	for( i = 0; i < sizeof(kFormats) / sizeof(IconFormat); i++ )
+		if( kFormats[i].type == type )
+		{
+			*format = kFormats[i];
+			return true;
+		}
+	return false;
+}
+
+Boolean IconDecode(const IconFormat *format, const UInt8 *bytes, UInt32 length, const IconElement *mask, UInt8 *pixels)
+{
+	UInt32 count = (UInt32) format->width * format->height, i;
+	UInt32 monoBytes = count / 8;
+	const UInt8 *monoMask = NULL, *alphaMask = NULL;
+
+	// the mask: the second half of 1-bit icons with one, the second half of a 1-bit icon, or a plane of alpha
+	if( format->depth == 1 && format->type != kICON )
+	{
+		if( length < monoBytes * 2 ) return false;
+		monoMask = bytes + monoBytes;
+	}
+	else if( mask && mask->bytes && (mask->type == format->masks[0] || mask->type == format->masks[1]) )
+	{
+		IconFormat maskFormat;
+		if( IconGetFormat( mask->type, &maskFormat ) )
+		{
+			if( mask->length >= monoBytes * 2 ) monoMask = mask->bytes + monoBytes;
+		}
+		else if( mask->length >= count ) alphaMask = mask->bytes;
+	}
+
+	switch( format->depth )
+	{
+		case 1:
+			if( length < monoBytes ) return false;
+			for( i = 0; i < count; i++ )
+			{
+				UInt8 bit = (bytes[i >> 3] >> (7 - (i & 7))) & 1;
+				pixels[i*4] = pixels[i*4+1] = pixels[i*4+2] = bit? 0x00 : 0xFF;
+				pixels[i*4+3] = 0xFF;
+				// pixels outside the mask but set invert what's behind them; black is the nearest
+				if( monoMask && !bit && !((monoMask[i >> 3] >> (7 - (i & 7))) & 1) )
+					pixels[i*4+3] = 0x00;
+			}
+			return true;
+
+		case 4:
+		case 8:
+		{
+			// the System's tables for the depth, which give every entry full alpha
+			ColourTable table;
+			if( length < count * format->depth / 8 ) return false;
+			ColourTableSystem( format->depth, &table );
+			ColourTableExpand( &table, bytes, count, format->depth, pixels );
+			break;
+		}
+
+		case 32:
+		{
+			const UInt8 *in = bytes, *end = bytes + length;
+			UInt8 *planes;
+			if( length == count * 4 )
+			{
+				// stored as they are, ARGB
+				for( i = 0; i < count; i++ )
+				{
+					pixels[i*4] = bytes[i*4+1];
+					pixels[i*4+1] = bytes[i*4+2];
+					pixels[i*4+2] = bytes[i*4+3];
+					pixels[i*4+3] = 0xFF;
+				}
+				break;
+			}
+
+			// 128x128 icons start with four zero bytes
+			if( format->type == kThumbnail )
+			{
+				if( length < 4 ) return false;
+				in += 4;
+			}
+			planes = (UInt8 *) malloc( count * 3 );
+			if( !planes ) return false;
+			if( !UnpackPlane( &in, end, planes, count ) || !UnpackPlane( &in, end, planes + count, count ) || !UnpackPlane( &in, end, planes + count * 2, count ) )
+			{
+				free( planes );
+				return false;
+			}
+			for( i = 0; i < count; i++ )
+			{
+				pixels[i*4] = planes[i];
+				pixels[i*4+1] = planes[count + i];
+				pixels[i*4+2] = planes[count * 2 + i];
+				pixels[i*4+3] = 0xFF;
+			}
+			free( planes );
+			break;
+		}
+
+		default:
+			return false;
+	}
+
+	// apply the mask, premultiplying
+	if( monoMask )
+	{
+		for( i = 0; i < count; i++ )
+			if( !((monoMask[i >> 3] >> (7 - (i & 7))) & 1) )
+				memset( pixels + i*4, 0, 4 );
+	}
+	else if( alphaMask )
+	{
+		for( i = 0; i < count; i++ )
+		{
+			UInt32 alpha = alphaMask[i];
+			pixels[i*4] = (UInt8) ((pixels[i*4] * alpha + 127) / 255);
+			pixels[i*4+1] = (UInt8) ((pixels[i*4+1] * alpha + 127) / 255);
+			pixels[i*4+2] = (UInt8) ((pixels[i*4+2] * alpha + 127) / 255);
+			pixels[i*4+3] = (UInt8) alpha;
+		}
+	}
+	return true;
+}
+
+/* An 'icns' is 'icns' and its length, then elements of a type, their length (counting these 8 bytes) and data. */
+Boolean IconFamilyFind(const UInt8 *bytes, UInt32 length, UInt16 largest, IconElement *image, IconElement *mask)
+{
+	IconFormat best, format;
+	UInt32 offset = 8, end;
+	if( length < 8 || ReadLong( bytes ) != kIconFamily ) return false;
+	end = ReadLong( bytes + 4 );
+	if( end > length ) end = length;
+
+	memset( &best, 0, sizeof(best) );
+	memset( image, 0, sizeof(IconElement) );
+	memset( mask, 0, sizeof(IconElement) );
+	while( offset + 8 <= end )
+	{
+		UInt32 type = ReadLong( bytes + offset ), size = ReadLong( bytes + offset + 4 );
+		if( size < 8 || size > end - offset ) break;
+		if( IconGetFormat( type, &format ) && format.width <= largest
+			&& (format.width > best.width || (format.width == best.width && format.depth > best.depth)) )
+		{
+			best = format;
+			image->type = type;
+			image->bytes = bytes + offset + 8;
+			image->length = size - 8;
+		}
+		offset += size;
+	}
+	if( !image->bytes ) return false;
+
+	// then the best mask for it
+	offset = 8;
+	while( offset + 8 <= end )
+	{
+		UInt32 type = ReadLong( bytes + offset ), size = ReadLong( bytes + offset + 4 );
+		if( size < 8 || size > end - offset ) break;
+		if( type && (type == best.masks[0] || (type == best.masks[1] && mask->type != best.masks[0])) )
+		{
+			mask->type = type;
+			mask->bytes = bytes + offset + 8;
+			mask->length = size - 8;
+		}
+		offset += size;
+	}
+	return true;
+}
@@ -0,0 +1,63 @@
+/* Macintosh icon decoder */
+
+/*	Decodes the classic icon resources, and the members of 'icns' icon families, into premultiplied RGBA, 8 bits per
+	sample in R, G, B, A order, as NSBitmapImageRep expects by default.
+
+	1-bit icons (ICON, ICN#, ics#, icm#, ich#, CURS) are black and white, with their mask following the image in the
+	same data except for ICON, which has none. 4 and 8-bit icons (icl4, ics4, icm4, ich4, icl8, ics8, icm8, ich8) are
+	indexed through the standard 16 and 256 colour Macintosh tables, and take their mask from the 1-bit icon of the same
+	size. 32-bit icons (il32, is32, ih32, it32) are three planes of red, green and blue, each run-length encoded a
+	byte at a time, and take their mask from the 8-bit alpha mask of the same size (l8mk, s8mk, h8mk, t8mk), or the
+	1-bit one if there isn't one. Runs are expanded with memset and memcpy, so this only depends on the C library.
+
+	Types are four character codes packed big-endian into a UInt32, as OSType is. */
+
+#ifndef ICON_DECODER_H
+#define ICON_DECODER_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IconFormat
+{
+	UInt32	type;
+	UInt16	width;
+	UInt16	height;
+	UInt16	depth;			// bits per pixel: 1, 4, 8 or 32
+	UInt32	masks[2];		// types to take the mask from, best first; 0 where there's no more, or for icons which carry their own
+} IconFormat;
+
+typedef struct IconElement
+{
+	UInt32		type;
+	const UInt8	*bytes;
+	UInt32		length;
+} IconElement;
+
+/*!
+@function	IconGetFormat
+@abstract	Returns false if this isn't a type of icon this can decode.
+*/
+Boolean IconGetFormat(UInt32 type, IconFormat *format);
+
+/*!
+@function	IconDecode
+@abstract	Draws the icon into pixels (width * height * 4 bytes), through the mask if one is given (its type must be one of the format's masks). Returns false if the data is too short.
+*/
+Boolean IconDecode(const IconFormat *format, const UInt8 *bytes, UInt32 length, const IconElement *mask, UInt8 *pixels);
+
+/*!
+@function	IconFamilyFind
+@abstract	Finds the members of an 'icns' to draw at up to the size given: the largest image with the most colours, and its best mask. Returns false if there are none this can decode.
+@discussion	PNG and JPEG 2000 members are skipped; drawing them is left to the system.
+*/
+Boolean IconFamilyFind(const UInt8 *bytes, UInt32 length, UInt16 largest, IconElement *image, IconElement *mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -21,3 +21,13 @@ NSString *ResourceAttributesDidChangeNotification	= @"ResourceAttributesDidChang
 NSString *ResourceDataDidChangeNotification			= @"ResourceDataDidChangeNotification";
 NSString *ResourceDidChangeNotification				= @"ResourceDidChangeNotification";
 NSString *ResourceWasSavedNotification				= @"ResourceWasSavedNotification";
+
+// the object of these is a dictionary holding the ResourceDataSource under "DataSource" and the Resource under "Resource"
+NSString *DataSourceWillAddResourceNotification		= @"DataSourceWillAddResource";
+NSString *DataSourceDidAddResourceNotification		= @"DataSourceDidAddResource";
+NSString *DataSourceWillRemoveResourceNotification	= @"DataSourceWillRemoveResource";
+NSString *DataSourceDidRemoveResourceNotification	= @"DataSourceDidRemoveResource";
+
+// the object of these is the document, posted once its resources can be looked up and just before it closes
+NSString *DocumentDidOpenNotification				= @"DocumentDidOpen";
+NSString *DocumentWillCloseNotification				= @"DocumentWillClose";
@@ -10,4 +10,7 @@
 	id <ResKnifeResourceProtocol>	resource;
 }
 
++ (NSBitmapImageRep *)bitmapForData:(NSData *)data;
+- (NSImage *)image;
+
 @end
@@ -1,7 +1,14 @@
 #import "PictWindowController.h"
+#import "../../../PICT Editor/Classes/Parser.h"
+#import <Carbon/Carbon.h>	// for SetWindowAlternateTitle()
 //#import "Element.h"
 #import <stdarg.h>
 
+enum
+{
+	kMaximumConvertedPixels = 4096 * 4096	// each export worker draws a whole picture at once
+};
+
 @implementation PictWindowController
 
 - (id)initWithResource:(id)newResource
@@ -39,7 +46,7 @@
 		SetWindowAlternateTitle( (WindowRef) [[self window] windowRef], (CFStringRef) [NSString stringWithFormat:@"%@ %@: %@", [resource type], [resource resID], [resource name]] );
 	}
 	
-	NSImage *image = [[[NSImage alloc] initWithData:[resource data]] autorelease];
+	NSImage *image = [self image];
 	if( image )
 	{
 		// resize the window to the size of the image
@@ -56,13 +63,96 @@
 	[self showWindow:self];
 }
 
+/* Draws the picture ourselves; only those with text or QuickTime images in need QuickDraw, and get nil. */
++ (NSBitmapImageRep *)bitmapForData:(NSData *)data
+{
+	NSBitmapImageRep *bitmap;
+	PictRect frame;
+	if( PictReadFrame( [data bytes], [data length], &frame ) != kPictNoError )
+		return nil;
+	
+	bitmap = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:frame.right - frame.left pixelsHigh:frame.bottom - frame.top bitsPerSample:8 samplesPerPixel:4 hasAlpha:YES isPlanar:NO colorSpaceName:NSDeviceRGBColorSpace bytesPerRow:(frame.right - frame.left) * 4 bitsPerPixel:32] autorelease];
+	if( !bitmap ) return nil;
+	memset( [bitmap bitmapData], 0, [bitmap bytesPerRow] * [bitmap pixelsHigh] );
+	if( PictDraw( [data bytes], [data length], [bitmap bitmapData], [bitmap bytesPerRow] ) != kPictNoError )
+		return nil;
+	return bitmap;
+}
+
+- (NSImage *)image
+{
+	NSBitmapImageRep *bitmap = [PictWindowController bitmapForData:[resource data]];
+	NSImage *image;
+	if( !bitmap )
+		return [[[NSImage alloc] initWithData:[resource data]] autorelease];
+	
+	image = [[[NSImage alloc] initWithSize:[bitmap size]] autorelease];
+	[image addRepresentation:bitmap];
+	return image;
+}
+
+/* Thumbnails are drawn full size and sampled down, on the host's worker threads; pictures needing QuickDraw get none. */
++ (NSImage *)thumbnailForResource:(id <ResKnifeResourceProtocol>)thumbResource size:(NSSize)size
+{
+	NSData *data = [thumbResource data];
+	NSBitmapImageRep *bitmap;
+	NSImage *image;
+	UInt8 *pixels, *out;
+	PictRect frame;
+	int width, height, thumbWidth, thumbHeight, x, y;
+	float scale;
+	if( PictReadFrame( [data bytes], [data length], &frame ) != kPictNoError )
+		return nil;
+	
+	width = frame.right - frame.left;
+	height = frame.bottom - frame.top;
+	pixels = (UInt8 *) calloc( width * height, 4 );
+	if( !pixels ) return nil;
+	if( PictDraw( [data bytes], [data length], pixels, width * 4 ) != kPictNoError )
+	{
+		free( pixels );
+		return nil;
+	}
+	
+	scale = MIN( 1.0, MIN( size.width / width, size.height / height ) );
+	thumbWidth = MAX( 1, (int) (width * scale) );
+	thumbHeight = MAX( 1, (int) (height * scale) );
+	bitmap = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:thumbWidth pixelsHigh:thumbHeight bitsPerSample:8 samplesPerPixel:4 hasAlpha:YES isPlanar:NO colorSpaceName:NSDeviceRGBColorSpace bytesPerRow:thumbWidth * 4 bitsPerPixel:32] autorelease];
+	out = [bitmap bitmapData];
+	for( y = 0; y < thumbHeight; y++ )
+		for( x = 0; x < thumbWidth; x++ )
+			memcpy( out + (y * thumbWidth + x) * 4, pixels + ((y * height / thumbHeight) * width + x * width / thumbWidth) * 4, 4 );
+	free( pixels );
+	
+	image = [[[NSImage alloc] initWithSize:[bitmap size]] autorelease];
+	[image addRepresentation:bitmap];
+	return image;
+}
+
+/* Converted exports are drawn the same way, on the host's export workers; pictures needing QuickDraw are exported as they are, and so are huge ones, rather than have every worker draw one at once. */
++ (NSData *)dataForFileConversion:(id <ResKnifeResourceProtocol>)exportResource
+{
+	NSData *data = [exportResource data];
+	PictRect frame;
+	if( PictReadFrame( [data bytes], [data length], &frame ) != kPictNoError )
+		return nil;
+	if( (UInt32) (frame.right - frame.left) * (UInt32) (frame.bottom - frame.top) > kMaximumConvertedPixels )
+		return nil;
+	return [[PictWindowController bitmapForData:data] representationUsingType:NSPNGFileType properties:nil];
+}
+
++ (NSString *)filenameExtensionForFileConversion:(id <ResKnifeResourceProtocol>)exportResource
+{
+	return @"png";
+}
+
 - (void)resourceDataDidChange:(NSNotification *)notification
 {
 	// ensure it's our resource which got changed (should always be true, we don't register for notifications on other resource objects)
 	if( [notification object] == (id)resource )
 	{
 		// refresh image
-		NSImage *image = [[[NSImage alloc] initWithData:[resource data]] autorelease];
+		NSImage *image = [self image];
 		if( image )
 		{
 			// resize the window to the size of the image
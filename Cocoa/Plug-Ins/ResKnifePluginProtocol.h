@@ -45,6 +45,19 @@
 */
 + (NSData *)dataForFileExport:(id <ResKnifeResourceProtocol>)resource;
 
+/*!
+@method		dataForFileConversion:
+@abstract	Return the resource converted to a file format other applications read, such as a PNG for a picture or a WAV for a sound, or nil if it can't be. Unlike dataForFileExport: this may leave out whatever that format can't hold, so it is only used when the user asks for exports to be converted.
+@discussion	This and dataForFileExport: are called on the host's export workers when many resources are exported at once, several at a time, so the same rules apply as for thumbnailForResource:size: below.
+*/
++ (NSData *)dataForFileConversion:(id <ResKnifeResourceProtocol>)resource;
+
+/*!
+@method		filenameExtensionForFileConversion:
+@abstract	The filename extension for the data returned by dataForFileConversion:.
+*/
++ (NSString *)filenameExtensionForFileConversion:(id <ResKnifeResourceProtocol>)resource;
+
 /*	Your plug should implement one of the following four methods.
  *	They are looked for in the order shown below. Only implement one.
  */
@@ -78,6 +91,13 @@
 
 + (NSString *)filenameExtensionForFileExport:(id <ResKnifeResourceProtocol>)resource;
 
+/*!
+@method		thumbnailForResource:size:
+@abstract	Return a picture of the resource no larger than the size given, for the resource list to show beside it, or nil if there's nothing to show.
+@discussion	This is called on one of the host's worker threads, several at once, so anything of your own you use must be safe for that. The resource's accessors and the Resource class's lookups may be used from them; the lookups are made on the main thread, so don't wait on it.
+*/
++ (NSImage *)thumbnailForResource:(id <ResKnifeResourceProtocol>)resource size:(NSSize)size;
+
 /*!
 @@method		iconForResourceType:
 @abstract		Returns the icon to be used throughout the UI for any given resource type.
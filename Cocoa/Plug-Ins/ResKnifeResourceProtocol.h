@@ -72,4 +72,12 @@ extern NSString *ResourceIDDidChangeNotification;
 extern NSString *ResourceAttributesDidChangeNotification;
 extern NSString *ResourceDataDidChangeNotification;
 extern NSString *ResourceDidChangeNotification;
-extern NSString *ResourceWasSavedNotification;
\ No newline at end of file
+extern NSString *ResourceWasSavedNotification;
+
+extern NSString *DataSourceWillAddResourceNotification;
+extern NSString *DataSourceDidAddResourceNotification;
+extern NSString *DataSourceWillRemoveResourceNotification;
+extern NSString *DataSourceDidRemoveResourceNotification;
+
+extern NSString *DocumentDidOpenNotification;
+extern NSString *DocumentWillCloseNotification;
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "SoundPeaks.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* The peak of a block of frames of each channel, one sample at a time. */
+static void ScalarPeaks(const SInt16 *pcm, UInt32 frames, UInt32 channels, SoundPeak *out)
+{
+	UInt32 channel, frame;
+	for( channel = 0; channel < channels; channel++ )
+	{
+		SInt16 min = pcm[channel], max = pcm[channel];
+		for( frame = 1; frame < frames; frame++ )
+		{
+			SInt16 sample = pcm[frame * channels + channel];
+			if( sample < min ) min = sample;
+			if( sample > max ) max = sample;
+		}
+		out[channel].min = min;
+		out[channel].max = max;
+	}
+}
+
+#ifdef __SSE2__
+/* 16 frames of mono are two vectors, of stereo four, with left and right alternating; folding each in half until
+	there's a lane per channel left leaves the channels apart. */
+static void VectorPeaks(const SInt16 *pcm, UInt32 blocks, UInt32 channels, SoundPeak *out)
+{
+	UInt32 block;
+	for( block = 0; block < blocks; block++, pcm += kSoundPeakFrames * channels, out += channels )
+	{
+		__m128i a = _mm_loadu_si128( (const __m128i *) pcm ), b = _mm_loadu_si128( (const __m128i *) pcm + 1 );
+		__m128i min = _mm_min_epi16( a, b ), max = _mm_max_epi16( a, b );
+		if( channels == 2 )
+		{
+			__m128i c = _mm_loadu_si128( (const __m128i *) pcm + 2 ), d = _mm_loadu_si128( (const __m128i *) pcm + 3 );
+			min = _mm_min_epi16( min, _mm_min_epi16( c, d ) );
+			max = _mm_max_epi16( max, _mm_max_epi16( c, d ) );
+		}
+		min = _mm_min_epi16( min, _mm_srli_si128( min, 8 ) );
+		max = _mm_max_epi16( max, _mm_srli_si128( max, 8 ) );
+		min = _mm_min_epi16( min, _mm_srli_si128( min, 4 ) );
+		max = _mm_max_epi16( max, _mm_srli_si128( max, 4 ) );
+		if( channels == 1 )
+		{
+			min = _mm_min_epi16( min, _mm_srli_si128( min, 2 ) );
+			max = _mm_max_epi16( max, _mm_srli_si128( max, 2 ) );
+		}
+		else
+		{
+			out[1].min = (SInt16) _mm_extract_epi16( min, 1 );
+			out[1].max = (SInt16) _mm_extract_epi16( max, 1 );
+		}
+		out[0].min = (SInt16) _mm_extract_epi16( min, 0 );
+		out[0].max = (SInt16) _mm_extract_epi16( max, 0 );
+	}
+}
+#endif
+
+Boolean SoundPeaksInit(SoundPeaks *peaks, UInt32 channels, UInt32 frames)
+{
+	UInt32 count = (frames + kSoundPeakFrames -1) / kSoundPeakFrames, total = 0, n;
+	memset( peaks, 0, sizeof(SoundPeaks) );
+	if( channels == 0 ) return false;
+	peaks->channels = channels;
+	if( count == 0 ) count = 1;
+
+	// all the levels in one block, each half the one below
+	for( n = 0; n < kSoundPeakMaxLevels; n++ )
+	{
+		peaks->count[n] = count;
+		total += count;
+		peaks->levels++;
+		if( count == 1 ) break;
+		count = (count + 1) / 2;
+	}
+	if( total > 0xFFFFFFFF / sizeof(SoundPeak) / channels ) return false;
+	peaks->level[0] = (SoundPeak *) calloc( total * channels, sizeof(SoundPeak) );
+	if( !peaks->level[0] ) return false;
+	for( n = 1; n < peaks->levels; n++ )
+		peaks->level[n] = peaks->level[n - 1] + peaks->count[n - 1] * channels;
+	return true;
+}
+
+void SoundPeaksAdd(SoundPeaks *peaks, const SInt16 *pcm, UInt32 frames)
+{
+	UInt32 channels = peaks->channels, first = peaks->frames / kSoundPeakFrames, blocks;
+	SoundPeak *out = peaks->level[0] + first * channels;
+
+	// what doesn't fit is dropped, as is anything after a block which wasn't whole
+	if( peaks->frames % kSoundPeakFrames || first >= peaks->count[0] ) return;
+	if( frames > (peaks->count[0] - first) * kSoundPeakFrames ) frames = (peaks->count[0] - first) * kSoundPeakFrames;
+	blocks = frames / kSoundPeakFrames;
+#ifdef __SSE2__
+	if( channels <= 2 )
+		VectorPeaks( pcm, blocks, channels, out );
+	else
+#endif
+	{
+		UInt32 block;
+		for( block = 0; block < blocks; block++ )
+			ScalarPeaks( pcm + block * kSoundPeakFrames * channels, kSoundPeakFrames, channels, out + block * channels );
+	}
+	if( frames % kSoundPeakFrames )
+		ScalarPeaks( pcm + blocks * kSoundPeakFrames * channels, frames % kSoundPeakFrames, channels, out + blocks * channels );
+	peaks->frames += frames;
+}
+
+void SoundPeaksFinish(SoundPeaks *peaks)
+{
+	UInt32 channels = peaks->channels, n, i, channel;
+	for( n = 1; n < peaks->levels; n++ )
+	{
+		const SoundPeak *below = peaks->level[n - 1];
+		SoundPeak *level = peaks->level[n];
+		for( i = 0; i < peaks->count[n]; i++ )
+		{
+			for( channel = 0; channel < channels; channel++ )
+			{
+				SoundPeak peak = below[i * 2 * channels + channel];
+				if( i * 2 + 1 < peaks->count[n - 1] )
+				{
+					SoundPeak next = below[(i * 2 + 1) * channels + channel];
+					if( next.min < peak.min ) peak.min = next.min;
+					if( next.max > peak.max ) peak.max = next.max;
+				}
+				level[i * channels + channel] = peak;
+			}
+		}
+	}
+}
+
+void SoundPeaksGet(const SoundPeaks *peaks, UInt32 channel, double firstFrame, double framesPerPixel, UInt32 pixels, SoundPeak *out)
+{
+	UInt32 n = 0, pixel, channels = peaks->channels, filled = (peaks->frames + kSoundPeakFrames -1) / kSoundPeakFrames;
+	double width = kSoundPeakFrames;
+	const SoundPeak *level;
+
+	// the level whose peaks are the widest no wider than a pixel
+	while( n + 1 < peaks->levels && width * 2 <= framesPerPixel )
+	{
+		width *= 2;
+		n++;
+	}
+	level = peaks->level[n];
+	if( filled > 0 ) filled = ((filled -1) >> n) + 1;		// peaks of this level with frames added under them
+	if( filled > peaks->count[n] ) filled = peaks->count[n];
+
+	for( pixel = 0; pixel < pixels; pixel++ )
+	{
+		double start = firstFrame + pixel * framesPerPixel;
+		double end = start + framesPerPixel;
+		SInt32 first = (SInt32) floor( start / width ), last = (SInt32) ceil( end / width ) -1, i;
+		SoundPeak peak = { 0, 0 };
+		if( first < 0 ) first = 0;
+		if( last >= (SInt32) filled ) last = (SInt32) filled -1;
+		if( first <= last )
+		{
+			peak = level[first * channels + channel];
+			for( i = first + 1; i <= last; i++ )
+			{
+				SoundPeak next = level[i * channels + channel];
+				if( next.min < peak.min ) peak.min = next.min;
+				if( next.max > peak.max ) peak.max = next.max;
+			}
+		}
+		out[pixel] = peak;
+	}
+}
+
+void SoundPeaksFree(SoundPeaks *peaks)
+{
+	free( peaks->level[0] );
+	memset( peaks, 0, sizeof(SoundPeaks) );
+}
@@ -0,0 +1,75 @@
+/* Waveform peaks */
+
+/*	A pyramid of the lowest and highest samples of a sound, so its waveform can be drawn at any zoom by looking at a
+	few peaks per pixel, rather than every sample. The lowest level holds a peak for every 16 frames of each channel,
+	and each level above halves the one below, up to a single peak for the whole sound. Drawing a pixel takes the
+	level whose peaks are the largest no wider than it, and at most three of them, so a repaint costs the same however
+	long the sound is. Zoomed in closer than 16 frames a pixel, the samples themselves are cheap enough to draw.
+
+	Sounds are added a block at a time as they're decoded, so the samples needn't be kept. The lowest level of mono
+	and stereo sounds is found eight samples at a time with SSE2, where the compiler has it. */
+
+#ifndef SOUND_PEAKS_H
+#define SOUND_PEAKS_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	kSoundPeakFrames = 16,		// frames per peak of the lowest level
+	kSoundPeakMaxLevels = 32
+};
+
+typedef struct SoundPeak
+{
+	SInt16	min;
+	SInt16	max;
+} SoundPeak;
+
+typedef struct SoundPeaks
+{
+	UInt32		channels;
+	UInt32		frames;			// added so far
+	UInt32		levels;
+	UInt32		count[kSoundPeakMaxLevels];		// peaks per channel in each level
+	SoundPeak	*level[kSoundPeakMaxLevels];	// level n has a peak per channel for every kSoundPeakFrames << n frames, channels interleaved
+} SoundPeaks;
+
+/*!
+@function	SoundPeaksInit
+@abstract	Makes room for the peaks of a sound of so many frames. Returns false if there's no memory for them.
+*/
+Boolean SoundPeaksInit(SoundPeaks *peaks, UInt32 channels, UInt32 frames);
+
+/*!
+@function	SoundPeaksAdd
+@abstract	Adds the next frames of the sound to the lowest level. Every block but the last must be a multiple of kSoundPeakFrames long.
+*/
+void SoundPeaksAdd(SoundPeaks *peaks, const SInt16 *pcm, UInt32 frames);
+
+/*!
+@function	SoundPeaksFinish
+@abstract	Builds the levels above the lowest, once the whole sound has been added.
+*/
+void SoundPeaksFinish(SoundPeaks *peaks);
+
+/*!
+@function	SoundPeaksGet
+@abstract	Finds the peak of the channel under each of so many pixels, the first starting at firstFrame and each framesPerPixel wide.
+*/
+void SoundPeaksGet(const SoundPeaks *peaks, UInt32 channel, double firstFrame, double framesPerPixel, UInt32 pixels, SoundPeak *out);
+
+/*!
+@function	SoundPeaksFree
+*/
+void SoundPeaksFree(SoundPeaks *peaks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
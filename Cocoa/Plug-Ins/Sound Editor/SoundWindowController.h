@@ -0,0 +1,27 @@
+#import <Cocoa/Cocoa.h>
+#import <Carbon/Carbon.h>
+
+#import "ResKnifePluginProtocol.h"
+#import "ResKnifeResourceProtocol.h"
+#import "../../Classes/SoundMixer.h"
+
+@class WaveformView;
+
+/*!
+@class			SoundWindowController
+@abstract		Shows the waveform of a 'snd ' resource, with buttons to zoom it and to play it through the host's SoundPlayer. Clicking the waveform plays from there.
+*/
+
+@interface SoundWindowController : NSWindowController <ResKnifePluginProtocol>
+{
+	id <ResKnifeResourceProtocol>	resource;
+	WaveformView					*waveform;
+	SoundVoiceID					voice;		// zero if not playing
+	BOOL							paused;
+}
+
+- (IBAction)playSound:(id)sender;
+- (IBAction)pauseSound:(id)sender;
+- (IBAction)stopSound:(id)sender;
+
+@end
@@ -0,0 +1,197 @@
+#import "SoundWindowController.h"
+#import "WaveformView.h"
+#import "../../Classes/SoundPlayer.h"
+
+enum
+{
+	kButtonHeight = 32,
+	kButtonWidth = 80
+};
+
+@interface SoundWindowController (Private)
+- (NSButton *)addButton:(NSString *)title action:(SEL)action target:(id)target at:(float)x;
+- (SoundPlayer *)player;
+- (void)waveformClicked:(id)sender;
+- (void)voiceDidFinish:(NSNotification *)notification;
+@end
+
+@implementation SoundWindowController
+
+- (id)initWithResource:(id <ResKnifeResourceProtocol>)inResource
+{
+	NSWindow *window = [[[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 580, 240) styleMask:NSTitledWindowMask | NSClosableWindowMask | NSMiniaturizableWindowMask | NSResizableWindowMask backing:NSBackingStoreBuffered defer:YES] autorelease];
+	NSView *content = [window contentView];
+	NSRect bounds = [content bounds];
+	NSScrollView *scrollView;
+	self = [self initWithWindow:window];
+	if(!self) return nil;
+
+	resource = [(id)inResource retain];
+	[window setReleasedWhenClosed:NO];
+	[window setDelegate:self];
+	[window setMinSize:NSMakeSize(300, 120)];
+	[window center];
+
+	// the waveform scrolls sideways beneath a row of buttons
+	bounds.size.height -= kButtonHeight;
+	scrollView = [[[NSScrollView alloc] initWithFrame:bounds] autorelease];
+	[scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+	[scrollView setHasHorizontalScroller:YES];
+	[scrollView setBorderType:NSBezelBorder];
+	waveform = [[[WaveformView alloc] initWithFrame:NSMakeRect(0, 0, [scrollView contentSize].width, [scrollView contentSize].height)] autorelease];
+	[scrollView setDocumentView:waveform];
+	[content addSubview:scrollView];
+	[self addButton:NSLocalizedString(@"Zoom In", nil) action:@selector(zoomIn:) target:waveform at:8];
+	[self addButton:NSLocalizedString(@"Zoom Out", nil) action:@selector(zoomOut:) target:waveform at:8 + kButtonWidth];
+	[self addButton:NSLocalizedString(@"Fit", nil) action:@selector(zoomToFit:) target:waveform at:8 + kButtonWidth * 2];
+	[self addButton:NSLocalizedString(@"Play", nil) action:@selector(playSound:) target:self at:16 + kButtonWidth * 3];
+	[self addButton:NSLocalizedString(@"Pause", nil) action:@selector(pauseSound:) target:self at:16 + kButtonWidth * 4];
+	[self addButton:NSLocalizedString(@"Stop", nil) action:@selector(stopSound:) target:self at:16 + kButtonWidth * 5];
+	[waveform setTarget:self];
+	[waveform setAction:@selector(waveformClicked:)];
+
+	if(![waveform setSoundData:[resource data]])
+		NSLog(@"Couldn't decode the sound of %@ %@.", [resource type], [resource resID]);
+	[self windowDidLoad];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[(id)resource release];
+	[super dealloc];
+}
+
+- (void)windowDidLoad
+{
+	[super windowDidLoad];
+
+	// set the window's title
+	if([[resource name] isEqualToString:@""])
+		[[self window] setTitle:[NSString stringWithFormat:@"%@ %@", [resource type], [resource resID]]];
+	else
+	{
+		[[self window] setTitle:[resource name]];
+		SetWindowAlternateTitle((WindowRef) [[self window] windowRef], (CFStringRef) [NSString stringWithFormat:NSLocalizedString(@"%@ %@: '%@'", nil), [resource type], [resource resID], [resource name]]);
+	}
+
+	// we don't want this notification until we have a window! (Only register for notifications on the resource we're editing)
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:resource];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(voiceDidFinish:) name:@"SoundPlayerVoiceDidFinishNotification" object:nil];
+
+	// finally, show the window
+	[self showWindow:self];
+}
+
+- (void)windowWillClose:(NSNotification *)notification
+{
+	// any peaks still being found are thrown away
+	[self stopSound:nil];
+	[waveform setSoundData:nil];
+}
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	[self stopSound:nil];
+	[waveform setSoundData:[resource data]];
+}
+
+/* Converted exports are WAV files of the sound decoded to 16 bits, made on the host's export workers. */
++ (NSData *)dataForFileConversion:(id <ResKnifeResourceProtocol>)exportResource
+{
+	NSData *data = [exportResource data];
+	NSMutableData *wav;
+	SoundDecoder decoder;
+	SInt16 *pcm;
+	UInt32 channels, decoded = 0, frames, i;
+	if(SoundDecoderOpen([data bytes], [data length], &decoder) != kSoundNoError)
+		return nil;
+	channels = decoder.info.channels;
+	if(channels == 0 || decoder.info.frames > (0x7FFFFFFF - kSoundWAVHeaderSize) / (channels * 2))
+		return nil;
+
+	wav = [NSMutableData dataWithLength:kSoundWAVHeaderSize + decoder.info.frames * channels * 2];
+	SoundWriteWAVHeader(&decoder.info, [wav mutableBytes]);
+	pcm = (SInt16 *) ((UInt8 *) [wav mutableBytes] + kSoundWAVHeaderSize);
+	while(decoded < decoder.info.frames && (frames = SoundDecode(&decoder, pcm + decoded * channels, MIN(kSoundBlockFrames, decoder.info.frames - decoded))))
+		decoded += frames;
+
+	// WAV samples are little-endian
+	for(i = 0; i < decoded * channels; i++)
+		pcm[i] = (SInt16) NSSwapHostShortToLittle((unsigned short) pcm[i]);
+	return wav;
+}
+
++ (NSString *)filenameExtensionForFileConversion:(id <ResKnifeResourceProtocol>)exportResource
+{
+	return @"wav";
+}
+
+- (IBAction)playSound:(id)sender
+{
+	if(voice && paused)
+	{
+		[[self player] resumeVoice:voice];
+		paused = NO;
+	}
+	else if(!voice)
+	{
+		voice = [[self player] playSoundData:[resource data]];
+		paused = NO;
+		if(!voice) NSBeep();
+	}
+}
+
+- (IBAction)pauseSound:(id)sender
+{
+	if(!voice) return;
+	if(paused) [[self player] resumeVoice:voice];
+	else [[self player] pauseVoice:voice];
+	paused = !paused;
+}
+
+- (IBAction)stopSound:(id)sender
+{
+	if(voice) [[self player] stopVoice:voice];
+	voice = 0;
+	paused = NO;
+}
+
+#pragma mark -
+
+- (NSButton *)addButton:(NSString *)title action:(SEL)action target:(id)target at:(float)x
+{
+	NSView *content = [[self window] contentView];
+	NSButton *button = [[[NSButton alloc] initWithFrame:NSMakeRect(x, NSMaxY([content bounds]) - kButtonHeight + 2, kButtonWidth, kButtonHeight - 4)] autorelease];
+	[button setTitle:title];
+	[button setBezelStyle:NSRoundedBezelStyle];
+	[button setTarget:target];
+	[button setAction:action];
+	[button setAutoresizingMask:NSViewMaxXMargin | NSViewMinYMargin];
+	[content addSubview:button];
+	return button;
+}
+
+- (SoundPlayer *)player
+{
+	// the host's, shared by every sound played
+	return [NSClassFromString(@"SoundPlayer") sharedPlayer];
+}
+
+- (void)waveformClicked:(id)sender
+{
+	if(!voice) [self playSound:sender];
+	[[self player] seekVoice:voice toFrame:[waveform clickedFrame]];
+}
+
+- (void)voiceDidFinish:(NSNotification *)notification
+{
+	if([[[notification userInfo] objectForKey:@"voice"] unsignedLongValue] == voice)
+	{
+		voice = 0;
+		paused = NO;
+	}
+}
+
+@end
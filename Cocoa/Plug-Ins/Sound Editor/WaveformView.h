@@ -0,0 +1,49 @@
+#import <Cocoa/Cocoa.h>
+#import "../../Classes/SoundDecoder.h"
+#import "SoundPeaks.h"
+
+/*!
+@class			WaveformView
+@abstract		Draws a sound's waveform, a lane per channel, at any number of frames per pixel, for use as a scroll view's document view.
+@description	The sound's peaks are found on a thread of their own when it's given, decoding a block at a time; the view is blank until they're ready. Each repaint then only looks at a few peaks for each pixel in the rect being drawn, or when zoomed in closer than the peaks go, decodes just the frames under it. Peaks found for a sound since replaced are thrown away.
+*/
+
+@interface WaveformView : NSView
+{
+	NSData			*soundData;		// the decoder reads from this
+	SoundDecoder	decoder;		// for drawing samples, zoomed in too far for peaks
+	BOOL			hasSound;
+	SoundPeaks		*peaks;			// NULL until they've been found
+	unsigned		generation;		// counts sounds given
+	double			framesPerPixel;
+	id				target;			// told when the view's clicked
+	SEL				action;
+	UInt32			clickedFrame;
+}
+
+/*!
+@method		setSoundData:
+@abstract	Shows the 'snd ' resource data given, or nothing if it's nil or can't be decoded. Returns whether it could be.
+*/
+- (BOOL)setSoundData:(NSData *)data;
+
+/*!
+@method		setFramesPerPixel:
+@abstract	Zooms, keeping the frame in the middle of the view where it is.
+*/
+- (void)setFramesPerPixel:(double)frames;
+- (double)framesPerPixel;
+
+- (IBAction)zoomIn:(id)sender;
+- (IBAction)zoomOut:(id)sender;
+- (IBAction)zoomToFit:(id)sender;
+
+/*!
+@method		setTarget:
+@abstract	Sets the object sent the action when the view's clicked, which can then ask which frame was clicked on.
+*/
+- (void)setTarget:(id)object;
+- (void)setAction:(SEL)selector;
+- (UInt32)clickedFrame;
+
+@end
@@ -0,0 +1,302 @@
+#import "WaveformView.h"
+
+enum
+{
+	kLaneGap = 4,
+	kMaxPixelsPerFrame = 16
+};
+
+@interface WaveformView (Private)
+- (void)tile;
+- (double)fitFramesPerPixel;
+- (void)superviewFrameDidChange:(NSNotification *)notification;
+- (void)peaksThread:(NSArray *)dataAndGeneration;
+- (void)peaksDidLoad:(NSArray *)peaksAndGeneration;
+- (void)getPeaks:(SoundPeak *)out channel:(UInt32)channel firstPixel:(UInt32)first pixels:(UInt32)pixels samples:(const SInt16 *)pcm firstFrame:(UInt32)firstFrame frames:(UInt32)frames;
+@end
+
+@implementation WaveformView
+
+- (id)initWithFrame:(NSRect)frame
+{
+	self = [super initWithFrame:frame];
+	if(!self) return nil;
+	framesPerPixel = kSoundPeakFrames;
+	memset(&decoder, 0, sizeof(decoder));
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[soundData release];
+	if(peaks)
+	{
+		SoundPeaksFree(peaks);
+		free(peaks);
+	}
+	[super dealloc];
+}
+
+- (BOOL)isOpaque
+{
+	return YES;
+}
+
+- (void)viewDidMoveToSuperview
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self name:NSViewFrameDidChangeNotification object:nil];
+	if([self superview])
+	{
+		[[self superview] setPostsFrameChangedNotifications:YES];
+		[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(superviewFrameDidChange:) name:NSViewFrameDidChangeNotification object:[self superview]];
+		[self tile];
+	}
+}
+
+- (BOOL)setSoundData:(NSData *)data
+{
+	// peaks still being found for the old sound are thrown away when they arrive
+	generation++;
+	if(peaks)
+	{
+		SoundPeaksFree(peaks);
+		free(peaks);
+		peaks = NULL;
+	}
+	[data retain];
+	[soundData release];
+	soundData = data;
+	hasSound = (data && SoundDecoderOpen((const UInt8 *)[data bytes], [data length], &decoder) == kSoundNoError && decoder.info.frames > 0);
+	if(!hasSound) memset(&decoder, 0, sizeof(decoder));
+	else [NSThread detachNewThreadSelector:@selector(peaksThread:) toTarget:self withObject:[NSArray arrayWithObjects:data, [NSNumber numberWithUnsignedInt:generation], nil]];
+
+	framesPerPixel = [self fitFramesPerPixel];
+	[self tile];
+	[self setNeedsDisplay:YES];
+	return hasSound;
+}
+
+- (void)setFramesPerPixel:(double)frames
+{
+	NSRect visible = [self visibleRect];
+	double middle = NSMidX(visible) * framesPerPixel;
+	double fit = [self fitFramesPerPixel];
+
+	if(frames > fit) frames = fit;
+	if(frames < 1.0 / kMaxPixelsPerFrame) frames = 1.0 / kMaxPixelsPerFrame;
+	if(frames == framesPerPixel) return;
+	framesPerPixel = frames;
+	[self tile];
+	[self scrollPoint:NSMakePoint(floor(middle / framesPerPixel - NSWidth(visible) / 2), NSMinY(visible))];
+	[self setNeedsDisplay:YES];
+}
+
+- (double)framesPerPixel
+{
+	return framesPerPixel;
+}
+
+- (IBAction)zoomIn:(id)sender
+{
+	[self setFramesPerPixel:framesPerPixel / 2];
+}
+
+- (IBAction)zoomOut:(id)sender
+{
+	[self setFramesPerPixel:framesPerPixel * 2];
+}
+
+- (IBAction)zoomToFit:(id)sender
+{
+	[self setFramesPerPixel:[self fitFramesPerPixel]];
+}
+
+- (void)setTarget:(id)object
+{
+	target = object;
+}
+
+- (void)setAction:(SEL)selector
+{
+	action = selector;
+}
+
+- (UInt32)clickedFrame
+{
+	return clickedFrame;
+}
+
+- (void)mouseDown:(NSEvent *)event
+{
+	double frame = [self convertPoint:[event locationInWindow] fromView:nil].x * framesPerPixel;
+	if(!hasSound) return;
+	clickedFrame = (frame <= 0)? 0 : (frame >= decoder.info.frames)? decoder.info.frames : (UInt32) frame;
+	if(action) [NSApp sendAction:action to:target from:self];
+}
+
+- (void)drawRect:(NSRect)rect
+{
+	NSRect bounds = [self bounds];
+	UInt32 channels = decoder.info.channels, channel, pixel;
+	UInt32 first = (UInt32) MAX(floor(NSMinX(rect)), 0), pixels = (UInt32) ceil(NSMaxX(rect)) - first;
+	float laneHeight = (channels? (NSHeight(bounds) - kLaneGap * (channels -1)) / channels : 0);
+	SoundPeak *peak;
+	NSRect *bars;
+	SInt16 *pcm = NULL;
+	UInt32 firstFrame = 0, frames = 0;
+
+	[[NSColor whiteColor] set];
+	NSRectFill(rect);
+	if(!hasSound || pixels == 0 || laneHeight < 1) return;
+
+	// zoomed in too far for peaks, decode just the frames under the rect (and one either side, to join them up)
+	if(framesPerPixel < kSoundPeakFrames)
+	{
+		double start = floor(first * framesPerPixel);
+		firstFrame = (start > 1)? (UInt32) start -1 : 0;
+		frames = (UInt32) ceil((first + pixels) * framesPerPixel) + 2 - firstFrame;
+		pcm = (SInt16 *) malloc(frames * channels * sizeof(SInt16));
+		if(!pcm) return;
+		SoundDecoderSeek(&decoder, firstFrame);
+		frames = SoundDecode(&decoder, pcm, frames);
+	}
+	else if(!peaks)
+	{
+		// still being found
+		[[NSColor lightGrayColor] set];
+		for(channel = 0; channel < channels; channel++)
+			NSRectFill(NSMakeRect(NSMinX(rect), NSMaxY(bounds) - channel * (laneHeight + kLaneGap) - floorf(laneHeight / 2) -1, NSWidth(rect), 1));
+		return;
+	}
+
+	peak = (SoundPeak *) malloc(pixels * sizeof(SoundPeak));
+	bars = (NSRect *) malloc(pixels * sizeof(NSRect));
+	if(peak && bars) for(channel = 0; channel < channels; channel++)
+	{
+		// channels top to bottom, a lane each
+		float top = NSMaxY(bounds) - channel * (laneHeight + kLaneGap);
+		float middle = top - laneHeight / 2, scale = laneHeight / 65536.0f;
+
+		[[NSColor lightGrayColor] set];
+		NSRectFill(NSMakeRect(NSMinX(rect), floorf(middle), NSWidth(rect), 1));
+
+		if(pcm) [self getPeaks:peak channel:channel firstPixel:first pixels:pixels samples:pcm firstFrame:firstFrame frames:frames];
+		else SoundPeaksGet(peaks, channel, first * framesPerPixel, framesPerPixel, pixels, peak);
+		for(pixel = 0; pixel < pixels; pixel++)
+		{
+			float low = floorf(middle + peak[pixel].min * scale);
+			float high = ceilf(middle + peak[pixel].max * scale);
+			bars[pixel] = NSMakeRect(first + pixel, low, 1, MAX(high - low, 1));
+		}
+		[[NSColor colorWithCalibratedRed:0.1f green:0.3f blue:0.6f alpha:1.0f] set];
+		NSRectFillList(bars, pixels);
+	}
+	free(peak);
+	free(bars);
+	free(pcm);
+}
+
+#pragma mark -
+
+- (double)fitFramesPerPixel
+{
+	NSView *clipView = [self superview];
+	float width = clipView? NSWidth([clipView frame]) : NSWidth([self frame]);
+	if(!hasSound || width < 1) return kSoundPeakFrames;
+	return MAX(decoder.info.frames / width, 1.0 / kMaxPixelsPerFrame);
+}
+
+- (void)tile
+{
+	NSView *clipView = [self superview];
+	NSSize size = clipView? [clipView frame].size : [self frame].size;
+	if(hasSound && decoder.info.frames / framesPerPixel > size.width)
+		size.width = ceil(decoder.info.frames / framesPerPixel);
+	if(!NSEqualSizes(size, [self frame].size))
+		[self setFrameSize:size];
+}
+
+- (void)superviewFrameDidChange:(NSNotification *)notification
+{
+	// showing the whole sound stays that way
+	BOOL fitted = (framesPerPixel * NSWidth([self frame]) <= decoder.info.frames +1);
+	if(fitted) framesPerPixel = [self fitFramesPerPixel];
+	[self tile];
+	[self setNeedsDisplay:YES];
+}
+
+- (void)peaksThread:(NSArray *)dataAndGeneration
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+	NSData *data = [dataAndGeneration objectAtIndex:0];
+	unsigned peaksGeneration = [[dataAndGeneration objectAtIndex:1] unsignedIntValue];
+	SoundDecoder peaksDecoder;
+	SoundPeaks *newPeaks = (SoundPeaks *) malloc(sizeof(SoundPeaks));
+	SInt16 *pcm = NULL;
+	UInt32 frames;
+
+	if(newPeaks && SoundDecoderOpen((const UInt8 *)[data bytes], [data length], &peaksDecoder) == kSoundNoError)
+	{
+		if(SoundPeaksInit(newPeaks, peaksDecoder.info.channels, peaksDecoder.info.frames))
+		{
+			pcm = (SInt16 *) malloc(kSoundBlockFrames * peaksDecoder.info.channels * sizeof(SInt16));
+			// generation is only read here; a sound given meanwhile just means stopping early
+			while(pcm && peaksGeneration == generation && (frames = SoundDecode(&peaksDecoder, pcm, kSoundBlockFrames)))
+				SoundPeaksAdd(newPeaks, pcm, frames);
+			SoundPeaksFinish(newPeaks);
+			free(pcm);
+			if(peaksGeneration == generation)
+			{
+				[self performSelectorOnMainThread:@selector(peaksDidLoad:) withObject:[NSArray arrayWithObjects:[NSValue valueWithPointer:newPeaks], [NSNumber numberWithUnsignedInt:peaksGeneration], nil] waitUntilDone:NO];
+				newPeaks = NULL;
+			}
+			else SoundPeaksFree(newPeaks);
+		}
+	}
+	free(newPeaks);
+	[pool release];
+}
+
+- (void)peaksDidLoad:(NSArray *)peaksAndGeneration
+{
+	SoundPeaks *newPeaks = (SoundPeaks *) [[peaksAndGeneration objectAtIndex:0] pointerValue];
+
+	// found for a sound since replaced
+	if([[peaksAndGeneration objectAtIndex:1] unsignedIntValue] != generation)
+	{
+		SoundPeaksFree(newPeaks);
+		free(newPeaks);
+		return;
+	}
+	peaks = newPeaks;
+	[self setNeedsDisplay:YES];
+}
+
+- (void)getPeaks:(SoundPeak *)out channel:(UInt32)channel firstPixel:(UInt32)first pixels:(UInt32)pixels samples:(const SInt16 *)pcm firstFrame:(UInt32)firstFrame frames:(UInt32)frames
+{
+	UInt32 channels = decoder.info.channels, pixel;
+	for(pixel = 0; pixel < pixels; pixel++)
+	{
+		// the frames under the pixel, and the one after so neighbouring pixels meet
+		double start = (first + pixel) * framesPerPixel;
+		SInt32 from = (SInt32) floor(start) - (SInt32) firstFrame;
+		SInt32 to = (SInt32) ceil(start + framesPerPixel) - (SInt32) firstFrame, i;
+		SoundPeak peak = { 0, 0 };
+		if(from < 0) from = 0;
+		if(to >= (SInt32) frames) to = (SInt32) frames -1;
+		if(from <= to)
+		{
+			peak.min = peak.max = pcm[from * channels + channel];
+			for(i = from + 1; i <= to; i++)
+			{
+				SInt16 sample = pcm[i * channels + channel];
+				if(sample < peak.min) peak.min = sample;
+				if(sample > peak.max) peak.max = sample;
+			}
+		}
+		out[pixel] = peak;
+	}
+}
+
+@end
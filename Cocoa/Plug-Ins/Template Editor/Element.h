@@ -1,6 +1,8 @@
 #import <Foundation/Foundation.h>
 #import "TemplateStream.h"
 
+#define kUnboundedSize	UINT_MAX	// returned by -maximumSizeOnDisk for fields with no upper limit
+
 /*
 	This is the base class for all template field types. Subclass this to
 	define a field type of your own.
@@ -18,6 +20,9 @@
 	NSString *type;					// Type code of this item (4 chars if from TMPL resource, but we may support longer types later).
 	NSString *label;				// Label ("name") of this field.
 	NSMutableArray *parentArray;	// The NSMutableArray* of the template field containing us, or the template window's list.
+	NSMutableArray *caseElements;	// CASE elements following this field in the TMPL (shared with copies).
+	NSMutableArray *keyedSections;	// KEYB sections selected by this field's value, if it is a key field (shared with copies).
+	NSMutableDictionary *caseMap;	// Precompiled key value -> KEYB section lookup (shared with copies).
 }
 
 + (id)elementForType:(NSString *)type withLabel:(NSString *)label;
@@ -39,6 +44,15 @@
 - (void)setParentArray:(NSMutableArray *)array;
 - (NSMutableArray *)parentArray;
 
+// Key fields (KBYT, KWRD, KUBT, KCHR, KTYP etc.) own the CASE values and KEYB sections that follow them in the TMPL:
+- (BOOL)isKey;
+- (NSArray *)caseElements;
+- (NSArray *)keyedSections;
+- (void)addCaseElement:(Element *)element;
+- (void)addKeyedSection:(Element *)section;
+- (Element *)sectionForKeyValue:(NSString *)value;
+- (NSArray *)unreachableSections;	// sections whose every key value is claimed by an earlier section
+
 - (NSString *)stringValue; // Used to display your data in the list.
 - (BOOL)editable;
 
@@ -50,10 +64,18 @@
 // This is called on an item of your class when displaying resource data using a template that uses your field:
 - (void)readDataFrom:(TemplateStream *)stream;
 
+// When every field of a template is fixed-width the resource is byte-swapped in one pass (see FixedWidth.h) and each element is then handed a pointer to its own already host-ordered bytes. Numeric fields must override this; those which don't (strings, hex and fillers, which aren't swapped) are read with -readDataFrom: from one stream over the whole resource instead, and the default is only there for other callers.
+- (void)readFixedWidthValueFrom:(const void *)bytes;
+
 // The following are used to write resource data back out:
 - (unsigned int)sizeOnDisk;
 - (void)writeDataTo:(TemplateStream *)stream;
 
+// Called on TMPL elements to bound the size of resources before any are read (see TemplateLint). The defaults return -sizeOnDisk, which is right for fixed-width fields, plus the smallest/largest keyed section if this is a key.
+- (unsigned int)minimumSizeOnDisk;
+- (unsigned int)maximumSizeOnDisk;
++ (void)getMinimumSize:(unsigned int *)min maximumSize:(unsigned int *)max ofElements:(NSArray *)elements;
+
 /* Apart from these messages, a Element may also implement the IBActions for
 	the standard edit commands (cut, copy, paste, clear). When an element is selected,
 	the template editor will forward any calls to these items to the element, if it
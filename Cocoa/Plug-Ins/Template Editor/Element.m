@@ -1,4 +1,6 @@
 #import "Element.h"
+#import "ElementCASE.h"
+#import "ElementKEYB.h"
 
 @implementation Element
 
@@ -20,6 +22,9 @@
 {
 	[label release];
 	[type release];
+	[caseElements release];
+	[keyedSections release];
+	[caseMap release];
 	[super dealloc];
 }
 
@@ -27,6 +32,11 @@
 {
 	Element *element = [[[self class] allocWithZone:zone] initForType:type withLabel:label];
 	[element setParentArray:parentArray];
+	
+	// the compiled key tables are read-only once the TMPL has been parsed, so share them
+	element->caseElements = [caseElements retain];
+	element->keyedSections = [keyedSections retain];
+	element->caseMap = [caseMap retain];
 	return element;
 }
 
@@ -77,6 +87,132 @@
 	return parentArray;
 }
 
+#pragma mark -
+#pragma mark Key Fields
+
+- (BOOL)isKey
+{
+	return [keyedSections count] > 0;
+}
+
+- (NSArray *)caseElements
+{
+	return caseElements;
+}
+
+- (NSArray *)keyedSections
+{
+	return keyedSections;
+}
+
+- (void)addCaseElement:(Element *)element
+{
+	if(!caseElements) caseElements = [[NSMutableArray alloc] init];
+	[caseElements addObject:element];
+}
+
+/* A KEYB label names the key value(s) that select it, either literally or via the symbol of a preceeding CASE,
+	e.g. "1", "$0001", "Circle" or "Circle,Oval". These are resolved once here, so that picking the section
+	for a resource is a single dictionary lookup no matter how many cases the key has. */
+- (void)addKeyedSection:(Element *)section
+{
+	if(!keyedSections)	keyedSections = [[NSMutableArray alloc] init];
+	if(!caseMap)		caseMap = [[NSMutableDictionary alloc] init];
+	[keyedSections addObject:section];
+	
+	NSString *token;
+	NSEnumerator *enumerator = [[[section label] componentsSeparatedByString:@","] objectEnumerator];
+	while(token = [enumerator nextObject])
+	{
+		Element *caseElement;
+		NSString *value = [token stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+		NSEnumerator *caseEnumerator = [caseElements objectEnumerator];
+		while(caseElement = [caseEnumerator nextObject])
+		{
+			if([[(ElementCASE *)caseElement caseSymbol] isEqualToString:value])
+			{
+				value = [(ElementCASE *)caseElement caseValue];
+				break;
+			}
+		}
+		
+		// first section wins if a template lists the same value twice
+		NSString *key = [ElementCASE normalisedValue:value];
+		if(![caseMap objectForKey:key])
+			[caseMap setObject:section forKey:key];
+	}
+}
+
+- (Element *)sectionForKeyValue:(NSString *)value
+{
+	if(!value) return nil;
+	return [caseMap objectForKey:[ElementCASE normalisedValue:value]];
+}
+
+- (NSArray *)unreachableSections
+{
+	NSMutableArray *unreachable = [NSMutableArray arrayWithArray:keyedSections];
+	[unreachable removeObjectsInArray:[caseMap allValues]];
+	return unreachable;
+}
+
+#pragma mark -
+#pragma mark Size Bounds
+
++ (void)getMinimumSize:(unsigned int *)min maximumSize:(unsigned int *)max ofElements:(NSArray *)elements
+{
+	Element *element;
+	NSEnumerator *enumerator = [elements objectEnumerator];
+	*min = 0;
+	*max = 0;
+	while(element = [enumerator nextObject])
+	{
+		unsigned int elementMax = [element maximumSizeOnDisk];
+		*min += [element minimumSizeOnDisk];
+		if(*max == kUnboundedSize || elementMax == kUnboundedSize || *max + elementMax < *max)
+			*max = kUnboundedSize;
+		else *max += elementMax;
+	}
+}
+
+- (unsigned int)minimumSizeOnDisk
+{
+	unsigned int size = [self sizeOnDisk];
+	if([self isKey])
+	{
+		// only one section is present in any given resource
+		ElementKEYB *section;
+		unsigned int smallest = kUnboundedSize, min, max;
+		NSEnumerator *enumerator = [keyedSections objectEnumerator];
+		while(section = [enumerator nextObject])
+		{
+			[section getSectionMinimum:&min maximum:&max];
+			if(min < smallest) smallest = min;
+		}
+		size += smallest;
+	}
+	return size;
+}
+
+- (unsigned int)maximumSizeOnDisk
+{
+	unsigned int size = [self sizeOnDisk];
+	if([self isKey])
+	{
+		ElementKEYB *section;
+		unsigned int largest = 0, min, max;
+		NSEnumerator *enumerator = [keyedSections objectEnumerator];
+		while(section = [enumerator nextObject])
+		{
+			[section getSectionMinimum:&min maximum:&max];
+			if(max > largest) largest = max;
+		}
+		if(largest == kUnboundedSize || size + largest < size) return kUnboundedSize;
+		size += largest;
+	}
+	return size;
+}
+
 /*** METHODS SUBCLASSES SHOULD OVERRIDE ***/
 
 - (int)subElementCount
@@ -103,6 +239,11 @@
 	NSLog(@"-readDataFrom:called on non-concrete class Element");
 }
 
+- (void)readFixedWidthValueFrom:(const void *)bytes
+{
+	[self readDataFrom:[TemplateStream streamWithBytes:(char *)bytes length:[self sizeOnDisk]]];
+}
+
 // Before writeDataTo:is called, this is called to calculate the final resource size:
 //	Items with sub-elements should return the sum of the sizes of all their sub-elements here as well.
 - (unsigned int)sizeOnDisk
@@ -0,0 +1,21 @@
+#import "Element.h"
+#import "FixedWidth.h"
+
+@interface ElementBBIT : Element
+{
+	UInt32 value;
+	FixedWidthField field;	// which bits of which size of unit we occupy
+}
+
+- (void)setValue:(UInt32)v;
+- (UInt32)value;
+- (void)setBitOffset:(unsigned int)offset;
+- (unsigned int)bitOffset;
+- (unsigned int)bitCount;
+- (unsigned int)unitWidth;
+- (BOOL)isLastInUnit;
+
+- (NSString *)stringValue;
+- (void)setStringValue:(NSString *)str;
+
+@end
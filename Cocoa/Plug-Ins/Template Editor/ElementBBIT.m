@@ -0,0 +1,115 @@
+#import "ElementBBIT.h"
+
+/* Bit fields pack from the most significant bit of a byte, word or long, and
+	the unit is only consumed from the stream by the field which fills it. The
+	others peek at it when reading and poke their bits into it when writing. */
+
+// implements BBIT, BBnn, WBIT, WBnn, LBIT, LBnn
+@implementation ElementBBIT
+
+- (id)initForType:(NSString *)t withLabel:(NSString *)l
+{
+	self = [super initForType:t withLabel:l];
+	if(!self) return nil;
+	if(!FixedWidthFieldForType([t cString], &field) || field.kind != kFixedWidthBits)
+	{
+		memset(&field, 0, sizeof(field));
+		field.width = 1;
+		field.bitCount = 8;
+	}
+	return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	ElementBBIT *element = [super copyWithZone:zone];
+	[element setBitOffset:field.bitOffset];
+	[element setValue:value];
+	return element;
+}
+
+- (void)readSubElementsFrom:(TemplateStream *)stream
+{
+	// not really sub-elements, but this is where we find out which bits of the unit are ours
+	[self setBitOffset:[stream claimBits:field.bitCount ofUnit:field.width]];
+}
+
+- (void)readDataFrom:(TemplateStream *)stream
+{
+	UInt8 unit[4] = { 0 };
+	[stream peekAmount:field.width toBuffer:unit];
+	value = FixedWidthExtractBits(FixedWidthReadBig(unit, field.width), &field);
+	[stream advanceAmount:[self sizeOnDisk] pad:NO];
+}
+
+- (void)readFixedWidthValueFrom:(const void *)bytes
+{
+	value = FixedWidthExtractBits(FixedWidthReadHost(bytes, field.width), &field);
+}
+
+- (unsigned int)sizeOnDisk
+{
+	return [self isLastInUnit]? field.width : 0;
+}
+
+- (void)writeDataTo:(TemplateStream *)stream
+{
+	// only this field's bits are replaced, so the unit's other fields survive whichever one is written
+	UInt8 unit[4] = { 0 };
+	[stream peekAmount:field.width toBuffer:unit];
+	FixedWidthWriteBig(unit, field.width, FixedWidthInsertBits(FixedWidthReadBig(unit, field.width), &field, value));
+	if([self isLastInUnit])
+		[stream writeAmount:field.width fromBuffer:unit];
+	else [stream pokeAmount:field.width fromBuffer:unit];
+}
+
+- (void)setValue:(UInt32)v
+{
+	value = v;
+}
+
+- (UInt32)value
+{
+	return value;
+}
+
+- (void)setBitOffset:(unsigned int)offset
+{
+	field.bitOffset = offset;
+}
+
+- (unsigned int)bitOffset
+{
+	return field.bitOffset;
+}
+
+- (unsigned int)bitCount
+{
+	return field.bitCount;
+}
+
+- (unsigned int)unitWidth
+{
+	return field.width;
+}
+
+- (BOOL)isLastInUnit
+{
+	return field.bitOffset + field.bitCount >= field.width * 8;
+}
+
+- (NSString *)stringValue
+{
+	return [NSString stringWithFormat:@"%lu", (unsigned long) value];
+}
+
+- (void)setStringValue:(NSString *)str
+{
+	char cstr[256];
+	char *endPtr = cstr + 255;
+	strncpy(cstr, [str cString], 255);
+	value = strtoul(cstr, &endPtr, 10);
+	if(field.bitCount < 32) value &= (1UL << field.bitCount) - 1;
+}
+
+@end
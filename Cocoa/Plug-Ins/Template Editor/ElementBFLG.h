@@ -0,0 +1,16 @@
+#import "Element.h"
+
+@interface ElementBFLG : Element
+{
+	UInt32 value;			// raw value, so that set bits other than the one we display survive a round trip
+	unsigned int width;
+}
+
+- (void)setValue:(UInt32)v;
+- (UInt32)value;
+- (BOOL)boolValue;
+
+- (NSString *)stringValue;
+- (void)setStringValue:(NSString *)str;
+
+@end
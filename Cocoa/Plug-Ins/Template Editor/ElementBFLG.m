@@ -0,0 +1,79 @@
+#import "ElementBFLG.h"
+#import "FixedWidth.h"
+
+// implements BFLG, WFLG, LFLG, BOOL
+@implementation ElementBFLG
+
+- (id)initForType:(NSString *)t withLabel:(NSString *)l
+{
+	self = [super initForType:t withLabel:l];
+	if(!self) return nil;
+	FixedWidthField field;
+	if(FixedWidthFieldForType([t cString], &field))
+		width = field.width;
+	else width = 1;
+	return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	ElementBFLG *element = [super copyWithZone:zone];
+	[element setValue:value];
+	return element;
+}
+
+- (void)readDataFrom:(TemplateStream *)stream
+{
+	UInt8 buffer[4] = { 0 };
+	[stream readAmount:width toBuffer:buffer];
+	value = FixedWidthReadBig(buffer, width);
+}
+
+- (void)readFixedWidthValueFrom:(const void *)bytes
+{
+	value = FixedWidthReadHost(bytes, width);
+}
+
+- (unsigned int)sizeOnDisk
+{
+	return width;
+}
+
+- (void)writeDataTo:(TemplateStream *)stream
+{
+	UInt8 buffer[4];
+	FixedWidthWriteBig(buffer, width, value);
+	[stream writeAmount:width fromBuffer:buffer];
+}
+
+- (void)setValue:(UInt32)v
+{
+	value = v;
+}
+
+- (UInt32)value
+{
+	return value;
+}
+
+- (BOOL)boolValue
+{
+	return value != 0;
+}
+
+- (NSString *)stringValue
+{
+	return value? @"true" : @"false";
+}
+
+- (void)setStringValue:(NSString *)str
+{
+	NSString *lower = [[str stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] lowercaseString];
+	BOOL flag = [lower hasPrefix:@"t"] || [lower hasPrefix:@"y"] || [lower hasPrefix:@"1"];
+	if(flag == [self boolValue]) return;
+	if(!flag) value = 0;
+	else if([type isEqualToString:@"BOOL"]) value = 0x0100;	// a Boolean in the high byte of a word
+	else value = 1;
+}
+
+@end
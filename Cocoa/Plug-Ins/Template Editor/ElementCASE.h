@@ -0,0 +1,14 @@
+#import "Element.h"
+
+@interface ElementCASE : Element
+{
+	NSString *caseSymbol;	// the part of the label before the '=', displayed to the user
+	NSString *caseValue;	// the part after, compared against the value of the preceeding field
+}
+
++ (NSString *)normalisedValue:(NSString *)value;
+
+- (NSString *)caseSymbol;
+- (NSString *)caseValue;
+
+@end
@@ -0,0 +1,86 @@
+#import "ElementCASE.h"
+
+// implements CASE
+@implementation ElementCASE
+
+/* CASE values and key fields may spell the same number differently ("1", "$01", "0x0001"),
+	so convert numeric values to decimal before using them as a lookup key. */
++ (NSString *)normalisedValue:(NSString *)value
+{
+	const char *cstr = [value cString];
+	const char *digits = cstr;
+	int base = 10;
+	BOOL negative = NO;
+	if(!cstr || *cstr == 0x00) return value;
+	if(*digits == '-')						{ negative = YES; digits++; }
+	if(*digits == '$')						{ base = 16; digits++; }
+	else if(digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))	{ base = 16; digits += 2; }
+	if(*digits == 0x00) return value;
+	
+	char *endPtr = NULL;
+	unsigned long long number = strtoull(digits, &endPtr, base);
+	if(*endPtr != 0x00) return value;	// not a number, e.g. a KTYP or KCHR value
+	if(negative)	return [NSString stringWithFormat:@"%lld", -(long long) number];
+	else			return [NSString stringWithFormat:@"%llu", number];
+}
+
+- (id)initForType:(NSString *)t withLabel:(NSString *)l
+{
+	self = [super initForType:t withLabel:l];
+	if(!self) return nil;
+	NSRange equals = [l rangeOfString:@"=" options:NSBackwardsSearch];
+	if(equals.location != NSNotFound)
+	{
+		caseSymbol = [[l substringToIndex:equals.location] copy];
+		caseValue = [[l substringFromIndex:equals.location +1] copy];
+	}
+	else
+	{
+		caseSymbol = [l copy];
+		caseValue = [l copy];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[caseSymbol release];
+	[caseValue release];
+	[super dealloc];
+}
+
+- (void)readDataFrom:(TemplateStream *)stream
+{
+	// cases only describe the template, they have no presence in the resource or its display
+	[parentArray removeObject:self];
+}
+
+- (void)writeDataTo:(TemplateStream *)stream
+{
+}
+
+- (NSString *)caseSymbol
+{
+	return caseSymbol;
+}
+
+- (NSString *)caseValue
+{
+	return caseValue;
+}
+
+- (NSString *)stringValue
+{
+	return caseValue;
+}
+
+- (void)setStringValue:(NSString *)str
+{
+}
+
+- (BOOL)editable
+{
+	return NO;
+}
+
+@end
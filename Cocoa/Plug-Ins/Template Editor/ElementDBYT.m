@@ -16,6 +16,11 @@
 	[stream readAmount:SIZE_ON_DISK toBuffer:&value];
 }
 
+- (void)readFixedWidthValueFrom:(const void *)bytes
+{
+	memmove(&value, bytes, SIZE_ON_DISK);
+}
+
 - (unsigned int)sizeOnDisk
 {
 	return SIZE_ON_DISK;
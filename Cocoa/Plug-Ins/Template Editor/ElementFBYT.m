@@ -1,17 +1,17 @@
 #import "ElementFBYT.h"
+#import "FixedWidth.h"
 
-// implements FBYT, FWRD, FLNG, FLLG
+// implements FBYT, FWRD, FLNG, FLLG, Fnnn
 @implementation ElementFBYT
 
 - (id)initForType:(NSString *)t withLabel:(NSString *)l
 {
 	self = [super initForType:t withLabel:l];
 	if(!self) return nil;
-	if     ([t isEqualToString:@"FBYT"])	length = 1;
-	else if([t isEqualToString:@"FWRD"])	length = 2;
-	else if([t isEqualToString:@"FLNG"])	length = 4;
-	else if([t isEqualToString:@"FLLG"])	length = 8;
-	else									length = 0;
+	FixedWidthField field;
+	if(FixedWidthFieldForType([t cString], &field) && field.kind == kFixedWidthFiller)
+		length = field.width;
+	else length = 0;
 	return self;
 }
 
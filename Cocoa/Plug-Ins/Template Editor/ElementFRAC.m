@@ -12,6 +12,12 @@
 - (void)readDataFrom:(TemplateStream *)stream
 {
 	[stream readAmount:sizeof(value) toBuffer:&value];
+	value = CFSwapInt32BigToHost(value);
+}
+
+- (void)readFixedWidthValueFrom:(const void *)bytes
+{
+	memmove(&value, bytes, sizeof(value));
 }
 
 - (unsigned int)sizeOnDisk
@@ -21,7 +27,8 @@
 
 - (void)writeDataTo:(TemplateStream *)stream
 {
-	[stream writeAmount:sizeof(value) fromBuffer:&value];
+	UInt32 tmp = CFSwapInt32HostToBig(value);
+	[stream writeAmount:sizeof(tmp) fromBuffer:&tmp];
 }
 
 - (void)setValue:(Fract)v
@@ -3,9 +3,12 @@
 @interface ElementHEXD : Element
 {
 	NSData *value;
+	unsigned long length;	// zero for HEXD, which takes the rest of the resource
 }
 - (void)setValue:(NSData *)d;
 - (NSData *)value;
+- (void)setLength:(unsigned long)l;
+- (unsigned long)length;
 
 - (NSString *)stringValue;
 - (void)setStringValue:(NSString *)str;
@@ -1,18 +1,38 @@
 #import "ElementHEXD.h"
+#import "FixedWidth.h"
 
+// implements HEXD, Hnnn
 @implementation ElementHEXD
 
+- (id)initForType:(NSString *)t withLabel:(NSString *)l
+{
+	self = [super initForType:t withLabel:l];
+	if(!self) return nil;
+	FixedWidthField field;
+	if(FixedWidthFieldForType([t cString], &field) && field.kind == kFixedWidthBytes)
+		length = field.width;
+	else length = 0;
+	return self;
+}
+
+- (void)dealloc
+{
+	[value release];
+	[super dealloc];
+}
+
 - (id)copyWithZone:(NSZone *)zone
 {
 	ElementHEXD *element = [super copyWithZone:zone];
 	[element setValue:value];
+	[element setLength:length];
 	return element;
 }
 
 - (void)readSubElementsFrom:(TemplateStream *)stream
 {
 	// override to tell stream to stop reading any more TMPL fields
-	if([stream bytesToGo] > 0)
+	if(length == 0 && [stream bytesToGo] > 0)
 	{
 		NSLog(@"Warning: Template has fields following hex dump, ignoring them.");
 		[stream setBytesToGo:0];
@@ -21,18 +41,35 @@
 
 - (void)readDataFrom:(TemplateStream *)stream
 {
-	[self setValue:[NSData dataWithBytes:[stream data] length:[stream bytesToGo]]];
-	[stream setBytesToGo:0];
+	unsigned int amount = length? MIN(length, [stream bytesToGo]) : [stream bytesToGo];
+	[self setValue:[NSData dataWithBytes:[stream data] length:amount]];
+	[stream advanceAmount:amount pad:NO];
 }
 
 - (unsigned int)sizeOnDisk
 {
+	if(length) return length;
 	return [value length];
 }
 
+- (unsigned int)minimumSizeOnDisk
+{
+	return length;
+}
+
+- (unsigned int)maximumSizeOnDisk
+{
+	return length? length : kUnboundedSize;
+}
+
 - (void)writeDataTo:(TemplateStream *)stream
 {
-	[stream writeAmount:[value length] fromBuffer:[value bytes]];
+	unsigned int amount = [value length];
+	if(length && amount > length) amount = length;
+	[stream writeAmount:amount fromBuffer:[value bytes]];
+	
+	// fixed-length dumps are padded with zeros if the resource was short when read
+	if(length > amount) [stream advanceAmount:length - amount pad:YES];
 }
 
 - (void)setValue:(NSData *)d
@@ -47,6 +84,16 @@
 	return value;
 }
 
+- (void)setLength:(unsigned long)l
+{
+	length = l;
+}
+
+- (unsigned long)length
+{
+	return length;
+}
+
 - (NSString *)stringValue
 {
 	return [value description];
@@ -54,11 +101,37 @@
 
 - (void)setStringValue:(NSString *)str
 {
+	// accepts the <0123 4567> form returned by -stringValue, or plain hex digits; anything else is skipped
+	NSMutableData *data;
+	const char *cstr = [str cString];
+	int high = -1;
+	if(!length || !cstr) return;
+	
+	data = [NSMutableData dataWithCapacity:length];
+	for(; *cstr && [data length] < length; cstr++)
+	{
+		int digit;
+		if     (*cstr >= '0' && *cstr <= '9') digit = *cstr - '0';
+		else if(*cstr >= 'a' && *cstr <= 'f') digit = *cstr - 'a' + 10;
+		else if(*cstr >= 'A' && *cstr <= 'F') digit = *cstr - 'A' + 10;
+		else continue;
+		
+		if(high < 0) high = digit;
+		else
+		{
+			UInt8 byte = (high << 4) | digit;
+			[data appendBytes:&byte length:1];
+			high = -1;
+		}
+	}
+	[data setLength:length];
+	[self setValue:data];
 }
 
 - (BOOL)editable
 {
-	return NO;
+	// only fixed-length dumps can be edited in place
+	return length != 0;
 }
 
 @end
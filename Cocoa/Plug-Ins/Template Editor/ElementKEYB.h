@@ -4,11 +4,19 @@
 @interface ElementKEYB : Element
 {
 	NSMutableArray *subElements;
+	ElementKEYB *sectionTemplate;	// TMPL equivalent of self, for cloning and for comparing against the key's case map
 }
 
++ (void)compileKeysInElements:(NSArray *)elements;
+
 - (void)setSubElements:(NSMutableArray *)a;
 - (NSMutableArray *)subElements;
 
+- (void)setSectionTemplate:(ElementKEYB *)e;
+- (ElementKEYB *)sectionTemplate;
+
+- (void)getSectionMinimum:(unsigned int *)min maximum:(unsigned int *)max;
+
 @end
 
 @interface ElementKEYE : Element
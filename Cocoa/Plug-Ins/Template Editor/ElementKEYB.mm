@@ -1,12 +1,43 @@
 #import "ElementKEYB.h"
+#import "ElementCASE.h"
 
+// implements KEYB
 @implementation ElementKEYB
 
+/* Links every key field in a parsed TMPL to the CASE and KEYB elements which follow it, recursing into
+	lists and sections. A field followed by KEYB sections becomes a key; CASE elements attach to whichever
+	field precedes them. Called once when the template is read, never when a resource is. */
++ (void)compileKeysInElements:(NSArray *)elements
+{
+	Element *owner = nil;
+	for(unsigned i = 0; i < [elements count]; i++)
+	{
+		Element *element = [elements objectAtIndex:i];
+		if([element class] == [ElementCASE class])
+		{
+			if(owner) [owner addCaseElement:element];
+		}
+		else if([element class] == [ElementKEYB class])
+		{
+			if(owner) [owner addKeyedSection:element];
+			else NSLog(@"Template has KEYB section '%@' with no key field before it.", [element label]);
+		}
+		else owner = element;
+		
+		// sub-elements of lists and sections form their own scope
+		NSMutableArray *children = [NSMutableArray array];
+		for(int j = 0; j < [element subElementCount]; j++)
+			[children addObject:[element subElementAtIndex:j]];
+		if([children count]) [self compileKeysInElements:children];
+	}
+}
+
 - (id)initForType:(NSString *)t withLabel:(NSString *)l
 {
 	self = [super initForType:t withLabel:l];
 	if(!self) return nil;
 	subElements = [[NSMutableArray alloc] init];
+	sectionTemplate = self;
 	return self;
 }
 
@@ -18,7 +49,10 @@
 
 - (id)copyWithZone:(NSZone *)zone
 {
-	return nil;
+	// sub-elements are cloned from the section template when data is read, and only if this section is selected
+	ElementKEYB *element = [super copyWithZone:zone];
+	[element setSectionTemplate:sectionTemplate];
+	return element;
 }
 
 - (void)readSubElementsFrom:(TemplateStream *)stream
@@ -34,11 +68,27 @@
 
 - (void)readDataFrom:(TemplateStream *)stream
 {
-	if([[self label] isEqualToString: [[stream key] stringValue]])
+	Element *key = [stream key];
+	BOOL selected = (key && [key sectionForKeyValue:[key stringValue]] == sectionTemplate);
+	if(selected)
 	{
-		for(unsigned i = 0; i < [subElements count]; i++)
-			[[subElements objectAtIndex:i] readDataFrom:stream];
+		NSEnumerator *enumerator = [[sectionTemplate subElements] objectEnumerator];
+		while(Element *element = [enumerator nextObject])
+		{
+			Element *clone = [[element copy] autorelease];
+			[subElements addObject:clone];
+			[clone setParentArray:subElements];
+			if([clone isKey]) [stream pushKey:clone];
+			[clone readDataFrom:stream];
+		}
 	}
+	
+	// the key goes out of scope after its last section, whether or not that section was selected
+	if(key && [[key keyedSections] lastObject] == sectionTemplate)
+		[stream popKey];
+	
+	// unselected sections take no space in the resource, and shouldn't clutter the display
+	if(!selected) [parentArray removeObject:self];
 }
 
 // Before writeDataTo:is called, this is called to calculate the final resource size:
@@ -46,9 +96,6 @@
 //	of this element itself.
 - (unsigned int)sizeOnDisk
 {
-//	if(![[self label] isEqualToString: [[stream key] stringValue]])
-//		return 0;
-	
 	unsigned int size = 0;
 	NSEnumerator *enumerator = [subElements objectEnumerator];
 	while(Element *element = [enumerator nextObject])
@@ -56,15 +103,28 @@
 	return size;
 }
 
+// a section's size is accounted for by its key field, which knows that only one of its sections is present
+- (unsigned int)minimumSizeOnDisk
+{
+	return 0;
+}
+
+- (unsigned int)maximumSizeOnDisk
+{
+	return 0;
+}
+
+- (void)getSectionMinimum:(unsigned int *)min maximum:(unsigned int *)max
+{
+	[Element getMinimumSize:min maximumSize:max ofElements:subElements];
+}
+
 - (void)writeDataTo:(TemplateStream *)stream
 {
-	if([[self label] isEqualToString: [[stream key] stringValue]])
-	{
-		// writes out the data of all our sub-elements here:
-		NSEnumerator *enumerator = [subElements objectEnumerator];
-		while(Element *element = [enumerator nextObject])
-			[element writeDataTo:stream];
-	}
+	// only the selected section survives -readDataFrom:, so just write out our sub-elements
+	NSEnumerator *enumerator = [subElements objectEnumerator];
+	while(Element *element = [enumerator nextObject])
+		[element writeDataTo:stream];
 }
 
 - (void)setSubElements:(NSMutableArray *)a
@@ -79,6 +139,17 @@
 	return subElements;
 }
 
+- (void)setSectionTemplate:(ElementKEYB *)e
+{
+	// do not retain, -init sets this to 'self' initially!
+	sectionTemplate = e;
+}
+
+- (ElementKEYB *)sectionTemplate
+{
+	return sectionTemplate;
+}
+
 - (int)subElementCount
 {
 	return [subElements count];
@@ -51,6 +51,7 @@
 			if([clone class] == [ElementOCNT class])
 				counter = (ElementOCNT *)clone;
 			[array addObject:clone];
+			[clone setParentArray:array];
 		}
 	}
 	return element;
@@ -75,7 +76,8 @@
 {
 	int counterValue = 0;
 	ElementOCNT *counter = nil;
-	for(unsigned i = 0; i < [subElements count]; i++)
+	unsigned i = 0;
+	while(i < [subElements count])
 	{
 		Element *element = [subElements objectAtIndex:i];
 		
@@ -103,10 +105,14 @@
 		}
 		
 		// actually read the data for this item
+		if([element isKey]) [stream pushKey:element];
 		[element readDataFrom:stream];
 		
 		// now that we've read the (possibly counter) data, save it to the local variable
 		if(counter) counterValue = [counter value];
+		
+		// CASEs and unselected KEYB sections remove themselves, leaving the next item at this index
+		if([subElements indexOfObjectIdenticalTo:element] != NSNotFound) i++;
 	}
 }
 
@@ -174,6 +180,21 @@
 	return size;
 }
 
+// A list may have any number of entries (the counter of an LSTC is just another field as far as size goes),
+//	so the only lower bound is the terminator of an LSTZ.
+- (unsigned int)minimumSizeOnDisk
+{
+	return [type isEqualToString:@"LSTZ"]? 1:0;
+}
+
+- (unsigned int)maximumSizeOnDisk
+{
+	unsigned int min, max;
+	[Element getMinimumSize:&min maximumSize:&max ofElements:subElements];
+	if(max == 0) return [self minimumSizeOnDisk];	// entries take no space, so can't affect the size
+	return kUnboundedSize;
+}
+
 - (void)writeDataTo:(TemplateStream *)stream
 {
 	// Writes out the data of all our sub-elements here:
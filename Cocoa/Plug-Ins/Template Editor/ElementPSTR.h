@@ -16,6 +16,7 @@ enum StringPadding
 	BOOL _terminatingByte;	// for C strings
 	int _lengthBytes;		// for Pascal strings
 	int _alignment;			// pads end to align on multiple of this
+	UInt32 _fixedSize;		// for Pnnn and Cnnn, which always occupy nnn bytes
 }
 
 - (NSString *)stringValue;
@@ -26,5 +27,6 @@ enum StringPadding
 - (void)setTerminatingByte:(BOOL)v;
 - (void)setLengthBytes:(int)v;
 - (void)setAlignment:(int)v;
+- (void)setFixedSize:(UInt32)v;
 
 @end
@@ -1,6 +1,7 @@
 #import "ElementPSTR.h"
+#import "FixedWidth.h"
 
-// implements PSTR, OSTR, ESTR, BSTR, WSTR, LSTR, CSTR, OCST, ECST, CHAR, TNAM
+// implements PSTR, OSTR, ESTR, BSTR, WSTR, LSTR, CSTR, OCST, ECST, CHAR, TNAM, Pnnn, Cnnn
 @implementation ElementPSTR
 
 - (id)initForType:(NSString *)t withLabel:(NSString *)l
@@ -22,6 +23,21 @@
 	// temp until keyed values are implemented
 	else if([t isEqualToString:@"KCHR"])	{ _lengthBytes = 0; _maxLength = 1; _minLength = 1; _terminatingByte = NO; _pad = kNoPadding; _alignment = 0; }
 	else if([t isEqualToString:@"KTYP"])	{ _lengthBytes = 0; _maxLength = 4; _minLength = 4; _terminatingByte = NO; _pad = kNoPadding; _alignment = 0; }
+	else
+	{
+		// Pnnn and Cnnn: nnn bytes including the length byte or terminator, padded out with nulls
+		FixedWidthField field;
+		if(FixedWidthFieldForType([t cString], &field) && field.kind == kFixedWidthBytes)
+		{
+			_fixedSize = field.width;
+			_maxLength = field.width - 1;
+			_minLength = 0;
+			_lengthBytes = [t hasPrefix:@"P"]? 1:0;
+			_terminatingByte = [t hasPrefix:@"C"];
+			_pad = kNoPadding;
+			_alignment = 0;
+		}
+	}
 	return self;
 }
 
@@ -41,6 +57,7 @@
 	[element setTerminatingByte:_terminatingByte];
 	[element setLengthBytes:_lengthBytes];
 	[element setAlignment:_alignment];
+	[element setFixedSize:_fixedSize];
 	return element;
 }
 
@@ -48,6 +65,7 @@
 {
 	// get string length
 	UInt32 length = 0;
+	unsigned int startBytesToGo = [stream bytesToGo];
 	if(_lengthBytes > 0)
 	{
 		[stream readAmount:_lengthBytes toBuffer:&length];
@@ -78,12 +96,15 @@
 	if(_terminatingByte) [stream advanceAmount:1 pad:NO];
 	if(_pad == kPadToOddLength && (length + _terminatingByte ? 1:0) % 2 == 0)	[stream advanceAmount:1 pad:NO];
 	if(_pad == kPadToEvenLength && (length + _terminatingByte ? 1:0) % 2 == 1)	[stream advanceAmount:1 pad:NO];
+	if(_fixedSize && startBytesToGo - [stream bytesToGo] < _fixedSize)
+		[stream advanceAmount:_fixedSize - (startBytesToGo - [stream bytesToGo]) pad:NO];
 	// alignment unhandled here
 }
 
 - (unsigned int)sizeOnDisk
 {
 	UInt32 length;
+	if(_fixedSize) return _fixedSize;
 	if([value respondsToSelector:@selector(lengthOfBytesUsingEncoding:)])	// 10.4
 		length = [value lengthOfBytesUsingEncoding:NSMacOSRomanStringEncoding];
 	else length = [value cStringLength];
@@ -96,10 +117,19 @@
 	return length;
 }
 
+- (unsigned int)maximumSizeOnDisk
+{
+	// the minimum is the size of the TMPL element's empty string, which the default returns
+	if(_fixedSize || [self isKey]) return [super maximumSizeOnDisk];
+	if(_maxLength == 0 || _maxLength > UINT16_MAX) return kUnboundedSize;	// C strings and LSTRs
+	return _lengthBytes + _maxLength + (_terminatingByte? 1:0) + (_pad != kNoPadding? 1:0);
+}
+
 - (void)writeDataTo:(TemplateStream *)stream
 {
 	// write string
 	UInt32 length = [value length], writeLength;
+	unsigned int startBytesToGo = [stream bytesToGo];
 	if(_maxLength && length > _maxLength) length = _maxLength;
 #if __BIG_ENDIAN__
 	writeLength = length << ((4 - _lengthBytes) << 3);
@@ -142,6 +172,8 @@
 	if(_terminatingByte) [stream advanceAmount:1 pad:YES];
 	if(_pad == kPadToOddLength && (length + _lengthBytes + (_terminatingByte? 1:0)) % 2 == 0)	[stream advanceAmount:1 pad:YES];
 	if(_pad == kPadToEvenLength && (length + _lengthBytes + (_terminatingByte? 1:0)) % 2 == 1)	[stream advanceAmount:1 pad:YES];
+	if(_fixedSize && startBytesToGo - [stream bytesToGo] < _fixedSize)
+		[stream advanceAmount:_fixedSize - (startBytesToGo - [stream bytesToGo]) pad:YES];
 }
 
 - (NSString *)stringValue
@@ -162,5 +194,6 @@
 - (void)setTerminatingByte:(BOOL)v { _terminatingByte = v; }
 - (void)setLengthBytes:(int)v { _lengthBytes = v; }
 - (void)setAlignment:(int)v { _alignment = v; }
+- (void)setFixedSize:(UInt32)v { _fixedSize = v; }
 
 @end
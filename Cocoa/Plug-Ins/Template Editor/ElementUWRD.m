@@ -18,6 +18,11 @@
 	value = CFSwapInt16BigToHost(tmp);
 }
 
+- (void)readFixedWidthValueFrom:(const void *)bytes
+{
+	memmove(&value, bytes, SIZE_ON_DISK);
+}
+
 - (unsigned int)sizeOnDisk
 {
 	return SIZE_ON_DISK;
@@ -0,0 +1,317 @@
+#include "FixedWidth.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*** FIXED-SIZE TYPES ***/
+
+typedef struct FixedWidthType
+{
+	char	type[5];
+	UInt8	kind;
+	UInt8	width;
+	UInt8	bitCount;
+} FixedWidthType;
+
+static const FixedWidthType gFixedWidthTypes[] =
+{
+	// integers
+	{ "DBYT", kFixedWidthSigned,	1, 0 },
+	{ "DWRD", kFixedWidthSigned,	2, 0 },
+	{ "DLNG", kFixedWidthSigned,	4, 0 },
+	{ "DLLG", kFixedWidthSigned,	8, 0 },
+	{ "UBYT", kFixedWidthUnsigned,	1, 0 },
+	{ "UWRD", kFixedWidthUnsigned,	2, 0 },
+	{ "ULNG", kFixedWidthUnsigned,	4, 0 },
+	{ "ULLG", kFixedWidthUnsigned,	8, 0 },
+	{ "HBYT", kFixedWidthUnsigned,	1, 0 },
+	{ "HWRD", kFixedWidthUnsigned,	2, 0 },
+	{ "HLNG", kFixedWidthUnsigned,	4, 0 },
+	{ "HLLG", kFixedWidthUnsigned,	8, 0 },
+	{ "KBYT", kFixedWidthSigned,	1, 0 },
+	{ "KWRD", kFixedWidthSigned,	2, 0 },
+	{ "KLNG", kFixedWidthSigned,	4, 0 },
+	{ "KLLG", kFixedWidthSigned,	8, 0 },
+	{ "KUBT", kFixedWidthUnsigned,	1, 0 },
+	{ "KUWD", kFixedWidthUnsigned,	2, 0 },
+	{ "KULG", kFixedWidthUnsigned,	4, 0 },
+	{ "KULL", kFixedWidthUnsigned,	8, 0 },
+	{ "KHBT", kFixedWidthUnsigned,	1, 0 },
+	{ "KHWD", kFixedWidthUnsigned,	2, 0 },
+	{ "KHLG", kFixedWidthUnsigned,	4, 0 },
+	{ "KHLL", kFixedWidthUnsigned,	8, 0 },
+	{ "RSID", kFixedWidthSigned,	2, 0 },
+
+	// flags
+	{ "BFLG", kFixedWidthUnsigned,	1, 0 },
+	{ "WFLG", kFixedWidthUnsigned,	2, 0 },
+	{ "LFLG", kFixedWidthUnsigned,	4, 0 },
+	{ "BOOL", kFixedWidthUnsigned,	2, 0 },
+
+	// single bits
+	{ "BBIT", kFixedWidthBits,		1, 1 },
+	{ "WBIT", kFixedWidthBits,		2, 1 },
+	{ "LBIT", kFixedWidthBits,		4, 1 },
+
+	// fractions, dates & other numbers
+	{ "FIXD", kFixedWidthSigned,	4, 0 },
+	{ "FRAC", kFixedWidthSigned,	4, 0 },
+	{ "SFRC", kFixedWidthUnsigned,	2, 0 },
+	{ "FXYZ", kFixedWidthUnsigned,	2, 0 },
+	{ "FWID", kFixedWidthUnsigned,	2, 0 },
+	{ "REAL", kFixedWidthUnsigned,	4, 0 },
+	{ "DOUB", kFixedWidthUnsigned,	8, 0 },
+	{ "DATE", kFixedWidthUnsigned,	4, 0 },
+	{ "MDAT", kFixedWidthUnsigned,	4, 0 },
+	{ "LLDT", kFixedWidthUnsigned,	8, 0 },
+	{ "PNT ", kFixedWidthUnsigned,	4, 0 },
+	{ "RECT", kFixedWidthUnsigned,	8, 0 },
+	{ "SCPC", kFixedWidthSigned,	2, 0 },
+	{ "LNGC", kFixedWidthSigned,	2, 0 },
+	{ "RGNC", kFixedWidthSigned,	2, 0 },
+	{ "STYL", kFixedWidthSigned,	1, 0 },
+
+	// characters & type codes
+	{ "CHAR", kFixedWidthBytes,		1, 0 },
+	{ "TNAM", kFixedWidthBytes,		4, 0 },
+	{ "KCHR", kFixedWidthBytes,		1, 0 },
+	{ "KTYP", kFixedWidthBytes,		4, 0 },
+
+	// fillers & cosmetic elements
+	{ "FBYT", kFixedWidthFiller,	1, 0 },
+	{ "FWRD", kFixedWidthFiller,	2, 0 },
+	{ "FLNG", kFixedWidthFiller,	4, 0 },
+	{ "FLLG", kFixedWidthFiller,	8, 0 },
+	{ "TITL", kFixedWidthFiller,	0, 0 },
+	{ "CMNT", kFixedWidthFiller,	0, 0 },
+	{ "DVDR", kFixedWidthFiller,	0, 0 },
+	{ "CASE", kFixedWidthFiller,	0, 0 }
+};
+
+/*** PARAMETERISED TYPES ***/
+
+static int HexDigit(char c)
+{
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+// returns the value of the three hex digits in Hnnn, Pnnn, Cnnn & Fnnn, or -1
+static int HexCount(const char *digits)
+{
+	int i, value = 0;
+	for(i = 0; i < 3; i++)
+	{
+		int digit = HexDigit(digits[i]);
+		if(digit < 0) return -1;
+		value = (value << 4) | digit;
+	}
+	return value;
+}
+
+// returns the value of the two decimal digits in BBnn, WBnn & LBnn, or -1
+static int DecimalCount(const char *digits)
+{
+	if(digits[0] < '0' || digits[0] > '9' || digits[1] < '0' || digits[1] > '9') return -1;
+	return (digits[0] - '0') * 10 + (digits[1] - '0');
+}
+
+Boolean FixedWidthFieldForType(const char *type, FixedWidthField *outField)
+{
+	unsigned int i;
+	int count;
+	if(type == NULL || strlen(type) != 4) return false;
+	memset(outField, 0, sizeof(FixedWidthField));
+
+	for(i = 0; i < sizeof(gFixedWidthTypes) / sizeof(FixedWidthType); i++)
+	{
+		if(memcmp(type, gFixedWidthTypes[i].type, 4) == 0)
+		{
+			outField->kind = gFixedWidthTypes[i].kind;
+			outField->width = gFixedWidthTypes[i].width;
+			outField->bitCount = gFixedWidthTypes[i].bitCount;
+			return true;
+		}
+	}
+
+	// Hnnn, Pnnn & Cnnn are nnn (hex) bytes of data, Pascal string & C string respectively; Fnnn is nnn bytes of filler
+	count = HexCount(type + 1);
+	if(count >= 0) switch(type[0])
+	{
+		case 'H':
+		case 'P':
+		case 'C':
+			if(count == 0) return false;
+			outField->kind = kFixedWidthBytes;
+			outField->width = count;
+			return true;
+
+		case 'F':
+			outField->kind = kFixedWidthFiller;
+			outField->width = count;
+			return true;
+	}
+
+	// BBnn, WBnn & LBnn are nn (decimal) bits within a byte, word or long
+	count = DecimalCount(type + 2);
+	if(count > 0 && type[1] == 'B')
+	{
+		switch(type[0])
+		{
+			case 'B':	outField->width = 1;	break;
+			case 'W':	outField->width = 2;	break;
+			case 'L':	outField->width = 4;	break;
+			default:	return false;
+		}
+		if(count > (int) outField->width * 8) return false;
+		outField->kind = kFixedWidthBits;
+		outField->bitCount = count;
+		return true;
+	}
+	return false;
+}
+
+/*** LAYOUTS ***/
+
+FixedWidthLayout *FixedWidthLayoutCreate(const char **types, UInt32 count)
+{
+	UInt32 i, offset = 0, bitPosition = 0, bitWidth = 0;	// bitWidth is the width of the bit unit being filled
+	FixedWidthLayout *layout = calloc(1, sizeof(FixedWidthLayout) + (count? count-1:0) * sizeof(FixedWidthField));
+	if(layout == NULL) return NULL;
+	layout->count = count;
+
+	for(i = 0; i < count; i++)
+	{
+		FixedWidthField *field = &layout->fields[i];
+		if(!FixedWidthFieldForType(types[i], field))
+			goto fail;
+
+		if(field->kind == kFixedWidthBits)
+		{
+			// consecutive bit fields share a unit, which must be filled exactly before anything else follows
+			if(bitPosition + field->bitCount > field->width * 8 || (bitPosition > 0 && field->width != bitWidth))
+				goto fail;
+			bitWidth = field->width;
+			field->offset = offset;
+			field->bitOffset = bitPosition;
+			bitPosition += field->bitCount;
+			if(bitPosition == field->width * 8)
+			{
+				offset += field->width;
+				bitPosition = 0;
+			}
+		}
+		else
+		{
+			// zero-width elements (comments, CASE values) may sit between bit fields
+			if(bitPosition != 0 && field->width > 0) goto fail;
+			field->offset = offset;
+			offset += field->width;
+		}
+	}
+	if(bitPosition != 0) goto fail;
+	layout->size = offset;
+	return layout;
+
+fail:
+	free(layout);
+	return NULL;
+}
+
+#if !__BIG_ENDIAN__
+static void SwapInPlace(UInt8 *bytes, UInt32 width)
+{
+	UInt32 i;
+	UInt8 temp;
+	for(i = 0; i < width/2; i++)
+	{
+		temp = bytes[i];
+		bytes[i] = bytes[width-1-i];
+		bytes[width-1-i] = temp;
+	}
+}
+#endif
+
+void FixedWidthLayoutSwapToHost(const FixedWidthLayout *layout, void *bytes)
+{
+#if __BIG_ENDIAN__
+	#pragma unused(layout, bytes)
+#else
+	UInt32 i;
+	for(i = 0; i < layout->count; i++)
+	{
+		const FixedWidthField *field = &layout->fields[i];
+		if(field->width < 2) continue;
+		if(field->kind == kFixedWidthSigned || field->kind == kFixedWidthUnsigned || (field->kind == kFixedWidthBits && field->bitOffset == 0))
+			SwapInPlace((UInt8 *) bytes + field->offset, field->width);
+	}
+#endif
+}
+
+void FixedWidthLayoutSwapToBig(const FixedWidthLayout *layout, void *bytes)
+{
+	// swapping is its own inverse
+	FixedWidthLayoutSwapToHost(layout, bytes);
+}
+
+/*** SINGLE VALUES ***/
+
+UInt64 FixedWidthReadBig(const void *bytes, UInt32 width)
+{
+	const UInt8 *b = bytes;
+	UInt64 value = 0;
+	UInt32 i;
+	for(i = 0; i < width; i++)
+		value = (value << 8) | b[i];
+	return value;
+}
+
+void FixedWidthWriteBig(void *bytes, UInt32 width, UInt64 value)
+{
+	UInt8 *b = bytes;
+	while(width--)
+	{
+		b[width] = value & 0xFF;
+		value >>= 8;
+	}
+}
+
+UInt64 FixedWidthReadHost(const void *bytes, UInt32 width)
+{
+	UInt8 v8; UInt16 v16; UInt32 v32; UInt64 v64;
+	switch(width)
+	{
+		case 1:	memcpy(&v8, bytes, 1);	return v8;
+		case 2:	memcpy(&v16, bytes, 2);	return v16;
+		case 4:	memcpy(&v32, bytes, 4);	return v32;
+		case 8:	memcpy(&v64, bytes, 8);	return v64;
+	}
+	return 0;
+}
+
+SInt64 FixedWidthSignExtend(UInt64 value, UInt32 width)
+{
+	UInt32 shift;
+	if(width == 0 || width >= 8) return (SInt64) value;
+	shift = 64 - width * 8;
+	return ((SInt64) (value << shift)) >> shift;
+}
+
+static UInt64 BitMask(UInt32 bitCount)
+{
+	return bitCount >= 64? ~0ULL : (1ULL << bitCount) - 1;
+}
+
+UInt64 FixedWidthExtractBits(UInt64 unit, const FixedWidthField *field)
+{
+	UInt32 shift = field->width * 8 - field->bitOffset - field->bitCount;
+	return (unit >> shift) & BitMask(field->bitCount);
+}
+
+UInt64 FixedWidthInsertBits(UInt64 unit, const FixedWidthField *field, UInt64 value)
+{
+	UInt32 shift = field->width * 8 - field->bitOffset - field->bitCount;
+	UInt64 mask = BitMask(field->bitCount) << shift;
+	return (unit & ~mask) | ((value << shift) & mask);
+}
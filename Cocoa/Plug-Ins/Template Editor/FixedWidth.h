@@ -0,0 +1,87 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		FixedWidth.h
+
+	PURPOSE:	Table-driven description and big-endian codec for every TMPL
+				field type which occupies a fixed number of bytes, including
+				the parameterised families (Hnnn, Pnnn, Cnnn, Fnnn, BBnn,
+				WBnn, LBnn) which can't go in the field registry.
+
+				A template consisting only of such fields compiles to a
+				FixedWidthLayout: a flat array of offsets and widths which
+				lets a resource be decoded with one memcpy and a byte-swap
+				loop, without creating or messaging an Element per field.
+   ========================================================================== */
+
+#ifndef FIXED_WIDTH_H
+#define FIXED_WIDTH_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum FixedWidthKind
+{
+	kFixedWidthSigned = 0,		// big-endian two's complement integer of 1, 2, 4 or 8 bytes
+	kFixedWidthUnsigned,		// big-endian unsigned integer of 1, 2, 4 or 8 bytes (also flags, fractions, dates)
+	kFixedWidthBits,			// bitCount bits within a big-endian byte, word or long shared with neighbouring fields
+	kFixedWidthBytes,			// uninterpreted bytes (hex dumps, fixed strings, type codes) - never swapped
+	kFixedWidthFiller			// bytes skipped when reading and zeroed when writing
+};
+
+typedef struct FixedWidthField
+{
+	UInt32	offset;		// from the start of the resource; only meaningful once placed in a FixedWidthLayout
+	UInt32	width;		// bytes on disk; for bit fields, the size of the containing unit
+	UInt8	kind;		// a FixedWidthKind
+	UInt8	bitOffset;	// bit fields only: bits from the most significant end of the unit
+	UInt8	bitCount;	// bit fields only
+	UInt8	reserved;
+} FixedWidthField;
+
+typedef struct FixedWidthLayout
+{
+	UInt32			count;		// number of fields, one per template element
+	UInt32			size;		// total bytes occupied by a resource using this template
+	FixedWidthField	fields[1];	// variable length
+} FixedWidthLayout;
+
+/*!
+@function	FixedWidthFieldForType
+@abstract	Looks up a four character TMPL type code. Returns false if the type is not of fixed size (e.g. PSTR, LSTB, HEXD).
+*/
+Boolean FixedWidthFieldForType(const char *type, FixedWidthField *outField);
+
+/*!
+@function	FixedWidthLayoutCreate
+@abstract	Compiles a list of TMPL type codes into a layout, or returns NULL if any of them is not fixed-width or a run of bit fields does not fill its unit. Free the result with free().
+*/
+FixedWidthLayout *FixedWidthLayoutCreate(const char **types, UInt32 count);
+
+/*!
+@function	FixedWidthLayoutSwapToHost
+@abstract	Converts a resource's bytes to host order in place. Bit fields are swapped once per unit.
+*/
+void FixedWidthLayoutSwapToHost(const FixedWidthLayout *layout, void *bytes);
+
+/*!
+@function	FixedWidthLayoutSwapToBig
+@abstract	The inverse of FixedWidthLayoutSwapToHost.
+*/
+void FixedWidthLayoutSwapToBig(const FixedWidthLayout *layout, void *bytes);
+
+// single values
+UInt64 FixedWidthReadBig(const void *bytes, UInt32 width);
+void FixedWidthWriteBig(void *bytes, UInt32 width, UInt64 value);
+UInt64 FixedWidthReadHost(const void *bytes, UInt32 width);
+SInt64 FixedWidthSignExtend(UInt64 value, UInt32 width);
+UInt64 FixedWidthExtractBits(UInt64 unit, const FixedWidthField *field);
+UInt64 FixedWidthInsertBits(UInt64 unit, const FixedWidthField *field, UInt64 value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		TemplateField.h
+
+	PURPOSE:	Finds one named top-level field of a template in resource
+				data without building the whole element tree. If every field
+				before it is fixed-width its offset is known up front, so
+				only the field's own bytes are read; otherwise the resource
+				is read through a TemplateStream and the field looked up by
+				label.
+   ========================================================================== */
+
+#import <Foundation/Foundation.h>
+#import "FixedWidth.h"
+
+@class Element;
+
+@interface TemplateField : NSObject
+{
+	Element *element;			// the TMPL element for the field
+	unsigned int index;			// of the element in the template's top level
+	NSArray *templateStructure;
+	BOOL isDirect;				// all preceeding fields are fixed-width, so the field is at a known offset
+	BOOL isInteger;				// the field displays the integer it holds, so can be decoded without an Element
+	unsigned int offset;
+	FixedWidthField field;		// the field's own size and kind, if it is fixed-width
+}
+
++ (NSArray *)fieldsOfTemplate:(NSArray *)elements;	// every top-level field which holds a value
+- (id)initWithElementAtIndex:(unsigned int)i ofTemplate:(NSArray *)elements;
+
+- (NSString *)label;
+- (Element *)element;
+- (BOOL)isDirect;
+- (BOOL)isNumeric;
+- (unsigned int)offset;		// only valid if -isDirect
+- (unsigned int)width;		// zero unless the field itself is fixed-width
+
+- (id)valueInData:(NSData *)data;					// NSNumber for numeric fields, NSString otherwise, nil if the data is too short. Thread safe.
+- (Element *)elementReadFromData:(NSData *)data;	// an Element holding the field's value, for editing
+- (BOOL)setStringValue:(NSString *)string inData:(NSMutableData *)data;	// rewrites just the field's bytes; only for -isDirect fields which are -editable
+
+@end
@@ -0,0 +1,174 @@
+#import "TemplateField.h"
+#import "TemplateStream.h"
+#import "Element.h"
+#import "ElementDBYT.h"
+#import "ElementDWRD.h"
+#import "ElementDLNG.h"
+#import "ElementDLLG.h"
+#import "ElementUBYT.h"
+#import "ElementUWRD.h"
+#import "ElementULNG.h"
+#import "ElementULLG.h"
+#import "ElementFIXD.h"
+#import "ElementFRAC.h"
+#import "ElementBFLG.h"
+#import "ElementBBIT.h"
+#import "ElementLSTB.h"
+#import "ElementLSTE.h"
+#import "ElementKEYB.h"
+
+@implementation TemplateField
+
++ (NSArray *)fieldsOfTemplate:(NSArray *)elements
+{
+	unsigned int i;
+	NSMutableArray *fields = [NSMutableArray array];
+	for(i = 0; i < [elements count]; i++)
+	{
+		Element *element = [elements objectAtIndex:i];
+		FixedWidthField field;
+		
+		// lists, keyed sections, fillers and cosmetic fields (including CASE) have no value of their own
+		if([element isKindOfClass:[ElementLSTB class]] || [element isKindOfClass:[ElementLSTE class]] ||
+		   [element isKindOfClass:[ElementKEYB class]] || [element isKindOfClass:[ElementKEYE class]])
+			continue;
+		if(FixedWidthFieldForType([[element type] cString], &field) && field.kind == kFixedWidthFiller)
+			continue;
+		[fields addObject:[[[self alloc] initWithElementAtIndex:i ofTemplate:elements] autorelease]];
+	}
+	return fields;
+}
+
+- (id)initWithElementAtIndex:(unsigned int)i ofTemplate:(NSArray *)elements
+{
+	unsigned int j;
+	self = [super init];
+	if(!self) return nil;
+	templateStructure = [elements copy];		// the editor refills its array when the template changes
+	element = [[elements objectAtIndex:i] retain];
+	index = i;
+	
+	// TMPL elements of fixed-width types report their width from -sizeOnDisk (and bit fields zero, except the last in a unit)
+	isDirect = YES;
+	for(j = 0; j < i && isDirect; j++)
+	{
+		FixedWidthField preceeding;
+		Element *e = [elements objectAtIndex:j];
+		if(FixedWidthFieldForType([[e type] cString], &preceeding) && ![e isKey])
+			offset += [e sizeOnDisk];
+		else isDirect = NO;
+	}
+	if(!FixedWidthFieldForType([[element type] cString], &field) || [element isKey])
+		isDirect = NO;
+	if([element isKindOfClass:[ElementBBIT class]])
+		field.bitOffset = [(ElementBBIT *)element bitOffset];
+	
+	isInteger = [element isKindOfClass:[ElementDBYT class]] || [element isKindOfClass:[ElementDWRD class]] || [element isKindOfClass:[ElementDLNG class]] || [element isKindOfClass:[ElementDLLG class]] ||
+				[element isKindOfClass:[ElementUBYT class]] || [element isKindOfClass:[ElementUWRD class]] || [element isKindOfClass:[ElementULNG class]] || [element isKindOfClass:[ElementULLG class]] ||
+				[element isKindOfClass:[ElementBFLG class]] || [element isKindOfClass:[ElementBBIT class]];
+	return self;
+}
+
+- (void)dealloc
+{
+	[element release];
+	[templateStructure release];
+	[super dealloc];
+}
+
+- (NSString *)label
+{
+	return [element label];
+}
+
+- (Element *)element
+{
+	return element;
+}
+
+- (BOOL)isDirect
+{
+	return isDirect;
+}
+
+- (BOOL)isNumeric
+{
+	return isInteger || [element isKindOfClass:[ElementFIXD class]] || [element isKindOfClass:[ElementFRAC class]];
+}
+
+- (unsigned int)offset
+{
+	return offset;
+}
+
+- (unsigned int)width
+{
+	return field.width;
+}
+
+- (id)valueInData:(NSData *)data
+{
+	Element *value;
+	
+	// integers at a known offset go straight through the codec
+	if(isDirect && isInteger)
+	{
+		UInt64 raw;
+		if(offset + field.width > [data length]) return nil;
+		raw = FixedWidthReadBig((const char *)[data bytes] + offset, field.width);
+		switch(field.kind)
+		{
+			case kFixedWidthSigned:	return [NSNumber numberWithLongLong:FixedWidthSignExtend(raw, field.width)];
+			case kFixedWidthBits:	return [NSNumber numberWithUnsignedLongLong:FixedWidthExtractBits(raw, &field)];
+			default:				return [NSNumber numberWithUnsignedLongLong:raw];
+		}
+	}
+	
+	// anything else needs an element to interpret it
+	value = [self elementReadFromData:data];
+	if(!value) return nil;
+	if([self isNumeric]) return [NSNumber numberWithDouble:[[value stringValue] doubleValue]];
+	return [value stringValue];
+}
+
+- (Element *)elementReadFromData:(NSData *)data
+{
+	if(isDirect)
+	{
+		// read just this field's bytes
+		Element *clone;
+		if(offset + field.width > [data length]) return nil;
+		clone = [[element copy] autorelease];
+		[clone readDataFrom:[TemplateStream streamWithBytes:(char *)[data bytes] + offset length:field.width]];
+		return clone;
+	}
+	else
+	{
+		// the field's position depends on the data before it, so read everything and find it again
+		Element *candidate;
+		NSMutableArray *structure = [NSMutableArray array];
+		TemplateStream *stream = [TemplateStream streamWithBytes:(char *)[data bytes] length:[data length]];
+		NSEnumerator *enumerator;
+		[stream readTemplateElements:templateStructure intoArray:structure];
+		enumerator = [structure objectEnumerator];
+		while(candidate = [enumerator nextObject])
+			if([[candidate label] isEqualToString:[element label]] && [[candidate type] isEqualToString:[element type]])
+				return candidate;
+		return nil;
+	}
+}
+
+- (BOOL)setStringValue:(NSString *)string inData:(NSMutableData *)data
+{
+	Element *value;
+	if(!isDirect || ![element editable]) return NO;
+	value = [self elementReadFromData:data];
+	if(!value) return NO;
+	
+	// bit fields read-modify-write their unit, so neighbouring fields survive
+	[value setValue:string forKey:@"stringValue"];
+	[value writeDataTo:[TemplateStream streamWithBytes:(char *)[data mutableBytes] + offset length:field.width]];
+	return YES;
+}
+
+@end
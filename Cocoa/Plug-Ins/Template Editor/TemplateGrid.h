@@ -0,0 +1,42 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		TemplateGrid.h
+
+	PURPOSE:	The model behind the grid editor: one row per resource of a
+				type in a document, one column per template field at a known
+				offset. Values are cached by column, each column decoded for
+				every row the first time it is asked for, so only fields
+				scrolled into view cost anything. Edits patch the field's
+				bytes in a copy of the resource's data and set it back; one
+				edit may span many rows, and is undone as one.
+   ========================================================================== */
+
+#import <Foundation/Foundation.h>
+
+@class TemplateField;
+
+@interface TemplateGrid : NSObject
+{
+	NSArray *columns;				// TemplateFields
+	NSMutableArray *resources;		// rows, as id <ResKnifeResourceProtocol>
+	NSMutableArray *columnValues;	// per column, an array of values by row, or NSNull until decoded
+	unsigned int extent;			// bytes a resource needs to hold every column
+	unsigned int skipped;
+	NSUndoManager *undoManager;
+}
+
+- (id)initWithTemplate:(NSArray *)elements resources:(NSArray *)all;
+
+- (unsigned int)rowCount;
+- (unsigned int)columnCount;
+- (TemplateField *)fieldForColumn:(unsigned int)column;
+- (id)resourceForRow:(unsigned int)row;
+- (unsigned int)skippedCount;		// resources too short to hold every column
+
+- (id)valueAtRow:(unsigned int)row column:(unsigned int)column;
+- (BOOL)setStringValue:(NSString *)string atRows:(NSIndexSet *)rows column:(unsigned int)column;
+- (void)invalidateRow:(unsigned int)row;
+
+- (void)setUndoManager:(NSUndoManager *)manager;
+
+@end
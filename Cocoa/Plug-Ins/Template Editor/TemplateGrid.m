@@ -0,0 +1,181 @@
+#import "TemplateGrid.h"
+#import "TemplateField.h"
+#import "TemplateScan.h"
+#import "Element.h"
+#import "ResKnifeResourceProtocol.h"
+
+@interface TemplateGrid (Private)
+- (NSMutableArray *)decodeColumn:(unsigned int)column;
+- (void)setData:(NSArray *)dataArray forResources:(NSArray *)targets actionName:(NSString *)name;
+- (void)resourceDataDidChange:(NSNotification *)notification;
+@end
+
+@implementation TemplateGrid
+
+- (id)initWithTemplate:(NSArray *)elements resources:(NSArray *)all
+{
+	unsigned int i;
+	NSMutableArray *fields = [NSMutableArray array];
+	NSEnumerator *enumerator;
+	TemplateField *field;
+	id <ResKnifeResourceProtocol> resource;
+	
+	self = [super init];
+	if(!self) return nil;
+	
+	// only fields at a known offset can be decoded and patched in place
+	enumerator = [[TemplateField fieldsOfTemplate:elements] objectEnumerator];
+	while(field = [enumerator nextObject])
+	{
+		if(![field isDirect]) continue;
+		[fields addObject:field];
+		if([field offset] + [field width] > extent)
+			extent = [field offset] + [field width];
+	}
+	columns = [fields retain];
+	
+	resources = [[NSMutableArray alloc] initWithCapacity:[all count]];
+	enumerator = [all objectEnumerator];
+	while(resource = [enumerator nextObject])
+		if([[resource data] length] >= extent)
+			[resources addObject:resource];
+	skipped = [all count] - [resources count];
+	
+	columnValues = [[NSMutableArray alloc] initWithCapacity:[columns count]];
+	for(i = 0; i < [columns count]; i++)
+		[columnValues addObject:[NSNull null]];
+	
+	// edits made here, undone, or made in other editors all come through this
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[undoManager removeAllActionsWithTarget:self];
+	[undoManager release];
+	[columns release];
+	[resources release];
+	[columnValues release];
+	[super dealloc];
+}
+
+- (void)setUndoManager:(NSUndoManager *)manager
+{
+	id old = undoManager;
+	[old removeAllActionsWithTarget:self];
+	undoManager = [manager retain];
+	[old release];
+}
+
+#pragma mark -
+
+- (unsigned int)rowCount
+{
+	return [resources count];
+}
+
+- (unsigned int)columnCount
+{
+	return [columns count];
+}
+
+- (TemplateField *)fieldForColumn:(unsigned int)column
+{
+	return [columns objectAtIndex:column];
+}
+
+- (id)resourceForRow:(unsigned int)row
+{
+	return [resources objectAtIndex:row];
+}
+
+- (unsigned int)skippedCount
+{
+	return skipped;
+}
+
+#pragma mark -
+#pragma mark Column Cache
+
+// decodes one field of every row, in parallel for fields which need an Element to interpret them
+- (NSMutableArray *)decodeColumn:(unsigned int)column
+{
+	unsigned int i;
+	NSMutableArray *dataArray = [NSMutableArray arrayWithCapacity:[resources count]];
+	for(i = 0; i < [resources count]; i++)
+		[dataArray addObject:[[resources objectAtIndex:i] data]];
+	return [NSMutableArray arrayWithArray:[TemplateScan resultsOfSelector:@selector(valueInData:) target:[columns objectAtIndex:column] withObjects:dataArray]];
+}
+
+- (id)valueAtRow:(unsigned int)row column:(unsigned int)column
+{
+	NSMutableArray *values = [columnValues objectAtIndex:column];
+	if(values == (id) [NSNull null])
+	{
+		values = [self decodeColumn:column];
+		[columnValues replaceObjectAtIndex:column withObject:values];
+	}
+	return [values objectAtIndex:row];
+}
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	unsigned int row = [resources indexOfObjectIdenticalTo:[notification object]];
+	if(row != NSNotFound) [self invalidateRow:row];
+}
+
+// only columns already decoded are refreshed
+- (void)invalidateRow:(unsigned int)row
+{
+	unsigned int i;
+	NSData *data = [[resources objectAtIndex:row] data];
+	for(i = 0; i < [columns count]; i++)
+	{
+		NSMutableArray *values = [columnValues objectAtIndex:i];
+		id value;
+		if(values == (id) [NSNull null]) continue;
+		value = [[columns objectAtIndex:i] valueInData:data];
+		[values replaceObjectAtIndex:row withObject:value? value : (id) [NSNull null]];
+	}
+}
+
+#pragma mark -
+#pragma mark Editing
+
+- (BOOL)setStringValue:(NSString *)string atRows:(NSIndexSet *)rows column:(unsigned int)column
+{
+	unsigned int row;
+	TemplateField *field = [columns objectAtIndex:column];
+	NSMutableArray *targets = [NSMutableArray arrayWithCapacity:[rows count]];
+	NSMutableArray *dataArray = [NSMutableArray arrayWithCapacity:[rows count]];
+	
+	for(row = [rows firstIndex]; row != NSNotFound; row = [rows indexGreaterThanIndex:row])
+	{
+		id <ResKnifeResourceProtocol> resource = [resources objectAtIndex:row];
+		NSMutableData *data = [[[resource data] mutableCopy] autorelease];
+		if(![field setStringValue:string inData:data]) return NO;
+		[targets addObject:resource];
+		[dataArray addObject:data];
+	}
+	[self setData:dataArray forResources:targets actionName:[NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"Change of '%@'", nil, [NSBundle bundleForClass:[TemplateGrid class]], nil), [field label]]];
+	return YES;
+}
+
+// sets every resource's data and registers the reverse as a single undo action
+- (void)setData:(NSArray *)dataArray forResources:(NSArray *)targets actionName:(NSString *)name
+{
+	unsigned int i;
+	NSMutableArray *oldData = [NSMutableArray arrayWithCapacity:[targets count]];
+	for(i = 0; i < [targets count]; i++)
+		[oldData addObject:[[targets objectAtIndex:i] data]];
+	
+	[[undoManager prepareWithInvocationTarget:self] setData:oldData forResources:targets actionName:name];
+	[undoManager setActionName:name];
+	
+	for(i = 0; i < [targets count]; i++)
+		[[targets objectAtIndex:i] setData:[dataArray objectAtIndex:i]];
+}
+
+@end
@@ -0,0 +1,26 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		TemplateGridWindowController.h
+
+	PURPOSE:	Shows every resource of a type in a document as a row of a
+				table, with a column per template field (see TemplateGrid).
+				Editing a cell while several rows are selected sets the
+				field in all of them as one undoable change. Built in code,
+				like the query window.
+   ========================================================================== */
+
+#import <Cocoa/Cocoa.h>
+
+@class TemplateGrid;
+
+@interface TemplateGridWindowController : NSWindowController
+{
+	TemplateGrid *grid;
+	NSDocument *document;		// owner of the resources, whose undo manager edits are registered with
+	NSTableView *gridTable;
+	NSTextField *statusField;
+}
+
+- (id)initWithTemplate:(NSArray *)elements forType:(NSString *)type inDocument:(NSDocument *)doc;
+
+@end
@@ -0,0 +1,136 @@
+#import "TemplateGridWindowController.h"
+#import "TemplateGrid.h"
+#import "TemplateField.h"
+#import "Element.h"
+#import "ResKnifeResourceProtocol.h"
+
+#define GridString(s)	NSLocalizedStringFromTableInBundle(s, nil, [NSBundle bundleForClass:[TemplateGridWindowController class]], nil)
+
+@interface TemplateGridWindowController (Private)
+- (void)buildWindow;
+- (void)resourceDataDidChange:(NSNotification *)notification;
+@end
+
+@implementation TemplateGridWindowController
+
+- (id)initWithTemplate:(NSArray *)elements forType:(NSString *)type inDocument:(NSDocument *)doc
+{
+	NSWindow *window = [[[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 640, 420) styleMask:NSTitledWindowMask | NSClosableWindowMask | NSMiniaturizableWindowMask | NSResizableWindowMask backing:NSBackingStoreBuffered defer:YES] autorelease];
+	self = [super initWithWindow:window];
+	if(!self) return nil;
+	document = [doc retain];
+	grid = [[TemplateGrid alloc] initWithTemplate:elements resources:[NSClassFromString(@"Resource") allResourcesOfType:type inDocument:document]];
+	[grid setUndoManager:[document undoManager]];
+	[self buildWindow];
+	[window setTitle:[NSString stringWithFormat:GridString(@"GridWindowTitle"), type, [document displayName]]];
+	[window setDelegate:self];
+	[window center];
+	
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[gridTable setDataSource:nil];
+	[grid release];
+	[document release];
+	[super dealloc];
+}
+
+- (void)buildWindow
+{
+	unsigned int i;
+	NSView *content = [[self window] contentView];
+	NSRect frame = [content frame];
+	NSScrollView *scrollView;
+	NSTableColumn *column;
+	
+	scrollView = [[[NSScrollView alloc] initWithFrame:NSMakeRect(-1, 28, NSWidth(frame) + 2, NSHeight(frame) - 27)] autorelease];
+	[scrollView setHasVerticalScroller:YES];
+	[scrollView setHasHorizontalScroller:YES];
+	[scrollView setBorderType:NSBezelBorder];
+	[scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+	gridTable = [[[NSTableView alloc] initWithFrame:[[scrollView contentView] bounds]] autorelease];
+	[gridTable setUsesAlternatingRowBackgroundColors:YES];
+	[gridTable setAllowsMultipleSelection:YES];
+	[gridTable setColumnAutoresizingStyle:NSTableViewNoColumnAutoresizing];
+	[gridTable setDataSource:self];
+	[gridTable setDelegate:self];
+	
+	// the table only asks for cells in view, and the grid only decodes columns it's asked for
+	column = [[[NSTableColumn alloc] initWithIdentifier:@"resID"] autorelease];
+	[[column headerCell] setStringValue:GridString(@"ID")];
+	[column setWidth:60];
+	[column setEditable:NO];
+	[gridTable addTableColumn:column];
+	column = [[[NSTableColumn alloc] initWithIdentifier:@"name"] autorelease];
+	[[column headerCell] setStringValue:GridString(@"Name")];
+	[column setWidth:160];
+	[column setEditable:NO];
+	[gridTable addTableColumn:column];
+	for(i = 0; i < [grid columnCount]; i++)
+	{
+		TemplateField *field = [grid fieldForColumn:i];
+		column = [[[NSTableColumn alloc] initWithIdentifier:[NSNumber numberWithUnsignedInt:i]] autorelease];
+		[[column headerCell] setStringValue:[field label]];
+		[column setWidth:[field isNumeric]? 70:120];
+		[column setEditable:[[field element] editable]];
+		[[column dataCell] setFont:[NSFont systemFontOfSize:[NSFont smallSystemFontSize]]];
+		[gridTable addTableColumn:column];
+	}
+	[scrollView setDocumentView:gridTable];
+	[content addSubview:scrollView];
+	
+	statusField = [[[NSTextField alloc] initWithFrame:NSMakeRect(12, 6, NSWidth(frame) - 24, 16)] autorelease];
+	[statusField setEditable:NO];
+	[statusField setBordered:NO];
+	[statusField setDrawsBackground:NO];
+	[statusField setFont:[NSFont systemFontOfSize:[NSFont smallSystemFontSize]]];
+	[statusField setAutoresizingMask:NSViewWidthSizable | NSViewMaxYMargin];
+	if([grid skippedCount])
+		[statusField setStringValue:[NSString stringWithFormat:GridString(@"%u resources, %u fields (%u resources too short to show)"), [grid rowCount], [grid columnCount], [grid skippedCount]]];
+	else [statusField setStringValue:[NSString stringWithFormat:GridString(@"%u resources, %u fields"), [grid rowCount], [grid columnCount]]];
+	[content addSubview:statusField];
+}
+
+- (NSUndoManager *)windowWillReturnUndoManager:(NSWindow *)sender
+{
+	return [document undoManager];
+}
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	// the grid has refreshed its cache by now or will have before the table draws
+	[gridTable setNeedsDisplay:YES];
+}
+
+#pragma mark -
+#pragma mark Table Management
+
+- (int)numberOfRowsInTableView:(NSTableView *)tableView
+{
+	return [grid rowCount];
+}
+
+- (id)tableView:(NSTableView *)tableView objectValueForTableColumn:(NSTableColumn *)tableColumn row:(int)row
+{
+	id identifier = [tableColumn identifier], value;
+	if([identifier isKindOfClass:[NSString class]])
+		return [(NSObject *)[grid resourceForRow:row] valueForKey:identifier];
+	value = [grid valueAtRow:row column:[identifier unsignedIntValue]];
+	return value == (id) [NSNull null]? nil : value;
+}
+
+/* Editing a row which is part of a multiple selection sets the field in every selected row. */
+- (void)tableView:(NSTableView *)tableView setObjectValue:(id)object forTableColumn:(NSTableColumn *)tableColumn row:(int)row
+{
+	NSIndexSet *rows = [tableView selectedRowIndexes];
+	if(![rows containsIndex:row]) rows = [NSIndexSet indexSetWithIndex:row];
+	if(![grid setStringValue:[object description] atRows:rows column:[[tableColumn identifier] unsignedIntValue]])
+		NSBeep();
+	[tableView reloadData];
+}
+
+@end
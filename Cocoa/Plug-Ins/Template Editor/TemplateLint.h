@@ -0,0 +1,36 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		TemplateLint.h
+
+	PURPOSE:	Checks a TMPL for structural mistakes when it is compiled,
+				works out the smallest and largest resource it can describe,
+				and checks resources against it. Fixed-size templates need
+				nothing more than a length comparison; others are read
+				through a TemplateStream to see whether they end early or
+				leave data over. Whole documents are scanned in parallel.
+   ========================================================================== */
+
+#import <Foundation/Foundation.h>
+#import "ResKnifeResourceProtocol.h"
+
+@interface TemplateLint : NSObject
+{
+	NSArray *templateStructure;		// Pre-parsed TMPL, with its keys compiled.
+	NSMutableArray *problems;		// Descriptions of faults in the TMPL itself.
+	unsigned int minimumSize;
+	unsigned int maximumSize;		// kUnboundedSize if the template has lists, hex dumps or C strings.
+}
+
+- (id)initWithTemplateData:(NSData *)tmpl elements:(NSArray *)elements;
+
+- (NSArray *)problems;
+- (unsigned int)minimumSize;
+- (unsigned int)maximumSize;
+- (BOOL)hasStaticSize;
+- (NSString *)sizeDescription;
+
+- (NSString *)problemWithResourceData:(NSData *)data;		// nil if the data fits the template. Safe to call from any thread.
+- (NSArray *)problemsWithResourceData:(NSArray *)dataArray;	// the same for many resources at once, with NSNull for those which fit
+- (NSString *)reportForResources:(NSArray *)resources;		// resources are id <ResKnifeResourceProtocol>
+
+@end
@@ -0,0 +1,259 @@
+#import "TemplateLint.h"
+#import "TemplateStream.h"
+#import "Element.h"
+#import "ElementKEYB.h"
+#import "TemplateScan.h"
+
+#define LintString(s)	NSLocalizedStringFromTableInBundle(s, nil, [NSBundle bundleForClass:[TemplateLint class]], nil)
+
+@interface TemplateLint (Private)
+- (void)checkTemplateData:(NSData *)tmpl;
+- (void)checkKeysInElements:(NSArray *)elements sections:(NSMutableArray *)sections;
+@end
+
+@implementation TemplateLint
+
+- (id)initWithTemplateData:(NSData *)tmpl elements:(NSArray *)elements
+{
+	NSMutableArray *sections = [NSMutableArray array];
+	ElementKEYB *section;
+	NSEnumerator *enumerator;
+
+	self = [super init];
+	if(!self) return nil;
+	templateStructure = [elements retain];
+	problems = [[NSMutableArray alloc] init];
+
+	// faults in the TMPL's layout
+	[self checkTemplateData:tmpl];
+
+	// faults in keyed sections, which are only apparent once their keys have been compiled
+	[self checkKeysInElements:templateStructure sections:sections];
+	enumerator = [sections objectEnumerator];
+	while(section = [enumerator nextObject])
+		[problems addObject:[NSString stringWithFormat:LintString(@"Keyed section '%@' has no key field before it."), [section label]]];
+
+	[Element getMinimumSize:&minimumSize maximumSize:&maximumSize ofElements:templateStructure];
+	return self;
+}
+
+- (void)dealloc
+{
+	[templateStructure release];
+	[problems release];
+	[super dealloc];
+}
+
+/* Works on the raw TMPL rather than the parsed elements, because the parser
+	quietly copes with most mistakes, e.g. an LSTB with no LSTE simply takes
+	the rest of the template as its entry. */
+- (void)checkTemplateData:(NSData *)tmpl
+{
+	const unsigned char *bytes = [tmpl bytes];
+	unsigned int offset = 0, length = [tmpl length];
+	NSMutableArray *openTypes = [NSMutableArray array];		// LSTB/LSTZ/LSTC/KEYB fields still waiting for their LSTE/KEYE
+	NSMutableArray *openLabels = [NSMutableArray array];
+	NSString *consumer = nil;								// label of a field which reads everything after it
+	BOOL reportedUnreachable = NO;
+	TemplateStream *registry = [TemplateStream streamWithBytes:NULL length:0];
+
+	while(offset < length)
+	{
+		NSString *label, *type;
+		unsigned int labelLength = bytes[offset];
+		if(offset + labelLength + 5 > length)
+		{
+			[problems addObject:[NSString stringWithFormat:LintString(@"The template ends part way through a field, %u bytes from the end."), length - offset]];
+			break;
+		}
+		label = [[[NSString alloc] initWithBytes:bytes+offset+1 length:labelLength encoding:NSMacOSRomanStringEncoding] autorelease];
+		type = [[[NSString alloc] initWithBytes:bytes+offset+1+labelLength length:4 encoding:NSMacOSRomanStringEncoding] autorelease];
+		offset += labelLength + 5;
+
+		// closing fields
+		if([type isEqualToString:@"LSTE"] || [type isEqualToString:@"KEYE"])
+		{
+			NSString *openType = [openTypes lastObject];
+			BOOL isList = [type isEqualToString:@"LSTE"];
+			if(!openType || isList != ![openType isEqualToString:@"KEYB"])
+				[problems addObject:[NSString stringWithFormat:LintString(@"'%@' (%@) has no matching %@."), label, type, isList? @"LSTB":@"KEYB"]];
+			else
+			{
+				// a list with neither counter nor terminator runs to the end of the resource (unless it's in one of several alternative keyed sections)
+				NSString *openLabel = [openLabels lastObject];
+				[openTypes removeLastObject];
+				[openLabels removeLastObject];
+				if([openType isEqualToString:@"LSTB"] && !consumer && ![openTypes containsObject:@"KEYB"])
+					consumer = openLabel;
+			}
+			continue;
+		}
+
+		// fields which nothing can be read after
+		if(consumer && !reportedUnreachable)
+		{
+			[problems addObject:[NSString stringWithFormat:LintString(@"'%@' (%@) and any fields after it can never be read, because '%@' takes up the rest of the resource."), label, type, consumer]];
+			reportedUnreachable = YES;
+		}
+		if([type isEqualToString:@"HEXD"] && !consumer)
+			consumer = label;
+
+		// opening fields
+		if([type isEqualToString:@"LSTB"] || [type isEqualToString:@"LSTZ"] || [type isEqualToString:@"LSTC"] || [type isEqualToString:@"KEYB"])
+		{
+			[openTypes addObject:type];
+			[openLabels addObject:label];
+		}
+
+		// everything else
+		else if(![[registry fieldRegistry] objectForKey:type] && ![registry classForFixedWidthType:type])
+			[problems addObject:[NSString stringWithFormat:LintString(@"'%@' has unknown type '%@'; resources will be shown as hex from this point on."), label, type]];
+	}
+
+	while([openTypes count])
+	{
+		[problems addObject:[NSString stringWithFormat:LintString(@"'%@' (%@) is never closed."), [openLabels lastObject], [openTypes lastObject]]];
+		[openTypes removeLastObject];
+		[openLabels removeLastObject];
+	}
+}
+
+// collects every KEYB section in the tree, minus those which belong to a key, so the caller is left with orphans
+- (void)checkKeysInElements:(NSArray *)elements sections:(NSMutableArray *)sections
+{
+	Element *element;
+	NSEnumerator *enumerator = [elements objectEnumerator];
+	while(element = [enumerator nextObject])
+	{
+		int i;
+		NSMutableArray *children = [NSMutableArray array];
+		if([element class] == [ElementKEYB class] && ![sections containsObject:element])
+			[sections addObject:element];
+		if([element isKey])
+		{
+			Element *section;
+			NSEnumerator *sectionEnumerator = [[element unreachableSections] objectEnumerator];
+			while(section = [sectionEnumerator nextObject])
+				[problems addObject:[NSString stringWithFormat:LintString(@"Keyed section '%@' of '%@' can never be selected; earlier sections claim all its values."), [section label], [element label]]];
+			[sections addObjectsFromArray:[element keyedSections]];	// stops them being added as orphans later
+		}
+		for(i = 0; i < [element subElementCount]; i++)
+			[children addObject:[element subElementAtIndex:i]];
+		[self checkKeysInElements:children sections:sections];
+	}
+
+	// sections claimed by keys at this level are not orphans
+	enumerator = [elements objectEnumerator];
+	while(element = [enumerator nextObject])
+		if([element isKey]) [sections removeObjectsInArray:[element keyedSections]];
+}
+
+#pragma mark -
+
+- (NSArray *)problems
+{
+	return problems;
+}
+
+- (unsigned int)minimumSize
+{
+	return minimumSize;
+}
+
+- (unsigned int)maximumSize
+{
+	return maximumSize;
+}
+
+- (BOOL)hasStaticSize
+{
+	return minimumSize == maximumSize;
+}
+
+- (NSString *)sizeDescription
+{
+	if([self hasStaticSize])
+		return [NSString stringWithFormat:LintString(@"exactly %u bytes"), minimumSize];
+	if(maximumSize == kUnboundedSize)
+		return [NSString stringWithFormat:LintString(@"at least %u bytes"), minimumSize];
+	return [NSString stringWithFormat:LintString(@"between %u and %u bytes"), minimumSize, maximumSize];
+}
+
+#pragma mark -
+#pragma mark Checking Resources
+
+- (NSString *)problemWithResourceData:(NSData *)data
+{
+	unsigned int length = [data length], size = 0;
+	NSMutableArray *structure;
+	TemplateStream *stream;
+	Element *element;
+	NSEnumerator *enumerator;
+
+	if(length < minimumSize)
+		return [NSString stringWithFormat:LintString(@"%u bytes long, but the template needs at least %u."), length, minimumSize];
+	if(maximumSize != kUnboundedSize && length > maximumSize)
+		return [NSString stringWithFormat:LintString(@"%u bytes long, but the template describes at most %u."), length, maximumSize];
+	if([self hasStaticSize])
+		return nil;
+
+	// otherwise the only way to know where the data ends is to read it
+	structure = [NSMutableArray array];
+	stream = [TemplateStream streamWithBytes:(char *)[data bytes] length:length];
+	[stream readTemplateElements:templateStructure intoArray:structure];
+	if([stream bytesToGo] > 0)
+		return [NSString stringWithFormat:LintString(@"%u bytes left over after reading the template."), [stream bytesToGo]];
+
+	// reads past the end are clipped, so compare with what the fields think they occupy
+	enumerator = [structure objectEnumerator];
+	while(element = [enumerator nextObject])
+		size += [element sizeOnDisk];
+	if(size > length)
+		return [NSString stringWithFormat:LintString(@"ends %u bytes before the template does."), size - length];
+	return nil;
+}
+
+- (NSArray *)problemsWithResourceData:(NSArray *)dataArray
+{
+	return [TemplateScan resultsOfSelector:@selector(problemWithResourceData:) target:self withObjects:dataArray];
+}
+
+- (NSString *)reportForResources:(NSArray *)resources
+{
+	unsigned int i, failures = 0;
+	NSMutableString *report = [NSMutableString string];
+	NSMutableArray *dataArray = [NSMutableArray arrayWithCapacity:[resources count]];
+	NSArray *results;
+	NSString *problem;
+	NSEnumerator *enumerator;
+
+	// the resources themselves are only touched on this thread
+	for(i = 0; i < [resources count]; i++)
+		[dataArray addObject:[[resources objectAtIndex:i] data]];
+	results = [self problemsWithResourceData:dataArray];
+
+	[report appendFormat:LintString(@"Resources using this template are %@.\n"), [self sizeDescription]];
+	if([problems count])
+	{
+		[report appendString:LintString(@"\nProblems with the template:\n")];
+		enumerator = [problems objectEnumerator];
+		while(problem = [enumerator nextObject])
+			[report appendFormat:@"\t%@\n", problem];
+	}
+
+	for(i = 0; i < [results count]; i++)
+	{
+		id <ResKnifeResourceProtocol> resource = [resources objectAtIndex:i];
+		problem = [results objectAtIndex:i];
+		if(problem == (id) [NSNull null]) continue;
+		if(failures++ == 0)
+			[report appendString:LintString(@"\nResources which don't fit:\n")];
+		[report appendFormat:@"\t'%@' %@ \"%@\": %@\n", [resource type], [resource resID], [resource name], problem];
+	}
+	if(failures == 0)
+		[report appendFormat:LintString(@"\nAll %u resources fit the template.\n"), [results count]];
+	else [report appendFormat:LintString(@"\n%u of %u resources don't fit the template.\n"), failures, [results count]];
+	return report;
+}
+
+@end
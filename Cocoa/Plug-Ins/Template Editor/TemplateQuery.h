@@ -0,0 +1,47 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		TemplateQuery.h
+
+	PURPOSE:	Answers questions like "every weap whose Damage > 40" by
+				pulling one template field (and optionally a second to group
+				by) out of every resource of a type, filtering, and summing
+				up. Values are extracted in parallel by TemplateScan, and
+				for fields at a known offset only their bytes are touched.
+   ========================================================================== */
+
+#import <Foundation/Foundation.h>
+
+@class TemplateField;
+
+enum QueryComparison
+{
+	kQueryAll = 0,
+	kQueryEqual,
+	kQueryNotEqual,
+	kQueryLessThan,
+	kQueryAtMost,
+	kQueryGreaterThan,
+	kQueryAtLeast,
+	kQueryContains
+};
+
+@interface TemplateQuery : NSObject
+{
+	TemplateField *field;		// the field whose values are wanted
+	TemplateField *groupField;	// optional second field to group the results by
+	int comparison;
+	id operand;					// NSNumber for numeric fields, NSString otherwise
+}
+
+- (id)initWithField:(TemplateField *)f;
+- (void)setComparison:(int)c operand:(NSString *)value;
+- (void)setGroupField:(TemplateField *)f;
+- (TemplateField *)field;
+- (TemplateField *)groupField;
+
+// rows are dictionaries with keys "resource", "resID", "name", "value" and (if grouping) "group", for resources passing the filter
+- (NSArray *)rowsForResources:(NSArray *)resources;
+- (NSArray *)groupsOfRows:(NSArray *)rows;			// one summary per distinct group value, with its value under "group"
++ (NSDictionary *)summaryOfRows:(NSArray *)rows;	// "count", "min", "max", and for numeric fields "sum" & "mean"
+
+@end
@@ -0,0 +1,186 @@
+#import "TemplateQuery.h"
+#import "TemplateField.h"
+#import "TemplateScan.h"
+#import "ResKnifeResourceProtocol.h"
+
+@interface TemplateQuery (Private)
+- (BOOL)valuePassesFilter:(id)value;
+- (NSArray *)valuesInData:(NSData *)data;
+@end
+
+@implementation TemplateQuery
+
+- (id)initWithField:(TemplateField *)f
+{
+	self = [super init];
+	if(!self) return nil;
+	field = [f retain];
+	comparison = kQueryAll;
+	return self;
+}
+
+- (void)dealloc
+{
+	[field release];
+	[groupField release];
+	[operand release];
+	[super dealloc];
+}
+
+- (void)setComparison:(int)c operand:(NSString *)value
+{
+	id old = operand;
+	comparison = c;
+	if([field isNumeric] && c != kQueryContains)
+		operand = [[NSNumber alloc] initWithDouble:[value doubleValue]];
+	else operand = [value copy];
+	[old release];
+}
+
+- (void)setGroupField:(TemplateField *)f
+{
+	id old = groupField;
+	groupField = [f retain];
+	[old release];
+}
+
+- (TemplateField *)field
+{
+	return field;
+}
+
+- (TemplateField *)groupField
+{
+	return groupField;
+}
+
+#pragma mark -
+
+- (BOOL)valuePassesFilter:(id)value
+{
+	NSComparisonResult order;
+	if(comparison == kQueryAll) return YES;
+	if(comparison == kQueryContains)
+		return [[value description] rangeOfString:operand options:NSCaseInsensitiveSearch].location != NSNotFound;
+	
+	if([value isKindOfClass:[NSNumber class]])
+		order = [(NSNumber *)value compare:operand];
+	else order = [[value description] caseInsensitiveCompare:operand];
+	switch(comparison)
+	{
+		case kQueryEqual:		return order == NSOrderedSame;
+		case kQueryNotEqual:	return order != NSOrderedSame;
+		case kQueryLessThan:	return order == NSOrderedAscending;
+		case kQueryAtMost:		return order != NSOrderedDescending;
+		case kQueryGreaterThan:	return order == NSOrderedDescending;
+		case kQueryAtLeast:		return order != NSOrderedAscending;
+	}
+	return NO;
+}
+
+// runs on a TemplateScan thread; returns nil for resources which are too short or are filtered out
+- (NSArray *)valuesInData:(NSData *)data
+{
+	id value = [field valueInData:data];
+	if(!value || ![self valuePassesFilter:value]) return nil;
+	if(groupField)
+	{
+		id group = [groupField valueInData:data];
+		if(!group) return nil;
+		return [NSArray arrayWithObjects:value, group, nil];
+	}
+	return [NSArray arrayWithObject:value];
+}
+
+- (NSArray *)rowsForResources:(NSArray *)resources
+{
+	unsigned int i;
+	NSArray *results;
+	NSMutableArray *rows = [NSMutableArray array];
+	NSMutableArray *dataArray = [NSMutableArray arrayWithCapacity:[resources count]];
+	
+	// the resources themselves are only touched on this thread
+	for(i = 0; i < [resources count]; i++)
+		[dataArray addObject:[[resources objectAtIndex:i] data]];
+	results = [TemplateScan resultsOfSelector:@selector(valuesInData:) target:self withObjects:dataArray];
+	
+	for(i = 0; i < [results count]; i++)
+	{
+		id <ResKnifeResourceProtocol> resource = [resources objectAtIndex:i];
+		NSArray *values = [results objectAtIndex:i];
+		NSMutableDictionary *row;
+		if(values == (id) [NSNull null]) continue;
+		
+		row = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+			resource, @"resource",
+			[resource resID], @"resID",
+			[resource name], @"name",
+			[values objectAtIndex:0], @"value", nil];
+		if([values count] > 1)
+			[row setObject:[values objectAtIndex:1] forKey:@"group"];
+		[rows addObject:row];
+	}
+	return rows;
+}
+
+- (NSArray *)groupsOfRows:(NSArray *)rows
+{
+	id key;
+	NSDictionary *row;
+	NSMutableArray *groups = [NSMutableArray array];
+	NSMutableDictionary *rowsByGroup = [NSMutableDictionary dictionary];
+	NSEnumerator *enumerator = [rows objectEnumerator];
+	while(row = [enumerator nextObject])
+	{
+		NSMutableArray *groupRows;
+		key = [row objectForKey:@"group"];
+		if(!key) continue;
+		groupRows = [rowsByGroup objectForKey:key];
+		if(!groupRows)
+		{
+			groupRows = [NSMutableArray array];
+			[rowsByGroup setObject:groupRows forKey:key];
+		}
+		[groupRows addObject:row];
+	}
+	
+	enumerator = [rowsByGroup keyEnumerator];
+	while(key = [enumerator nextObject])
+	{
+		NSMutableDictionary *summary = [NSMutableDictionary dictionaryWithDictionary:[TemplateQuery summaryOfRows:[rowsByGroup objectForKey:key]]];
+		[summary setObject:key forKey:@"group"];
+		[groups addObject:summary];
+	}
+	return groups;
+}
+
++ (NSDictionary *)summaryOfRows:(NSArray *)rows
+{
+	id value, min = nil, max = nil;
+	double sum = 0.0;
+	BOOL numeric = YES;
+	NSDictionary *row;
+	NSMutableDictionary *summary = [NSMutableDictionary dictionary];
+	NSEnumerator *enumerator = [rows objectEnumerator];
+	while(row = [enumerator nextObject])
+	{
+		value = [row objectForKey:@"value"];
+		if(!min || [value compare:min] == NSOrderedAscending)	min = value;
+		if(!max || [value compare:max] == NSOrderedDescending)	max = value;
+		if([value isKindOfClass:[NSNumber class]])
+			sum += [value doubleValue];
+		else numeric = NO;
+	}
+	
+	[summary setObject:[NSNumber numberWithUnsignedInt:[rows count]] forKey:@"count"];
+	if(min) [summary setObject:min forKey:@"min"];
+	if(max) [summary setObject:max forKey:@"max"];
+	if(numeric && [rows count])
+	{
+		[summary setObject:[NSNumber numberWithDouble:sum] forKey:@"sum"];
+		[summary setObject:[NSNumber numberWithDouble:sum / [rows count]] forKey:@"mean"];
+	}
+	return summary;
+}
+
+@end
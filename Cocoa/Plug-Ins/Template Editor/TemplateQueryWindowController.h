@@ -0,0 +1,32 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		TemplateQueryWindowController.h
+
+	PURPOSE:	A window for querying one field of every resource of a type
+				in all open documents (see TemplateQuery), showing either
+				the matching resources or one row per group in a sortable
+				table, with a summary underneath. The window is built in
+				code as the template editor's nib has no room for it.
+   ========================================================================== */
+
+#import <Cocoa/Cocoa.h>
+
+@interface TemplateQueryWindowController : NSWindowController
+{
+	NSString *resType;
+	NSArray *fields;				// TemplateFields of the template's top level
+	NSMutableArray *rows;			// results being displayed
+	BOOL showsGroups;
+	
+	NSPopUpButton *fieldPopup;
+	NSPopUpButton *comparisonPopup;
+	NSTextField *operandField;
+	NSPopUpButton *groupPopup;
+	NSTableView *resultsTable;
+	NSTextField *summaryField;
+}
+
+- (id)initWithTemplate:(NSArray *)elements forType:(NSString *)type;
+- (IBAction)runQuery:(id)sender;
+
+@end
@@ -0,0 +1,193 @@
+#import "TemplateQueryWindowController.h"
+#import "TemplateQuery.h"
+#import "TemplateField.h"
+#import "ResKnifeResourceProtocol.h"
+
+#define QueryString(s)	NSLocalizedStringFromTableInBundle(s, nil, [NSBundle bundleForClass:[TemplateQueryWindowController class]], nil)
+
+@interface TemplateQueryWindowController (Private)
+- (void)buildWindow;
+- (void)setColumns:(NSArray *)identifiers titles:(NSArray *)titles;
+- (NSString *)stringForValue:(id)value;
+@end
+
+@implementation TemplateQueryWindowController
+
+- (id)initWithTemplate:(NSArray *)elements forType:(NSString *)type
+{
+	NSWindow *window = [[[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 600, 420) styleMask:NSTitledWindowMask | NSClosableWindowMask | NSMiniaturizableWindowMask | NSResizableWindowMask backing:NSBackingStoreBuffered defer:YES] autorelease];
+	self = [super initWithWindow:window];
+	if(!self) return nil;
+	resType = [type copy];
+	fields = [[TemplateField fieldsOfTemplate:elements] retain];
+	rows = [[NSMutableArray alloc] init];
+	[self buildWindow];
+	[window setTitle:[NSString stringWithFormat:QueryString(@"QueryWindowTitle"), resType]];
+	[window center];
+	return self;
+}
+
+- (void)dealloc
+{
+	[resultsTable setDataSource:nil];
+	[resType release];
+	[fields release];
+	[rows release];
+	[super dealloc];
+}
+
+- (void)buildWindow
+{
+	unsigned int i;
+	NSView *content = [[self window] contentView];
+	NSRect frame = [content frame];
+	NSButton *findButton;
+	NSScrollView *scrollView;
+	
+	// field, comparison, value, group by, find
+	fieldPopup = [[[NSPopUpButton alloc] initWithFrame:NSMakeRect(12, NSMaxY(frame) - 36, 150, 26) pullsDown:NO] autorelease];
+	for(i = 0; i < [fields count]; i++)
+		[fieldPopup addItemWithTitle:[NSString stringWithFormat:@"%@ (%@)", [[fields objectAtIndex:i] label], [[[fields objectAtIndex:i] element] type]]];
+	[fieldPopup setAutoresizingMask:NSViewMinYMargin];
+	[content addSubview:fieldPopup];
+	
+	comparisonPopup = [[[NSPopUpButton alloc] initWithFrame:NSMakeRect(166, NSMaxY(frame) - 36, 80, 26) pullsDown:NO] autorelease];
+	[comparisonPopup addItemsWithTitles:[NSArray arrayWithObjects:QueryString(@"any"), @"=", @"≠", @"<", @"≤", @">", @"≥", QueryString(@"contains"), nil]];
+	[comparisonPopup setAutoresizingMask:NSViewMinYMargin];
+	[content addSubview:comparisonPopup];
+	
+	operandField = [[[NSTextField alloc] initWithFrame:NSMakeRect(250, NSMaxY(frame) - 33, 100, 22)] autorelease];
+	[operandField setAutoresizingMask:NSViewMinYMargin | NSViewWidthSizable];
+	[operandField setTarget:self];
+	[operandField setAction:@selector(runQuery:)];
+	[content addSubview:operandField];
+	
+	groupPopup = [[[NSPopUpButton alloc] initWithFrame:NSMakeRect(NSMaxX(frame) - 240, NSMaxY(frame) - 36, 150, 26) pullsDown:NO] autorelease];
+	[groupPopup addItemWithTitle:QueryString(@"No Grouping")];
+	for(i = 0; i < [fields count]; i++)
+		[groupPopup addItemWithTitle:[NSString stringWithFormat:QueryString(@"By %@"), [[fields objectAtIndex:i] label]]];
+	[groupPopup setAutoresizingMask:NSViewMinYMargin | NSViewMinXMargin];
+	[content addSubview:groupPopup];
+	
+	findButton = [[[NSButton alloc] initWithFrame:NSMakeRect(NSMaxX(frame) - 86, NSMaxY(frame) - 38, 78, 32)] autorelease];
+	[findButton setTitle:QueryString(@"Find")];
+	[findButton setBezelStyle:NSRoundedBezelStyle];
+	[findButton setKeyEquivalent:@"\r"];
+	[findButton setTarget:self];
+	[findButton setAction:@selector(runQuery:)];
+	[findButton setAutoresizingMask:NSViewMinYMargin | NSViewMinXMargin];
+	[content addSubview:findButton];
+	
+	// results
+	scrollView = [[[NSScrollView alloc] initWithFrame:NSMakeRect(-1, 28, NSWidth(frame) + 2, NSHeight(frame) - 72)] autorelease];
+	[scrollView setHasVerticalScroller:YES];
+	[scrollView setHasHorizontalScroller:YES];
+	[scrollView setBorderType:NSBezelBorder];
+	[scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+	resultsTable = [[[NSTableView alloc] initWithFrame:[[scrollView contentView] bounds]] autorelease];
+	[resultsTable setUsesAlternatingRowBackgroundColors:YES];
+	[resultsTable setDataSource:self];
+	[resultsTable setDelegate:self];
+	[scrollView setDocumentView:resultsTable];
+	[content addSubview:scrollView];
+	[self setColumns:[NSArray arrayWithObjects:@"resID", @"name", @"value", nil] titles:[NSArray arrayWithObjects:QueryString(@"ID"), QueryString(@"Name"), QueryString(@"Value"), nil]];
+	
+	summaryField = [[[NSTextField alloc] initWithFrame:NSMakeRect(12, 6, NSWidth(frame) - 24, 16)] autorelease];
+	[summaryField setEditable:NO];
+	[summaryField setBordered:NO];
+	[summaryField setDrawsBackground:NO];
+	[summaryField setFont:[NSFont systemFontOfSize:[NSFont smallSystemFontSize]]];
+	[summaryField setAutoresizingMask:NSViewWidthSizable | NSViewMaxYMargin];
+	[summaryField setStringValue:@""];
+	[content addSubview:summaryField];
+}
+
+- (void)setColumns:(NSArray *)identifiers titles:(NSArray *)titles
+{
+	unsigned int i;
+	while([[resultsTable tableColumns] count])
+		[resultsTable removeTableColumn:[[resultsTable tableColumns] lastObject]];
+	for(i = 0; i < [identifiers count]; i++)
+	{
+		NSString *identifier = [identifiers objectAtIndex:i];
+		NSTableColumn *column = [[[NSTableColumn alloc] initWithIdentifier:identifier] autorelease];
+		[[column headerCell] setStringValue:[titles objectAtIndex:i]];
+		[column setWidth:[identifier isEqualToString:@"name"]? 200:90];
+		[column setEditable:NO];
+		[column setSortDescriptorPrototype:[[[NSSortDescriptor alloc] initWithKey:identifier ascending:YES] autorelease]];
+		[resultsTable addTableColumn:column];
+	}
+	[resultsTable setSortDescriptors:[NSArray array]];
+}
+
+#pragma mark -
+
+- (IBAction)runQuery:(id)sender
+{
+	int fieldIndex = [fieldPopup indexOfSelectedItem], groupIndex = [groupPopup indexOfSelectedItem] - 1;
+	NSArray *resources;
+	NSDictionary *summary;
+	TemplateQuery *query;
+	if(fieldIndex < 0 || fieldIndex >= (int) [fields count]) return;
+	
+	query = [[[TemplateQuery alloc] initWithField:[fields objectAtIndex:fieldIndex]] autorelease];
+	[query setComparison:[comparisonPopup indexOfSelectedItem] operand:[operandField stringValue]];
+	if(groupIndex >= 0) [query setGroupField:[fields objectAtIndex:groupIndex]];
+	
+	// all open documents, not just the one the template editor was opened from
+	resources = [NSClassFromString(@"Resource") allResourcesOfType:resType inDocument:nil];
+	[rows setArray:[query rowsForResources:resources]];
+	summary = [TemplateQuery summaryOfRows:rows];
+	
+	if(groupIndex >= 0)
+	{
+		showsGroups = YES;
+		[rows setArray:[query groupsOfRows:rows]];
+		[self setColumns:[NSArray arrayWithObjects:@"group", @"count", @"min", @"max", @"sum", nil] titles:[NSArray arrayWithObjects:[[query groupField] label], QueryString(@"Count"), QueryString(@"Min"), QueryString(@"Max"), QueryString(@"Sum"), nil]];
+	}
+	else if(showsGroups || sender == nil)
+	{
+		showsGroups = NO;
+		[self setColumns:[NSArray arrayWithObjects:@"resID", @"name", @"value", nil] titles:[NSArray arrayWithObjects:QueryString(@"ID"), QueryString(@"Name"), [[query field] label], nil]];
+	}
+	else [[[resultsTable tableColumnWithIdentifier:@"value"] headerCell] setStringValue:[[query field] label]];
+	[rows sortUsingDescriptors:[resultsTable sortDescriptors]];
+	[resultsTable reloadData];
+	
+	if([summary objectForKey:@"sum"])
+		[summaryField setStringValue:[NSString stringWithFormat:QueryString(@"%@ of %u resources match; min %@, max %@, sum %@, mean %@"), [summary objectForKey:@"count"], [resources count],
+			[self stringForValue:[summary objectForKey:@"min"]], [self stringForValue:[summary objectForKey:@"max"]], [self stringForValue:[summary objectForKey:@"sum"]], [self stringForValue:[summary objectForKey:@"mean"]]]];
+	else [summaryField setStringValue:[NSString stringWithFormat:QueryString(@"%@ of %u resources match"), [summary objectForKey:@"count"], [resources count]]];
+}
+
+- (NSString *)stringForValue:(id)value
+{
+	if([value isKindOfClass:[NSNumber class]])
+	{
+		double d = [value doubleValue];
+		if(d == (double)(long long) d) return [NSString stringWithFormat:@"%lld", (long long) d];
+		return [NSString stringWithFormat:@"%.3f", d];
+	}
+	return value? [value description] : @"";
+}
+
+#pragma mark -
+#pragma mark Table Management
+
+- (int)numberOfRowsInTableView:(NSTableView *)tableView
+{
+	return [rows count];
+}
+
+- (id)tableView:(NSTableView *)tableView objectValueForTableColumn:(NSTableColumn *)tableColumn row:(int)row
+{
+	return [self stringForValue:[[rows objectAtIndex:row] objectForKey:[tableColumn identifier]]];
+}
+
+- (void)tableView:(NSTableView *)tableView sortDescriptorsDidChange:(NSArray *)oldDescriptors
+{
+	[rows sortUsingDescriptors:[tableView sortDescriptors]];
+	[tableView reloadData];
+}
+
+@end
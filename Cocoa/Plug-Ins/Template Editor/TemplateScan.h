@@ -0,0 +1,27 @@
+/* =============================================================================
+	PROJECT:	ResKnife
+	FILE:		TemplateScan.h
+
+	PURPOSE:	Sends one message per object of an array, spread over as
+				many threads as there are processors, and collects the
+				results in order. Used to check or query every resource of
+				a type at once. The selector must take one object and return
+				an autoreleased object (or nil), and must be thread safe.
+   ========================================================================== */
+
+#import <Foundation/Foundation.h>
+
+@interface TemplateScan : NSObject
+{
+	id target;
+	SEL selector;
+	NSArray *objects;
+	id *results;
+	unsigned int threadCount;
+	NSConditionLock *lock;		// condition is the number of threads which have finished
+}
+
+// returns an array the same size as objects, with NSNull in place of nil results
++ (NSArray *)resultsOfSelector:(SEL)sel target:(id)target withObjects:(NSArray *)objects;
+
+@end
@@ -0,0 +1,82 @@
+#import "TemplateScan.h"
+#import <CoreServices/CoreServices.h>	// for MPProcessorsScheduled()
+
+@interface TemplateScan (Private)
+- (id)initWithSelector:(SEL)sel target:(id)t objects:(NSArray *)o;
+- (NSArray *)run;
+- (void)scanThread:(NSNumber *)firstIndex;
+@end
+
+@implementation TemplateScan
+
++ (NSArray *)resultsOfSelector:(SEL)sel target:(id)t withObjects:(NSArray *)o
+{
+	TemplateScan *scan = [[[self alloc] initWithSelector:sel target:t objects:o] autorelease];
+	return [scan run];
+}
+
+- (id)initWithSelector:(SEL)sel target:(id)t objects:(NSArray *)o
+{
+	self = [super init];
+	if(!self) return nil;
+	target = [t retain];
+	selector = sel;
+	objects = [o retain];
+	return self;
+}
+
+- (void)dealloc
+{
+	[target release];
+	[objects release];
+	[super dealloc];
+}
+
+- (NSArray *)run
+{
+	unsigned int i, count = [objects count];
+	NSMutableArray *array = [NSMutableArray arrayWithCapacity:count];
+	if(count == 0) return array;
+
+	// each thread takes every threadCount'th object, and keeps its answer in its own slot of results
+	results = (id *) calloc(count, sizeof(id));
+	threadCount = MPProcessorsScheduled();
+	if(threadCount < 1) threadCount = 1;
+	if(threadCount > count) threadCount = count;
+	lock = [[NSConditionLock alloc] initWithCondition:0];
+	for(i = 0; i < threadCount; i++)
+		[NSThread detachNewThreadSelector:@selector(scanThread:) toTarget:self withObject:[NSNumber numberWithUnsignedInt:i]];
+
+	// wait for them all to finish
+	[lock lockWhenCondition:threadCount];
+	[lock unlock];
+
+	for(i = 0; i < count; i++)
+	{
+		if(results[i])	[array addObject:[results[i] autorelease]];
+		else			[array addObject:[NSNull null]];
+	}
+	free(results);
+	results = NULL;
+	[lock release];
+	lock = nil;
+	return array;
+}
+
+- (void)scanThread:(NSNumber *)firstIndex
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+	unsigned int i, count = [objects count];
+	for(i = [firstIndex unsignedIntValue]; i < count; i += threadCount)
+	{
+		NSAutoreleasePool *objectPool = [[NSAutoreleasePool alloc] init];
+		results[i] = [[target performSelector:selector withObject:[objects objectAtIndex:i]] retain];
+		[objectPool release];
+	}
+
+	[lock lock];
+	[lock unlockWithCondition:[lock condition] + 1];
+	[pool release];
+}
+
+@end
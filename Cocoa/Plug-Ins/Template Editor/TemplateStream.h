@@ -1,4 +1,5 @@
 #import <Foundation/Foundation.h>
+#import "FixedWidth.h"
 
 @class	Element, ElementOCNT;
 @interface TemplateStream : NSObject
@@ -7,6 +8,7 @@
 	unsigned int bytesToGo;
 	NSMutableArray *counterStack;
 	NSMutableArray *keyStack;
+	unsigned int bitPosition;	// bits of the current byte/word/long already claimed by bit fields, when parsing a TMPL
 }
 
 + (id)streamWithBytes:(char *)d length:(unsigned int)l;
@@ -24,13 +26,19 @@
 - (Element *)key;
 - (void)pushKey:(Element *)k;
 - (void)popKey;
+- (unsigned int)claimBits:(unsigned int)count ofUnit:(unsigned int)width;	// returns the offset of the bits within the unit
 
 - (Element *)readOneElement;	// For parsing of 'TMPL' resource as template.
+- (void)readTemplateElements:(NSArray *)elements intoArray:(NSMutableArray *)array;	// Clones the TMPL elements and reads resource data into them.
 - (unsigned int)bytesToNull;
 - (void)advanceAmount:(unsigned int)l pad:(BOOL)pad;					// advance r/w pointer and optionally write padding bytes
 - (void)peekAmount:(unsigned int)l toBuffer:(void *)buffer;				// read bytes without advancing pointer
 - (void)readAmount:(unsigned int)l toBuffer:(void *)buffer;				// stream reading
 - (void)writeAmount:(unsigned int)l fromBuffer:(const void *)buffer;	// stream writing
+- (void)pokeAmount:(unsigned int)l fromBuffer:(const void *)buffer;		// write bytes without advancing pointer
 - (NSMutableDictionary *)fieldRegistry;
+- (Class)classForFixedWidthType:(NSString *)type;						// for parameterised types like Hnnn which can't go in the registry
+
++ (FixedWidthLayout *)fixedWidthLayoutForElements:(NSArray *)elements;	// NULL unless every element is fixed-width; free() the result
 
 @end
@@ -22,6 +22,9 @@
 #import "ElementLSTC.h"
 #import "ElementLSTE.h"
 #import "ElementKEYB.h"
+#import "ElementCASE.h"
+#import "ElementBFLG.h"
+#import "ElementBBIT.h"
 
 @implementation TemplateStream
 
@@ -102,22 +105,28 @@
 
 - (Element *)key
 {
-	NSLog(@"Getting last key of stack: %@", keyStack);
-	return [counterStack lastObject];
+	return (Element *) [keyStack lastObject];
 }
 
 - (void)pushKey:(Element *)k
 {
 	[keyStack addObject:k];
-	NSLog(@"Pushed key to stack: %@", keyStack);
 }
 
 - (void)popKey
 {
-	NSLog(@"Popping key from stack: %@", keyStack);
 	[keyStack removeLastObject];
 }
 
+- (unsigned int)claimBits:(unsigned int)count ofUnit:(unsigned int)width
+{
+	unsigned int offset = bitPosition;
+	bitPosition += count;
+	if(bitPosition >= width * 8)
+		bitPosition = 0;
+	return offset;
+}
+
 #pragma mark -
 
 - (Element *)readOneElement
@@ -139,8 +148,14 @@
 		return [ElementHEXD elementForType:@"HEXD" withLabel:NSLocalizedString(@"Error: Hex Dump", nil)];
 	}
 	
+	// bit fields share their unit only with the bit fields immediately preceeding them (ignoring comments & CASE values)
+	FixedWidthField field;
+	if(!FixedWidthFieldForType([type cString], &field) || (field.kind != kFixedWidthBits && field.width > 0))
+		bitPosition = 0;
+	
 	// create element class
 	Class class = [[self fieldRegistry] objectForKey:type];
+	if(!class) class = [self classForFixedWidthType:type];
 	if(class)
 	{
 		Element *element = (Element *) [class elementForType:type withLabel:label];
@@ -155,6 +170,28 @@
 	}
 }
 
+- (void)readTemplateElements:(NSArray *)elements intoArray:(NSMutableArray *)array
+{
+	Element *element;
+	NSEnumerator *enumerator = [elements objectEnumerator];
+	while(element = [enumerator nextObject])
+	{
+		Element *clone = [[element copy] autorelease];	// copy the template object.
+		[array addObject:clone];						// add it to our parsed resource data list. Do this right away so the element can append other items should it desire to.
+		[clone setParentArray:array];					// the parent for these is the root level array
+		Class cc = [clone class];
+		
+		BOOL pushedCounter = NO;
+		if(cc == [ElementOCNT class])
+		{	[self pushCounter:(ElementOCNT *)clone]; pushedCounter = YES; }
+		if([clone isKey])
+			[self pushKey:clone];						// popped by the key's last KEYB section
+		[clone readDataFrom:self];						// fill it with resource data.
+		if(cc == [ElementLSTE class] && pushedCounter)
+			[self popCounter];
+	}
+}
+
 - (void)advanceAmount:(unsigned int)l pad:(BOOL)pad
 {
 	if(l > bytesToGo) l = bytesToGo;
@@ -194,6 +231,12 @@
 	}
 }
 
+- (void)pokeAmount:(unsigned int)l fromBuffer:(const void *)buffer
+{
+	if(l > bytesToGo) l = bytesToGo;
+	if(l > 0) memmove(data, buffer, l);
+}
+
 #pragma mark -
 #pragma mark Misc
 
@@ -255,11 +298,21 @@
 	// key begin/end
 		[registry setObject:[ElementKEYB class] forKey:@"KEYB"];
 		[registry setObject:[ElementKEYE class] forKey:@"KEYE"];
+		[registry setObject:[ElementCASE class] forKey:@"CASE"];	// symbolic value for the preceeding field, also used to select keyed sections
 		
 	// dates
 		[registry setObject:[ElementDATE class] forKey:@"DATE"];	// 4-byte date (seconds since 1 Jan 1904)
 		[registry setObject:[ElementDATE class] forKey:@"MDAT"];
 		
+	// flags & bit fields
+		[registry setObject:[ElementBFLG class] forKey:@"BFLG"];	// binary flag the size of a byte/word/long
+		[registry setObject:[ElementBFLG class] forKey:@"WFLG"];
+		[registry setObject:[ElementBFLG class] forKey:@"LFLG"];
+		[registry setObject:[ElementBFLG class] forKey:@"BOOL"];	// true = 256; false = 0
+		[registry setObject:[ElementBBIT class] forKey:@"BBIT"];	// single bit within a byte/word/long (BBnn, WBnn & LBnn are handled by -classForFixedWidthType:)
+		[registry setObject:[ElementBBIT class] forKey:@"WBIT"];
+		[registry setObject:[ElementBBIT class] forKey:@"LBIT"];
+		
 	// and some faked ones just to increase compatibility (these are marked 'x' in the docs)
 		[registry setObject:[ElementUBYT class] forKey:@"HBYT"];	// hex byte/word/long
 		[registry setObject:[ElementUWRD class] forKey:@"HWRD"];
@@ -280,17 +333,12 @@
 		[registry setObject:[ElementPSTR class] forKey:@"KCHR"];	// keyed MacRoman values
 		[registry setObject:[ElementPSTR class] forKey:@"KTYP"];
 		[registry setObject:[ElementFBYT class] forKey:@"KRID"];	// key on ID of the resource
-		[registry setObject:[ElementUWRD class] forKey:@"BOOL"];	// true = 256; false = 0
-		[registry setObject:[ElementUBYT class] forKey:@"BFLG"];	// binary flag the size of a byte/word/long
-		[registry setObject:[ElementUWRD class] forKey:@"WFLG"];
-		[registry setObject:[ElementULNG class] forKey:@"LFLG"];
 		[registry setObject:[ElementDWRD class] forKey:@"RSID"];	// resouce id (signed word)
 		[registry setObject:[ElementULNG class] forKey:@"REAL"];	// single precision float
 		[registry setObject:[ElementULLG class] forKey:@"DOUB"];	// double precision float
 		[registry setObject:[ElementUWRD class] forKey:@"SFRC"];	// 0.16 fixed fraction
 		[registry setObject:[ElementUWRD class] forKey:@"FXYZ"];	// 1.15 fixed fraction
 		[registry setObject:[ElementUWRD class] forKey:@"FWID"];	// 4.12 fixed fraction
-		[registry setObject:[ElementFBYT class] forKey:@"CASE"];
 		[registry setObject:[ElementFBYT class] forKey:@"TITL"];	// resource title (e.g. utxt would have "Unicode Text"; must be first element of template, and not anywhere else)
 		[registry setObject:[ElementFBYT class] forKey:@"CMNT"];
 		[registry setObject:[ElementFBYT class] forKey:@"DVDR"];
@@ -303,11 +351,38 @@
 		[registry setObject:[ElementDWRD class] forKey:@"RGNC"];	// MacOS region code (RegionCode)
 		
 	// unhandled types at present, see file:///Users/nicholas/Sites/resknife.sf.net/resorcerer_comparison.html
-		// BBIT, BBnn, FBIT, FBnn, WBIT, WBnn
-		// Pnnn, Cnnn, Hnnn, Fnnn, HEXD
+		// FBIT, FBnn (FBnn is indistinguishable from a Fnnn filler)
 		// AWRD, ALNG (not so easy, element needs to know how much data preceeds it in the stream)
 	}
 	return registry;
 }
 
+- (Class)classForFixedWidthType:(NSString *)type
+{
+	FixedWidthField field;
+	if(!FixedWidthFieldForType([type cString], &field)) return nil;
+	switch(field.kind)
+	{
+		case kFixedWidthBits:	return [ElementBBIT class];		// BBnn, WBnn, LBnn
+		case kFixedWidthFiller:	return [ElementFBYT class];		// Fnnn
+		case kFixedWidthBytes:
+			if([type hasPrefix:@"H"]) return [ElementHEXD class];	// Hnnn
+			else return [ElementPSTR class];						// Pnnn, Cnnn
+	}
+	return nil;
+}
+
++ (FixedWidthLayout *)fixedWidthLayoutForElements:(NSArray *)elements
+{
+	FixedWidthLayout *layout;
+	unsigned i, count = [elements count];
+	const char **types = (const char **) malloc(count * sizeof(char *));
+	if(!types) return NULL;
+	for(i = 0; i < count; i++)
+		types[i] = [[[elements objectAtIndex:i] type] cString];
+	layout = FixedWidthLayoutCreate(types, count);
+	free(types);
+	return layout;
+}
+
 @end
@@ -22,6 +22,9 @@
 #import <Cocoa/Cocoa.h>
 #import "ResKnifePluginProtocol.h"
 #import "ResKnifeResourceProtocol.h"
+#import "FixedWidth.h"
+
+@class Element, TemplateLint, TemplateQueryWindowController, TemplateGridWindowController;
 
 @interface TemplateWindowController : NSWindowController <ResKnifeTemplatePluginProtocol>
 {
@@ -31,6 +34,10 @@
 	NSMutableDictionary	*toolbarItems;
 	NSMutableArray *templateStructure;		// Pre-parsed form of our template.
 	NSMutableArray *resourceStructure;		// Parsed form of our resource.
+	FixedWidthLayout *fixedLayout;			// Offsets of every field, if the template has no variable-length ones.
+	TemplateLint *lint;						// Problems with the template, and the size of resources it describes.
+	TemplateQueryWindowController *query;	// Field query across every resource of this type.
+	TemplateGridWindowController *grid;		// Every resource of this type in the document, one per row.
 	id <ResKnifeResourceProtocol> resource;	// The resource we operate on.
 	id <ResKnifeResourceProtocol> backup;	// The original resource.
 	BOOL liveEdit;
@@ -39,9 +46,14 @@
 - (void)setupToolbar;
 - (void)readTemplate:(id <ResKnifeResourceProtocol>)tmplRes;
 - (void)loadResource;
+- (void)loadFixedWidthResource;
+- (void)reloadSectionForKey:(Element *)key;
 - (IBAction)saveResource:(id)sender;
 - (IBAction)revertResource:(id)sender;
 - (IBAction)createListEntry:(id)sender;
+- (IBAction)validateResources:(id)sender;
+- (IBAction)queryResources:(id)sender;
+- (IBAction)showGrid:(id)sender;
 - (IBAction)cut:(id)sender;
 - (IBAction)copy:(id)sender;
 - (IBAction)paste:(id)sender;
@@ -3,10 +3,10 @@
 #import "Element.h"
 #import "ElementOCNT.h"
 #import "ElementLSTE.h"
-// and ones for keyed fields
-#import "ElementDBYT.h"
-#import "ElementDWRD.h"
-#import "ElementDLNG.h"
+#import "ElementKEYB.h"
+#import "TemplateLint.h"
+#import "TemplateQueryWindowController.h"
+#import "TemplateGridWindowController.h"
 
 #import "NSOutlineView-SelectedItems.h"
 
@@ -66,6 +66,12 @@
 	[toolbarItems release];
 	[templateStructure release];
 	[resourceStructure release];
+	if(fixedLayout) free(fixedLayout);
+	[lint release];
+	[query close];
+	[query release];
+	[grid close];
+	[grid release];
 	[(id)resource release];
 	[(id)backup release];
 	[super dealloc];
@@ -92,6 +98,13 @@
 
 - (void)templateDataDidChange:(NSNotification *)notification
 {
+	// the query and grid windows hold fields and offsets worked out from the old template; they're rebuilt when next opened
+	[query close];
+	[query release];
+	query = nil;
+	[grid close];
+	[grid release];
+	grid = nil;
 	[templateStructure removeAllObjects];
 	[self readTemplate:[notification object]];
 	if([self isWindowLoaded])
@@ -108,34 +121,15 @@
 
 - (void)loadResource
 {
-	// create new stream
-	TemplateStream *stream = [TemplateStream streamWithBytes:(char *)[[resource data] bytes] length:[[resource data] length]];
-	
-	// loop through template cloning its elements
-	Element *element;
 	[resourceStructure removeAllObjects];
-	NSEnumerator *enumerator = [templateStructure objectEnumerator];
-	while(element = [enumerator nextObject])
+	
+	// templates with no variable-length fields don't need a stream, see -loadFixedWidthResource
+	if(fixedLayout && [[resource data] length] == fixedLayout->size)
+		[self loadFixedWidthResource];
+	else
 	{
-		Element *clone = [[element copy] autorelease];	// copy the template object.
-//		NSLog(@"clone = %@; resourceStructure = %@", clone, resourceStructure);
-		[resourceStructure addObject:clone];			// add it to our parsed resource data list. Do this right away so the element can append other items should it desire to.
-		[clone setParentArray:resourceStructure];		// the parent for these is the root level resourceStructure object
-		Class cc = [clone class];
-		
-		BOOL pushedCounter = NO;
-		BOOL pushedKey = NO;
-		if(cc == [ElementOCNT class])
-		{	[stream pushCounter:(ElementOCNT *)clone]; pushedCounter = YES; }
-		if(cc == [ElementKBYT class] ||
-		   cc == [ElementKWRD class] ||
-		   cc == [ElementKLNG class] )
-		{	[stream pushKey:clone]; pushedKey = YES; }
-		[clone readDataFrom:stream];				// fill it with resource data.
-		if(cc == [ElementLSTE class] && pushedCounter)
-			[stream popCounter];
-//		if(cc == [ElementKEYE class] && pushedKey)
-//			[stream popKey];
+		TemplateStream *stream = [TemplateStream streamWithBytes:(char *)[[resource data] bytes] length:[[resource data] length]];
+		[stream readTemplateElements:templateStructure intoArray:resourceStructure];
 	}
 	
 	// reload the view
@@ -149,6 +143,100 @@
 	}
 }
 
+/* The whole resource is copied and byte-swapped in one pass over the layout's offset table, after which each
+	numeric field just picks its value out of the host-ordered buffer at its offset in the table. Fields with no
+	numeric value (strings, hex and fillers, which are never swapped) are read from one stream over the original
+	bytes, moved on to each one's offset. An element is still made per field, since they are the outline's rows.
+	A resource whose size doesn't match the template (truncated or with trailing data) goes through the stream
+	instead, so it is handled the same as before. */
+- (void)loadFixedWidthResource
+{
+	unsigned i;
+	NSData *data = [resource data];
+	NSMutableData *hostData = [NSMutableData dataWithData:data];
+	char *bytes = (char *) [hostData mutableBytes];
+	TemplateStream *stream = [TemplateStream streamWithBytes:(char *)[data bytes] length:[data length]];
+	IMP streamed = [Element instanceMethodForSelector:@selector(readFixedWidthValueFrom:)];
+	FixedWidthLayoutSwapToHost(fixedLayout, bytes);
+	for(i = 0; i < fixedLayout->count; i++)
+	{
+		UInt32 offset = fixedLayout->fields[i].offset, position;
+		Element *clone = [[[templateStructure objectAtIndex:i] copy] autorelease];
+		[resourceStructure addObject:clone];
+		[clone setParentArray:resourceStructure];
+		if([clone methodForSelector:@selector(readFixedWidthValueFrom:)] != streamed)
+			[clone readFixedWidthValueFrom:bytes + offset];
+		else
+		{
+			position = [data length] - [stream bytesToGo];
+			if(offset > position) [stream advanceAmount:offset - position pad:NO];
+			[clone readDataFrom:stream];
+		}
+	}
+}
+
+/* When a key field is edited only the section it selects needs decoding again; every other field still holds
+	valid values. The old section's bytes are handed to the new section so that switching keys reinterprets
+	the existing data the way the resource would be read from disk, rather than zeroing it. */
+- (void)reloadSectionForKey:(Element *)key
+{
+	NSMutableArray *parent = [key parentArray];
+	unsigned index = [parent indexOfObjectIdenticalTo:key];
+	if(!parent || index == NSNotFound) return;
+	index++;
+	
+	// serialise and remove the currently selected section, if any
+	NSMutableData *sectionData = [NSMutableData data];
+	if(index < [parent count])
+	{
+		ElementKEYB *oldSection = [parent objectAtIndex:index];
+		if([oldSection isKindOfClass:[ElementKEYB class]] && [[key keyedSections] containsObject:[oldSection sectionTemplate]])
+		{
+			[sectionData setLength:[oldSection sizeOnDisk]];
+			[oldSection writeDataTo:[TemplateStream streamWithBytes:(char *)[sectionData mutableBytes] length:[sectionData length]]];
+			[parent removeObjectAtIndex:index];
+		}
+	}
+	
+	// decode the newly selected section from those bytes
+	ElementKEYB *newTemplate = (ElementKEYB *) [key sectionForKeyValue:[key stringValue]];
+	if(newTemplate)
+	{
+		ElementKEYB *section = [[newTemplate copy] autorelease];
+		TemplateStream *stream = [TemplateStream streamWithBytes:(char *)[sectionData mutableBytes] length:[sectionData length]];
+		[parent insertObject:section atIndex:index];
+		[section setParentArray:parent];
+		[stream pushKey:key];
+		[section readDataFrom:stream];
+	}
+}
+
+/* Checks every resource of this type in the document against the template, and shows the results. This is
+	cheap enough to run before shipping a data file: resources of fixed-size templates are only compared by
+	length, and others are read on as many threads as there are processors. */
+- (IBAction)validateResources:(id)sender
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	NSArray *resources = [[(NSObject *)backup class] allResourcesOfType:[backup type] inDocument:[backup document]];
+	NSString *report = [lint reportForResources:resources];
+	NSBeginInformationalAlertSheet([NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"ValidateDialogTitle", nil, bundle, nil), [backup type]], nil, nil, nil, [self window], nil, NULL, NULL, NULL, @"%@", report);
+}
+
+/* Opens a window for finding and totting up the values of one field in every resource of this type, in every open document. */
+- (IBAction)queryResources:(id)sender
+{
+	if(!query) query = [[TemplateQueryWindowController alloc] initWithTemplate:templateStructure forType:[backup type]];
+	[query showWindow:sender];
+}
+
+/* Opens a spreadsheet of every resource of this type in the document, with a column for each field at a fixed
+	offset (all of them, for templates without lists, keys or strings). Only the columns scrolled into view are decoded. */
+- (IBAction)showGrid:(id)sender
+{
+	if(!grid) grid = [[TemplateGridWindowController alloc] initWithTemplate:templateStructure forType:[backup type] inDocument:[backup document]];
+	[grid showWindow:sender];
+}
+
 - (BOOL)windowShouldClose:(id)sender
 {
 	[[self window] makeFirstResponder:dataList];
@@ -244,6 +332,18 @@
 		}
 	}
 	
+	// build the case tables for keyed sections now, rather than every time a resource is read
+	[ElementKEYB compileKeysInElements:templateStructure];
+	
+	// likewise the field offsets, if the template has no variable-length fields
+	if(fixedLayout) free(fixedLayout);
+	fixedLayout = [TemplateStream fixedWidthLayoutForElements:templateStructure];
+	
+	// check the template itself; resources are only checked on request, see -validateResources:
+	[lint release];
+	lint = [[TemplateLint alloc] initWithTemplateData:[tmplRes data] elements:templateStructure];
+	if([[lint problems] count])
+		NSLog(@"Template '%@' has problems:\n%@", [tmplRes name], [[lint problems] componentsJoinedByString:@"\n"]);
 	[displayList reloadData];
 }
 
@@ -286,6 +386,11 @@
 //		[[self undoManager] registerUndoWithTarget:item selector:@selector(setStringValue:) object:old];
 //		[[self undoManager] setActionName:NSLocalizedString(@"Changes", nil)];
 		[item setValue:object forKey:[tableColumn identifier]];
+		if([(Element *)item isKey])
+		{
+			[self reloadSectionForKey:item];
+			[dataList reloadData];
+		}
 		if(!liveEdit) [self setDocumentEdited:YES];
 		
 		// remove self to avoid reloading the resource
@@ -383,6 +488,9 @@
 
 static NSString *RKTEToolbarIdentifier		= @"com.nickshanks.resknife.templateeditor.toolbar";
 static NSString *RKTEDisplayTMPLIdentifier	= @"com.nickshanks.resknife.templateeditor.toolbar.tmpl";
+static NSString *RKTEValidateIdentifier		= @"com.nickshanks.resknife.templateeditor.toolbar.validate";
+static NSString *RKTEQueryIdentifier		= @"com.nickshanks.resknife.templateeditor.toolbar.query";
+static NSString *RKTEGridIdentifier			= @"com.nickshanks.resknife.templateeditor.toolbar.grid";
 
 - (void)setupToolbar
 {
@@ -400,6 +508,30 @@ static NSString *RKTEDisplayTMPLIdentifier	= @"com.nickshanks.resknife.templatee
 	[item setAction:@selector(toggle:)];
 	[toolbarItems setObject:item forKey:RKTEDisplayTMPLIdentifier];
 	
+	item = [[[NSToolbarItem alloc] initWithItemIdentifier:RKTEValidateIdentifier] autorelease];
+	[item setLabel:NSLocalizedString(@"Validate", nil)];
+	[item setPaletteLabel:NSLocalizedString(@"Validate Resources", nil)];
+	[item setToolTip:NSLocalizedString(@"Check All Resources of This Type Against the Template", nil)];
+	[item setTarget:self];
+	[item setAction:@selector(validateResources:)];
+	[toolbarItems setObject:item forKey:RKTEValidateIdentifier];
+	
+	item = [[[NSToolbarItem alloc] initWithItemIdentifier:RKTEQueryIdentifier] autorelease];
+	[item setLabel:NSLocalizedString(@"Query", nil)];
+	[item setPaletteLabel:NSLocalizedString(@"Query Resources", nil)];
+	[item setToolTip:NSLocalizedString(@"Find and Summarise a Field Across All Resources of This Type", nil)];
+	[item setTarget:self];
+	[item setAction:@selector(queryResources:)];
+	[toolbarItems setObject:item forKey:RKTEQueryIdentifier];
+	
+	item = [[[NSToolbarItem alloc] initWithItemIdentifier:RKTEGridIdentifier] autorelease];
+	[item setLabel:NSLocalizedString(@"Grid", nil)];
+	[item setPaletteLabel:NSLocalizedString(@"Edit All as Grid", nil)];
+	[item setToolTip:NSLocalizedString(@"Edit All Resources of This Type as a Grid", nil)];
+	[item setTarget:self];
+	[item setAction:@selector(showGrid:)];
+	[toolbarItems setObject:item forKey:RKTEGridIdentifier];
+	
 	NSToolbar *toolbar = [[[NSToolbar alloc] initWithIdentifier:RKTEToolbarIdentifier] autorelease];
 	
 	// set toolbar properties
@@ -421,12 +553,12 @@ static NSString *RKTEDisplayTMPLIdentifier	= @"com.nickshanks.resknife.templatee
 
 - (NSArray *)toolbarDefaultItemIdentifiers:(NSToolbar *)toolbar
 {
-    return [NSArray arrayWithObjects:RKTEDisplayTMPLIdentifier, NSToolbarFlexibleSpaceItemIdentifier, NSToolbarPrintItemIdentifier, nil];
+    return [NSArray arrayWithObjects:RKTEDisplayTMPLIdentifier, RKTEValidateIdentifier, RKTEQueryIdentifier, RKTEGridIdentifier, NSToolbarFlexibleSpaceItemIdentifier, NSToolbarPrintItemIdentifier, nil];
 }
 
 - (NSArray *)toolbarAllowedItemIdentifiers:(NSToolbar *)toolbar
 {
-    return [NSArray arrayWithObjects:RKTEDisplayTMPLIdentifier, NSToolbarPrintItemIdentifier, NSToolbarCustomizeToolbarItemIdentifier, NSToolbarFlexibleSpaceItemIdentifier, NSToolbarSpaceItemIdentifier, NSToolbarSeparatorItemIdentifier, nil];
+    return [NSArray arrayWithObjects:RKTEDisplayTMPLIdentifier, RKTEValidateIdentifier, RKTEQueryIdentifier, RKTEGridIdentifier, NSToolbarPrintItemIdentifier, NSToolbarCustomizeToolbarItemIdentifier, NSToolbarFlexibleSpaceItemIdentifier, NSToolbarSpaceItemIdentifier, NSToolbarSeparatorItemIdentifier, nil];
 }
 
 @end
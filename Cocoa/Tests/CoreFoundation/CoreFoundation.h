@@ -0,0 +1,24 @@
+/*	Stands in for CoreFoundation when the portable decoders' tests and benchmarks are built away from the Mac, with
+	-I pointing at the folder above this one. The decoders only need the MacTypes, so that's all this has. */
+
+#ifndef TEST_CORE_FOUNDATION_H
+#define TEST_CORE_FOUNDATION_H
+
+#include <stdint.h>
+
+typedef uint8_t			UInt8;
+typedef int8_t			SInt8;
+typedef uint16_t		UInt16;
+typedef int16_t			SInt16;
+typedef uint32_t		UInt32;
+typedef int32_t			SInt32;
+typedef uint64_t		UInt64;
+typedef int64_t			SInt64;
+typedef unsigned char	Boolean;
+
+#ifndef true
+#define true	1
+#define false	0
+#endif
+
+#endif
@@ -0,0 +1,234 @@
+/*	Decode benchmark for SoundDecoder, buildable with any C compiler:
+
+		cc -std=c99 -O2 -Wall -Wno-unknown-pragmas -Wno-multichar -I../Classes -I. SoundDecoderBench.c ../Classes/SoundDecoder.c -lm -o SoundDecoderBench && ./SoundDecoderBench
+
+	Cocoa/Tests supplies just the MacTypes the decoder needs in place of CoreFoundation, so this builds the same anywhere.
+	Makes a ten second stereo 'snd ' in each format the decoder reads (mono for the standard header), filled with noise,
+	then decodes it a block at a time over and over for a couple of seconds, reporting millions of frames per second
+	and how many times faster than real time that is. Before timing, each sound is decoded whole, then again from a
+	seek to part way through a packet, and the two compared, since MACE has to decode its way to the frame sought; the
+	whole sound is also written out as a WAV and read back, header and samples.
+
+	MACE is checked first by encoding two tones with the decoder itself: each packet gets whichever bytes decode
+	closest to the tones, one byte at a time. If the step tables and the way codes index them are right, the decoded
+	sound follows the tones closely and every code gets used. */
+
+#include "SoundDecoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+enum
+{
+	kRate = 22050,
+	kSeconds = 10,
+	kFrames = kRate * kSeconds,
+	kBenchSeconds = 2,
+	kSeekFrame = kFrames / 3 + 5,
+	kEncodePackets = 2000,
+	kEncodeAmplitude = 12000
+};
+
+static UInt8 *Put(UInt8 *p, UInt32 value, UInt32 size)
+{
+	while( size-- ) *p++ = (UInt8) (value >> (8 * size));
+	return p;
+}
+
+/* A format 2 resource with one buffer command, pointing to the header after it. */
+static UInt32 MakeSound(UInt8 *bytes, UInt32 format, SInt16 compression, UInt32 channels, UInt32 packetFrames, UInt32 packetBytes)
+{
+	UInt32 packets = kFrames / packetFrames, i;
+	UInt8 *p = Put( Put( Put( bytes, 2, 2 ), 0, 2 ), 1, 2 );
+	p = Put( Put( Put( p, 0x8051, 2 ), 0, 2 ), 14, 4 );
+	memset( p, 0, 64 );
+	Put( p + 8, kRate << 16, 4 );
+	p[21] = 60;
+	if( format == 'raw ' )
+	{
+		Put( p + 4, packets, 4 );
+		p += 22;
+	}
+	else
+	{
+		Put( p + 4, channels, 4 );
+		p[20] = 0xFE;
+		Put( p + 22, packets, 4 );
+		Put( p + 40, format, 4 );
+		Put( p + 56, (UInt16) compression, 2 );
+		Put( p + 62, (format == 'twos')? 16:8, 2 );
+		p += 64;
+	}
+	for( i = 0; i < packets * packetBytes * channels; i++ )
+		*p++ = (UInt8) rand();
+	return (UInt32) (p - bytes);
+}
+
+static UInt32 ReadLittle(const UInt8 *p, UInt32 size)
+{
+	UInt32 value = 0;
+	while( size-- ) value = (value << 8) | p[size];
+	return value;
+}
+
+static void Fail(const char *name, const char *problem)
+{
+	printf( "%s: %s\n", name, problem );
+	exit( 1 );
+}
+
+/* Writes the sound as the file output does, a header and then little-endian samples, and reads it back. */
+static void CheckWAV(const char *name, const SoundInfo *info, const SInt16 *pcm)
+{
+	UInt32 samples = info->frames * info->channels, i;
+	UInt8 *wav = malloc( kSoundWAVHeaderSize + samples * 2 );
+	SoundWriteWAVHeader( info, wav );
+	for( i = 0; i < samples; i++ )
+	{
+		wav[kSoundWAVHeaderSize + i * 2] = (UInt8) pcm[i];
+		wav[kSoundWAVHeaderSize + i * 2 + 1] = (UInt8) ((UInt16) pcm[i] >> 8);
+	}
+
+	if( memcmp( wav, "RIFF", 4 ) || memcmp( wav + 8, "WAVEfmt ", 8 ) || memcmp( wav + 36, "data", 4 ) )
+		Fail( name, "the WAV header's chunk names are wrong" );
+	if( ReadLittle( wav + 4, 4 ) != 36 + samples * 2 || ReadLittle( wav + 16, 4 ) != 16 || ReadLittle( wav + 40, 4 ) != samples * 2 )
+		Fail( name, "the WAV header's chunk lengths are wrong" );
+	if( ReadLittle( wav + 20, 2 ) != 1 || ReadLittle( wav + 22, 2 ) != info->channels || ReadLittle( wav + 24, 4 ) != kRate ||
+		ReadLittle( wav + 28, 4 ) != kRate * info->channels * 2 || ReadLittle( wav + 32, 2 ) != info->channels * 2 || ReadLittle( wav + 34, 2 ) != 16 )
+		Fail( name, "the WAV header's format is wrong" );
+	for( i = 0; i < samples; i++ )
+		if( (SInt16) ReadLittle( wav + kSoundWAVHeaderSize + i * 2, 2 ) != pcm[i] )
+			Fail( name, "the WAV's samples differ from those decoded" );
+	free( wav );
+}
+
+/* Mono, so each packet is packetBytes bytes of codes for six frames. */
+static void CheckMACE(const char *name, UInt32 format, SInt16 compression, UInt32 packetBytes, double minimumSNR)
+{
+	UInt8 *bytes = malloc( 78 + kFrames );
+	UInt32 length = MakeSound( bytes, format, compression, 1, 6, packetBytes ), packet, byte, code, i;
+	SInt16 *target = malloc( kEncodePackets * 6 * sizeof(SInt16) ), decoded[6];
+	UInt32 used3 = 0, used2 = 0;
+	double signal = 0, noise = 0, snr;
+	SoundDecoder decoder, trial;
+	UInt8 *samples;
+
+	if( SoundDecoderOpen( bytes, length, &decoder ) != kSoundNoError )
+		Fail( name, "the test sound didn't open" );
+	samples = (UInt8 *) decoder.info.samples;
+	for( i = 0; i < kEncodePackets * 6; i++ )
+		target[i] = (SInt16) (kEncodeAmplitude * sin( i * 2 * 3.14159265358979 * 440 / kRate ) + kEncodeAmplitude / 3 * sin( i * 2 * 3.14159265358979 * 1250 / kRate ));
+
+	for( packet = 0; packet < kEncodePackets; packet++ )
+	{
+		UInt8 *codes = samples + packet * packetBytes;
+		for( byte = 0; byte < packetBytes; byte++ )
+		{
+			double best = -1;
+			UInt32 bestCode = 0, frames = (byte + 1) * 6 / packetBytes;
+			for( code = 0; code < 256; code++ )
+			{
+				double error = 0;
+				codes[byte] = (UInt8) code;
+				trial = decoder;
+				SoundDecode( &trial, decoded, 6 );
+				for( i = 0; i < frames; i++ )
+					error += (double) (decoded[i] - target[packet * 6 + i]) * (decoded[i] - target[packet * 6 + i]);
+				if( best < 0 || error < best )
+				{
+					best = error;
+					bestCode = code;
+				}
+			}
+			codes[byte] = (UInt8) bestCode;
+			used3 |= 1 << (bestCode & 7) | 1 << (bestCode >> 5);
+			used2 |= 1 << ((bestCode >> 3) & 3);
+		}
+
+		if( SoundDecode( &decoder, decoded, 6 ) != 6 )
+			Fail( name, "a packet didn't decode to six frames" );
+		for( i = 0; i < 6; i++ )
+		{
+			double difference = decoded[i] - target[packet * 6 + i];
+			if( (decoded[i] & 0xFF) != ((decoded[i] >> 8) & 0xFF) )
+				Fail( name, "a sample's low byte doesn't repeat its high byte" );
+			signal += (double) target[packet * 6 + i] * target[packet * 6 + i];
+			noise += difference * difference;
+		}
+	}
+
+	snr = 10 * log10( signal / noise );
+	printf( "%-10s round trip: %4.1f dB\n", name, snr );
+	if( snr < minimumSNR )
+		Fail( name, "the decoded tones are too far from those encoded" );
+	if( used3 != 0xFF || used2 != 0xF )
+		Fail( name, "some codes were never the best, so parts of the step tables can't be right" );
+	free( target );
+	free( bytes );
+}
+
+static void Bench(const char *name, const UInt8 *bytes, UInt32 length)
+{
+	SoundDecoder decoder;
+	SInt16 *block = malloc( kSoundBlockFrames * kSoundMaxChannels * sizeof(SInt16) );
+	SInt16 *whole, *sought;
+	UInt32 channels, frames = 0, count;
+	unsigned long decoded = 0;
+	clock_t start, elapsed;
+	double seconds;
+
+	if( SoundDecoderOpen( bytes, length, &decoder ) != kSoundNoError )
+	{
+		printf( "%s: the test sound didn't open\n", name );
+		exit( 1 );
+	}
+	channels = decoder.info.channels;
+	whole = malloc( decoder.info.frames * channels * sizeof(SInt16) );
+	sought = malloc( decoder.info.frames * channels * sizeof(SInt16) );
+	while( (count = SoundDecode( &decoder, whole + frames * channels, kSoundBlockFrames )) )
+		frames += count;
+	SoundDecoderSeek( &decoder, kSeekFrame );
+	count = SoundDecode( &decoder, sought, frames - kSeekFrame );
+	if( frames != decoder.info.frames || count != frames - kSeekFrame ||
+		memcmp( sought, whole + kSeekFrame * channels, count * channels * sizeof(SInt16) ) != 0 )
+	{
+		printf( "%s: seeking gave different samples from decoding from the start\n", name );
+		exit( 1 );
+	}
+	CheckWAV( name, &decoder.info, whole );
+
+	start = clock();
+	do
+	{
+		SoundDecoderRewind( &decoder );
+		while( (count = SoundDecode( &decoder, block, kSoundBlockFrames )) )
+			decoded += count;
+		elapsed = clock() - start;
+	}
+	while( elapsed < kBenchSeconds * CLOCKS_PER_SEC );
+
+	seconds = (double) elapsed / CLOCKS_PER_SEC;
+	printf( "%-10s %u channel%s: %7.1f Mframes/s, %6.0fx real time\n", name, channels, (channels == 1)? "":"s", decoded / seconds / 1e6,
+		decoded / seconds / kRate );
+	free( block );
+	free( whole );
+	free( sought );
+}
+
+int main(void)
+{
+	UInt8 *bytes = malloc( 78 + kFrames * 2 * 2 );
+	srand( 1 );
+	CheckMACE( "MACE 3:1", 'MAC3', 3, 2, 20 );
+	CheckMACE( "MACE 6:1", 'MAC6', 4, 1, 12 );
+	Bench( "raw", bytes, MakeSound( bytes, 'raw ', 0, 1, 1, 1 ) );
+	Bench( "twos", bytes, MakeSound( bytes, 'twos', -1, 2, 1, 2 ) );
+	Bench( "ulaw", bytes, MakeSound( bytes, 'ulaw', -2, 2, 1, 1 ) );
+	Bench( "ima4", bytes, MakeSound( bytes, 'ima4', -2, 2, 64, 34 ) );
+	Bench( "MACE 3:1", bytes, MakeSound( bytes, 'MAC3', 3, 2, 6, 2 ) );
+	Bench( "MACE 6:1", bytes, MakeSound( bytes, 'MAC6', 4, 2, 6, 1 ) );
+	free( bytes );
+	return 0;
+}
@@ -0,0 +1,215 @@
+/*	Headless playback test for SoundMixer and the file output, buildable with any C compiler:
+
+		cc -std=c99 -O2 -Wall -Wno-unknown-pragmas -Wno-multichar -I../Classes -I. SoundMixerTest.c ../Classes/SoundMixer.c ../Classes/SoundOutput.c ../Classes/SoundDecoder.c -lpthread -o SoundMixerTest && ./SoundMixerTest
+
+	(on the Mac, leave out -I. and add -framework AudioUnit -framework CoreServices.) Plays a few mono 'snd 's, each
+	holding one value throughout, through a file output, pausing, seeking and stopping them along the way, and checks
+	each is handed back with its owner at the point it should be. The WAV written is then read back: its header has to
+	match its length, and every frame has to be the same in both channels and the sum of sounds which were playing. */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "SoundMixer.h"
+#include "SoundOutput.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum
+{
+	kA = 8000,				// values of the sounds, chosen so every sum of those which overlap is different
+	kB = -3000,
+	kC = 1000,
+	kD = 200,
+	kE = 300,
+	kTimeout = 2000,		// milliseconds to wait for a sound to be handed back
+	kSeekTimeout = 200		// less than the rest of A would take to play, had it not been moved on
+};
+
+static const char *gPath = "SoundMixerTest.wav";
+static SoundMixer *gMixer;
+static int gOwners[5];		// their addresses are the owners of sounds A to E
+static int gHandedBack[5];
+
+static void Fail(const char *problem)
+{
+	printf( "%s\n", problem );
+	remove( gPath );
+	exit( 1 );
+}
+
+static void Wait(UInt32 milliseconds)
+{
+	struct timespec wait;
+	wait.tv_sec = milliseconds / 1000;
+	wait.tv_nsec = (long) (milliseconds % 1000) * 1000000;
+	nanosleep( &wait, NULL );
+}
+
+static UInt8 *Put(UInt8 *p, UInt32 value, UInt32 size)
+{
+	while( size-- ) *p++ = (UInt8) (value >> (8 * size));
+	return p;
+}
+
+/* A format 2 resource with one buffer command and a 16-bit 'twos' header at the mixer's rate, so no resampling. */
+static UInt8 *MakeSound(SInt16 value, UInt32 frames, UInt32 *length)
+{
+	UInt8 *bytes = malloc( 14 + 64 + frames * 2 ), *p;
+	UInt32 i;
+	p = Put( Put( Put( bytes, 2, 2 ), 0, 2 ), 1, 2 );
+	p = Put( Put( Put( p, 0x8051, 2 ), 0, 2 ), 14, 4 );
+	memset( p, 0, 64 );
+	Put( p + 4, 1, 4 );
+	Put( p + 8, (UInt32) kSoundMixerRate << 16, 4 );
+	p[20] = 0xFE;
+	p[21] = 60;
+	Put( p + 22, frames, 4 );
+	Put( p + 40, 'twos', 4 );
+	Put( p + 56, (UInt16) -1, 2 );
+	Put( p + 62, 16, 2 );
+	p += 64;
+	for( i = 0; i < frames; i++ )
+		p = Put( p, (UInt16) value, 2 );
+	*length = (UInt32) (p - bytes);
+	return bytes;
+}
+
+/* Takes whatever has been handed back, checking each is a sound played and is handed back only once. */
+static void TakeFinished(const SoundVoiceID *voices)
+{
+	SoundMixerFinished finished;
+	while( SoundMixerNextFinished( gMixer, &finished ) )
+	{
+		int sound = (int *) finished.owner - gOwners;
+		if( sound < 0 || sound >= 5 || voices[sound] != finished.voice )
+			Fail( "a sound was handed back with the wrong owner" );
+		if( gHandedBack[sound]++ )
+			Fail( "a sound was handed back twice" );
+	}
+}
+
+static void WaitForFinished(const SoundVoiceID *voices, int sound, UInt32 timeout, const char *problem)
+{
+	UInt32 waited;
+	for( waited = 0; waited < timeout && !gHandedBack[sound]; waited += 10 )
+	{
+		Wait( 10 );
+		TakeFinished( voices );
+	}
+	if( !gHandedBack[sound] ) Fail( problem );
+}
+
+static UInt32 ReadLittle(const UInt8 *p, UInt32 size)
+{
+	UInt32 value = 0;
+	while( size-- ) value = (value << 8) | p[size];
+	return value;
+}
+
+static void CheckWAV(void)
+{
+	static const SInt32 allowed[] = { 0, kA, kB, kA + kB, kC, kD, kE, kD + kE };
+	Boolean seen[sizeof(allowed) / sizeof(allowed[0])] = { false };
+	FILE *file = fopen( gPath, "rb" );
+	UInt8 header[kSoundWAVHeaderSize], frame[4];
+	UInt32 frames = 0, dataLength, i;
+	long fileLength;
+	if( !file || fread( header, sizeof(header), 1, file ) != 1 )
+		Fail( "the WAV couldn't be read back" );
+	fseek( file, 0, SEEK_END );
+	fileLength = ftell( file );
+	fseek( file, kSoundWAVHeaderSize, SEEK_SET );
+
+	dataLength = ReadLittle( header + 40, 4 );
+	if( memcmp( header, "RIFF", 4 ) || memcmp( header + 8, "WAVEfmt ", 8 ) || memcmp( header + 36, "data", 4 ) ||
+		ReadLittle( header + 4, 4 ) != 36 + dataLength || (long) (kSoundWAVHeaderSize + dataLength) != fileLength )
+		Fail( "the WAV's header doesn't match its length" );
+	if( ReadLittle( header + 20, 2 ) != 1 || ReadLittle( header + 22, 2 ) != kSoundMixerChannels || ReadLittle( header + 24, 4 ) != kSoundMixerRate ||
+		ReadLittle( header + 32, 2 ) != kSoundMixerChannels * 2 || ReadLittle( header + 34, 2 ) != 16 )
+		Fail( "the WAV's header has the wrong format" );
+	if( dataLength == 0 || dataLength % (kSoundMixerVoiceFrames * 4) )
+		Fail( "the WAV isn't a whole number of rendered blocks" );
+
+	while( fread( frame, sizeof(frame), 1, file ) == 1 )
+	{
+		SInt16 left = (SInt16) ReadLittle( frame, 2 ), right = (SInt16) ReadLittle( frame + 2, 2 );
+		if( left != right )
+			Fail( "a mono sound didn't play the same in both channels" );
+		for( i = 0; i < sizeof(allowed) / sizeof(allowed[0]); i++ )
+			if( left == allowed[i] ) break;
+		if( i == sizeof(allowed) / sizeof(allowed[0]) )
+			Fail( "a frame isn't a sum of sounds which were playing together" );
+		seen[i] = true;
+		frames++;
+	}
+	fclose( file );
+	if( frames * 4 != dataLength )
+		Fail( "the WAV's data ended early" );
+	if( !seen[3] || !seen[1] || !seen[4] || !seen[7] )
+		Fail( "a sound which played isn't in the WAV" );
+	printf( "%u frames written, each a sum of the sounds playing\n", frames );
+}
+
+int main(void)
+{
+	UInt32 lengths[5], frames[5] = { kSoundMixerRate / 2, kSoundMixerRate / 5, kSoundMixerRate * 2, kSoundMixerRate * 2, kSoundMixerRate * 2 };
+	SInt16 values[5] = { kA, kB, kC, kD, kE };
+	SoundVoiceID voices[5];
+	UInt8 *sounds[5], junk[16];
+	SoundOutput *output;
+	int i;
+
+	for( i = 0; i < 5; i++ )
+		sounds[i] = MakeSound( values[i], frames[i], &lengths[i] );
+	gMixer = malloc( sizeof(SoundMixer) );
+	SoundMixerInit( gMixer );
+	output = SoundOutputOpenFile( gPath );
+	if( !output || !SoundOutputStart( output, gMixer ) )
+		Fail( "the file output didn't start" );
+	memset( junk, 0, sizeof(junk) );
+	if( SoundMixerPlay( gMixer, junk, sizeof(junk), NULL ) != 0 )
+		Fail( "data which isn't a sound was played" );
+
+	// A (half a second) is paused soon after it starts; B (a fifth of a second) ends meanwhile, but A mustn't
+	voices[0] = SoundMixerPlay( gMixer, sounds[0], lengths[0], &gOwners[0] );
+	voices[1] = SoundMixerPlay( gMixer, sounds[1], lengths[1], &gOwners[1] );
+	if( !voices[0] || !voices[1] || voices[0] == voices[1] )
+		Fail( "sounds weren't given IDs of their own" );
+	Wait( 50 );
+	SoundMixerPause( gMixer, voices[0], true );
+	WaitForFinished( voices, 1, kTimeout, "a sound wasn't handed back when it ended" );
+	Wait( 500 );
+	TakeFinished( voices );
+	if( gHandedBack[0] )
+		Fail( "a paused sound played on" );
+
+	// resumed and moved to its last hundredth of a second, A should end long before the rest of it could have played
+	SoundMixerPause( gMixer, voices[0], false );
+	SoundMixerSeek( gMixer, voices[0], frames[0] - kSoundMixerRate / 100 );
+	WaitForFinished( voices, 0, kSeekTimeout, "a sound moved to its end wasn't handed back" );
+
+	// C is stopped by its ID, D and E all at once
+	voices[2] = SoundMixerPlay( gMixer, sounds[2], lengths[2], &gOwners[2] );
+	Wait( 50 );
+	SoundMixerStop( gMixer, voices[2] );
+	WaitForFinished( voices, 2, kTimeout, "a sound stopped wasn't handed back" );
+	voices[3] = SoundMixerPlay( gMixer, sounds[3], lengths[3], &gOwners[3] );
+	voices[4] = SoundMixerPlay( gMixer, sounds[4], lengths[4], &gOwners[4] );
+	Wait( 50 );
+	SoundMixerStop( gMixer, 0 );
+	WaitForFinished( voices, 3, kTimeout, "stopping every sound didn't hand them all back" );
+	WaitForFinished( voices, 4, kTimeout, "stopping every sound didn't hand them all back" );
+
+	SoundOutputClose( output );
+	TakeFinished( voices );
+	printf( "every sound was handed back once, with its owner\n" );
+	CheckWAV();
+
+	remove( gPath );
+	for( i = 0; i < 5; i++ )
+		free( sounds[i] );
+	free( gMixer );
+	return 0;
+}
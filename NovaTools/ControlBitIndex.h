@@ -0,0 +1,25 @@
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+
+/*	The control bit expressions of every chär, crön, flët, mïsn, öops and përs in a document, compiled once (by
+	ControlBits.c) and recompiled only when a resource is given new data. Answers which resources test or set a bit,
+	and, by following every way the bits could be set from each chär's OnStart until nothing more can change, which
+	resources can never become available whatever the player does. */
+
+@interface ControlBitIndex : NSObject
+{
+	NSDocument *document;			// not retained; indexes are dropped once their document has closed
+	NSMutableArray *resources;		// every resource with expressions, as last seen
+	NSMutableDictionary *compiled;	// non-retained resource -> [data compiled, NSArray of NSData code or NSNumber error offset, by field]
+	NSMutableDictionary *testers;	// NSNumber bit -> resources testing it, rebuilt after anything is recompiled
+	NSMutableDictionary *setters;	// NSNumber bit -> resources setting, clearing or toggling it
+}
+
++ (ControlBitIndex *)indexForDocument:(NSDocument *)document;
+
+- (NSArray *)resourcesTestingBit:(unsigned)bit;
+- (NSArray *)resourcesSettingBit:(unsigned)bit;
+- (NSArray *)unreachableResources;
+- (NSArray *)syntaxErrors;		// NSDictionaries with Resource, Field and Message keys, as NovaValidator's problems
+
+@end
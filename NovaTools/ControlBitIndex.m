@@ -0,0 +1,310 @@
+#import "ControlBitIndex.h"
+#import "Structs.h"
+#import "NovaCodec.h"
+#import "ControlBits.h"
+#include <stddef.h>
+
+/* Where the expressions are. Strings in cdata fields are packed one after another, 255 bytes each. A resource
+	with a test expression is available when the test passes; one without (a chär) is available from the start. */
+
+typedef struct NCBField
+{
+	const char			*type;		// key in Resource Types.strings
+	const NovaRecord	*record;
+	UInt32				offset;		// of the string in the structure
+	UInt16				length;
+	const char			*name;
+	Boolean				sets;		// else it's a test
+} NCBField;
+
+#define NCB(type, rec, field, skip, length, name, sets)	{ type, &kNova##rec, offsetof(rec, field) + (skip), length, name, sets }
+
+static const NCBField gFields[] =
+{
+	NCB("char", CharRec, OnStart, 0, 256, "OnStart", true),
+	NCB("cron", CronRec, cdata, 0, 255, "EnableOn", false),
+	NCB("cron", CronRec, cdata, 255, 255, "OnStart", true),
+	NCB("cron", CronRec, cdata, 510, 256, "OnEnd", true),
+	NCB("flet", FletRec, ActivateOn, 0, 256, "ActivateOn", false),
+	NCB("misn", MisnRec, cdata, 0, 255, "AvailBits", false),
+	NCB("misn", MisnRec, cdata, 255, 255, "OnAccept", true),
+	NCB("misn", MisnRec, cdata, 510, 255, "OnRefuse", true),
+	NCB("misn", MisnRec, cdata, 765, 255, "OnSuccess", true),
+	NCB("misn", MisnRec, cdata, 1020, 255, "OnFailure", true),
+	NCB("misn", MisnRec, cdata, 1275, 255, "OnAbort", true),
+	NCB("misn", MisnRec, cdata2, 0, 255, "OnShipDone", true),
+	NCB("oops", OopsRec, ActivateOn, 0, 256, "ActivateOn", false),
+	NCB("pers", PersRec, ActivateOn, 0, 256, "ActivateOn", false)
+};
+
+#define kFieldCount		(sizeof(gFields) / sizeof(gFields[0]))
+
+static NSDictionary *gFieldIndexes = nil;		// type -> NSArray of NSNumber indexes into gFields
+static NSArray *gTypes = nil;					// types with expressions, in the order of gFields
+static NSMutableDictionary *gIndexes = nil;		// non-retained document -> ControlBitIndex
+
+static NSString *TypeName(const char *key)
+{
+	return [[NSBundle bundleForClass:[ControlBitIndex class]] localizedStringForKey:[NSString stringWithUTF8String:key] value:@"" table:@"Resource Types"];
+}
+
+@interface ControlBitIndex (Private)
+- (id)initWithDocument:(NSDocument *)newDocument;
+- (void)update;
+- (NSArray *)compileData:(NSData *)data ofType:(NSString *)type;
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource withCode:(NSData *)code toTesters:(BOOL)tests;
+@end
+
+@implementation ControlBitIndex
+
++ (void)initialize
+{
+	unsigned i;
+	NSMutableDictionary *indexes;
+	NSMutableArray *types;
+	if( self != [ControlBitIndex class] ) return;
+	indexes = [NSMutableDictionary dictionary];
+	types = [NSMutableArray array];
+	for( i = 0; i < kFieldCount; i++ )
+	{
+		NSString *type = TypeName(gFields[i].type);
+		NSMutableArray *fields = [indexes objectForKey:type];
+		if( !fields )
+		{
+			[indexes setObject:(fields = [NSMutableArray array]) forKey:type];
+			[types addObject:type];
+		}
+		[fields addObject:[NSNumber numberWithUnsignedInt:i]];
+	}
+	gFieldIndexes = [indexes copy];
+	gTypes = [types copy];
+	gIndexes = [[NSMutableDictionary alloc] init];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(documentWillClose:) name:DocumentWillCloseNotification object:nil];
+}
+
+// dropped as the document goes, so a new document at the same address doesn't get its expressions
++ (void)documentWillClose:(NSNotification *)notification
+{
+	[gIndexes removeObjectForKey:[NSValue valueWithNonretainedObject:[notification object]]];
+}
+
++ (ControlBitIndex *)indexForDocument:(NSDocument *)document
+{
+	ControlBitIndex *index;
+	NSValue *key = [NSValue valueWithNonretainedObject:document];
+	index = [gIndexes objectForKey:key];
+	if( !index )
+	{
+		index = [[[ControlBitIndex alloc] initWithDocument:document] autorelease];
+		[gIndexes setObject:index forKey:key];
+	}
+	return index;
+}
+
+- (id)initWithDocument:(NSDocument *)newDocument
+{
+	self = [super init];
+	if( !self ) return nil;
+	document = newDocument;
+	resources = [[NSMutableArray alloc] init];
+	compiled = [[NSMutableDictionary alloc] init];
+	return self;
+}
+
+- (void)dealloc
+{
+	[resources release];
+	[compiled release];
+	[testers release];
+	[setters release];
+	[super dealloc];
+}
+
+#pragma mark -
+
+- (NSArray *)resourcesTestingBit:(unsigned)bit
+{
+	NSArray *found;
+	[self update];
+	found = [testers objectForKey:[NSNumber numberWithUnsignedInt:bit]];
+	return found? found : [NSArray array];
+}
+
+- (NSArray *)resourcesSettingBit:(unsigned)bit
+{
+	NSArray *found;
+	[self update];
+	found = [setters objectForKey:[NSNumber numberWithUnsignedInt:bit]];
+	return found? found : [NSArray array];
+}
+
+/* Works with what each bit might ever be rather than what it is: every bit might be clear (they all start so),
+	and a bit might be set once anything which might be available sets it. Repeats until no more bits can change,
+	which is at most once per resource but in practice a handful of times. A test which can't be compiled is
+	assumed to pass, as its mistake is reported by -syntaxErrors. */
+- (NSArray *)unreachableResources
+{
+	unsigned i, j, count;
+	NCBBits maySet, mayClear;
+	BOOL *available, changed = YES;
+	NSMutableArray *unreachable = [NSMutableArray array];
+	[self update];
+
+	count = [resources count];
+	available = (BOOL *) calloc( count, sizeof(BOOL) );
+	memset( &maySet, 0, sizeof(maySet) );
+	memset( &mayClear, 0xFF, sizeof(mayClear) );
+	while( changed )
+	{
+		changed = NO;
+		for( i = 0; i < count; i++ )
+		{
+			id <ResKnifeResourceProtocol> resource = [resources objectAtIndex:i];
+			NSArray *fields = [gFieldIndexes objectForKey:[resource type]];
+			NSArray *code = [[compiled objectForKey:[NSValue valueWithNonretainedObject:resource]] objectAtIndex:1];
+			if( available[i] ) continue;
+
+			available[i] = YES;
+			for( j = 0; j < [fields count]; j++ )
+			{
+				NSData *test = [code objectAtIndex:j];
+				if( gFields[[[fields objectAtIndex:j] unsignedIntValue]].sets || ![test isKindOfClass:[NSData class]] ) continue;
+				if( !NCBMayPass( [test bytes], [test length] / sizeof(NCBInstruction), &maySet, &mayClear ) )
+					available[i] = NO;
+			}
+			if( !available[i] ) continue;
+
+			for( j = 0; j < [fields count]; j++ )
+			{
+				NSData *set = [code objectAtIndex:j];
+				if( !gFields[[[fields objectAtIndex:j] unsignedIntValue]].sets || ![set isKindOfClass:[NSData class]] ) continue;
+				if( NCBMayApply( [set bytes], [set length] / sizeof(NCBInstruction), &maySet, &mayClear ) )
+					changed = YES;
+			}
+		}
+	}
+
+	for( i = 0; i < count; i++ )
+		if( !available[i] ) [unreachable addObject:[resources objectAtIndex:i]];
+	free( available );
+	return unreachable;
+}
+
+- (NSArray *)syntaxErrors
+{
+	unsigned j;
+	NSMutableArray *errors = [NSMutableArray array];
+	id <ResKnifeResourceProtocol> resource;
+	NSEnumerator *enumerator;
+	[self update];
+
+	enumerator = [resources objectEnumerator];
+	while( resource = [enumerator nextObject] )
+	{
+		NSArray *fields = [gFieldIndexes objectForKey:[resource type]];
+		NSArray *code = [[compiled objectForKey:[NSValue valueWithNonretainedObject:resource]] objectAtIndex:1];
+		for( j = 0; j < [fields count]; j++ )
+		{
+			id result = [code objectAtIndex:j];
+			if( [result isKindOfClass:[NSData class]] ) continue;
+			[errors addObject:[NSDictionary dictionaryWithObjectsAndKeys:resource, @"Resource", [NSString stringWithUTF8String:gFields[[[fields objectAtIndex:j] unsignedIntValue]].name], @"Field",
+				[NSString stringWithFormat:@"has a mistake at character %u.", [result unsignedIntValue] + 1], @"Message", nil]];
+		}
+	}
+	return errors;
+}
+
+#pragma mark -
+
+/* Recompiles the expressions of resources which are new or have new data, and rebuilds the bit indexes if any were. */
+- (void)update
+{
+	NSEnumerator *typeEnumerator = [gTypes objectEnumerator];
+	NSMutableDictionary *results = [NSMutableDictionary dictionary];
+	NSString *type;
+	BOOL changed = NO;
+
+	[resources removeAllObjects];
+	while( type = [typeEnumerator nextObject] )
+	{
+		id <ResKnifeResourceProtocol> resource;
+		NSEnumerator *enumerator = [[NSClassFromString(@"Resource") allResourcesOfType:type inDocument:document] objectEnumerator];
+		while( resource = [enumerator nextObject] )
+		{
+			NSValue *key = [NSValue valueWithNonretainedObject:resource];
+			NSArray *entry = [compiled objectForKey:key];
+			NSData *data = [resource data];
+			if( !data ) data = [NSData data];
+			if( !entry || [entry objectAtIndex:0] != data )
+			{
+				entry = [NSArray arrayWithObjects:data, [self compileData:data ofType:type], nil];
+				changed = YES;
+			}
+			[results setObject:entry forKey:key];
+			[resources addObject:resource];
+		}
+	}
+	if( [results count] != [compiled count] ) changed = YES;	// something was removed
+	[compiled setDictionary:results];
+	if( !changed && testers ) return;
+
+	[testers release];
+	[setters release];
+	testers = [[NSMutableDictionary alloc] init];
+	setters = [[NSMutableDictionary alloc] init];
+	{
+		id <ResKnifeResourceProtocol> resource;
+		NSEnumerator *enumerator = [resources objectEnumerator];
+		while( resource = [enumerator nextObject] )
+		{
+			unsigned j;
+			NSArray *fields = [gFieldIndexes objectForKey:[resource type]];
+			NSArray *code = [[compiled objectForKey:[NSValue valueWithNonretainedObject:resource]] objectAtIndex:1];
+			for( j = 0; j < [fields count]; j++ )
+				if( [[code objectAtIndex:j] isKindOfClass:[NSData class]] )
+					[self addResource:resource withCode:[code objectAtIndex:j] toTesters:!gFields[[[fields objectAtIndex:j] unsignedIntValue]].sets];
+		}
+	}
+}
+
+- (NSArray *)compileData:(NSData *)data ofType:(NSString *)type
+{
+	unsigned j;
+	NSArray *fields = [gFieldIndexes objectForKey:type];
+	NSMutableArray *code = [NSMutableArray arrayWithCapacity:[fields count]];
+	const NovaRecord *record = gFields[[[fields objectAtIndex:0] unsignedIntValue]].record;
+	char *native = (char *) calloc( 1, record->nativeSize );
+	NovaDecodeRecord( record, [data bytes], [data length], native );
+	for( j = 0; j < [fields count]; j++ )
+	{
+		const NCBField *field = &gFields[[[fields objectAtIndex:j] unsignedIntValue]];
+		NCBInstruction instructions[kNCBMaxInstructions];
+		UInt32 count, errorOffset = 0;
+		if( field->sets ) count = NCBCompileSet( native + field->offset, field->length, instructions, &errorOffset );
+		else count = NCBCompileTest( native + field->offset, field->length, instructions, &errorOffset );
+		if( count ) [code addObject:[NSData dataWithBytes:instructions length:count * sizeof(NCBInstruction)]];
+		else [code addObject:[NSNumber numberWithUnsignedLong:errorOffset]];
+	}
+	free( native );
+	return code;
+}
+
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource withCode:(NSData *)code toTesters:(BOOL)tests
+{
+	unsigned i, count = [code length] / sizeof(NCBInstruction);
+	const NCBInstruction *instructions = [code bytes];
+	NSMutableDictionary *index = tests? testers : setters;
+	for( i = 0; i < count; i++ )
+	{
+		UInt16 opcode = NCBOpcode( instructions[i] );
+		if( opcode == kNCBBit || opcode == kNCBSet || opcode == kNCBClear || opcode == kNCBToggle )
+		{
+			NSNumber *bit = [NSNumber numberWithUnsignedInt:NCBOperand( instructions[i] )];
+			NSMutableArray *found = [index objectForKey:bit];
+			if( !found ) [index setObject:(found = [NSMutableArray array]) forKey:bit];
+			if( [found lastObject] != resource ) [found addObject:resource];
+		}
+	}
+}
+
+@end
@@ -0,0 +1,327 @@
+#include "ControlBits.h"
+#include <ctype.h>
+#include <string.h>
+
+typedef struct Parser
+{
+	const char		*source;
+	UInt32			length;		// up to the first NUL
+	UInt32			position;
+	NCBInstruction	*code;
+	UInt32			count;
+	Boolean			failed;
+} Parser;
+
+static NCBInstruction Instruction(UInt16 opcode, UInt16 operand)
+{
+	return ((UInt32) opcode << 16) | operand;
+}
+
+static Boolean TestBit(const NCBBits *bits, UInt32 bit)
+{
+	return (bits->words[bit >> 5] >> (bit & 31)) & 1;
+}
+
+#pragma mark -
+
+static void StartParser(Parser *parser, const char *source, UInt32 length, NCBInstruction *code)
+{
+	parser->source = source;
+	parser->length = 0;
+	while( parser->length < length && source[parser->length] )
+		parser->length++;
+	parser->position = 0;
+	parser->code = code;
+	parser->count = 0;
+	parser->failed = false;
+}
+
+// the next character which isn't space, or NUL at the end
+static char Peek(Parser *parser)
+{
+	while( parser->position < parser->length && isspace( (unsigned char) parser->source[parser->position] ) )
+		parser->position++;
+	return (parser->position < parser->length)? parser->source[parser->position] : '\0';
+}
+
+static void Emit(Parser *parser, UInt16 opcode, UInt16 operand)
+{
+	if( parser->count == kNCBMaxInstructions ) parser->failed = true;
+	if( parser->failed ) return;
+	parser->code[parser->count++] = Instruction( opcode, operand );
+}
+
+// a letter and its number, if any; returns the letter, with the number in number (-1 if there wasn't one)
+static char ParseTerm(Parser *parser, SInt32 *number)
+{
+	char letter = Peek( parser );
+	*number = -1;
+	if( !isalpha( (unsigned char) letter ) )
+	{
+		parser->failed = true;
+		return '\0';
+	}
+	parser->position++;
+	while( parser->position < parser->length && isdigit( (unsigned char) parser->source[parser->position] ) )
+	{
+		if( *number < 0 ) *number = 0;
+		if( *number < 100000 ) *number = *number * 10 + (parser->source[parser->position] - '0');
+		parser->position++;
+	}
+	return (char) tolower( (unsigned char) letter );
+}
+
+static UInt16 ParseBit(Parser *parser)
+{
+	SInt32 bit;
+	char letter = ParseTerm( parser, &bit );
+	if( letter != 'b' || bit < 0 || bit >= kNCBBitCount )
+	{
+		parser->failed = true;
+		return 0;
+	}
+	return (UInt16) bit;
+}
+
+#pragma mark -
+
+static void ParseOr(Parser *parser);
+
+static void ParseUnary(Parser *parser)
+{
+	SInt32 number;
+	char c = Peek( parser );
+	if( parser->failed ) return;
+	if( c == '!' )
+	{
+		parser->position++;
+		ParseUnary( parser );
+		Emit( parser, kNCBNot, 0 );
+	}
+	else if( c == '(' )
+	{
+		parser->position++;
+		ParseOr( parser );
+		if( Peek( parser ) != ')' ) parser->failed = true;
+		else parser->position++;
+	}
+	else
+	{
+		char letter = ParseTerm( parser, &number );
+		if( letter != 'b' ) Emit( parser, kNCBOther, (UInt16) letter );
+		else if( number < 0 || number >= kNCBBitCount ) parser->failed = true;
+		else Emit( parser, kNCBBit, (UInt16) number );
+	}
+}
+
+static void ParseAnd(Parser *parser)
+{
+	ParseUnary( parser );
+	while( !parser->failed && Peek( parser ) == '&' )
+	{
+		parser->position++;
+		ParseUnary( parser );
+		Emit( parser, kNCBAnd, 0 );
+	}
+}
+
+static void ParseOr(Parser *parser)
+{
+	ParseAnd( parser );
+	while( !parser->failed && Peek( parser ) == '|' )
+	{
+		parser->position++;
+		ParseAnd( parser );
+		Emit( parser, kNCBOr, 0 );
+	}
+}
+
+UInt32 NCBCompileTest(const char *source, UInt32 length, NCBInstruction *code, UInt32 *errorOffset)
+{
+	Parser parser;
+	StartParser( &parser, source, length, code );
+	if( Peek( &parser ) == '\0' )
+		Emit( &parser, kNCBTrue, 0 );
+	else
+	{
+		ParseOr( &parser );
+		if( Peek( &parser ) != '\0' ) parser.failed = true;
+	}
+	if( parser.failed )
+	{
+		if( errorOffset ) *errorOffset = parser.position;
+		return 0;
+	}
+	return parser.count;
+}
+
+#pragma mark -
+
+static void ParseOperation(Parser *parser, Boolean allowRandom)
+{
+	SInt32 number;
+	char c = Peek( parser );
+	if( c == '!' || c == '^' )
+	{
+		parser->position++;
+		Emit( parser, (c == '!')? kNCBClear : kNCBToggle, ParseBit( parser ) );
+	}
+	else if( (c == 'r' || c == 'R') && parser->position + 1 < parser->length && parser->source[parser->position + 1] == '(' )
+	{
+		UInt32 random = parser->count;
+		if( !allowRandom )
+		{
+			parser->failed = true;
+			return;
+		}
+		parser->position += 2;
+		Emit( parser, kNCBRandom, 0 );
+		while( !parser->failed && Peek( parser ) != ')' && Peek( parser ) != '\0' )
+			ParseOperation( parser, false );
+		if( Peek( parser ) != ')' || parser->count == random + 1 ) parser->failed = true;
+		if( parser->failed ) return;
+		parser->position++;
+		parser->code[random] = Instruction( kNCBRandom, (UInt16) (parser->count - random - 1) );
+	}
+	else
+	{
+		char letter = ParseTerm( parser, &number );
+		if( letter != 'b' ) Emit( parser, kNCBOperation, (UInt16) letter );
+		else if( number < 0 || number >= kNCBBitCount ) parser->failed = true;
+		else Emit( parser, kNCBSet, (UInt16) number );
+	}
+}
+
+UInt32 NCBCompileSet(const char *source, UInt32 length, NCBInstruction *code, UInt32 *errorOffset)
+{
+	Parser parser;
+	StartParser( &parser, source, length, code );
+	if( Peek( &parser ) == '\0' )
+		Emit( &parser, kNCBTrue, 0 );
+	while( !parser.failed && Peek( &parser ) != '\0' )
+		ParseOperation( &parser, true );
+	if( parser.failed )
+	{
+		if( errorOffset ) *errorOffset = parser.position;
+		return 0;
+	}
+	return parser.count;
+}
+
+#pragma mark -
+
+Boolean NCBPasses(const NCBInstruction *code, UInt32 count, const NCBBits *bits)
+{
+	Boolean stack[kNCBMaxInstructions];
+	UInt32 i, depth = 0;
+	for( i = 0; i < count; i++ )
+	{
+		UInt16 operand = NCBOperand( code[i] );
+		switch( NCBOpcode( code[i] ) )
+		{
+			case kNCBTrue:	stack[depth++] = true;								break;
+			case kNCBBit:	stack[depth++] = TestBit( bits, operand );			break;
+			case kNCBOther:	stack[depth++] = false;								break;
+			case kNCBNot:	stack[depth-1] = !stack[depth-1];					break;
+			case kNCBAnd:	depth--; stack[depth-1] = stack[depth-1] && stack[depth];	break;
+			case kNCBOr:	depth--; stack[depth-1] = stack[depth-1] || stack[depth];	break;
+		}
+	}
+	return depth? stack[depth-1] : false;
+}
+
+static void ApplyOne(NCBInstruction instruction, NCBBits *bits)
+{
+	UInt16 bit = NCBOperand( instruction );
+	UInt32 mask = 1UL << (bit & 31);
+	switch( NCBOpcode( instruction ) )
+	{
+		case kNCBSet:		bits->words[bit >> 5] |= mask;		break;
+		case kNCBClear:		bits->words[bit >> 5] &= ~mask;		break;
+		case kNCBToggle:	bits->words[bit >> 5] ^= mask;		break;
+	}
+}
+
+void NCBApply(const NCBInstruction *code, UInt32 count, NCBBits *bits, UInt32 *seed)
+{
+	UInt32 i;
+	for( i = 0; i < count; i++ )
+	{
+		if( NCBOpcode( code[i] ) == kNCBRandom )
+		{
+			UInt32 choices = NCBOperand( code[i] );
+			*seed = *seed * 1103515245 + 12345;
+			ApplyOne( code[i + 1 + (*seed >> 16) % choices], bits );
+			i += choices;
+		}
+		else ApplyOne( code[i], bits );
+	}
+}
+
+#pragma mark -
+
+Boolean NCBMayPass(const NCBInstruction *code, UInt32 count, const NCBBits *maySet, const NCBBits *mayClear)
+{
+	// each entry is whether that part of the expression might be true, and whether it might be false
+	Boolean mayBeTrue[kNCBMaxInstructions], mayBeFalse[kNCBMaxInstructions], swap;
+	UInt32 i, depth = 0;
+	for( i = 0; i < count; i++ )
+	{
+		UInt16 operand = NCBOperand( code[i] );
+		switch( NCBOpcode( code[i] ) )
+		{
+			case kNCBTrue:
+				mayBeTrue[depth] = true;
+				mayBeFalse[depth++] = false;
+				break;
+			case kNCBBit:
+				mayBeTrue[depth] = TestBit( maySet, operand );
+				mayBeFalse[depth++] = TestBit( mayClear, operand );
+				break;
+			case kNCBOther:
+				mayBeTrue[depth] = mayBeFalse[depth] = true;
+				depth++;
+				break;
+			case kNCBNot:
+				swap = mayBeTrue[depth-1];
+				mayBeTrue[depth-1] = mayBeFalse[depth-1];
+				mayBeFalse[depth-1] = swap;
+				break;
+			case kNCBAnd:
+				depth--;
+				mayBeTrue[depth-1] = mayBeTrue[depth-1] && mayBeTrue[depth];
+				mayBeFalse[depth-1] = mayBeFalse[depth-1] || mayBeFalse[depth];
+				break;
+			case kNCBOr:
+				depth--;
+				mayBeTrue[depth-1] = mayBeTrue[depth-1] || mayBeTrue[depth];
+				mayBeFalse[depth-1] = mayBeFalse[depth-1] && mayBeFalse[depth];
+				break;
+		}
+	}
+	return depth? mayBeTrue[depth-1] : false;
+}
+
+Boolean NCBMayApply(const NCBInstruction *code, UInt32 count, NCBBits *maySet, NCBBits *mayClear)
+{
+	Boolean changed = false;
+	UInt32 i;
+	for( i = 0; i < count; i++ )
+	{
+		UInt16 bit = NCBOperand( code[i] );
+		UInt32 mask = 1UL << (bit & 31), *set = &maySet->words[bit >> 5], *clear = &mayClear->words[bit >> 5];
+		UInt16 opcode = NCBOpcode( code[i] );
+		// a random choice might be any of the operations after it, which are looked at in turn anyway
+		if( (opcode == kNCBSet || opcode == kNCBToggle) && !(*set & mask) )
+		{
+			*set |= mask;
+			changed = true;
+		}
+		if( (opcode == kNCBClear || opcode == kNCBToggle) && !(*clear & mask) )
+		{
+			*clear |= mask;
+			changed = true;
+		}
+	}
+	return changed;
+}
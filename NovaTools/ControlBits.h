@@ -0,0 +1,98 @@
+/* Nova control bit expressions */
+
+/*	Compiles the control bit (NCB) strings of chärs, cröns, mïsns and the like to postfix code, and runs it against
+	the 10,000 bits as 32-bit words rather than NovaControlBits' bytes.
+
+	Test expressions are bits (b123) and other terms (p45 for an outfit the player has, and so on), combined with
+	'&', '|', '!' and parentheses; an empty test is true. Set expressions are a list of operations: b123 sets a bit,
+	!b123 clears it, ^b123 toggles it, r(...) does one of the operations inside at random, and anything else, such
+	as granting an outfit, has nothing to do with bits and is kept only so it can be counted.
+
+	Besides running code against real bits, NCBMayPass and NCBMayApply work on what each bit might be (could it
+	ever be set, could it ever be clear) for finding what can never happen, whatever the player does. */
+
+#ifndef CONTROL_BITS_H
+#define CONTROL_BITS_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	kNCBBitCount = 10000,
+	kNCBWordCount = (kNCBBitCount + 31) / 32,
+	kNCBMaxInstructions = 256		// enough for any 255-character expression
+};
+
+enum
+{
+	// test code
+	kNCBTrue,
+	kNCBBit,			// operand is the bit
+	kNCBOther,			// operand is the term's letter; these can't be known from the bits
+	kNCBNot,
+	kNCBAnd,
+	kNCBOr,
+
+	// set code
+	kNCBSet,
+	kNCBClear,
+	kNCBToggle,
+	kNCBRandom,			// operand is how many of the following instructions to choose between
+	kNCBOperation		// operand is the operation's letter
+};
+
+typedef UInt32 NCBInstruction;		// opcode in the top 16 bits, operand in the bottom 16
+
+#define NCBOpcode(instruction)		((instruction) >> 16)
+#define NCBOperand(instruction)		((instruction) & 0xFFFF)
+
+typedef struct NCBBits
+{
+	UInt32	words[kNCBWordCount];	// bit n is (words[n / 32] >> (n % 32)) & 1
+} NCBBits;
+
+/*!
+@function	NCBCompileTest
+@abstract	Compiles a test expression of at most length characters (stopping at a NUL) into code, which must hold kNCBMaxInstructions. Returns the number of instructions (an empty expression is one kNCBTrue), or 0 with the offset of the mistake in errorOffset.
+*/
+UInt32 NCBCompileTest(const char *source, UInt32 length, NCBInstruction *code, UInt32 *errorOffset);
+
+/*!
+@function	NCBCompileSet
+@abstract	As NCBCompileTest, for set expressions. Operations inside r(...) can't themselves be random.
+*/
+UInt32 NCBCompileSet(const char *source, UInt32 length, NCBInstruction *code, UInt32 *errorOffset);
+
+/*!
+@function	NCBPasses
+@abstract	Runs test code against bits. Terms other than bits are taken to be false.
+*/
+Boolean NCBPasses(const NCBInstruction *code, UInt32 count, const NCBBits *bits);
+
+/*!
+@function	NCBApply
+@abstract	Runs set code on bits, using seed (which it updates) to make random choices.
+*/
+void NCBApply(const NCBInstruction *code, UInt32 count, NCBBits *bits, UInt32 *seed);
+
+/*!
+@function	NCBMayPass
+@abstract	Returns whether test code could pass, given which bits might ever be set and which might ever be clear. Terms other than bits might be either.
+*/
+Boolean NCBMayPass(const NCBInstruction *code, UInt32 count, const NCBBits *maySet, const NCBBits *mayClear);
+
+/*!
+@function	NCBMayApply
+@abstract	Adds the bits set code could set or clear to maySet and mayClear. Returns whether either changed.
+*/
+Boolean NCBMayApply(const NCBInstruction *code, UInt32 count, NCBBits *maySet, NCBBits *mayClear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,9 +1,12 @@
 #import <Cocoa/Cocoa.h>
 
+@class ResourceCatalog;
+
 @interface DataSource : NSObject
 {
 	NSString *type;
-	NSMutableDictionary *data;
+	ResourceCatalog *catalog;	// shared by every DataSource of this type; nil once -setData: or -setString:forResID: has been used
+	NSMutableDictionary *data;	// private names, only if catalog is nil
 	NSMutableArray *parsed;		// a subset of data, parsed to contain the typed string
 }
 
@@ -1,6 +1,8 @@
 #import "DataSource.h"
 #import "ResKnifeResourceProtocol.h"
 #import "NSNumber-Range.h"
+#import "ResourceCatalog.h"
+#import "NameIndex.h"
 
 @implementation DataSource
 
@@ -14,21 +16,15 @@
 {
 	self = [super init];
 	type = [typeString copy];
-	data = [[NSMutableDictionary alloc] init];
-	{
-		id <ResKnifeResourceProtocol> resource;
-		NSArray *resources = [NSClassFromString(@"Resource") allResourcesOfType:type inDocument:nil];	// nil document will search in ANY open document for the correct resource
-		NSEnumerator *enumerator = [resources objectEnumerator];
-		while( resource = [enumerator nextObject] )
-			[data setObject:[resource name] forKey:[resource resID]];
-	}
-	parsed = [[NSMutableArray alloc] initWithArray:[data allValues]];
+	catalog = [[ResourceCatalog catalogForType:type] retain];	// built by the first editor to ask, covering ANY open document
+	parsed = [[NSMutableArray alloc] initWithArray:[[self data] allValues]];
 	return self;
 }
 
 - (void)dealloc
 {
 	[type release];
+	[catalog release];
 	[data release];
 	[parsed release];
 	[super dealloc];
@@ -36,6 +32,7 @@
 
 - (NSDictionary *)data
 {
+	if( catalog ) return [catalog names];
 	return data;
 }
 
@@ -43,12 +40,21 @@
 {
 	id old = data;
 	data = [newData retain];
+	[catalog release];
+	catalog = nil;
 	[self parseForString:@"" sorted:YES];
 	[old autorelease];
 }
 
 - (void)setString:(NSString *)string forResID:(int)resID
 {
+	// the catalog is shared, so take a private copy before changing anything
+	if( catalog )
+	{
+		data = [[catalog names] mutableCopy];
+		[catalog release];
+		catalog = nil;
+	}
 	[data setObject:string forKey:[NSNumber numberWithInt:resID]];
 }
 
@@ -62,12 +68,24 @@
 {
 	NSNumber *resID;
 	NSString *trimmedString = [DataSource resNameFromStringValue:string];
-	NSEnumerator *enumerator = [[data allKeys] objectEnumerator];
+	NSDictionary *names;
+	NSEnumerator *enumerator;
 	[parsed removeAllObjects];
 	if( trimmedString == nil ) trimmedString = @"";
+	
+	// the shared catalog keeps an index which returns matches already formatted, and sorted if asked
+	if( catalog )
+	{
+		[parsed setArray:[[catalog index] displayStringsMatching:trimmedString inIDRange:resIDRange sorted:sort]];
+		if( [parsed count] == 0 ) [parsed addObject:string];
+		return;
+	}
+	
+	names = [self data];
+	enumerator = [[names allKeys] objectEnumerator];
 	while( resID = [enumerator nextObject] )
 	{
-		NSString *value = [data objectForKey:resID];
+		NSString *value = [names objectForKey:resID];
 		NSRange range = [value rangeOfString:trimmedString options:NSCaseInsensitiveSearch];
 		if( ((range.location != NSNotFound && range.length != 0) || [trimmedString isEqualToString:@""]) && [resID isBoundedByRange:resIDRange] )
 			[parsed addObject:[self stringValueForResID:resID]];
@@ -82,13 +100,16 @@
 
 - (id)objectValueForResID:(NSNumber *)resID
 {
-	return [data objectForKey:resID];
+	return [[self data] objectForKey:resID];
 }
 
 - (NSString *)stringValueForResID:(NSNumber *)resID
 {
-	if( resID && [data objectForKey:resID] )
-		return [NSString stringWithFormat:@"%@ {%@}", [data objectForKey:resID], resID];
+	NSString *name = resID? [[self data] objectForKey:resID] : nil;
+	if( name && catalog )
+		return [[catalog index] displayStringForResID:resID];
+	else if( name )
+		return [NSString stringWithFormat:@"%@ {%@}", name, resID];
 	else if( [resID shortValue] == -1 )
 		return @"";
 	else if( resID )
@@ -145,7 +166,7 @@
 
 - (NSString *)description
 {
-	return [NSString stringWithFormat:@"\nType: %@\nData: %@\nParsed Data: %@\n", type, [data description], [parsed description]];
+	return [NSString stringWithFormat:@"\nType: %@\nData: %@\nParsed Data: %@\n", type, [[self data] description], [parsed description]];
 }
 
 @end
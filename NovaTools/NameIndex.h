@@ -0,0 +1,33 @@
+#import <Cocoa/Cocoa.h>
+
+/*	An immutable index over a resID -> name dictionary, for answering combo box queries ("names containing this,
+	with IDs in that range") without touching every name. Names are lower-cased once and every substring of up to
+	kNameIndexGramLength characters maps to the set of names containing it, so a query starts from the rarest
+	such substring of what was typed. IDs are kept sorted for range queries. Results come back as the cached
+	"name {id}" strings, in display order or, unsorted, in ID order. ResourceCatalog builds one on demand and
+	throws it away when a name changes. */
+
+#define kNameIndexGramLength 3
+
+typedef struct NameIndexID
+{
+	int			resID;
+	unsigned	position;	// in display order
+} NameIndexID;
+
+@interface NameIndex : NSObject
+{
+	unsigned count;
+	NSArray *displayStrings;		// "name {id}", sorted case-insensitively
+	NSArray *foldedNames;			// lower-case names, by display position
+	int *resIDs;					// by display position
+	NameIndexID *byID;				// sorted by resID
+	NSDictionary *grams;			// substring -> NSIndexSet of display positions
+	NSDictionary *displayByID;		// resID -> "name {id}"
+}
+
+- (id)initWithNames:(NSDictionary *)names;
+- (NSArray *)displayStringsMatching:(NSString *)string inIDRange:(NSRange)range sorted:(BOOL)sort;	// range as used by -[NSNumber isBoundedByRange:]; unsorted is ID order
+- (NSString *)displayStringForResID:(NSNumber *)resID;
+
+@end
@@ -0,0 +1,181 @@
+#import "NameIndex.h"
+
+@interface NameIndex (Private)
+- (unsigned)firstIDNotBelow:(int)min;
+- (NSIndexSet *)positionsInIDRange:(NSRange)range;
+@end
+
+static int CompareDisplayStrings(id first, id second, void *displayByID)
+{
+	return [[(NSDictionary *)displayByID objectForKey:first] caseInsensitiveCompare:[(NSDictionary *)displayByID objectForKey:second]];
+}
+
+static int CompareIDs(const void *first, const void *second)
+{
+	int a = ((const NameIndexID *)first)->resID, b = ((const NameIndexID *)second)->resID;
+	return (a > b) - (a < b);
+}
+
+@implementation NameIndex
+
+- (id)initWithNames:(NSDictionary *)names
+{
+	unsigned i;
+	NSArray *sortedIDs;
+	NSMutableArray *display, *folded;
+	NSMutableDictionary *displayCache, *gramSets;
+	NSNumber *resID;
+	NSEnumerator *enumerator;
+	
+	self = [super init];
+	if( !self ) return nil;
+	
+	// format every display string once
+	displayCache = [NSMutableDictionary dictionaryWithCapacity:[names count]];
+	enumerator = [names keyEnumerator];
+	while( resID = [enumerator nextObject] )
+		[displayCache setObject:[NSString stringWithFormat:@"%@ {%@}", [names objectForKey:resID], resID] forKey:resID];
+	
+	// display order is the order parseForString:sorted: used to sort into on every keystroke
+	sortedIDs = [[names allKeys] sortedArrayUsingFunction:CompareDisplayStrings context:displayCache];
+	count = [sortedIDs count];
+	display = [NSMutableArray arrayWithCapacity:count];
+	folded = [NSMutableArray arrayWithCapacity:count];
+	gramSets = [NSMutableDictionary dictionary];
+	resIDs = (int *) malloc(sizeof(int) * (count? count:1));
+	byID = (NameIndexID *) malloc(sizeof(NameIndexID) * (count? count:1));
+	for( i = 0; i < count; i++ )
+	{
+		unsigned start, length, gramLength;
+		NSString *name;
+		resID = [sortedIDs objectAtIndex:i];
+		name = [[names objectForKey:resID] lowercaseString];
+		[display addObject:[displayCache objectForKey:resID]];
+		[folded addObject:name];
+		resIDs[i] = [resID intValue];
+		byID[i].resID = resIDs[i];
+		byID[i].position = i;
+		
+		// every substring of up to kNameIndexGramLength characters
+		length = [name length];
+		for( start = 0; start < length; start++ )
+		{
+			for( gramLength = 1; gramLength <= kNameIndexGramLength && start + gramLength <= length; gramLength++ )
+			{
+				NSString *gram = [name substringWithRange:NSMakeRange(start, gramLength)];
+				NSMutableIndexSet *set = [gramSets objectForKey:gram];
+				if( !set )
+				{
+					set = [NSMutableIndexSet indexSet];
+					[gramSets setObject:set forKey:gram];
+				}
+				[set addIndex:i];
+			}
+		}
+	}
+	qsort(byID, count, sizeof(NameIndexID), CompareIDs);
+	
+	displayStrings = [display copy];
+	foldedNames = [folded copy];
+	grams = [gramSets copy];
+	displayByID = [displayCache copy];
+	return self;
+}
+
+- (void)dealloc
+{
+	[displayStrings release];
+	[foldedNames release];
+	[grams release];
+	[displayByID release];
+	free(resIDs);
+	free(byID);
+	[super dealloc];
+}
+
+- (NSString *)displayStringForResID:(NSNumber *)resID
+{
+	return [displayByID objectForKey:resID];
+}
+
+// binary search of byID for the first ID >= min
+- (unsigned)firstIDNotBelow:(int)min
+{
+	unsigned low = 0, high = count;
+	while( low < high )
+	{
+		unsigned middle = (low + high) / 2;
+		if( byID[middle].resID < min ) low = middle + 1;
+		else high = middle;
+	}
+	return low;
+}
+
+// display positions of names whose IDs satisfy location <= ID < location+length
+- (NSIndexSet *)positionsInIDRange:(NSRange)range
+{
+	int max = (int) (range.location + range.length);
+	unsigned low = [self firstIDNotBelow:(int) range.location];
+	NSMutableIndexSet *positions = [NSMutableIndexSet indexSet];
+	for( ; low < count && byID[low].resID < max; low++ )
+		[positions addIndex:byID[low].position];
+	return positions;
+}
+
+- (NSArray *)displayStringsMatching:(NSString *)string inIDRange:(NSRange)range sorted:(BOOL)sort
+{
+	unsigned i, length, position, found = 0;
+	int min = (int) range.location, max = (int) (range.location + range.length);
+	NSString *folded = [string lowercaseString];
+	NSIndexSet *candidates = nil;
+	NSMutableArray *results = [NSMutableArray array];
+	NameIndexID *matches;
+	
+	length = [folded length];
+	if( length == 0 )
+	{
+		// byID already holds every name in ID order
+		if( !sort )
+		{
+			unsigned low = [self firstIDNotBelow:min];
+			for( ; low < count && byID[low].resID < max; low++ )
+				[results addObject:[displayStrings objectAtIndex:byID[low].position]];
+			return results;
+		}
+		candidates = [self positionsInIDRange:range];
+		for( position = [candidates firstIndex]; position != NSNotFound; position = [candidates indexGreaterThanIndex:position] )
+			[results addObject:[displayStrings objectAtIndex:position]];
+		return results;
+	}
+	
+	// start from the rarest substring of the query; if the query is no longer than a gram, that is the answer
+	if( length <= kNameIndexGramLength )
+		candidates = [grams objectForKey:folded];
+	else for( i = 0; i + kNameIndexGramLength <= length; i++ )
+	{
+		NSIndexSet *set = [grams objectForKey:[folded substringWithRange:NSMakeRange(i, kNameIndexGramLength)]];
+		if( !set ) return results;
+		if( !candidates || [set count] < [candidates count] )
+			candidates = set;
+	}
+	if( !candidates ) return results;
+	
+	// positions are in display order; unsorted results are put in ID order instead
+	matches = (NameIndexID *) malloc(sizeof(NameIndexID) * ([candidates count]? [candidates count]:1));
+	for( position = [candidates firstIndex]; position != NSNotFound; position = [candidates indexGreaterThanIndex:position] )
+	{
+		if( resIDs[position] < min || resIDs[position] >= max ) continue;
+		if( length > kNameIndexGramLength && [[foldedNames objectAtIndex:position] rangeOfString:folded options:NSLiteralSearch].location == NSNotFound )
+			continue;
+		matches[found].resID = resIDs[position];
+		matches[found].position = position;
+		found++;
+	}
+	if( !sort ) qsort(matches, found, sizeof(NameIndexID), CompareIDs);
+	for( i = 0; i < found; i++ )
+		[results addObject:[displayStrings objectAtIndex:matches[i].position]];
+	free(matches);
+	return results;
+}
+
+@end
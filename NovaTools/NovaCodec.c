@@ -0,0 +1,731 @@
+#include "NovaCodec.h"
+#include "Structs.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/*** COMPILE-TIME CHECKS ***/
+
+// fails to compile (negative array size) if the condition is false
+#define NOVA_STATIC_ASSERT(name, condition)			typedef char NovaAssert_##name[(condition)? 1:-1]
+
+// every field in a list must be exactly the size its entry claims
+#define NOVA_CHECK_FIELD(rec, field, width, count)	NOVA_STATIC_ASSERT(rec##_##field, sizeof(((rec *)0)->field) == (width) * (count));
+#define NOVA_DESCRIBE_FIELD(rec, field, width, count)	{ offsetof(rec, field), width, count },
+#define NOVA_FIELD_SIZE(rec, field, width, count)	+ (width) * (count)
+
+// with mac68k alignment the structure must also be exactly the size of the resource (rounded up to a word), which catches missing fields
+#if defined(__APPLE_CC__) || defined(__MWERKS__)
+	#define NOVA_CHECK_PACKING(rec, FIELDS)			NOVA_STATIC_ASSERT(rec##_size, sizeof(rec) == ((0 FIELDS(NOVA_FIELD_SIZE)) + 1) / 2 * 2);
+#else
+	#define NOVA_CHECK_PACKING(rec, FIELDS)			NOVA_STATIC_ASSERT(rec##_size, sizeof(rec) >= (0 FIELDS(NOVA_FIELD_SIZE)));
+#endif
+
+// and on every compiler the fields listed must add up to exactly the resource's documented size
+#define NOVA_RECORD(rec, FIELDS, diskSize) \
+	FIELDS(NOVA_CHECK_FIELD) \
+	NOVA_CHECK_PACKING(rec, FIELDS) \
+	NOVA_STATIC_ASSERT(rec##_disk, (0 FIELDS(NOVA_FIELD_SIZE)) == (diskSize)); \
+	static const NovaField g##rec##Fields[] = { FIELDS(NOVA_DESCRIBE_FIELD) }; \
+	const NovaRecord kNova##rec = { #rec, diskSize, sizeof(rec), sizeof(g##rec##Fields) / sizeof(NovaField), g##rec##Fields };
+
+/*** FIELD LISTS ***/
+
+// in on-disk order: record, field, element width, element count (Rects are four shorts)
+
+#define NOVA_BOOM_FIELDS(F) \
+	F(BoomRec, FrameAdvance, 2, 1) \
+	F(BoomRec, SoundIndex, 2, 1) \
+	F(BoomRec, GraphicIndex, 2, 1)
+
+#define NOVA_CHAR_FIELDS(F) \
+	F(CharRec, startCash, 4, 1) \
+	F(CharRec, startShipType, 2, 1) \
+	F(CharRec, startSystem, 2, 4) \
+	F(CharRec, startGovt, 2, 4) \
+	F(CharRec, startStatus, 2, 4) \
+	F(CharRec, startKills, 2, 1) \
+	F(CharRec, introPictID, 2, 4) \
+	F(CharRec, introPictDelay, 2, 4) \
+	F(CharRec, introTextID, 2, 1) \
+	F(CharRec, OnStart, 1, 256) \
+	F(CharRec, Flags, 2, 1) \
+	F(CharRec, startDay, 2, 1) \
+	F(CharRec, startMonth, 2, 1) \
+	F(CharRec, startYear, 2, 1) \
+	F(CharRec, Prefix, 1, 16) \
+	F(CharRec, Suffix, 1, 16) \
+	F(CharRec, UnusedA, 2, 8)
+
+#define NOVA_COLR_FIELDS(F) \
+	F(ColrRec, ButtonUp, 4, 1) \
+	F(ColrRec, ButtonDown, 4, 1) \
+	F(ColrRec, ButtonGrey, 4, 1) \
+	F(ColrRec, MenuFont, 1, 64) \
+	F(ColrRec, MenuFontSize, 2, 1) \
+	F(ColrRec, MenuColor1, 4, 1) \
+	F(ColrRec, MenuColor2, 4, 1) \
+	F(ColrRec, GridBright, 4, 1) \
+	F(ColrRec, GridDim, 4, 1) \
+	F(ColrRec, ProgArea, 2, 4) \
+	F(ColrRec, ProgBright, 4, 1) \
+	F(ColrRec, ProgDim, 4, 1) \
+	F(ColrRec, ProgOutline, 4, 1) \
+	F(ColrRec, Button1x, 2, 1) \
+	F(ColrRec, Button1y, 2, 1) \
+	F(ColrRec, Button2x, 2, 1) \
+	F(ColrRec, Button2y, 2, 1) \
+	F(ColrRec, Button3x, 2, 1) \
+	F(ColrRec, Button3y, 2, 1) \
+	F(ColrRec, Button4x, 2, 1) \
+	F(ColrRec, Button4y, 2, 1) \
+	F(ColrRec, Button5x, 2, 1) \
+	F(ColrRec, Button5y, 2, 1) \
+	F(ColrRec, Button6x, 2, 1) \
+	F(ColrRec, Button6y, 2, 1) \
+	F(ColrRec, FloatingMap, 4, 1) \
+	F(ColrRec, ListText, 4, 1) \
+	F(ColrRec, ListBkgnd, 4, 1) \
+	F(ColrRec, ListHilite, 4, 1) \
+	F(ColrRec, EscortHilite, 4, 1) \
+	F(ColrRec, ButtonFont, 1, 64) \
+	F(ColrRec, ButtonFontSz, 2, 1) \
+	F(ColrRec, LogoX, 2, 1) \
+	F(ColrRec, LogoY, 2, 1) \
+	F(ColrRec, RolloverX, 2, 1) \
+	F(ColrRec, RolloverY, 2, 1) \
+	F(ColrRec, Slide1x, 2, 1) \
+	F(ColrRec, Slide1y, 2, 1) \
+	F(ColrRec, Slide2x, 2, 1) \
+	F(ColrRec, Slide2y, 2, 1) \
+	F(ColrRec, Slide3x, 2, 1) \
+	F(ColrRec, Slide3y, 2, 1)
+
+#define NOVA_CRON_FIELDS(F) \
+	F(CronRec, FirstDay, 2, 1) \
+	F(CronRec, FirstMonth, 2, 1) \
+	F(CronRec, FirstYear, 2, 1) \
+	F(CronRec, LastDay, 2, 1) \
+	F(CronRec, LastMonth, 2, 1) \
+	F(CronRec, LastYear, 2, 1) \
+	F(CronRec, Random, 2, 1) \
+	F(CronRec, Duration, 2, 1) \
+	F(CronRec, PreHoldoff, 2, 1) \
+	F(CronRec, PostHoldoff, 2, 1) \
+	F(CronRec, IndNewsStr, 2, 1) \
+	F(CronRec, Flags, 2, 1) \
+	F(CronRec, cdata, 1, 766) \
+	F(CronRec, Contributes0, 4, 1) \
+	F(CronRec, Contributes1, 4, 1) \
+	F(CronRec, Require0, 4, 1) \
+	F(CronRec, Require1, 4, 1) \
+	F(CronRec, NewsGovt, 2, 4) \
+	F(CronRec, GovtNewsString, 2, 4)
+
+#define NOVA_DESCCODA_FIELDS(F) \
+	F(DescCodaRec, Graphic, 2, 1) \
+	F(DescCodaRec, Movie, 1, 32) \
+	F(DescCodaRec, Flags, 2, 1)
+
+#define NOVA_DEQT_FIELDS(F) \
+	F(DeqtRec, Flags, 2, 1)
+
+#define NOVA_DUDE_FIELDS(F) \
+	F(DudeRec, AIType, 2, 1) \
+	F(DudeRec, Govt, 2, 1) \
+	F(DudeRec, Booty, 2, 1) \
+	F(DudeRec, InfoTypes, 2, 1) \
+	F(DudeRec, ShipTypes, 2, 16) \
+	F(DudeRec, Probs, 2, 16) \
+	F(DudeRec, UnusedA, 2, 8)
+
+#define NOVA_FLET_FIELDS(F) \
+	F(FletRec, LeadShipType, 2, 1) \
+	F(FletRec, EscortShipType, 2, 4) \
+	F(FletRec, EscortMin, 2, 4) \
+	F(FletRec, EscortMax, 2, 4) \
+	F(FletRec, Govt, 2, 1) \
+	F(FletRec, LinkSyst, 2, 1) \
+	F(FletRec, ActivateOn, 1, 256) \
+	F(FletRec, Quote, 2, 1) \
+	F(FletRec, Flags, 2, 1) \
+	F(FletRec, UnusedA, 2, 8)
+
+#define NOVA_INTF_FIELDS(F) \
+	F(IntfRec, BrightText, 4, 1) \
+	F(IntfRec, DimText, 4, 1) \
+	F(IntfRec, RadarArea, 2, 4) \
+	F(IntfRec, BrightRadar, 4, 1) \
+	F(IntfRec, DimRadar, 4, 1) \
+	F(IntfRec, ShieldArea, 2, 4) \
+	F(IntfRec, Shield, 4, 1) \
+	F(IntfRec, ArmorArea, 2, 4) \
+	F(IntfRec, Armor, 4, 1) \
+	F(IntfRec, FuelArea, 2, 4) \
+	F(IntfRec, FuelFull, 4, 1) \
+	F(IntfRec, FuelPartial, 4, 1) \
+	F(IntfRec, NavArea, 2, 4) \
+	F(IntfRec, WeapArea, 2, 4) \
+	F(IntfRec, TargArea, 2, 4) \
+	F(IntfRec, CargoArea, 2, 4) \
+	F(IntfRec, StatusFont, 1, 64) \
+	F(IntfRec, StatFontSize, 2, 1) \
+	F(IntfRec, SubtitleSize, 2, 1) \
+	F(IntfRec, StatusBkgnd, 2, 1)
+
+#define NOVA_JUNK_FIELDS(F) \
+	F(JunkRec, SoldAt, 2, 8) \
+	F(JunkRec, BoughtAt, 2, 8) \
+	F(JunkRec, BasePrice, 2, 1) \
+	F(JunkRec, Flags, 2, 1) \
+	F(JunkRec, ScanMask, 2, 1) \
+	F(JunkRec, cdata, 1, 638)
+
+#define NOVA_GOVT_FIELDS(F) \
+	F(GovtRec, VoiceType, 2, 1) \
+	F(GovtRec, Flags, 2, 1) \
+	F(GovtRec, Flags2, 2, 1) \
+	F(GovtRec, ScanFine, 2, 1) \
+	F(GovtRec, CrimeTol, 2, 1) \
+	F(GovtRec, SmugPenalty, 2, 1) \
+	F(GovtRec, DisabPenalty, 2, 1) \
+	F(GovtRec, BoardPenalty, 2, 1) \
+	F(GovtRec, KillPenalty, 2, 1) \
+	F(GovtRec, ShootPenalty, 2, 1) \
+	F(GovtRec, InitialRec, 2, 1) \
+	F(GovtRec, MaxOdds, 2, 1) \
+	F(GovtRec, Classes, 2, 4) \
+	F(GovtRec, Allies, 2, 4) \
+	F(GovtRec, Enemies, 2, 4) \
+	F(GovtRec, SkillMult, 2, 1) \
+	F(GovtRec, ScanMask, 2, 1) \
+	F(GovtRec, CommName, 1, 16) \
+	F(GovtRec, TargetCode, 1, 16) \
+	F(GovtRec, Require0, 4, 1) \
+	F(GovtRec, Require1, 4, 1) \
+	F(GovtRec, InhJam, 2, 4) \
+	F(GovtRec, MediumName, 1, 64) \
+	F(GovtRec, color, 4, 1) \
+	F(GovtRec, ShipColor, 4, 1) \
+	F(GovtRec, intf, 2, 1) \
+	F(GovtRec, NewsPict, 2, 1) \
+	F(GovtRec, UnusedA, 2, 8)
+
+#define NOVA_MISN_FIELDS(F) \
+	F(MisnRec, AvailStel, 2, 1) \
+	F(MisnRec, Unused1, 2, 1) \
+	F(MisnRec, AvailLoc, 2, 1) \
+	F(MisnRec, AvailRecord, 2, 1) \
+	F(MisnRec, AvailRating, 2, 1) \
+	F(MisnRec, AvailRandom, 2, 1) \
+	F(MisnRec, TravelStel, 2, 1) \
+	F(MisnRec, ReturnStel, 2, 1) \
+	F(MisnRec, CargoType, 2, 1) \
+	F(MisnRec, CargoQty, 2, 1) \
+	F(MisnRec, PickupMode, 2, 1) \
+	F(MisnRec, DropoffMode, 2, 1) \
+	F(MisnRec, ScanGovt, 2, 1) \
+	F(MisnRec, Unused2, 2, 1) \
+	F(MisnRec, PayVal, 4, 1) \
+	F(MisnRec, ShipCount, 2, 1) \
+	F(MisnRec, ShipSyst, 2, 1) \
+	F(MisnRec, ShipDude, 2, 1) \
+	F(MisnRec, ShipGoal, 2, 1) \
+	F(MisnRec, ShipBehav, 2, 1) \
+	F(MisnRec, ShipNameID, 2, 1) \
+	F(MisnRec, ShipStart, 2, 1) \
+	F(MisnRec, CompGovt, 2, 1) \
+	F(MisnRec, CompReward, 2, 1) \
+	F(MisnRec, ShipSubTitle, 2, 1) \
+	F(MisnRec, BriefText, 2, 1) \
+	F(MisnRec, QuickBrief, 2, 1) \
+	F(MisnRec, LoadCargText, 2, 1) \
+	F(MisnRec, DropCargText, 2, 1) \
+	F(MisnRec, CompText, 2, 1) \
+	F(MisnRec, FailText, 2, 1) \
+	F(MisnRec, TimeLimit, 2, 1) \
+	F(MisnRec, CanAbort, 2, 1) \
+	F(MisnRec, ShipDoneText, 2, 1) \
+	F(MisnRec, Unused3, 2, 1) \
+	F(MisnRec, AuxShipCount, 2, 1) \
+	F(MisnRec, AuxShipDude, 2, 1) \
+	F(MisnRec, AuxShipSyst, 2, 1) \
+	F(MisnRec, Unused4, 2, 1) \
+	F(MisnRec, Flags, 2, 1) \
+	F(MisnRec, Flags2, 2, 1) \
+	F(MisnRec, Unused6, 2, 1) \
+	F(MisnRec, Unused7, 2, 1) \
+	F(MisnRec, RefuseText, 2, 1) \
+	F(MisnRec, AvailShipType, 2, 1) \
+	F(MisnRec, cdata, 1, 1530) \
+	F(MisnRec, Require0, 4, 1) \
+	F(MisnRec, Require1, 4, 1) \
+	F(MisnRec, DatePostInc, 2, 1) \
+	F(MisnRec, cdata2, 1, 320) \
+	F(MisnRec, DispWeight, 2, 1) \
+	F(MisnRec, UnusedA, 2, 8)
+
+#define NOVA_NEBU_FIELDS(F) \
+	F(NebuRec, XPos, 2, 1) \
+	F(NebuRec, YPos, 2, 1) \
+	F(NebuRec, XSize, 2, 1) \
+	F(NebuRec, YSize, 2, 1) \
+	F(NebuRec, cdata, 1, 510) \
+	F(NebuRec, UnusedA, 2, 8)
+
+#define NOVA_OOPS_FIELDS(F) \
+	F(OopsRec, Stellar, 2, 1) \
+	F(OopsRec, Commodity, 2, 1) \
+	F(OopsRec, PriceDelta, 2, 1) \
+	F(OopsRec, Duration, 2, 1) \
+	F(OopsRec, Freq, 2, 1) \
+	F(OopsRec, ActivateOn, 1, 256) \
+	F(OopsRec, UnusedA, 2, 8)
+
+#define NOVA_OUTF_FIELDS(F) \
+	F(OutfRec, DispWeight, 2, 1) \
+	F(OutfRec, Mass, 2, 1) \
+	F(OutfRec, TechLevel, 2, 1) \
+	F(OutfRec, ModType, 2, 1) \
+	F(OutfRec, ModVal, 2, 1) \
+	F(OutfRec, Max, 2, 1) \
+	F(OutfRec, Flags, 2, 1) \
+	F(OutfRec, Cost, 4, 1) \
+	F(OutfRec, ModType2, 2, 1) \
+	F(OutfRec, ModVal2, 2, 1) \
+	F(OutfRec, ModType3, 2, 1) \
+	F(OutfRec, ModVal3, 2, 1) \
+	F(OutfRec, ModType4, 2, 1) \
+	F(OutfRec, ModVal4, 2, 1) \
+	F(OutfRec, Contributes0, 4, 1) \
+	F(OutfRec, Contributes1, 4, 1) \
+	F(OutfRec, Require0, 4, 1) \
+	F(OutfRec, Require1, 4, 1) \
+	F(OutfRec, cdata, 1, 958) \
+	F(OutfRec, ItemClass, 2, 1) \
+	F(OutfRec, ScanMask, 2, 1) \
+	F(OutfRec, BuyRandom, 2, 1) \
+	F(OutfRec, RequireGovt, 2, 1) \
+	F(OutfRec, UnusedA, 2, 8)
+
+#define NOVA_PERS_FIELDS(F) \
+	F(PersRec, LinkSyst, 2, 1) \
+	F(PersRec, Govt, 2, 1) \
+	F(PersRec, AIType, 2, 1) \
+	F(PersRec, Aggress, 2, 1) \
+	F(PersRec, Coward, 2, 1) \
+	F(PersRec, ShipType, 2, 1) \
+	F(PersRec, WeapType, 2, 4) \
+	F(PersRec, WeapCount, 2, 4) \
+	F(PersRec, AmmoLoad, 2, 4) \
+	F(PersRec, Credits, 4, 1) \
+	F(PersRec, ShieldMod, 2, 1) \
+	F(PersRec, HailPict, 2, 1) \
+	F(PersRec, CommQuote, 2, 1) \
+	F(PersRec, HailQuote, 2, 1) \
+	F(PersRec, LinkMission, 2, 1) \
+	F(PersRec, Flags, 2, 1) \
+	F(PersRec, ActivateOn, 1, 256) \
+	F(PersRec, GrantClass, 2, 1) \
+	F(PersRec, GrantCount, 2, 1) \
+	F(PersRec, GrantProb, 2, 1) \
+	F(PersRec, SubTitle, 1, 64) \
+	F(PersRec, ShipColor, 4, 1) \
+	F(PersRec, Flags2, 2, 1) \
+	F(PersRec, UnusedA, 2, 8)
+
+#define NOVA_RANK_FIELDS(F) \
+	F(RankRec, Weight, 2, 1) \
+	F(RankRec, Govt, 2, 1) \
+	F(RankRec, PriceMod, 2, 1) \
+	F(RankRec, Salary, 4, 1) \
+	F(RankRec, SalaryCap, 4, 1) \
+	F(RankRec, Contributes0, 4, 1) \
+	F(RankRec, Contributes1, 4, 1) \
+	F(RankRec, flags, 2, 1) \
+	F(RankRec, cdata, 1, 128)
+
+#define NOVA_ROID_FIELDS(F) \
+	F(RoidRec, Strength, 2, 1) \
+	F(RoidRec, spinRate, 2, 1) \
+	F(RoidRec, yieldType, 2, 1) \
+	F(RoidRec, yieldQty, 2, 1) \
+	F(RoidRec, partCount, 2, 1) \
+	F(RoidRec, partColor, 4, 1) \
+	F(RoidRec, fragType, 2, 2) \
+	F(RoidRec, fragCount, 2, 1) \
+	F(RoidRec, ExplodeType, 2, 1) \
+	F(RoidRec, Mass, 2, 1) \
+	F(RoidRec, UnusedA, 2, 8)
+
+#define NOVA_SHAN_FIELDS(F) \
+	F(ShanRec, BaseImageID, 2, 1) \
+	F(ShanRec, BaseMaskID, 2, 1) \
+	F(ShanRec, BaseSetCount, 2, 1) \
+	F(ShanRec, BaseXSize, 2, 1) \
+	F(ShanRec, BaseYSize, 2, 1) \
+	F(ShanRec, BaseTransp, 2, 1) \
+	F(ShanRec, AltImageID, 2, 1) \
+	F(ShanRec, AltMaskID, 2, 1) \
+	F(ShanRec, AltSetCount, 2, 1) \
+	F(ShanRec, AltXSize, 2, 1) \
+	F(ShanRec, AltYSize, 2, 1) \
+	F(ShanRec, GlowImageID, 2, 1) \
+	F(ShanRec, GlowMaskID, 2, 1) \
+	F(ShanRec, GlowXSize, 2, 1) \
+	F(ShanRec, GlowYSize, 2, 1) \
+	F(ShanRec, LightImageID, 2, 1) \
+	F(ShanRec, LightMaskID, 2, 1) \
+	F(ShanRec, LightXSize, 2, 1) \
+	F(ShanRec, LightYSize, 2, 1) \
+	F(ShanRec, WeapImageID, 2, 1) \
+	F(ShanRec, WeapMaskID, 2, 1) \
+	F(ShanRec, WeapXSize, 2, 1) \
+	F(ShanRec, WeapYSize, 2, 1) \
+	F(ShanRec, Flags, 2, 1) \
+	F(ShanRec, AnimDelay, 2, 1) \
+	F(ShanRec, WeapDecay, 2, 1) \
+	F(ShanRec, FramesPer, 2, 1) \
+	F(ShanRec, BlinkMode, 2, 1) \
+	F(ShanRec, BlinkA, 2, 1) \
+	F(ShanRec, BlinkB, 2, 1) \
+	F(ShanRec, BlinkC, 2, 1) \
+	F(ShanRec, BlinkD, 2, 1) \
+	F(ShanRec, ShieldImgID, 2, 1) \
+	F(ShanRec, ShieldMaskID, 2, 1) \
+	F(ShanRec, ShieldXSize, 2, 1) \
+	F(ShanRec, ShieldYSize, 2, 1) \
+	F(ShanRec, GunPosX, 2, 4) \
+	F(ShanRec, GunPosY, 2, 4) \
+	F(ShanRec, TurretPosX, 2, 4) \
+	F(ShanRec, TurretPosY, 2, 4) \
+	F(ShanRec, GuidedPosX, 2, 4) \
+	F(ShanRec, GuidedPosY, 2, 4) \
+	F(ShanRec, BeamPosX, 2, 4) \
+	F(ShanRec, BeamPosY, 2, 4) \
+	F(ShanRec, UpCompressX, 2, 1) \
+	F(ShanRec, UpCompressY, 2, 1) \
+	F(ShanRec, DnCompressX, 2, 1) \
+	F(ShanRec, DnCompressY, 2, 1) \
+	F(ShanRec, GunPosZ, 2, 4) \
+	F(ShanRec, TurretPosZ, 2, 4) \
+	F(ShanRec, GuidedPosZ, 2, 4) \
+	F(ShanRec, BeamPosZ, 2, 4) \
+	F(ShanRec, UnusedA, 2, 8)
+
+#define NOVA_SHIP_FIELDS(F) \
+	F(ShipRec, holds, 2, 1) \
+	F(ShipRec, Shield, 2, 1) \
+	F(ShipRec, Accel, 2, 1) \
+	F(ShipRec, Speed, 2, 1) \
+	F(ShipRec, Maneuver, 2, 1) \
+	F(ShipRec, Fuel, 2, 1) \
+	F(ShipRec, freeMass, 2, 1) \
+	F(ShipRec, Armor, 2, 1) \
+	F(ShipRec, ShieldRegen, 2, 1) \
+	F(ShipRec, WType, 2, 4) \
+	F(ShipRec, WCount, 2, 4) \
+	F(ShipRec, Ammo, 2, 4) \
+	F(ShipRec, MaxGun, 2, 1) \
+	F(ShipRec, MaxTur, 2, 1) \
+	F(ShipRec, TechLevel, 2, 1) \
+	F(ShipRec, Cost, 4, 1) \
+	F(ShipRec, DeathDelay, 2, 1) \
+	F(ShipRec, ArmorRech, 2, 1) \
+	F(ShipRec, Explode1, 2, 1) \
+	F(ShipRec, Explode2, 2, 1) \
+	F(ShipRec, DispWeight, 2, 1) \
+	F(ShipRec, Mass, 2, 1) \
+	F(ShipRec, Length, 2, 1) \
+	F(ShipRec, InherentAI, 2, 1) \
+	F(ShipRec, Crew, 2, 1) \
+	F(ShipRec, Strength, 2, 1) \
+	F(ShipRec, InherentGovt, 2, 1) \
+	F(ShipRec, Flags, 2, 1) \
+	F(ShipRec, PodCount, 2, 1) \
+	F(ShipRec, DefaultItems, 2, 4) \
+	F(ShipRec, ItemCount, 2, 4) \
+	F(ShipRec, FuelRegen, 2, 1) \
+	F(ShipRec, SkillVar, 2, 1) \
+	F(ShipRec, Flags2, 2, 1) \
+	F(ShipRec, Contributes0, 4, 1) \
+	F(ShipRec, Contributes1, 4, 1) \
+	F(ShipRec, cdata1, 1, 766) \
+	F(ShipRec, Deionize, 2, 1) \
+	F(ShipRec, IonizeMax, 2, 1) \
+	F(ShipRec, KeyCarried, 2, 1) \
+	F(ShipRec, DefaultItems2, 2, 4) \
+	F(ShipRec, ItemCount2, 2, 4) \
+	F(ShipRec, Require0, 4, 1) \
+	F(ShipRec, Require1, 4, 1) \
+	F(ShipRec, BuyRandom, 2, 1) \
+	F(ShipRec, HireRandom, 2, 1) \
+	F(ShipRec, unusedBlock, 2, 34) \
+	F(ShipRec, cdata2, 1, 766) \
+	F(ShipRec, WType2, 2, 4) \
+	F(ShipRec, WCount2, 2, 4) \
+	F(ShipRec, Ammo2, 2, 4) \
+	F(ShipRec, cdata3, 1, 64) \
+	F(ShipRec, Flags3, 2, 1) \
+	F(ShipRec, UpgradeTo, 2, 1) \
+	F(ShipRec, EscUpgrdCost, 4, 1) \
+	F(ShipRec, EscSellValue, 4, 1) \
+	F(ShipRec, EscortType, 2, 1) \
+	F(ShipRec, UnusedA, 2, 8)
+
+#define NOVA_SPIN_FIELDS(F) \
+	F(SpinRec, SpritesID, 2, 1) \
+	F(SpinRec, MasksID, 2, 1) \
+	F(SpinRec, xSize, 2, 1) \
+	F(SpinRec, ySize, 2, 1) \
+	F(SpinRec, nx, 2, 1) \
+	F(SpinRec, ny, 2, 1)
+
+#define NOVA_SPOB_FIELDS(F) \
+	F(SpobRec, xPos, 2, 1) \
+	F(SpobRec, yPos, 2, 1) \
+	F(SpobRec, spobType, 2, 1) \
+	F(SpobRec, Flags, 4, 1) \
+	F(SpobRec, Tribute, 2, 1) \
+	F(SpobRec, TechLevel, 2, 1) \
+	F(SpobRec, SpecialTech1, 2, 1) \
+	F(SpobRec, SpecialTech2, 2, 1) \
+	F(SpobRec, SpecialTech3, 2, 1) \
+	F(SpobRec, Govt, 2, 1) \
+	F(SpobRec, MinCoolness, 2, 1) \
+	F(SpobRec, CustPicID, 2, 1) \
+	F(SpobRec, CustSndID, 2, 1) \
+	F(SpobRec, DefDude, 2, 1) \
+	F(SpobRec, DefCount, 2, 1) \
+	F(SpobRec, Flags2, 2, 1) \
+	F(SpobRec, AnimDelay, 2, 1) \
+	F(SpobRec, Frame0Bias, 2, 1) \
+	F(SpobRec, HyperLink, 2, 8) \
+	F(SpobRec, cdata, 1, 510) \
+	F(SpobRec, Fee, 4, 1) \
+	F(SpobRec, Gravity, 2, 1) \
+	F(SpobRec, Weapon, 2, 1) \
+	F(SpobRec, Strength, 4, 1) \
+	F(SpobRec, DeadType, 2, 1) \
+	F(SpobRec, DeadTime, 2, 1) \
+	F(SpobRec, ExplodType, 2, 1) \
+	F(SpobRec, cdata2, 1, 510) \
+	F(SpobRec, SpecialTech4, 2, 1) \
+	F(SpobRec, SpecialTech5, 2, 1) \
+	F(SpobRec, SpecialTech6, 2, 1) \
+	F(SpobRec, SpecialTech7, 2, 1) \
+	F(SpobRec, SpecialTech8, 2, 1) \
+	F(SpobRec, UnusedA, 2, 8)
+
+#define NOVA_SYST_FIELDS(F) \
+	F(SystRec, xPos, 2, 1) \
+	F(SystRec, yPos, 2, 1) \
+	F(SystRec, con, 2, 16) \
+	F(SystRec, nav, 2, 16) \
+	F(SystRec, DudeTypes, 2, 8) \
+	F(SystRec, Probs, 2, 8) \
+	F(SystRec, AvgShips, 2, 1) \
+	F(SystRec, Govt, 2, 1) \
+	F(SystRec, Message, 2, 1) \
+	F(SystRec, Asteroids, 2, 1) \
+	F(SystRec, Interference, 2, 1) \
+	F(SystRec, Person, 2, 8) \
+	F(SystRec, PersonProb, 2, 8) \
+	F(SystRec, BkgndColor, 4, 1) \
+	F(SystRec, Murk, 2, 1) \
+	F(SystRec, AstTypes, 2, 1) \
+	F(SystRec, Visiblility, 1, 256) \
+	F(SystRec, ReinfFleet, 2, 1) \
+	F(SystRec, ReinfTime, 2, 1) \
+	F(SystRec, ReinfIntrval, 2, 1) \
+	F(SystRec, UnusedA, 2, 8)
+
+#define NOVA_WEAP_FIELDS(F) \
+	F(WeapRec, Reload, 2, 1) \
+	F(WeapRec, Count, 2, 1) \
+	F(WeapRec, MassDmg, 2, 1) \
+	F(WeapRec, EnergyDmg, 2, 1) \
+	F(WeapRec, Guidance, 2, 1) \
+	F(WeapRec, Speed, 2, 1) \
+	F(WeapRec, AmmoType, 2, 1) \
+	F(WeapRec, Graphic, 2, 1) \
+	F(WeapRec, Inaccuracy, 2, 1) \
+	F(WeapRec, Sound, 2, 1) \
+	F(WeapRec, Impact, 2, 1) \
+	F(WeapRec, ExplodType, 2, 1) \
+	F(WeapRec, ProxRadius, 2, 1) \
+	F(WeapRec, BlastRadius, 2, 1) \
+	F(WeapRec, Flags, 2, 1) \
+	F(WeapRec, Seeker, 2, 1) \
+	F(WeapRec, SmokeSet, 2, 1) \
+	F(WeapRec, Decay, 2, 1) \
+	F(WeapRec, Particles, 2, 1) \
+	F(WeapRec, PartVel, 2, 1) \
+	F(WeapRec, PartLifeMin, 2, 1) \
+	F(WeapRec, PartLifeMax, 2, 1) \
+	F(WeapRec, PartColor, 4, 1) \
+	F(WeapRec, BeamLength, 2, 1) \
+	F(WeapRec, BeamWidth, 2, 1) \
+	F(WeapRec, Falloff, 2, 1) \
+	F(WeapRec, BeamColor, 4, 1) \
+	F(WeapRec, CoronaColor, 4, 1) \
+	F(WeapRec, SubCount, 2, 1) \
+	F(WeapRec, SubType, 2, 1) \
+	F(WeapRec, SubTheta, 2, 1) \
+	F(WeapRec, SubLimit, 2, 1) \
+	F(WeapRec, ProxSafety, 2, 1) \
+	F(WeapRec, Flags2, 2, 1) \
+	F(WeapRec, Ionization, 2, 1) \
+	F(WeapRec, HitParticles, 2, 1) \
+	F(WeapRec, HitPartLife, 2, 1) \
+	F(WeapRec, HitPartVel, 2, 1) \
+	F(WeapRec, HitPartColor, 4, 1) \
+	F(WeapRec, Recoil, 2, 1) \
+	F(WeapRec, ExitType, 2, 1) \
+	F(WeapRec, BurstCount, 2, 1) \
+	F(WeapRec, BurstReload, 2, 1) \
+	F(WeapRec, JamVuln1, 2, 1) \
+	F(WeapRec, JamVuln2, 2, 1) \
+	F(WeapRec, JamVuln3, 2, 1) \
+	F(WeapRec, JamVuln4, 2, 1) \
+	F(WeapRec, Flags3, 2, 1) \
+	F(WeapRec, Durability, 2, 1) \
+	F(WeapRec, GuidedTurn, 2, 1) \
+	F(WeapRec, MaxAmmo, 2, 1) \
+	F(WeapRec, LiDensity, 2, 1) \
+	F(WeapRec, LiAmplitude, 2, 1) \
+	F(WeapRec, IonizeColor, 4, 1) \
+	F(WeapRec, UnusedA, 2, 8)
+
+#define NOVA_YEAR_FIELDS(F) \
+	F(YearRec, Day, 2, 1) \
+	F(YearRec, Month, 2, 1) \
+	F(YearRec, Year, 2, 1) \
+	F(YearRec, Prefix, 1, 16) \
+	F(YearRec, Suffix, 1, 15)
+
+NOVA_RECORD(BoomRec, NOVA_BOOM_FIELDS,	6)
+NOVA_RECORD(CharRec, NOVA_CHAR_FIELDS,	362)
+NOVA_RECORD(ColrRec, NOVA_COLR_FIELDS,	244)
+NOVA_RECORD(CronRec, NOVA_CRON_FIELDS,	822)
+NOVA_RECORD(DescCodaRec, NOVA_DESCCODA_FIELDS,	36)
+NOVA_RECORD(DeqtRec, NOVA_DEQT_FIELDS,	2)
+NOVA_RECORD(DudeRec, NOVA_DUDE_FIELDS,	88)
+NOVA_RECORD(FletRec, NOVA_FLET_FIELDS,	306)
+NOVA_RECORD(IntfRec, NOVA_INTF_FIELDS,	166)
+NOVA_RECORD(JunkRec, NOVA_JUNK_FIELDS,	676)
+NOVA_RECORD(GovtRec, NOVA_GOVT_FIELDS,	192)
+NOVA_RECORD(MisnRec, NOVA_MISN_FIELDS,	1970)
+NOVA_RECORD(NebuRec, NOVA_NEBU_FIELDS,	534)
+NOVA_RECORD(OopsRec, NOVA_OOPS_FIELDS,	282)
+NOVA_RECORD(OutfRec, NOVA_OUTF_FIELDS,	1028)
+NOVA_RECORD(PersRec, NOVA_PERS_FIELDS,	400)
+NOVA_RECORD(RankRec, NOVA_RANK_FIELDS,	152)
+NOVA_RECORD(RoidRec, NOVA_ROID_FIELDS,	40)
+NOVA_RECORD(ShanRec, NOVA_SHAN_FIELDS,	192)
+NOVA_RECORD(ShipRec, NOVA_SHIP_FIELDS,	1860)
+NOVA_RECORD(SpinRec, NOVA_SPIN_FIELDS,	12)
+NOVA_RECORD(SpobRec, NOVA_SPOB_FIELDS,	1118)
+NOVA_RECORD(SystRec, NOVA_SYST_FIELDS,	428)
+NOVA_RECORD(WeapRec, NOVA_WEAP_FIELDS,	134)
+NOVA_RECORD(YearRec, NOVA_YEAR_FIELDS,	37)
+
+/*** CONVERSION ***/
+
+// written as plain loops over whole arrays so the compiler can vectorise them; the shifts make them endian-neutral
+static void NovaCopyFromBig(void *native, const UInt8 *bytes, UInt32 width, UInt32 count)
+{
+	UInt32 i;
+	if(width == 2)
+	{
+		UInt16 *values = (UInt16 *) native;
+		for(i = 0; i < count; i++)
+			values[i] = (UInt16) ((bytes[2*i] << 8) | bytes[2*i+1]);
+	}
+	else if(width == 4)
+	{
+		UInt32 *values = (UInt32 *) native;
+		for(i = 0; i < count; i++)
+			values[i] = ((UInt32) bytes[4*i] << 24) | ((UInt32) bytes[4*i+1] << 16) | ((UInt32) bytes[4*i+2] << 8) | bytes[4*i+3];
+	}
+	else memcpy(native, bytes, count);
+}
+
+static void NovaCopyToBig(UInt8 *bytes, const void *native, UInt32 width, UInt32 count)
+{
+	UInt32 i;
+	if(width == 2)
+	{
+		const UInt16 *values = (const UInt16 *) native;
+		for(i = 0; i < count; i++)
+		{
+			bytes[2*i]   = (UInt8) (values[i] >> 8);
+			bytes[2*i+1] = (UInt8) values[i];
+		}
+	}
+	else if(width == 4)
+	{
+		const UInt32 *values = (const UInt32 *) native;
+		for(i = 0; i < count; i++)
+		{
+			bytes[4*i]   = (UInt8) (values[i] >> 24);
+			bytes[4*i+1] = (UInt8) (values[i] >> 16);
+			bytes[4*i+2] = (UInt8) (values[i] >> 8);
+			bytes[4*i+3] = (UInt8) values[i];
+		}
+	}
+	else memcpy(bytes, native, count);
+}
+
+Boolean NovaDecodeRecord(const NovaRecord *record, const void *bytes, UInt32 length, void *native)
+{
+	UInt32 i, offset = 0;
+	memset(native, 0, record->nativeSize);
+	for(i = 0; i < record->fieldCount; i++)
+	{
+		const NovaField *field = &record->fields[i];
+		UInt32 size = field->width * field->count;
+		if(field->width > 1) offset = (offset + 1) & ~1UL;		// mac68k alignment
+		if(offset + size > length) return false;
+		NovaCopyFromBig((UInt8 *) native + field->offset, (const UInt8 *) bytes + offset, field->width, field->count);
+		offset += size;
+	}
+	return true;
+}
+
+void NovaEncodeRecord(const NovaRecord *record, const void *native, void *bytes)
+{
+	UInt32 i, offset = 0;
+	memset(bytes, 0, record->diskSize);
+	for(i = 0; i < record->fieldCount; i++)
+	{
+		const NovaField *field = &record->fields[i];
+		if(field->width > 1) offset = (offset + 1) & ~1UL;
+		NovaCopyToBig((UInt8 *) bytes + offset, (const UInt8 *) native + field->offset, field->width, field->count);
+		offset += field->width * field->count;
+	}
+}
+
+UInt32 NovaDecodeRecords(const NovaRecord *record, const void *const *bytes, const UInt32 *lengths, UInt32 count, void *natives)
+{
+	UInt32 i, complete = 0;
+	for(i = 0; i < count; i++)
+		if(NovaDecodeRecord(record, bytes[i], lengths[i], (UInt8 *) natives + i * record->nativeSize))
+			complete++;
+	return complete;
+}
+
+UInt32 NovaDiskOffset(const NovaRecord *record, UInt32 nativeOffset)
+{
+	UInt32 i, offset = 0;
+	for(i = 0; i < record->fieldCount; i++)
+	{
+		const NovaField *field = &record->fields[i];
+		UInt32 size = field->width * field->count;
+		if(field->width > 1) offset = (offset + 1) & ~1UL;
+		if(nativeOffset >= field->offset && nativeOffset < field->offset + size)
+			return offset + (nativeOffset - field->offset);
+		offset += size;
+	}
+	return record->diskSize;
+}
@@ -0,0 +1,70 @@
+/* Nova Resource codec */
+
+/*	Converts between the big-endian bytes of a Nova resource and the structures in Structs.h, without relying on
+	the compiler laying those structures out the way the resource is (#pragma options align=mac68k only exists
+	in Apple's and Metrowerks' compilers) or on the host being big-endian.
+	
+	Each record is described by a table of its fields in on-disk order, generated from a field list in NovaCodec.c
+	which is checked field by field against Structs.h when it is compiled. Decoding walks the table, copying each
+	field (or array of fields) to its offset in the native structure with a byte-swap loop. NovaCodec.c includes
+	only Structs.h and standard headers, so it can be built and checked with any C compiler; NovaCodecTest.c in
+	the Tests folder does so. */
+
+#ifndef NOVA_CODEC_H
+#define NOVA_CODEC_H
+
+#include "Structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct NovaField
+{
+	UInt32	offset;		// in the native structure
+	UInt16	width;		// of one element in bytes: 1 (never swapped), 2 or 4
+	UInt16	count;		// of elements, for arrays
+} NovaField;
+
+typedef struct NovaRecord
+{
+	const char			*name;
+	UInt32				diskSize;		// bytes in the resource
+	UInt32				nativeSize;		// sizeof() the structure
+	UInt32				fieldCount;
+	const NovaField		*fields;
+} NovaRecord;
+
+extern const NovaRecord kNovaBoomRec, kNovaCharRec, kNovaColrRec, kNovaCronRec, kNovaDescCodaRec, kNovaDeqtRec, kNovaDudeRec,
+	kNovaFletRec, kNovaIntfRec, kNovaJunkRec, kNovaGovtRec, kNovaMisnRec, kNovaNebuRec, kNovaOopsRec, kNovaOutfRec, kNovaPersRec,
+	kNovaRankRec, kNovaRoidRec, kNovaShanRec, kNovaShipRec, kNovaSpinRec, kNovaSpobRec, kNovaSystRec, kNovaWeapRec, kNovaYearRec;
+
+/*!
+@function	NovaDecodeRecord
+@abstract	Fills native from a resource's bytes. Fields beyond the end of the data are zeroed; returns false if there were any.
+*/
+Boolean NovaDecodeRecord(const NovaRecord *record, const void *bytes, UInt32 length, void *native);
+
+/*!
+@function	NovaEncodeRecord
+@abstract	Writes record->diskSize bytes of resource data from native.
+*/
+void NovaEncodeRecord(const NovaRecord *record, const void *native, void *bytes);
+
+/*!
+@function	NovaDiskOffset
+@abstract	Converts an offset within the native structure (e.g. offsetof(SystRec, nav)) to the offset of the same bytes in the resource.
+*/
+UInt32 NovaDiskOffset(const NovaRecord *record, UInt32 nativeOffset);
+
+/*!
+@function	NovaDecodeRecords
+@abstract	Decodes count resources into an array of native structures (record->nativeSize apart). Returns how many were complete.
+*/
+UInt32 NovaDecodeRecords(const NovaRecord *record, const void *const *bytes, const UInt32 *lengths, UInt32 count, void *natives);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
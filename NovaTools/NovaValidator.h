@@ -0,0 +1,43 @@
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+
+/*	Checks every Nova resource in a document against the rules in NovaValidator.m (the same ones the editors use in
+	-validateValues), for references to resources the document doesn't have (from ReferenceGraph), and for control
+	bit expressions which don't compile or can never pass (from ControlBitIndex). The rule checks are plain C over
+	each resource's data and run on as many threads as there are processors, while the main thread carries on. What
+	each resource broke is kept with the data it was checked against, so asking again only rechecks resources given
+	new data. */
+
+@interface NovaValidator : NSObject
+{
+	NSDocument *document;			// not retained; validators are dropped once their document has closed
+	NSMutableDictionary *checked;	// non-retained resource -> [data checked, NSNumber of rules broken]
+	const void **jobBytes;			// the resources being checked by -checkThread:, and their results
+	UInt32 *jobLengths;
+	unsigned *jobRecords;
+	UInt32 *jobResults;
+	unsigned jobCount;
+	unsigned threadCount;
+	NSConditionLock *lock;			// condition is the number of threads which have finished; nil unless checking
+	NSArray *jobResources;			// what the threads are checking, and the data they are checking it against
+	NSArray *jobData;
+	NSArray *reportResources;		// every resource in the document when the check began
+	NSMutableDictionary *pending;	// results to go into checked once the threads are done
+	NSDate *started;
+	NSMutableArray *waiting;		// [target, selector name] pairs to be sent the report
+	unsigned lastCount;				// resources in the document, and how many of them needed checking, last time
+	unsigned lastChecked;
+}
+
++ (NovaValidator *)validatorForDocument:(NSDocument *)document;
++ (NSDictionary *)problemsWithData:(NSData *)data ofType:(NSString *)type;	// field label -> message, as -validateValues returns
+
+/*!
+@method		reportTo:selector:
+@abstract	Starts checking the document and returns at once; target is sent selector with the report (an NSString of the
+			problems and how long finding them took) on the main thread when the threads are done. Nothing is sent if the
+			document closes first. A request made while a check is running is answered when that check is done.
+*/
+- (void)reportTo:(id)target selector:(SEL)selector;
+
+@end
@@ -0,0 +1,388 @@
+#import "NovaValidator.h"
+#import "ReferenceGraph.h"
+#import "ControlBitIndex.h"
+#import "Structs.h"
+#import "NovaCodec.h"
+#import <CoreServices/CoreServices.h>	// for MPProcessorsScheduled()
+#include <stddef.h>
+
+/* Ranges each field must be in. Every element of an array must pass, with alternative allowed as well (e.g. -1 for
+	unused entries). Rules are grouped by type, at most 31 to a type; bit 31 of a result means the data is short. */
+
+typedef struct NovaRule
+{
+	const NovaRecord	*record;
+	UInt32				offset;		// of the field in the structure
+	UInt16				width;		// of one element: 2 or 4
+	UInt16				count;		// of elements
+	const char			*label;		// as the editor shows it
+	SInt32				minimum;
+	SInt32				maximum;
+	SInt32				alternative;
+	const char			*message;
+} NovaRule;
+
+#define RULE_OR(rec, field, count, label, minimum, maximum, alternative, message) \
+	{ &kNova##rec, offsetof(rec, field), sizeof(((rec *)0)->field) / (count), count, label, minimum, maximum, alternative, message }
+#define RULE(rec, field, count, label, minimum, maximum, message)	RULE_OR(rec, field, count, label, minimum, maximum, minimum, message)
+
+static const NovaRule gRules[] =
+{
+	RULE(BoomRec, GraphicIndex, 1, "Graphics", 0, 63, "must match a spin resource with ID between 400 and 463."),
+	RULE(BoomRec, SoundIndex, 1, "Sound", -1, 63, "must match a sound resource with ID between 300 and 363."),
+	RULE(BoomRec, FrameAdvance, 1, "Frame Advance", 1, 1000, "cannot be below 0% or above 1000%."),
+	RULE(CharRec, startDay, 1, "Start Day", 1, 31, "must be between 1 and 31."),
+	RULE(CharRec, startMonth, 1, "Start Month", 1, 12, "must be between 1 and 12."),
+	RULE(CharRec, startYear, 1, "Start Year", 1, 32767, "must be above zero."),
+	RULE_OR(CharRec, introPictDelay, 4, "Intro Picture Delays", 1, 300, -1, "valid delays are 1 to 300 seconds, or -1 for unused values."),
+	RULE(CronRec, Random, 1, "Random", 0, 100, "is a percentage, between 0 and 100."),
+	RULE(DudeRec, Probs, 16, "Probabilities", 0, 100, "are percentages, between 0 and 100."),
+	RULE(MisnRec, AvailRandom, 1, "Available Random", 0, 100, "is a percentage, between 0 and 100."),
+	RULE(PersRec, Aggress, 1, "Aggression", 1, 3, "must be between 1 and 3."),
+	RULE(PersRec, Coward, 1, "Cowardice", 0, 100, "is a percentage of shields, between 0 and 100."),
+	RULE(PersRec, GrantProb, 1, "Grant Probability", 0, 100, "is a percentage, between 0 and 100.")
+};
+
+// every type with a fixed-size record is checked, if only for its length
+static const struct { const char *type; const NovaRecord *record; } gRecords[] =
+{
+	{ "boom", &kNovaBoomRec },	{ "char", &kNovaCharRec },	{ "colr", &kNovaColrRec },	{ "cron", &kNovaCronRec },
+	{ "dude", &kNovaDudeRec },	{ "flet", &kNovaFletRec },	{ "govt", &kNovaGovtRec },	{ "intf", &kNovaIntfRec },
+	{ "junk", &kNovaJunkRec },	{ "misn", &kNovaMisnRec },	{ "nebu", &kNovaNebuRec },	{ "oops", &kNovaOopsRec },
+	{ "ouft", &kNovaOutfRec },	{ "pers", &kNovaPersRec },	{ "rank", &kNovaRankRec },	{ "roid", &kNovaRoidRec },
+	{ "shan", &kNovaShanRec },	{ "ship", &kNovaShipRec },	{ "spin", &kNovaSpinRec },	{ "spob", &kNovaSpobRec },
+	{ "syst", &kNovaSystRec },	{ "weap", &kNovaWeapRec },	{ "year", &kNovaYearRec }
+};
+
+#define kRuleCount		(sizeof(gRules) / sizeof(gRules[0]))
+#define kRecordCount	(sizeof(gRecords) / sizeof(gRecords[0]))
+#define kShortData		(1UL << 31)
+
+static unsigned gFirstRule[kRecordCount], gRuleCount[kRecordCount];
+static UInt32 gLargestRecord = 0;				// nativeSize, for each thread's decoding buffer
+static NSDictionary *gRecordIndexes = nil;		// type -> NSNumber index into gRecords
+static NSMutableDictionary *gValidators = nil;	// non-retained document -> NovaValidator
+
+static NSString *TypeName(const char *key)
+{
+	return [[NSBundle bundleForClass:[NovaValidator class]] localizedStringForKey:[NSString stringWithUTF8String:key] value:@"" table:@"Resource Types"];
+}
+
+// thread safe: only reads the tables and writes to native, which must hold gLargestRecord bytes
+static UInt32 BrokenRules(unsigned recordIndex, const void *bytes, UInt32 length, void *native)
+{
+	UInt32 broken = 0;
+	unsigned i, j;
+	// the fields past the end of short data are zero-filled, so their ranges mean nothing
+	if( !NovaDecodeRecord( gRecords[recordIndex].record, bytes, length, native ) )
+		return kShortData;
+	for( i = 0; i < gRuleCount[recordIndex]; i++ )
+	{
+		const NovaRule *rule = &gRules[gFirstRule[recordIndex] + i];
+		for( j = 0; j < rule->count; j++ )
+		{
+			const char *field = (const char *) native + rule->offset + j * rule->width;
+			SInt32 value = (rule->width == 4)? *(const SInt32 *) field : *(const SInt16 *) field;
+			if( (value < rule->minimum || value > rule->maximum) && value != rule->alternative )
+			{
+				broken |= 1UL << i;
+				break;
+			}
+		}
+	}
+	return broken;
+}
+
+@interface NovaValidator (Private)
+- (id)initWithDocument:(NSDocument *)newDocument;
+- (void)documentWillClose;
+- (void)beginChecking;
+- (void)checkThread:(NSNumber *)firstIndex;
+- (void)finishChecking;
+- (NSArray *)problemsOfResources:(NSArray *)resources;
+- (NSString *)reportOfProblems:(NSArray *)problems;
+@end
+
+@implementation NovaValidator
+
++ (void)initialize
+{
+	unsigned i, j;
+	NSMutableDictionary *indexes;
+	if( self != [NovaValidator class] ) return;
+	indexes = [NSMutableDictionary dictionary];
+	for( i = 0; i < kRecordCount; i++ )
+	{
+		gFirstRule[i] = kRuleCount;
+		for( j = 0; j < kRuleCount; j++ )
+			if( gRules[j].record == gRecords[i].record )
+			{
+				if( gFirstRule[i] == kRuleCount ) gFirstRule[i] = j;
+				gRuleCount[i]++;
+			}
+		if( gRecords[i].record->nativeSize > gLargestRecord )
+			gLargestRecord = gRecords[i].record->nativeSize;
+		[indexes setObject:[NSNumber numberWithUnsignedInt:i] forKey:TypeName(gRecords[i].type)];
+	}
+	gRecordIndexes = [indexes copy];
+	gValidators = [[NSMutableDictionary alloc] init];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(documentWillClose:) name:DocumentWillCloseNotification object:nil];
+}
+
+// dropped as the document goes, so a new document at the same address doesn't get its results
++ (void)documentWillClose:(NSNotification *)notification
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:[notification object]];
+	[[gValidators objectForKey:key] documentWillClose];
+	[gValidators removeObjectForKey:key];
+}
+
++ (NovaValidator *)validatorForDocument:(NSDocument *)document
+{
+	NovaValidator *validator;
+	NSValue *key = [NSValue valueWithNonretainedObject:document];
+	validator = [gValidators objectForKey:key];
+	if( !validator )
+	{
+		validator = [[[NovaValidator alloc] initWithDocument:document] autorelease];
+		[gValidators setObject:validator forKey:key];
+	}
+	return validator;
+}
+
++ (NSDictionary *)problemsWithData:(NSData *)data ofType:(NSString *)type
+{
+	unsigned i, recordIndex;
+	UInt32 broken;
+	void *native;
+	NSMutableDictionary *problems = [NSMutableDictionary dictionary];
+	NSNumber *index = [gRecordIndexes objectForKey:type];
+	if( !index ) return problems;
+
+	recordIndex = [index unsignedIntValue];
+	native = malloc( gLargestRecord );
+	broken = BrokenRules( recordIndex, [data bytes], [data length], native );
+	free( native );
+	for( i = 0; i < gRuleCount[recordIndex]; i++ )
+		if( broken & (1UL << i) )
+			[problems setObject:[NSString stringWithUTF8String:gRules[gFirstRule[recordIndex] + i].message] forKey:[NSString stringWithUTF8String:gRules[gFirstRule[recordIndex] + i].label]];
+	if( broken & kShortData )
+		[problems setObject:[NSString stringWithFormat:@"is %u bytes, but should be %lu.", [data length], gRecords[recordIndex].record->diskSize] forKey:@"Length"];
+	return problems;
+}
+
+- (id)initWithDocument:(NSDocument *)newDocument
+{
+	self = [super init];
+	if( !self ) return nil;
+	document = newDocument;
+	checked = [[NSMutableDictionary alloc] init];
+	waiting = [[NSMutableArray alloc] init];
+	return self;
+}
+
+- (void)dealloc
+{
+	[checked release];
+	[waiting release];
+	[super dealloc];
+}
+
+// a running check keeps the validator alive until its threads are done, but mustn't report on a closed document
+- (void)documentWillClose
+{
+	document = nil;
+}
+
+#pragma mark -
+
+- (void)reportTo:(id)target selector:(SEL)selector
+{
+	if( !document ) return;
+	[waiting addObject:[NSArray arrayWithObjects:target, NSStringFromSelector(selector), nil]];
+	if( [waiting count] == 1 )
+		[self beginChecking];
+}
+
+/* As in the template editor's TemplateScan, each thread takes every threadCount'th resource. The resources are
+	only touched on the main thread; the others see their bytes, which jobData keeps alive. The last thread to
+	finish hands back to the main thread in -finishChecking. */
+- (void)beginChecking
+{
+	unsigned i;
+	NSMutableArray *resources = [NSMutableArray array];
+	NSMutableArray *stale = [NSMutableArray array];
+	NSMutableArray *dataArray = [NSMutableArray array];
+	id <ResKnifeResourceProtocol> resource;
+	NSEnumerator *enumerator;
+
+	started = [[NSDate alloc] init];
+	pending = [[NSMutableDictionary alloc] init];
+
+	// keep what was found for resources whose data hasn't changed; anything no longer in the document is forgotten
+	for( i = 0; i < kRecordCount; i++ )
+	{
+		enumerator = [[NSClassFromString(@"Resource") allResourcesOfType:TypeName(gRecords[i].type) inDocument:document] objectEnumerator];
+		while( resource = [enumerator nextObject] )
+		{
+			NSValue *key = [NSValue valueWithNonretainedObject:resource];
+			NSArray *entry = [checked objectForKey:key];
+			[resources addObject:resource];
+			if( entry && [entry objectAtIndex:0] == [resource data] )
+				[pending setObject:entry forKey:key];
+			else [stale addObject:resource];
+		}
+	}
+	reportResources = [resources copy];
+	jobResources = [stale copy];
+	jobCount = [stale count];
+	if( jobCount == 0 )
+	{
+		[self performSelectorOnMainThread:@selector(finishChecking) withObject:nil waitUntilDone:NO];
+		return;
+	}
+
+	jobBytes = (const void **) calloc( jobCount, sizeof(void *) );
+	jobLengths = (UInt32 *) calloc( jobCount, sizeof(UInt32) );
+	jobRecords = (unsigned *) calloc( jobCount, sizeof(unsigned) );
+	jobResults = (UInt32 *) calloc( jobCount, sizeof(UInt32) );
+	for( i = 0; i < jobCount; i++ )
+	{
+		NSData *data;
+		resource = [stale objectAtIndex:i];
+		data = [resource data];
+		[dataArray addObject:data? data : [NSData data]];
+		jobBytes[i] = [[dataArray lastObject] bytes];
+		jobLengths[i] = [[dataArray lastObject] length];
+		jobRecords[i] = [[gRecordIndexes objectForKey:[resource type]] unsignedIntValue];
+	}
+	jobData = [dataArray copy];
+
+	threadCount = MPProcessorsScheduled();
+	if( threadCount < 1 ) threadCount = 1;
+	if( threadCount > jobCount ) threadCount = jobCount;
+	lock = [[NSConditionLock alloc] initWithCondition:0];
+	for( i = 0; i < threadCount; i++ )
+		[NSThread detachNewThreadSelector:@selector(checkThread:) toTarget:self withObject:[NSNumber numberWithUnsignedInt:i]];
+}
+
+- (void)checkThread:(NSNumber *)firstIndex
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+	unsigned i, finished;
+	void *native = malloc( gLargestRecord );
+	for( i = [firstIndex unsignedIntValue]; i < jobCount; i += threadCount )
+		jobResults[i] = BrokenRules( jobRecords[i], jobBytes[i], jobLengths[i], native );
+	free( native );
+
+	[lock lock];
+	finished = [lock condition] + 1;
+	[lock unlockWithCondition:finished];
+	if( finished == threadCount )
+		[self performSelectorOnMainThread:@selector(finishChecking) withObject:nil waitUntilDone:NO];
+	[pool release];
+}
+
+- (void)finishChecking
+{
+	unsigned i;
+	NSString *report = nil;
+	NSArray *requests = [[waiting copy] autorelease];
+	NSEnumerator *enumerator;
+	NSArray *request;
+
+	for( i = 0; i < jobCount; i++ )
+		[pending setObject:[NSArray arrayWithObjects:[jobData objectAtIndex:i], [NSNumber numberWithUnsignedLong:jobResults[i]], nil] forKey:[NSValue valueWithNonretainedObject:[jobResources objectAtIndex:i]]];
+	if( jobCount )
+	{
+		free( jobBytes );
+		free( jobLengths );
+		free( jobRecords );
+		free( jobResults );
+	}
+	jobCount = 0;
+	[lock release];
+	lock = nil;
+	[checked setDictionary:pending];
+	lastChecked = [jobResources count];
+	lastCount = [reportResources count];
+
+	if( document )
+		report = [self reportOfProblems:[self problemsOfResources:reportResources]];
+	[pending release];
+	[jobResources release];
+	[jobData release];
+	[reportResources release];
+	[started release];
+	pending = nil;
+	jobResources = jobData = reportResources = nil;
+	started = nil;
+
+	// requests made from here on start a new check
+	[waiting removeAllObjects];
+	if( !report ) return;
+	enumerator = [requests objectEnumerator];
+	while( request = [enumerator nextObject] )
+		[[request objectAtIndex:0] performSelector:NSSelectorFromString( [request objectAtIndex:1] ) withObject:report];
+}
+
+- (NSArray *)problemsOfResources:(NSArray *)resources
+{
+	unsigned i;
+	NSMutableArray *problems = [NSMutableArray array];
+	id <ResKnifeResourceProtocol> resource;
+	NSEnumerator *enumerator = [resources objectEnumerator];
+	ReferenceLink *link;
+
+	while( resource = [enumerator nextObject] )
+	{
+		UInt32 broken = [[[checked objectForKey:[NSValue valueWithNonretainedObject:resource]] objectAtIndex:1] unsignedLongValue];
+		unsigned recordIndex = [[gRecordIndexes objectForKey:[resource type]] unsignedIntValue];
+		if( !broken ) continue;
+		if( broken & kShortData )
+			[problems addObject:[NSDictionary dictionaryWithObjectsAndKeys:resource, @"Resource", @"Length", @"Field",
+				[NSString stringWithFormat:@"is %u bytes, but should be %lu.", [[resource data] length], gRecords[recordIndex].record->diskSize], @"Message", nil]];
+		for( i = 0; i < gRuleCount[recordIndex]; i++ )
+			if( broken & (1UL << i) )
+			{
+				const NovaRule *rule = &gRules[gFirstRule[recordIndex] + i];
+				[problems addObject:[NSDictionary dictionaryWithObjectsAndKeys:resource, @"Resource", [NSString stringWithUTF8String:rule->label], @"Field",
+					[NSString stringWithUTF8String:rule->message], @"Message", nil]];
+			}
+	}
+
+	enumerator = [[[ReferenceGraph sharedGraph] danglingReferencesInDocument:document] objectEnumerator];
+	while( link = [enumerator nextObject] )
+		[problems addObject:[NSDictionary dictionaryWithObjectsAndKeys:[link source], @"Resource", [link fieldName], @"Field",
+			[NSString stringWithFormat:@"refers to '%@' %@, which isn't in the document.", [link targetType], [link targetID]], @"Message", nil]];
+
+	// control bits
+	[problems addObjectsFromArray:[[ControlBitIndex indexForDocument:document] syntaxErrors]];
+	enumerator = [[[ControlBitIndex indexForDocument:document] unreachableResources] objectEnumerator];
+	while( resource = [enumerator nextObject] )
+		[problems addObject:[NSDictionary dictionaryWithObjectsAndKeys:resource, @"Resource", @"Availability", @"Field",
+			@"can never pass its control bit test, as nothing can set the bits it needs.", @"Message", nil]];
+	return problems;
+}
+
+- (NSString *)reportOfProblems:(NSArray *)problems
+{
+	NSMutableString *report = [NSMutableString string];
+	NSDictionary *problem;
+	NSEnumerator *enumerator = [problems objectEnumerator];
+	NSString *timing = [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"%u resources, %u of them changed since last time, checked in %.3f seconds.", nil, [NSBundle bundleForClass:[NovaValidator class]], nil),
+		lastCount, lastChecked, -[started timeIntervalSinceNow]];
+	if( [problems count] == 0 )
+		return [NSString stringWithFormat:@"%@\n\n%@", NSLocalizedStringFromTableInBundle(@"No problems were found.", nil, [NSBundle bundleForClass:[NovaValidator class]], nil), timing];
+
+	while( problem = [enumerator nextObject] )
+	{
+		id <ResKnifeResourceProtocol> resource = [problem objectForKey:@"Resource"];
+		[report appendFormat:@"'%@' %@ \"%@\": %@ %@\n", [resource type], [resource resID], [resource name], [problem objectForKey:@"Field"], [problem objectForKey:@"Message"]];
+	}
+	[report appendFormat:NSLocalizedStringFromTableInBundle(@"\n%u problems found.\n", nil, [NSBundle bundleForClass:[NovaValidator class]], nil), [problems count]];
+	[report appendFormat:@"%@\n", timing];
+	return report;
+}
+
+@end
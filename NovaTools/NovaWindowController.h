@@ -1,6 +1,7 @@
 #import <Cocoa/Cocoa.h>
 #import <Carbon/Carbon.h>
 #import "Structs.h"
+#import "NovaCodec.h"
 #import "DataSource.h"
 
 #import "ResKnifePluginProtocol.h"
@@ -22,11 +23,20 @@
 	DataSource *shipDataSource;
 	DataSource *soundDataSource;
 	DataSource *spinDataSource;
+	
+	NSPanel *renumberSheet;			// built in code, while it's up
+	NSTextField *renumberField;
 }
 
++ (NSData *)dataWithRecord:(const void *)native format:(const NovaRecord *)format;	// big-endian resource data for one of the structures in Structs.h
 - (void)setResource:(id <ResKnifeResourceProtocol>)newResource;
 - (void)setUndoManager:(NSUndoManager *)newUndoManager;
 - (IBAction)toggleResID:(id)sender;
+- (IBAction)validatePlugIn:(id)sender;
+- (IBAction)showTextSearch:(id)sender;
+- (IBAction)showReferences:(id)sender;
+- (IBAction)showRenumberSheet:(id)sender;
+- (IBAction)endRenumberSheet:(id)sender;
 
 - (void)resourceNameDidChange:(NSNotification *)notification;
 - (void)saveSheetDidClose:(NSWindow *)sheet returnCode:(int)returnCode contextInfo:(void *)contextInfo;
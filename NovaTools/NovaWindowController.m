@@ -6,6 +6,21 @@
 #import "DescWindowController.h"
 #import "MisnWindowController.h"
 #import "ShipWindowController.h"
+#import "SystWindowController.h"
+#import "NovaValidator.h"
+#import "ReferenceGraph.h"
+#import "TextSearchWindowController.h"
+
+enum
+{
+	kNovaMenuItemTag = 'Nova',		// on the items we add to the Resource menu, so they can be taken out again
+	kMaxReferencesShown = 30
+};
+
+@interface NovaWindowController (Private)
+- (NSString *)descriptionOfResourceOfType:(NSString *)type resID:(NSNumber *)resID;
+- (void)showValidationReport:(NSString *)report;
+@end
 
 @implementation NovaWindowController
 
@@ -42,18 +57,31 @@
 {
 //	[localCenter release];
 	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[renumberSheet release];
 	[(id)resource autorelease];
 	[undoManager release];
+	[descriptionDataSource release];
+	[governmentDataSource release];
+	[pictureDataSource release];
+	[planetDataSource release];
 	[shipDataSource release];
 	[soundDataSource release];
+	[spinDataSource release];
 	[super dealloc];
 }
 
++ (NSData *)dataWithRecord:(const void *)native format:(const NovaRecord *)format
+{
+	NSMutableData *data = [NSMutableData dataWithLength:format->diskSize];
+	NovaEncodeRecord( format, native, [data mutableBytes] );
+	return data;
+}
+
 - (void)windowDidLoad
 {
 	[super windowDidLoad];
 	
-	// create the data sources (here because this is called just before they are applied to the combo boxes)
+	// create the data sources (here because this is called just before they are applied to the combo boxes); the names behind them are shared between editors, see ResourceCatalog
 	descriptionDataSource = [[DataSource alloc] initForType:[plugBundle localizedStringForKey:@"desc" value:@"" table:@"Resource Types"]];
 	governmentDataSource = [[DataSource alloc] initForType:[plugBundle localizedStringForKey:@"govt" value:@"" table:@"Resource Types"]];
 	pictureDataSource = [[DataSource alloc] initForType:[plugBundle localizedStringForKey:@"PICT" value:@"" table:@"Resource Types"]];
@@ -68,6 +96,31 @@
 //	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:resource];
 }
 
+- (void)windowDidBecomeKey:(NSNotification *)notification
+{
+	unsigned i;
+	NSMenu *resourceMenu = [[[NSApp mainMenu] itemAtIndex:3] submenu];
+	NSString *titles[] = { @"Show References", @"Renumber...", @"Check Plug-in", @"Find in Descriptions..." };
+	SEL actions[] = { @selector(showReferences:), @selector(showRenumberSheet:), @selector(validatePlugIn:), @selector(showTextSearch:) };
+	if( [resourceMenu indexOfItemWithTag:kNovaMenuItemTag] != -1 ) return;
+	
+	[resourceMenu addItem:[NSMenuItem separatorItem]];
+	[[resourceMenu itemAtIndex:[resourceMenu numberOfItems] -1] setTag:kNovaMenuItemTag];
+	for( i = 0; i < sizeof(actions) / sizeof(SEL); i++ )
+	{
+		NSMenuItem *item = [resourceMenu addItemWithTitle:NSLocalizedStringFromTableInBundle(titles[i], nil, plugBundle, nil) action:actions[i] keyEquivalent:@""];
+		[item setTag:kNovaMenuItemTag];
+	}
+}
+
+- (void)windowDidResignKey:(NSNotification *)notification
+{
+	int index;
+	NSMenu *resourceMenu = [[[NSApp mainMenu] itemAtIndex:3] submenu];
+	while( (index = [resourceMenu indexOfItemWithTag:kNovaMenuItemTag]) != -1 )
+		[resourceMenu removeItemAtIndex:index];
+}
+
 - (NSUndoManager *)windowWillReturnUndoManager:(NSWindow *)sender
 {
 	return undoManager;
@@ -127,6 +180,112 @@
 	NSLog( @"%@", [resource type] );
 }
 
+/* Checks every Nova resource in the document this one is in, reporting all the problems at once when the check is done. */
+- (IBAction)validatePlugIn:(id)sender
+{
+	[[NovaValidator validatorForDocument:[resource document]] reportTo:self selector:@selector(showValidationReport:)];
+}
+
+- (void)showValidationReport:(NSString *)report
+{
+	if( ![[self window] isVisible] || [[self window] attachedSheet] ) return;
+	NSBeginInformationalAlertSheet( NSLocalizedStringFromTableInBundle(@"Checking the plug-in", nil, plugBundle, nil), nil, nil, nil, [self window], nil, NULL, NULL, NULL, @"%@", report );
+}
+
+- (IBAction)showTextSearch:(id)sender
+{
+	[[TextSearchWindowController sharedController] showWindow:sender];
+}
+
+/* Lists what this resource refers to and what refers to it, both straight from the ReferenceGraph. */
+- (IBAction)showReferences:(id)sender
+{
+	ReferenceLink *link;
+	NSEnumerator *enumerator;
+	NSArray *uses = [[ReferenceGraph sharedGraph] referencesFromResource:resource];
+	NSArray *usedBy = [[ReferenceGraph sharedGraph] referencesToResource:resource];
+	NSMutableString *report = [NSMutableString string];
+	unsigned shown = 0;
+	
+	[report appendFormat:NSLocalizedStringFromTableInBundle(@"Uses %u:\n", nil, plugBundle, nil), [uses count]];
+	enumerator = [uses objectEnumerator];
+	while( (link = [enumerator nextObject]) && shown++ < kMaxReferencesShown )
+		[report appendFormat:@"%@: %@\n", [link fieldName], [self descriptionOfResourceOfType:[link targetType] resID:[link targetID]]];
+	[report appendFormat:NSLocalizedStringFromTableInBundle(@"\nUsed by %u:\n", nil, plugBundle, nil), [usedBy count]];
+	enumerator = [usedBy objectEnumerator];
+	shown = 0;
+	while( (link = [enumerator nextObject]) && shown++ < kMaxReferencesShown )
+		[report appendFormat:@"%@ (%@)\n", [self descriptionOfResourceOfType:[[link source] type] resID:[[link source] resID]], [link fieldName]];
+	if( [uses count] > kMaxReferencesShown || [usedBy count] > kMaxReferencesShown )
+		[report appendString:NSLocalizedStringFromTableInBundle(@"\nOnly the first of each are listed.", nil, plugBundle, nil)];
+	NSBeginInformationalAlertSheet( NSLocalizedStringFromTableInBundle(@"References", nil, plugBundle, nil), nil, nil, nil, [self window], nil, NULL, NULL, NULL, @"%@", report );
+}
+
+- (NSString *)descriptionOfResourceOfType:(NSString *)type resID:(NSNumber *)resID
+{
+	id <ResKnifeResourceProtocol> found = [NSClassFromString(@"Resource") resourceOfType:type andID:resID inDocument:[resource document]];
+	if( !found ) return [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"'%@' %@ (missing)", nil, plugBundle, nil), type, resID];
+	if( [[found name] isEqualToString:@""] ) return [NSString stringWithFormat:@"'%@' %@", type, resID];
+	return [NSString stringWithFormat:@"'%@' %@ %@", type, resID, [found name]];
+}
+
+/* Asks for a new ID, then renumbers the resource and fixes up everything in its document which refers to it. */
+- (IBAction)showRenumberSheet:(id)sender
+{
+	NSView *content;
+	NSTextField *label;
+	NSButton *button;
+	if( renumberSheet ) return;
+	renumberSheet = [[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 300, 104) styleMask:NSTitledWindowMask backing:NSBackingStoreBuffered defer:YES];
+	content = [renumberSheet contentView];
+	
+	label = [[[NSTextField alloc] initWithFrame:NSMakeRect(20, 64, 100, 17)] autorelease];
+	[label setEditable:NO];
+	[label setBordered:NO];
+	[label setDrawsBackground:NO];
+	[label setStringValue:NSLocalizedStringFromTableInBundle(@"New ID:", nil, plugBundle, nil)];
+	[content addSubview:label];
+	
+	renumberField = [[[NSTextField alloc] initWithFrame:NSMakeRect(124, 62, 156, 22)] autorelease];
+	[renumberField setIntValue:[[resource resID] intValue]];
+	[content addSubview:renumberField];
+	
+	button = [[[NSButton alloc] initWithFrame:NSMakeRect(198, 12, 88, 32)] autorelease];
+	[button setTitle:NSLocalizedStringFromTableInBundle(@"Renumber", nil, plugBundle, nil)];
+	[button setBezelStyle:NSRoundedBezelStyle];
+	[button setKeyEquivalent:@"\r"];
+	[button setTag:NSOKButton];
+	[button setTarget:self];
+	[button setAction:@selector(endRenumberSheet:)];
+	[content addSubview:button];
+	
+	button = [[[NSButton alloc] initWithFrame:NSMakeRect(110, 12, 88, 32)] autorelease];
+	[button setTitle:NSLocalizedStringFromTableInBundle(@"Cancel", nil, plugBundle, nil)];
+	[button setBezelStyle:NSRoundedBezelStyle];
+	[button setKeyEquivalent:@"\033"];
+	[button setTag:NSCancelButton];
+	[button setTarget:self];
+	[button setAction:@selector(endRenumberSheet:)];
+	[content addSubview:button];
+	
+	[renumberSheet setInitialFirstResponder:renumberField];
+	[NSApp beginSheet:renumberSheet modalForWindow:[self window] modalDelegate:nil didEndSelector:NULL contextInfo:NULL];
+}
+
+- (IBAction)endRenumberSheet:(id)sender
+{
+	int value = [renumberField intValue];
+	NSNumber *newID = [NSNumber numberWithShort:(short) value];
+	[NSApp endSheet:renumberSheet];
+	[renumberSheet orderOut:nil];
+	[renumberSheet autorelease];
+	renumberSheet = nil;
+	renumberField = nil;
+	
+	if( [sender tag] == NSOKButton && !(value == [newID intValue] && [[ReferenceGraph sharedGraph] renumberResource:resource toID:newID]) )
+		NSBeginAlertSheet( NSLocalizedStringFromTableInBundle(@"The resource couldn't be renumbered.", nil, plugBundle, nil), nil, nil, nil, [self window], nil, NULL, NULL, NULL, NSLocalizedStringFromTableInBundle(@"Another resource of this type already has ID %d, or something which refers to this resource can't hold that ID. Nothing has been changed.", nil, plugBundle, nil), value );
+}
+
 - (void)resourceNameDidChange:(NSNotification *)notification
 {
 	NSString *prefix;
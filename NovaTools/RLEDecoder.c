@@ -0,0 +1,159 @@
+#include "RLEDecoder.h"
+#include <string.h>
+
+enum
+{
+	kRLEHeaderSize = 16,
+
+	kTokenEndOfFrame = 0,
+	kTokenLineStart = 1,
+	kTokenPixelData = 2,
+	kTokenTransparentRun = 3,
+	kTokenPixelRun = 4
+};
+
+static UInt16 ReadShort(const UInt8 *bytes)
+{
+	return (UInt16) ((bytes[0] << 8) | bytes[1]);
+}
+
+static UInt32 ReadLong(const UInt8 *bytes)
+{
+	return ((UInt32) bytes[0] << 24) | ((UInt32) bytes[1] << 16) | ((UInt32) bytes[2] << 8) | bytes[3];
+}
+
+static UInt32 Padded(UInt32 count)
+{
+	return (count + 3) & ~3UL;
+}
+
+// one 16-bit pixel (xRRRRRGGGGGBBBBB) as RGBA in memory order, whatever the host's byte order
+static UInt32 Pixel16(UInt16 pixel)
+{
+	UInt32 value;
+	UInt8 rgba[4];
+	UInt8 r = (pixel >> 10) & 0x1F, g = (pixel >> 5) & 0x1F, b = pixel & 0x1F;
+	rgba[0] = (UInt8) ((r << 3) | (r >> 2));
+	rgba[1] = (UInt8) ((g << 3) | (g >> 2));
+	rgba[2] = (UInt8) ((b << 3) | (b >> 2));
+	rgba[3] = 0xFF;
+	memcpy( &value, rgba, 4 );
+	return value;
+}
+
+static void CopyPixels(UInt32 *pixels, UInt32 count, const UInt8 *source, UInt16 depth, const ColourTable *table)
+{
+	UInt32 i;
+	if( depth == 16 )
+		for( i = 0; i < count; i++ )
+			pixels[i] = Pixel16( ReadShort( source + i*2 ) );
+	else ColourTableExpand( table, source, count, 8, (UInt8 *) pixels );
+}
+
+// the 4 bytes after a run token hold two 16-bit or four 8-bit pixels, repeated across the run
+static void RunPixels(UInt32 *pixels, UInt32 count, const UInt8 *source, UInt16 depth, const ColourTable *table)
+{
+	UInt32 i, pattern[4];
+	UInt32 length = (depth == 16)? 2 : 4;
+	CopyPixels( pattern, length, source, depth, table );
+	if( pattern[0] == pattern[1] && (length == 2 || (pattern[0] == pattern[2] && pattern[0] == pattern[3])) )
+	{
+		UInt32 value = pattern[0];
+		for( i = 0; i < count; i++ )
+			pixels[i] = value;
+	}
+	else for( i = 0; i < count; i++ )
+		pixels[i] = pattern[i % length];
+}
+
+#pragma mark -
+
+Boolean RLEReadHeader(const UInt8 *bytes, UInt32 length, RLEHeader *header)
+{
+	if( length < kRLEHeaderSize ) return false;
+	header->width = ReadShort( bytes );
+	header->height = ReadShort( bytes + 2 );
+	header->depth = ReadShort( bytes + 4 );
+	header->palette = (SInt16) ReadShort( bytes + 6 );
+	header->frameCount = ReadShort( bytes + 8 );
+	if( header->depth != 8 && header->depth != 16 ) return false;
+	return header->width > 0 && header->height > 0 && header->width < 0x8000 && header->height < 0x8000;
+}
+
+UInt32 RLEIndexFrames(const UInt8 *bytes, UInt32 length, const RLEHeader *header, UInt32 *offsets)
+{
+	UInt32 frame = 0, offset = kRLEHeaderSize;
+	while( frame < header->frameCount && offset + 4 <= length )
+	{
+		Boolean ended = false;
+		offsets[frame++] = offset;
+		while( !ended )
+		{
+			UInt32 token;
+			if( offset + 4 > length ) return frame;
+			token = ReadLong( bytes + offset );
+			offset += 4;
+			switch( token >> 24 )
+			{
+				case kTokenEndOfFrame:		ended = true;						break;
+				case kTokenLineStart:
+				case kTokenTransparentRun:										break;
+				case kTokenPixelData:		offset += Padded( token & 0xFFFFFF );	break;
+				case kTokenPixelRun:		offset += 4;						break;
+				default:					return frame;
+			}
+		}
+	}
+	return frame;
+}
+
+Boolean RLEDecodeFrame(const UInt8 *bytes, UInt32 length, UInt32 offset, const RLEHeader *header, const ColourTable *table, UInt8 *pixels)
+{
+	UInt32 bytesPerPixel = header->depth / 8;
+	UInt32 width = header->width, x = 0, y = 0;
+	UInt32 *row = NULL;		// NULL before the first line and after the last
+	Boolean started = false;
+
+	while( offset + 4 <= length )
+	{
+		UInt32 token = ReadLong( bytes + offset );
+		UInt32 count = token & 0xFFFFFF;
+		UInt32 n = count / bytesPerPixel;
+		UInt32 visible = (row && x < width)? (n < width - x? n : width - x) : 0;
+		offset += 4;
+		switch( token >> 24 )
+		{
+			case kTokenEndOfFrame:
+				return true;
+
+			case kTokenLineStart:
+				if( started ) y++;
+				started = true;
+				x = 0;
+				row = (y < header->height)? (UInt32 *) pixels + y * width : NULL;
+				break;
+
+			case kTokenTransparentRun:
+				x += n;
+				break;
+
+			case kTokenPixelRun:
+				if( offset + 4 > length ) return false;
+				if( visible ) RunPixels( row + x, visible, bytes + offset, header->depth, table );
+				x += n;
+				offset += 4;
+				break;
+
+			case kTokenPixelData:
+				if( offset + count > length ) return false;
+				if( visible ) CopyPixels( row + x, visible, bytes + offset, header->depth, table );
+				x += n;
+				offset += Padded( count );
+				break;
+
+			default:
+				return false;
+		}
+	}
+	return false;
+}
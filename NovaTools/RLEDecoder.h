@@ -0,0 +1,53 @@
+/* Nova rlë sprite decoder */
+
+/*	Decodes frames of rlë8 (8-bit, through a colour table) and rlëD (16-bit, 5 bits per channel) sprites into
+	premultiplied RGBA, 8 bits per sample in R, G, B, A order, as NSBitmapImageRep expects by default.
+
+	After the header described by RLEPixelData, each frame is a stream of big-endian 32-bit tokens: the top byte is an
+	opcode and the rest a count of bytes. Line-start tokens move to the next row, transparent runs skip pixels, pixel
+	runs repeat the 4 bytes following the token, and pixel data copies the bytes following (padded to 4) as they are.
+	An end token closes the frame. The work is all in fills and copies of whole runs, written as plain loops over
+	32-bit pixels which compilers can vectorise, so this only depends on the C library. */
+
+#ifndef RLE_DECODER_H
+#define RLE_DECODER_H
+
+#include <CoreFoundation/CoreFoundation.h>
+#include "../Cocoa/Classes/ColourTable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RLEHeader
+{
+	UInt16	width;
+	UInt16	height;
+	UInt16	depth;			// 8 or 16
+	SInt16	palette;		// 'clut' ID for 8-bit sprites, 0 for the system palette
+	UInt16	frameCount;
+} RLEHeader;
+
+/*!
+@function	RLEReadHeader
+@abstract	Returns false if the data is too short or isn't a sprite this can decode.
+*/
+Boolean RLEReadHeader(const UInt8 *bytes, UInt32 length, RLEHeader *header);
+
+/*!
+@function	RLEIndexFrames
+@abstract	Finds where each frame's tokens start by skipping through the stream. Returns the number found, at most frameCount.
+*/
+UInt32 RLEIndexFrames(const UInt8 *bytes, UInt32 length, const RLEHeader *header, UInt32 *offsets);
+
+/*!
+@function	RLEDecodeFrame
+@abstract	Draws the frame starting at offset into pixels (width * height * 4 bytes), which must be cleared first. table is only used for 8-bit sprites. Returns false if the stream was cut short, though whatever was decoded is left in place.
+*/
+Boolean RLEDecodeFrame(const UInt8 *bytes, UInt32 length, UInt32 offset, const RLEHeader *header, const ColourTable *table, UInt8 *pixels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+#import "RLEDecoder.h"
+
+/*	An rlë8 or rlëD sprite whose frames are decoded (by RLEDecoder) the first time they are asked for. Only the most
+	recently used frames are kept, enough for a whole rotation of a ship. Sprites are shared per resource, and
+	rebuilt when the resource is given new data or its colour table changes. */
+
+@interface RLESprite : NSObject
+{
+	NSData *data;
+	RLEHeader header;
+	UInt32 *offsets;			// of each frame's tokens
+	unsigned frameCount;		// found in the data, which may be fewer than the header claims
+	NSData *colourTable;		// a ColourTable, for rlë8s
+	NSMutableArray *frames;		// NSImage or NSNull, by frame
+	NSMutableArray *recent;		// indexes of decoded frames, least recently used first
+}
+
++ (RLESprite *)spriteForResource:(id <ResKnifeResourceProtocol>)resource;	// nil if it isn't a sprite
+- (id)initWithData:(NSData *)spriteData colourTable:(NSData *)table;		// a ColourTable, as RKPaletteCache gives
+
+- (unsigned)frameCount;
+- (NSSize)size;
+- (NSImage *)imageForFrame:(unsigned)index;
+
+@end
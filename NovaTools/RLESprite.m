@@ -0,0 +1,141 @@
+#import "RLESprite.h"
+#import "../Cocoa/Classes/RKPaletteCache.h"
+
+enum
+{
+	kFrameCacheSize = 40,		// decoded frames kept per sprite; ships have 36
+	kSpriteCacheSize = 16		// sprites kept between editors
+};
+
+static NSMutableDictionary *gSprites = nil;		// non-retained resource -> RLESprite
+static NSMutableArray *gRecentSprites = nil;	// keys of gSprites, least recently used first
+
+@interface RLESprite (Private)
+- (NSData *)data;
+- (NSData *)colourTable;
+@end
+
+@implementation RLESprite
+
++ (RLESprite *)spriteForResource:(id <ResKnifeResourceProtocol>)resource
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	RLESprite *sprite;
+	RLEHeader header;
+	NSData *table;
+	if( !gSprites )
+	{
+		gSprites = [[NSMutableDictionary alloc] init];
+		gRecentSprites = [[NSMutableArray alloc] init];
+	}
+
+	// the sprite keeps the data and colour table it was made from, so a resource given new data, or whose table has been
+	// read again, never matches
+	if( !RLEReadHeader( [[resource data] bytes], [[resource data] length], &header ) )
+		return nil;
+	table = [[NSClassFromString(@"RKPaletteCache") sharedCache] colourTableWithID:header.palette depth:8 inDocument:[resource document]];
+	sprite = [gSprites objectForKey:key];
+	if( sprite && ([sprite data] != [resource data] || [sprite colourTable] != table) )
+		sprite = nil;
+	if( !sprite )
+	{
+		sprite = [[[RLESprite alloc] initWithData:[resource data] colourTable:table] autorelease];
+		if( !sprite ) return nil;
+		[gSprites setObject:sprite forKey:key];
+	}
+
+	[gRecentSprites removeObject:key];
+	[gRecentSprites addObject:key];
+	if( [gRecentSprites count] > kSpriteCacheSize )
+	{
+		[gSprites removeObjectForKey:[gRecentSprites objectAtIndex:0]];
+		[gRecentSprites removeObjectAtIndex:0];
+	}
+	return sprite;
+}
+
+- (id)initWithData:(NSData *)spriteData colourTable:(NSData *)table
+{
+	unsigned i;
+	self = [super init];
+	if( !self ) return nil;
+	if( !RLEReadHeader( [spriteData bytes], [spriteData length], &header ) )
+	{
+		[self release];
+		return nil;
+	}
+	data = [spriteData retain];
+	offsets = (UInt32 *) calloc( header.frameCount + 1, sizeof(UInt32) );
+	frameCount = RLEIndexFrames( [data bytes], [data length], &header, offsets );
+	colourTable = [table retain];
+
+	frames = [[NSMutableArray alloc] initWithCapacity:frameCount];
+	for( i = 0; i < frameCount; i++ )
+		[frames addObject:[NSNull null]];
+	recent = [[NSMutableArray alloc] init];
+	return self;
+}
+
+- (void)dealloc
+{
+	[data release];
+	[colourTable release];
+	free( offsets );
+	[frames release];
+	[recent release];
+	[super dealloc];
+}
+
+- (NSData *)data
+{
+	return data;
+}
+
+- (NSData *)colourTable
+{
+	return colourTable;
+}
+
+- (unsigned)frameCount
+{
+	return frameCount;
+}
+
+- (NSSize)size
+{
+	return NSMakeSize( header.width, header.height );
+}
+
+- (NSImage *)imageForFrame:(unsigned)index
+{
+	NSImage *image;
+	NSBitmapImageRep *rep;
+	NSNumber *number = [NSNumber numberWithUnsignedInt:index];
+	if( index >= frameCount ) return nil;
+
+	image = [frames objectAtIndex:index];
+	if( image != (id) [NSNull null] )
+	{
+		[recent removeObject:number];
+		[recent addObject:number];
+		return image;
+	}
+
+	// the rep's buffer starts cleared, so everything not drawn is transparent
+	rep = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:header.width pixelsHigh:header.height bitsPerSample:8 samplesPerPixel:4 hasAlpha:YES isPlanar:NO colorSpaceName:NSDeviceRGBColorSpace bytesPerRow:header.width * 4 bitsPerPixel:32] autorelease];
+	memset( [rep bitmapData], 0, header.width * header.height * 4 );
+	RLEDecodeFrame( [data bytes], [data length], offsets[index], &header, (const ColourTable *) [colourTable bytes], [rep bitmapData] );
+	image = [[[NSImage alloc] initWithSize:[self size]] autorelease];
+	[image addRepresentation:rep];
+
+	[frames replaceObjectAtIndex:index withObject:image];
+	[recent addObject:number];
+	if( [recent count] > kFrameCacheSize )
+	{
+		[frames replaceObjectAtIndex:[[recent objectAtIndex:0] unsignedIntValue] withObject:[NSNull null]];
+		[recent removeObjectAtIndex:0];
+	}
+	return image;
+}
+
+@end
@@ -0,0 +1,49 @@
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+
+/*	Every ID reference between the Nova resources in all open documents, in both directions. Which fields hold
+	references is described by a table in ReferenceGraph.m, against the structures in Structs.h, and their bytes are
+	found through NovaCodec's field tables. The graph is built the first time it's asked for and then kept up to date
+	from the notifications ResKnife posts as documents open and close and resources change, re-reading only what
+	changed, so the queries below are dictionary lookups. */
+
+@interface ReferenceLink : NSObject
+{
+	id <ResKnifeResourceProtocol> source;
+	NSValue *owner;			// non-retained value of the source's document
+	unsigned field;			// in the reference table
+	unsigned element;		// for arrays
+	NSString *targetType;
+	NSNumber *targetID;
+}
+
+- (id <ResKnifeResourceProtocol>)source;
+- (NSString *)fieldName;		// e.g. "nav[3]"
+- (NSString *)targetType;
+- (NSNumber *)targetID;
+
+@end
+
+@interface ReferenceGraph : NSObject
+{
+	NSDictionary *fieldsByType;		// type -> NSNumber indexes into the reference table
+	NSArray *targetTypes;			// parallel to the reference table
+	NSSet *trackedTypes;			// those which refer to something or can be referred to
+	NSMutableDictionary *entries;	// non-retained resource -> [resource, owner, [type, resID], links] for those of a tracked type
+	NSMutableSet *documents;		// non-retained NSValues of the open documents we have scanned, removed as they close
+	NSMutableDictionary *usedBy;	// type -> resID -> ReferenceLinks pointing at it
+	NSMutableDictionary *present;	// type -> resID -> NSCountedSet of owners having a resource with that ID
+}
+
++ (ReferenceGraph *)sharedGraph;
+
+- (NSArray *)referencesFromResource:(id <ResKnifeResourceProtocol>)resource;
+- (NSArray *)referencesToResource:(id <ResKnifeResourceProtocol>)resource;		// from its own document only
+- (NSArray *)danglingReferencesInDocument:(NSDocument *)document;				// links to resources the document doesn't have
+
+/* Gives a resource a new ID and rewrites every reference to it in its document, registering the whole lot as one
+	undo action. Fails, changing nothing, if the ID is taken or some field can't express it (e.g. a bööm sound index
+	only reaches 63). */
+- (BOOL)renumberResource:(id <ResKnifeResourceProtocol>)resource toID:(NSNumber *)newID;
+
+@end
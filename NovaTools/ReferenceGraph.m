@@ -0,0 +1,596 @@
+#import "ReferenceGraph.h"
+#import "Structs.h"
+#import "NovaCodec.h"
+#include <stddef.h>
+
+/* Fields holding the ID of another resource. Most hold the ID itself, from 128 up (-1 and anything below 128 meaning
+	"none" or some special case); a few hold an index which is offset to get the ID, such as a bööm's GraphicIndex. */
+
+typedef struct NovaReference
+{
+	const char			*type;		// key of the referring resources in Resource Types.strings
+	const NovaRecord	*record;
+	UInt32				offset;		// of the field in the structure
+	UInt16				count;		// of IDs in the field
+	const char			*name;
+	const char			*target;	// key of the referenced resources
+	SInt16				base;		// added to the stored value to give the target's ID
+	SInt16				minimum;	// stored values outside these are "none" or flags
+	SInt16				maximum;
+} NovaReference;
+
+#define REF(type, rec, field, target, base, minimum, maximum) \
+	{ type, &kNova##rec, offsetof(rec, field), sizeof(((rec *)0)->field) / sizeof(short), #field, target, base, minimum, maximum }
+#define IDREF(type, rec, field, target, last)	REF(type, rec, field, target, 0, 128, last)
+
+enum
+{
+	kLastDesc = 32767,	kLastDude = 639,	kLastFlet = 383,	kLastGovt = 383,	kLastIntf = 32767,
+	kLastMisn = 16127,	kLastOutf = 639,	kLastPers = 1211,	kLastPICT = 32767,	kLastShip = 895,
+	kLastSnd = 32767,	kLastStellar = 2175,	kLastWeap = 383
+};
+
+static const NovaReference gReferences[] =
+{
+	REF("boom", BoomRec, SoundIndex, "snd", 300, 0, 63),
+	REF("boom", BoomRec, GraphicIndex, "spin", 400, 0, 63),
+	IDREF("char", CharRec, startShipType, "ship", kLastShip),
+	IDREF("char", CharRec, startSystem, "syst", kLastStellar),
+	IDREF("char", CharRec, startGovt, "govt", kLastGovt),
+	IDREF("char", CharRec, introPictID, "PICT", kLastPICT),
+	IDREF("char", CharRec, introTextID, "desc", kLastDesc),
+	IDREF("cron", CronRec, NewsGovt, "govt", kLastGovt),
+	IDREF("dude", DudeRec, Govt, "govt", kLastGovt),
+	IDREF("dude", DudeRec, ShipTypes, "ship", kLastShip),
+	IDREF("flet", FletRec, LeadShipType, "ship", kLastShip),
+	IDREF("flet", FletRec, EscortShipType, "ship", kLastShip),
+	IDREF("flet", FletRec, Govt, "govt", kLastGovt),
+	IDREF("flet", FletRec, LinkSyst, "syst", kLastStellar),
+	IDREF("govt", GovtRec, intf, "intf", kLastIntf),
+	IDREF("govt", GovtRec, NewsPict, "PICT", kLastPICT),
+	IDREF("junk", JunkRec, SoldAt, "spob", kLastStellar),
+	IDREF("junk", JunkRec, BoughtAt, "spob", kLastStellar),
+	IDREF("misn", MisnRec, AvailStel, "spob", kLastStellar),
+	REF("misn", MisnRec, AvailStel, "syst", 128-5000, 5000, 5000-128+kLastStellar),	// any stellar in the system
+	IDREF("misn", MisnRec, TravelStel, "spob", kLastStellar),
+	REF("misn", MisnRec, TravelStel, "syst", 128-5000, 5000, 5000-128+kLastStellar),
+	IDREF("misn", MisnRec, ReturnStel, "spob", kLastStellar),
+	REF("misn", MisnRec, ReturnStel, "syst", 128-5000, 5000, 5000-128+kLastStellar),
+	IDREF("misn", MisnRec, ScanGovt, "govt", kLastGovt),
+	IDREF("misn", MisnRec, ShipSyst, "syst", kLastStellar),
+	IDREF("misn", MisnRec, ShipDude, "dude", kLastDude),
+	IDREF("misn", MisnRec, CompGovt, "govt", kLastGovt),
+	IDREF("misn", MisnRec, BriefText, "desc", kLastDesc),
+	IDREF("misn", MisnRec, QuickBrief, "desc", kLastDesc),
+	IDREF("misn", MisnRec, LoadCargText, "desc", kLastDesc),
+	IDREF("misn", MisnRec, DropCargText, "desc", kLastDesc),
+	IDREF("misn", MisnRec, CompText, "desc", kLastDesc),
+	IDREF("misn", MisnRec, FailText, "desc", kLastDesc),
+	IDREF("misn", MisnRec, ShipDoneText, "desc", kLastDesc),
+	IDREF("misn", MisnRec, AuxShipDude, "dude", kLastDude),
+	IDREF("misn", MisnRec, AuxShipSyst, "syst", kLastStellar),
+	IDREF("misn", MisnRec, RefuseText, "desc", kLastDesc),
+	IDREF("misn", MisnRec, AvailShipType, "ship", kLastShip),
+	IDREF("oops", OopsRec, Stellar, "spob", kLastStellar),
+	IDREF("pers", PersRec, LinkSyst, "syst", kLastStellar),
+	IDREF("pers", PersRec, Govt, "govt", kLastGovt),
+	IDREF("pers", PersRec, ShipType, "ship", kLastShip),
+	IDREF("pers", PersRec, WeapType, "weap", kLastWeap),
+	IDREF("pers", PersRec, HailPict, "PICT", kLastPICT),
+	IDREF("pers", PersRec, LinkMission, "misn", kLastMisn),
+	IDREF("rank", RankRec, Govt, "govt", kLastGovt),
+	REF("roid", RoidRec, ExplodeType, "boom", 128, 0, 63),
+	IDREF("ship", ShipRec, WType, "weap", kLastWeap),
+	REF("ship", ShipRec, Explode1, "boom", 128, 0, 63),
+	REF("ship", ShipRec, Explode2, "boom", 128, 0, 63),
+	IDREF("ship", ShipRec, InherentGovt, "govt", kLastGovt),
+	IDREF("ship", ShipRec, DefaultItems, "ouft", kLastOutf),
+	IDREF("ship", ShipRec, DefaultItems2, "ouft", kLastOutf),
+	IDREF("ship", ShipRec, WType2, "weap", kLastWeap),
+	IDREF("ship", ShipRec, UpgradeTo, "ship", kLastShip),
+	IDREF("spob", SpobRec, Govt, "govt", kLastGovt),
+	IDREF("spob", SpobRec, CustPicID, "PICT", kLastPICT),
+	IDREF("spob", SpobRec, CustSndID, "snd", kLastSnd),
+	IDREF("spob", SpobRec, DefDude, "dude", kLastDude),
+	IDREF("spob", SpobRec, Weapon, "weap", kLastWeap),
+	REF("spob", SpobRec, ExplodType, "boom", 128, 0, 63),
+	IDREF("syst", SystRec, con, "syst", kLastStellar),
+	IDREF("syst", SystRec, nav, "spob", kLastStellar),
+	IDREF("syst", SystRec, DudeTypes, "dude", kLastDude),
+	IDREF("syst", SystRec, Govt, "govt", kLastGovt),
+	IDREF("syst", SystRec, Person, "pers", kLastPers),
+	IDREF("syst", SystRec, ReinfFleet, "flet", kLastFlet),
+	REF("weap", WeapRec, AmmoType, "weap", 128, 0, kLastWeap-128),
+	REF("weap", WeapRec, Graphic, "spin", 3000, 0, 255),
+	REF("weap", WeapRec, Sound, "snd", 200, 0, 63),
+	REF("weap", WeapRec, ExplodType, "boom", 128, 0, 63),
+	IDREF("weap", WeapRec, SubType, "weap", kLastWeap)
+};
+
+#define kReferenceCount		(sizeof(gReferences) / sizeof(gReferences[0]))
+
+static UInt32 gDiskOffsets[kReferenceCount];	// of each field in the resource, from NovaCodec
+static ReferenceGraph *gSharedGraph = nil;
+
+enum
+{
+	kEntryResource,
+	kEntryOwner,
+	kEntryKey,		// [type, resID] as last seen, to spot what changed
+	kEntryLinks		// the ReferenceLinks out of the resource
+};
+
+static NSString *TypeName(const char *key)
+{
+	return [[NSBundle bundleForClass:[ReferenceGraph class]] localizedStringForKey:[NSString stringWithUTF8String:key] value:@"" table:@"Resource Types"];
+}
+
+@interface ReferenceLink (Private)
+- (id)initWithSource:(id <ResKnifeResourceProtocol>)resource owner:(NSValue *)document field:(unsigned)index element:(unsigned)i targetType:(NSString *)type targetID:(NSNumber *)resID;
+- (NSValue *)owner;
+- (unsigned)field;
+- (unsigned)element;
+@end
+
+@implementation ReferenceLink
+
+- (id)initWithSource:(id <ResKnifeResourceProtocol>)resource owner:(NSValue *)document field:(unsigned)index element:(unsigned)i targetType:(NSString *)type targetID:(NSNumber *)resID
+{
+	self = [super init];
+	source = [resource retain];
+	owner = [document retain];
+	field = index;
+	element = i;
+	targetType = [type copy];
+	targetID = [resID retain];
+	return self;
+}
+
+- (void)dealloc
+{
+	[source release];
+	[owner release];
+	[targetType release];
+	[targetID release];
+	[super dealloc];
+}
+
+- (id <ResKnifeResourceProtocol>)source
+{
+	return source;
+}
+
+- (NSValue *)owner
+{
+	return owner;
+}
+
+- (unsigned)field
+{
+	return field;
+}
+
+- (unsigned)element
+{
+	return element;
+}
+
+- (NSString *)fieldName
+{
+	if( gReferences[field].count == 1 )
+		return [NSString stringWithUTF8String:gReferences[field].name];
+	return [NSString stringWithFormat:@"%s[%u]", gReferences[field].name, element];
+}
+
+- (NSString *)targetType
+{
+	return targetType;
+}
+
+- (NSNumber *)targetID
+{
+	return targetID;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"'%@' %@ %@ -> '%@' %@", [source type], [source resID], [self fieldName], targetType, targetID];
+}
+
+@end
+
+@interface ReferenceGraph (Private)
+- (void)scanDocument:(NSDocument *)document;
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource ofDocument:(NSDocument *)document;
+- (void)removeResourceForKey:(NSValue *)key;
+- (NSArray *)linksFromResource:(id <ResKnifeResourceProtocol>)resource owner:(NSValue *)owner;
+- (void)setLinks:(NSArray *)newLinks forEntry:(NSMutableArray *)entry;
+- (NSMutableArray *)linksToType:(NSString *)type resID:(NSNumber *)resID create:(BOOL)create;
+- (NSArray *)linksToType:(NSString *)type resID:(NSNumber *)resID owner:(NSValue *)owner;
+- (void)addKey:(NSArray *)key owner:(NSValue *)owner;
+- (void)removeKey:(NSArray *)key owner:(NSValue *)owner;
+- (BOOL)isKey:(NSArray *)key presentInOwner:(NSValue *)owner;
+- (void)setData:(NSArray *)dataArray forResources:(NSArray *)targets resource:(id <ResKnifeResourceProtocol>)resource resID:(NSNumber *)resID;
+@end
+
+@implementation ReferenceGraph
+
++ (ReferenceGraph *)sharedGraph
+{
+	if( !gSharedGraph ) gSharedGraph = [[ReferenceGraph alloc] init];
+	return gSharedGraph;
+}
+
+- (id)init
+{
+	unsigned i;
+	NSMutableDictionary *fields = [NSMutableDictionary dictionary];
+	NSMutableArray *targets = [NSMutableArray arrayWithCapacity:kReferenceCount];
+	NSMutableSet *types = [NSMutableSet set];
+	NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+	NSDocument *document;
+	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
+	self = [super init];
+
+	for( i = 0; i < kReferenceCount; i++ )
+	{
+		NSString *type = TypeName(gReferences[i].type);
+		NSMutableArray *indexes = [fields objectForKey:type];
+		if( !indexes ) [fields setObject:(indexes = [NSMutableArray array]) forKey:type];
+		[indexes addObject:[NSNumber numberWithUnsignedInt:i]];
+		[targets addObject:TypeName(gReferences[i].target)];
+		[types addObject:type];
+		[types addObject:[targets lastObject]];
+		gDiskOffsets[i] = NovaDiskOffset( gReferences[i].record, gReferences[i].offset );
+	}
+	fieldsByType = [fields copy];
+	targetTypes = [targets copy];
+	trackedTypes = [types copy];
+	entries = [[NSMutableDictionary alloc] init];
+	documents = [[NSMutableSet alloc] init];
+	usedBy = [[NSMutableDictionary alloc] init];
+	present = [[NSMutableDictionary alloc] init];
+	while( document = [enumerator nextObject] )
+		[self scanDocument:document];
+
+	// as in ResourceCatalog, ResourceDidChange stands in for the ID and type notifications which aren't posted
+	[center addObserver:self selector:@selector(documentDidOpen:) name:DocumentDidOpenNotification object:nil];
+	[center addObserver:self selector:@selector(documentWillClose:) name:DocumentWillCloseNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidAddResource:) name:DataSourceDidAddResourceNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidRemoveResource:) name:DataSourceDidRemoveResourceNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDidChange:) name:ResourceDidChangeNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[fieldsByType release];
+	[targetTypes release];
+	[trackedTypes release];
+	[entries release];
+	[documents release];
+	[usedBy release];
+	[present release];
+	[super dealloc];
+}
+
+#pragma mark -
+#pragma mark Queries
+
+- (NSArray *)referencesFromResource:(id <ResKnifeResourceProtocol>)resource
+{
+	NSArray *entry = [entries objectForKey:[NSValue valueWithNonretainedObject:resource]];
+	return entry? [entry objectAtIndex:kEntryLinks] : [NSArray array];
+}
+
+- (NSArray *)referencesToResource:(id <ResKnifeResourceProtocol>)resource
+{
+	NSArray *entry = [entries objectForKey:[NSValue valueWithNonretainedObject:resource]];
+	if( !entry ) return [NSArray array];
+	return [self linksToType:[resource type] resID:[resource resID] owner:[entry objectAtIndex:kEntryOwner]];
+}
+
+- (NSArray *)danglingReferencesInDocument:(NSDocument *)document
+{
+	NSMutableArray *dangling = [NSMutableArray array];
+	NSValue *owner = document? [NSValue valueWithNonretainedObject:document] : nil;
+	NSArray *entry;
+	NSEnumerator *entryEnumerator = [entries objectEnumerator];
+	while( entry = [entryEnumerator nextObject] )
+	{
+		ReferenceLink *link;
+		NSEnumerator *enumerator;
+		if( owner && ![[entry objectAtIndex:kEntryOwner] isEqual:owner] ) continue;
+		enumerator = [[entry objectAtIndex:kEntryLinks] objectEnumerator];
+		while( link = [enumerator nextObject] )
+			if( ![self isKey:[NSArray arrayWithObjects:[link targetType], [link targetID], nil] presentInOwner:[link owner]] )
+				[dangling addObject:link];
+	}
+	return dangling;
+}
+
+#pragma mark -
+#pragma mark Renumbering
+
+- (BOOL)renumberResource:(id <ResKnifeResourceProtocol>)resource toID:(NSNumber *)newID
+{
+	NSArray *entry = [entries objectForKey:[NSValue valueWithNonretainedObject:resource]];
+	NSValue *owner;
+	NSMutableArray *targets = [NSMutableArray array];
+	NSMutableArray *dataArray = [NSMutableArray array];
+	ReferenceLink *link;
+	NSEnumerator *enumerator;
+
+	if( !entry ) return NO;
+	owner = [entry objectAtIndex:kEntryOwner];
+	if( [[resource resID] isEqualToNumber:newID] ) return YES;
+	if( [self isKey:[NSArray arrayWithObjects:[resource type], newID, nil] presentInOwner:owner] ) return NO;
+
+	// patch copies of every referring resource first, so nothing is changed if one of them can't take the new ID
+	enumerator = [[self linksToType:[resource type] resID:[resource resID] owner:owner] objectEnumerator];
+	while( link = [enumerator nextObject] )
+	{
+		const NovaReference *reference = &gReferences[[link field]];
+		int value = [newID intValue] - reference->base;
+		UInt32 offset = gDiskOffsets[[link field]] + [link element] * sizeof(short);
+		unsigned char *bytes;
+		unsigned i;
+		if( value < reference->minimum || value > reference->maximum )
+			return NO;
+		i = [targets indexOfObjectIdenticalTo:[link source]];
+		if( i == NSNotFound )
+		{
+			i = [targets count];
+			[targets addObject:[link source]];
+			[dataArray addObject:[[[[link source] data] mutableCopy] autorelease]];
+		}
+		bytes = [[dataArray objectAtIndex:i] mutableBytes];
+		bytes[offset] = (value >> 8) & 0xFF;
+		bytes[offset+1] = value & 0xFF;
+	}
+
+	[self setData:dataArray forResources:targets resource:resource resID:newID];
+	return YES;
+}
+
+// sets the referring resources' data and the renumbered resource's ID, registering the reverse as a single undo action
+- (void)setData:(NSArray *)dataArray forResources:(NSArray *)targets resource:(id <ResKnifeResourceProtocol>)resource resID:(NSNumber *)resID
+{
+	unsigned i;
+	NSUndoManager *undoManager = [[resource document] undoManager];
+	NSMutableArray *oldData = [NSMutableArray arrayWithCapacity:[targets count]];
+	for( i = 0; i < [targets count]; i++ )
+		[oldData addObject:[[targets objectAtIndex:i] data]];
+
+	[[undoManager prepareWithInvocationTarget:self] setData:oldData forResources:targets resource:resource resID:[resource resID]];
+	[undoManager setActionName:NSLocalizedStringFromTableInBundle(@"Renumber", nil, [NSBundle bundleForClass:[ReferenceGraph class]], nil)];
+
+	for( i = 0; i < [targets count]; i++ )
+		[[targets objectAtIndex:i] setData:[dataArray objectAtIndex:i]];
+	[resource setResID:resID];
+}
+
+#pragma mark -
+#pragma mark Maintenance
+
+/* Loading a file doesn't post add notifications, so a document's resources are read when it opens (or when we're created). */
+- (void)scanDocument:(NSDocument *)document
+{
+	NSString *type;
+	NSEnumerator *typeEnumerator = [trackedTypes objectEnumerator];
+	while( type = [typeEnumerator nextObject] )
+	{
+		id <ResKnifeResourceProtocol> resource;
+		NSEnumerator *enumerator = [[NSClassFromString(@"Resource") allResourcesOfType:type inDocument:document] objectEnumerator];
+		while( resource = [enumerator nextObject] )
+			[self addResource:resource ofDocument:document];
+	}
+	[documents addObject:[NSValue valueWithNonretainedObject:document]];
+}
+
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource ofDocument:(NSDocument *)document
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	NSValue *owner = [NSValue valueWithNonretainedObject:document];
+	NSArray *resourceKey = [NSArray arrayWithObjects:[resource type], [resource resID], nil];
+	NSMutableArray *entry;
+	if( [entries objectForKey:key] ) return;
+	entry = [NSMutableArray arrayWithObjects:resource, owner, resourceKey, [NSArray array], nil];
+	[entries setObject:entry forKey:key];
+	[self addKey:resourceKey owner:owner];
+	[self setLinks:[self linksFromResource:resource owner:owner] forEntry:entry];
+}
+
+- (void)removeResourceForKey:(NSValue *)key
+{
+	NSMutableArray *entry = [[[entries objectForKey:key] retain] autorelease];
+	if( !entry ) return;
+	[self setLinks:[NSArray array] forEntry:entry];
+	[self removeKey:[entry objectAtIndex:kEntryKey] owner:[entry objectAtIndex:kEntryOwner]];
+	[entries removeObjectForKey:key];
+}
+
+/* Reads just the referring fields, straight from the big-endian data. */
+- (NSArray *)linksFromResource:(id <ResKnifeResourceProtocol>)resource owner:(NSValue *)owner
+{
+	NSData *data = [resource data];
+	const unsigned char *bytes = [data bytes];
+	unsigned length = [data length];
+	NSMutableArray *found = [NSMutableArray array];
+	NSNumber *number;
+	NSEnumerator *enumerator = [[fieldsByType objectForKey:[resource type]] objectEnumerator];
+	while( number = [enumerator nextObject] )
+	{
+		unsigned i, field = [number unsignedIntValue];
+		const NovaReference *reference = &gReferences[field];
+		for( i = 0; i < reference->count; i++ )
+		{
+			UInt32 offset = gDiskOffsets[field] + i * sizeof(short);
+			SInt16 value;
+			if( offset + sizeof(short) > length ) break;
+			value = (SInt16) ((bytes[offset] << 8) | bytes[offset+1]);
+			if( value < reference->minimum || value > reference->maximum ) continue;
+			[found addObject:[[[ReferenceLink alloc] initWithSource:resource owner:owner field:field element:i targetType:[targetTypes objectAtIndex:field] targetID:[NSNumber numberWithInt:value + reference->base]] autorelease]];
+		}
+	}
+	return found;
+}
+
+- (void)setLinks:(NSArray *)newLinks forEntry:(NSMutableArray *)entry
+{
+	ReferenceLink *link;
+	NSEnumerator *enumerator = [[entry objectAtIndex:kEntryLinks] objectEnumerator];
+	while( link = [enumerator nextObject] )
+		[[self linksToType:[link targetType] resID:[link targetID] create:NO] removeObjectIdenticalTo:link];
+	enumerator = [newLinks objectEnumerator];
+	while( link = [enumerator nextObject] )
+		[[self linksToType:[link targetType] resID:[link targetID] create:YES] addObject:link];
+	[entry replaceObjectAtIndex:kEntryLinks withObject:newLinks];
+}
+
+- (NSMutableArray *)linksToType:(NSString *)type resID:(NSNumber *)resID create:(BOOL)create
+{
+	NSMutableDictionary *byID = [usedBy objectForKey:type];
+	NSMutableArray *array;
+	if( !byID && create )
+	{
+		byID = [NSMutableDictionary dictionary];
+		[usedBy setObject:byID forKey:type];
+	}
+	array = [byID objectForKey:resID];
+	if( !array && create )
+	{
+		array = [NSMutableArray array];
+		[byID setObject:array forKey:resID];
+	}
+	return array;
+}
+
+// a copy, since renumbering changes the graph while working through it
+- (NSArray *)linksToType:(NSString *)type resID:(NSNumber *)resID owner:(NSValue *)owner
+{
+	ReferenceLink *link;
+	NSArray *all = [self linksToType:type resID:resID create:NO];
+	NSMutableArray *found = [NSMutableArray arrayWithCapacity:[all count]];
+	NSEnumerator *enumerator = [all objectEnumerator];
+	while( link = [enumerator nextObject] )
+		if( !owner || [[link owner] isEqual:owner] )
+			[found addObject:link];
+	return found;
+}
+
+- (void)addKey:(NSArray *)key owner:(NSValue *)owner
+{
+	NSMutableDictionary *byID = [present objectForKey:[key objectAtIndex:0]];
+	NSCountedSet *set;
+	if( !byID )
+	{
+		byID = [NSMutableDictionary dictionary];
+		[present setObject:byID forKey:[key objectAtIndex:0]];
+	}
+	set = [byID objectForKey:[key objectAtIndex:1]];
+	if( !set )
+	{
+		set = [NSCountedSet set];
+		[byID setObject:set forKey:[key objectAtIndex:1]];
+	}
+	[set addObject:owner];
+}
+
+- (void)removeKey:(NSArray *)key owner:(NSValue *)owner
+{
+	[[[present objectForKey:[key objectAtIndex:0]] objectForKey:[key objectAtIndex:1]] removeObject:owner];
+}
+
+- (BOOL)isKey:(NSArray *)key presentInOwner:(NSValue *)owner
+{
+	return [[[present objectForKey:[key objectAtIndex:0]] objectForKey:[key objectAtIndex:1]] containsObject:owner];
+}
+
+#pragma mark -
+#pragma mark Notifications
+
+- (void)documentDidOpen:(NSNotification *)notification
+{
+	[self scanDocument:[notification object]];
+}
+
+- (void)documentWillClose:(NSNotification *)notification
+{
+	// forget the document before it goes, so a new one at the same address isn't mistaken for it
+	NSValue *owner = [NSValue valueWithNonretainedObject:[notification object]];
+	NSValue *key;
+	NSEnumerator *enumerator;
+	if( ![documents containsObject:owner] ) return;
+	[documents removeObject:owner];
+	enumerator = [[entries allKeys] objectEnumerator];
+	while( key = [enumerator nextObject] )
+		if( [[[entries objectForKey:key] objectAtIndex:kEntryOwner] isEqual:owner] )
+			[self removeResourceForKey:key];
+}
+
+- (void)dataSourceDidAddResource:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [[notification object] objectForKey:@"Resource"];
+	NSDocument *document;
+	if( ![trackedTypes containsObject:[resource type]] ) return;
+	document = [resource document];
+	if( document && [documents containsObject:[NSValue valueWithNonretainedObject:document]] )
+		[self addResource:resource ofDocument:document];
+}
+
+- (void)dataSourceDidRemoveResource:(NSNotification *)notification
+{
+	[self removeResourceForKey:[NSValue valueWithNonretainedObject:[[notification object] objectForKey:@"Resource"]]];
+}
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	NSMutableArray *entry = [entries objectForKey:[NSValue valueWithNonretainedObject:[notification object]]];
+	if( entry && [fieldsByType objectForKey:[[notification object] type]] )
+		[self setLinks:[self linksFromResource:[notification object] owner:[entry objectAtIndex:kEntryOwner]] forEntry:entry];
+}
+
+- (void)resourceDidChange:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [notification object];
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	NSMutableArray *entry = [entries objectForKey:key];
+	NSArray *oldKey, *newKey;
+	NSValue *owner;
+	if( !entry )
+	{
+		// a resource whose type was changed to one we track
+		if( [trackedTypes containsObject:[resource type]] )
+		{
+			NSDocument *document = [resource document];
+			if( document && [documents containsObject:[NSValue valueWithNonretainedObject:document]] )
+				[self addResource:resource ofDocument:document];
+		}
+		return;
+	}
+
+	// most changes are to data, which has its own notification
+	oldKey = [[[entry objectAtIndex:kEntryKey] retain] autorelease];
+	newKey = [NSArray arrayWithObjects:[resource type], [resource resID], nil];
+	if( [oldKey isEqualToArray:newKey] ) return;
+	owner = [[[entry objectAtIndex:kEntryOwner] retain] autorelease];
+
+	// a new type means different fields, so start again
+	if( ![[oldKey objectAtIndex:0] isEqualToString:[newKey objectAtIndex:0]] )
+	{
+		[self removeResourceForKey:key];
+		if( [trackedTypes containsObject:[resource type]] )
+			[self addResource:resource ofDocument:[owner nonretainedObjectValue]];
+		return;
+	}
+
+	// a new ID leaves what it refers to alone, but references to the old ID now dangle (unless renumbered with fix-up)
+	[self removeKey:oldKey owner:owner];
+	[self addKey:newKey owner:owner];
+	[entry replaceObjectAtIndex:kEntryKey withObject:newKey];
+}
+
+@end
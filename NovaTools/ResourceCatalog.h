@@ -0,0 +1,23 @@
+#import <Cocoa/Cocoa.h>
+
+@class NameIndex;
+
+/*	One catalog per resource type, shared by every editor's DataSources, mapping resource ID to name over all
+	open documents. It is built the first time it's asked for and then kept up to date from the notifications
+	ResKnife posts as documents open and close and as resources are added, removed, renamed or renumbered, so
+	asking for the names never scans anything. Treat the dictionary as read-only. */
+
+@interface ResourceCatalog : NSObject
+{
+	NSString *type;
+	NSMutableDictionary *names;		// resID -> name
+	NSMutableDictionary *entries;	// non-retained resource -> [resource, owner, resID, name] as last seen, to spot what changed
+	NSMutableSet *documents;		// non-retained NSValues of the open documents we have scanned, removed as they close
+	NameIndex *nameIndex;			// built on demand, discarded whenever names changes
+}
+
++ (ResourceCatalog *)catalogForType:(NSString *)typeString;
+- (NSDictionary *)names;
+- (NameIndex *)index;
+
+@end
@@ -0,0 +1,227 @@
+#import "ResourceCatalog.h"
+#import "ResKnifeResourceProtocol.h"
+#import "NameIndex.h"
+
+static NSMutableDictionary *gCatalogs = nil;
+
+enum
+{
+	kEntryResource,
+	kEntryOwner,
+	kEntryResID,
+	kEntryName
+};
+
+@interface ResourceCatalog (Private)
+- (id)initForType:(NSString *)typeString;
+- (void)scanDocument:(NSDocument *)document;
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource ofDocument:(NSDocument *)document;
+- (void)removeResourceForKey:(NSValue *)key;
+- (void)setName:(NSString *)name forResID:(NSNumber *)resID excludingKey:(NSValue *)key;
+- (void)invalidateIndex;
+@end
+
+@implementation ResourceCatalog
+
++ (ResourceCatalog *)catalogForType:(NSString *)typeString
+{
+	ResourceCatalog *catalog;
+	if( !gCatalogs ) gCatalogs = [[NSMutableDictionary alloc] init];
+	catalog = [gCatalogs objectForKey:typeString];
+	if( !catalog )
+	{
+		catalog = [[[ResourceCatalog alloc] initForType:typeString] autorelease];
+		[gCatalogs setObject:catalog forKey:typeString];
+	}
+	return catalog;
+}
+
+- (id)initForType:(NSString *)typeString
+{
+	NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+	NSDocument *document;
+	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
+	self = [super init];
+	type = [typeString copy];
+	names = [[NSMutableDictionary alloc] init];
+	entries = [[NSMutableDictionary alloc] init];
+	documents = [[NSMutableSet alloc] init];
+	while( document = [enumerator nextObject] )
+		[self scanDocument:document];
+
+	// ResourceNameDidChange & ResourceIDDidChange aren't currently posted, so ResourceDidChange (posted on every edit) covers them
+	[center addObserver:self selector:@selector(documentDidOpen:) name:DocumentDidOpenNotification object:nil];
+	[center addObserver:self selector:@selector(documentWillClose:) name:DocumentWillCloseNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidAddResource:) name:DataSourceDidAddResourceNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidRemoveResource:) name:DataSourceDidRemoveResourceNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDidChange:) name:ResourceNameDidChangeNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDidChange:) name:ResourceIDDidChangeNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDidChange:) name:ResourceDidChangeNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[type release];
+	[names release];
+	[entries release];
+	[documents release];
+	[nameIndex release];
+	[super dealloc];
+}
+
+- (NSDictionary *)names
+{
+	return names;
+}
+
+- (NameIndex *)index
+{
+	if( !nameIndex ) nameIndex = [[NameIndex alloc] initWithNames:names];
+	return nameIndex;
+}
+
+- (void)invalidateIndex
+{
+	[nameIndex release];
+	nameIndex = nil;
+}
+
+/* Loading a file doesn't post add notifications, so a document's resources are read when it opens (or when we're created). */
+- (void)scanDocument:(NSDocument *)document
+{
+	id <ResKnifeResourceProtocol> resource;
+	NSEnumerator *enumerator = [[NSClassFromString(@"Resource") allResourcesOfType:type inDocument:document] objectEnumerator];
+	while( resource = [enumerator nextObject] )
+		[self addResource:resource ofDocument:document];
+	[documents addObject:[NSValue valueWithNonretainedObject:document]];
+}
+
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource ofDocument:(NSDocument *)document
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	if( [entries objectForKey:key] ) return;
+	[entries setObject:[NSArray arrayWithObjects:resource, [NSValue valueWithNonretainedObject:document], [resource resID], [resource name], nil] forKey:key];
+	[names setObject:[resource name] forKey:[resource resID]];
+	[self invalidateIndex];
+}
+
+- (void)removeResourceForKey:(NSValue *)key
+{
+	NSArray *entry = [[[entries objectForKey:key] retain] autorelease];
+	if( !entry ) return;
+	[entries removeObjectForKey:key];
+	[self setName:nil forResID:[entry objectAtIndex:kEntryResID] excludingKey:nil];
+}
+
+/* Sets or clears the name for an ID, unless another resource (in another document) still has that ID. */
+- (void)setName:(NSString *)name forResID:(NSNumber *)resID excludingKey:(NSValue *)excluded
+{
+	NSValue *key;
+	NSEnumerator *enumerator;
+	[self invalidateIndex];
+	if( name )
+	{
+		[names setObject:name forKey:resID];
+		return;
+	}
+	[names removeObjectForKey:resID];
+	enumerator = [entries keyEnumerator];
+	while( key = [enumerator nextObject] )
+	{
+		NSArray *entry = [entries objectForKey:key];
+		if( ![key isEqual:excluded] && [[entry objectAtIndex:kEntryResID] isEqualToNumber:resID] )
+		{
+			[names setObject:[entry objectAtIndex:kEntryName] forKey:resID];
+			break;
+		}
+	}
+}
+
+#pragma mark -
+#pragma mark Notifications
+
+- (void)documentDidOpen:(NSNotification *)notification
+{
+	[self scanDocument:[notification object]];
+}
+
+- (void)documentWillClose:(NSNotification *)notification
+{
+	// forget the document before it goes, so a new one at the same address isn't mistaken for it
+	NSValue *owner = [NSValue valueWithNonretainedObject:[notification object]];
+	NSValue *key;
+	NSArray *entry;
+	NSEnumerator *enumerator;
+	if( ![documents containsObject:owner] ) return;
+	[documents removeObject:owner];
+	enumerator = [[entries allKeys] objectEnumerator];
+	while( key = [enumerator nextObject] )
+		if( [[[entries objectForKey:key] objectAtIndex:kEntryOwner] isEqual:owner] )
+			[entries removeObjectForKey:key];
+
+	// then the names, in one pass rather than one per resource removed
+	[names removeAllObjects];
+	enumerator = [entries objectEnumerator];
+	while( entry = [enumerator nextObject] )
+		[names setObject:[entry objectAtIndex:kEntryName] forKey:[entry objectAtIndex:kEntryResID]];
+	[self invalidateIndex];
+}
+
+- (void)dataSourceDidAddResource:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [[notification object] objectForKey:@"Resource"];
+	NSDocument *document;
+	if( ![[resource type] isEqualToString:type] ) return;
+
+	// resources added while a document is being opened belong to a document we'll scan anyway
+	document = [resource document];
+	if( document && [documents containsObject:[NSValue valueWithNonretainedObject:document]] )
+		[self addResource:resource ofDocument:document];
+}
+
+- (void)dataSourceDidRemoveResource:(NSNotification *)notification
+{
+	[self removeResourceForKey:[NSValue valueWithNonretainedObject:[[notification object] objectForKey:@"Resource"]]];
+}
+
+- (void)resourceDidChange:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [notification object];
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	NSArray *entry = [[[entries objectForKey:key] retain] autorelease];
+	NSNumber *resID, *oldID;
+	NSString *name;
+	if( !entry )
+	{
+		// a resource whose type was changed to ours
+		if( [[resource type] isEqualToString:type] )
+		{
+			NSDocument *document = [resource document];
+			if( document && [documents containsObject:[NSValue valueWithNonretainedObject:document]] )
+				[self addResource:resource ofDocument:document];
+		}
+		return;
+	}
+
+	// ...or away from it
+	if( ![[resource type] isEqualToString:type] )
+	{
+		[self removeResourceForKey:key];
+		return;
+	}
+
+	// most changes are to data, which we don't care about
+	resID = [resource resID];
+	name = [resource name];
+	oldID = [entry objectAtIndex:kEntryResID];
+	if( [oldID isEqualToNumber:resID] && [[entry objectAtIndex:kEntryName] isEqualToString:name] )
+		return;
+	[entries setObject:[NSArray arrayWithObjects:resource, [entry objectAtIndex:kEntryOwner], resID, name, nil] forKey:key];
+	if( ![oldID isEqualToNumber:resID] )
+		[self setName:nil forResID:oldID excludingKey:key];
+	[self setName:name forResID:resID excludingKey:key];
+}
+
+@end
@@ -1,11 +1,27 @@
 /* Nova Resource structures */
 
-#import <Carbon/Carbon.h>
-
+#ifndef NOVA_STRUCTS_H
+#define NOVA_STRUCTS_H
+
+// NovaCodec.c is built with this alone, so nothing here may need more than MacTypes.h or, elsewhere, the C library
+#if defined(__APPLE__)
+	#include <MacTypes.h>
+#else
+	#include <stdint.h>
+	typedef uint8_t		UInt8;
+	typedef uint16_t	UInt16;
+	typedef uint32_t	UInt32;
+	typedef int32_t		SInt32;
+	typedef unsigned char Boolean;
+	typedef struct Rect { short top, left, bottom, right; } Rect;
+#endif
+
+#if defined(__APPLE_CC__) || defined(__MWERKS__)
 #pragma options align=mac68k
 //#pragma options align=packed		// TODO: This doesn't compile in PB (but it does in xCode).
 // see http://developer.apple.com/techpubs/macosx/DeveloperTools/MachORuntime/2rt_powerpc_abi/PowerPC_Data_Alignment.html
 // align=reset is at the bottom of the file.
+#endif
 
 typedef struct NovaControlBits
 {
@@ -23,7 +39,7 @@ typedef struct BoomRec
 
 typedef struct CharRec
 {
-	long startCash;
+	SInt32 startCash;
 	short startShipType;
 	short startSystem[4];
 	short startGovt[4];
@@ -44,20 +60,20 @@ typedef struct CharRec
 
 typedef struct ColrRec
 {
-	long ButtonUp;
-	long ButtonDown;
-	long ButtonGrey;
+	SInt32 ButtonUp;
+	SInt32 ButtonDown;
+	SInt32 ButtonGrey;
 	char MenuFont[64];
 	short MenuFontSize;
-	long MenuColor1;
-	long MenuColor2;
-	long GridBright;
-	long GridDim;
+	SInt32 MenuColor1;
+	SInt32 MenuColor2;
+	SInt32 GridBright;
+	SInt32 GridDim;
 	//	p2c: Structs.p, line 696: Warning: Symbol 'RECT' is not defined [221]
 	Rect ProgArea;
-	long ProgBright;
-	long ProgDim;
-	long ProgOutline;
+	SInt32 ProgBright;
+	SInt32 ProgDim;
+	SInt32 ProgOutline;
 
 	short Button1x;
 	short Button1y;
@@ -72,11 +88,11 @@ typedef struct ColrRec
 	short Button6x;
 	short Button6y;
 
-	long FloatingMap;
-	long ListText;
-	long ListBkgnd;
-	long ListHilite;
-	long EscortHilite;
+	SInt32 FloatingMap;
+	SInt32 ListText;
+	SInt32 ListBkgnd;
+	SInt32 ListHilite;
+	SInt32 EscortHilite;
 
 	char ButtonFont[64];
 	short ButtonFontSz;
@@ -114,10 +130,10 @@ typedef struct CronRec
 	// OnStart: packed array[0..254] of char;
 	// OnEnd: packed array[0..255] of char;
 	char cdata[766];
-	long Contributes0;
-	long Contributes1;
-	long Require0;
-	long Require1;
+	SInt32 Contributes0;
+	SInt32 Contributes1;
+	SInt32 Require0;
+	SInt32 Require1;
 	short NewsGovt[4];
 	short GovtNewsString[4];
 } CronRec;
@@ -166,18 +182,18 @@ typedef struct FletRec
 
 typedef struct IntfRec
 {
-	long BrightText;
-	long DimText;
+	SInt32 BrightText;
+	SInt32 DimText;
 	Rect RadarArea;
-	long BrightRadar;
-	long DimRadar;
+	SInt32 BrightRadar;
+	SInt32 DimRadar;
 	Rect ShieldArea;
-	long Shield;
+	SInt32 Shield;
 	Rect ArmorArea;
-	long Armor;
+	SInt32 Armor;
 	Rect FuelArea;
-	long FuelFull;
-	long FuelPartial;
+	SInt32 FuelFull;
+	SInt32 FuelPartial;
 	Rect NavArea;
 	Rect WeapArea;
 	Rect TargArea;
@@ -223,12 +239,12 @@ typedef struct GovtRec
 	short ScanMask;
 	char CommName[16];
 	char TargetCode[16];
-	long Require0;
-	long Require1;
+	SInt32 Require0;
+	SInt32 Require1;
 	short InhJam[4];
 	char MediumName[64];
-	long color;
-	long ShipColor;
+	SInt32 color;
+	SInt32 ShipColor;
 	short intf;
 	short NewsPict;
 	short UnusedA[8];
@@ -251,7 +267,7 @@ typedef struct MisnRec
 	short DropoffMode;
 	short ScanGovt;
 	short Unused2;
-	long PayVal;
+	SInt32 PayVal;
 	short ShipCount;
 	short ShipSyst;
 	short ShipDude;
@@ -291,8 +307,8 @@ typedef struct MisnRec
 
 	char cdata[1530];
 
-	long Require0;
-	long Require1;
+	SInt32 Require0;
+	SInt32 Require1;
 	short DatePostInc;
 	// OnShipDone: packed array[0..254] of char;
 	// AcceptButton: packed array[0..31] of char;
@@ -335,17 +351,17 @@ typedef struct OutfRec
 	short ModVal;
 	short Max;
 	short Flags;
-	long Cost;
+	SInt32 Cost;
 	short ModType2;
 	short ModVal2;
 	short ModType3;
 	short ModVal3;
 	short ModType4;
 	short ModVal4;
-	long Contributes0;
-	long Contributes1;
-	long Require0;
-	long Require1;
+	SInt32 Contributes0;
+	SInt32 Contributes1;
+	SInt32 Require0;
+	SInt32 Require1;
 	// Availability: packed array[0..254] of char;
 	// OnPurchase: packed array[0..254] of char;
 	// OnSell: packed array[0..254] of char;
@@ -371,7 +387,7 @@ typedef struct PersRec
 	short WeapType[4];
 	short WeapCount[4];
 	short AmmoLoad[4];
-	long Credits;
+	SInt32 Credits;
 	short ShieldMod;
 	short HailPict;
 	short CommQuote;
@@ -383,7 +399,7 @@ typedef struct PersRec
 	short GrantCount;
 	short GrantProb;
 	char SubTitle[64];
-	long ShipColor;
+	SInt32 ShipColor;
 	short Flags2;
 	short UnusedA[8];
 } PersRec;
@@ -393,10 +409,10 @@ typedef struct RankRec
 	short Weight;
 	short Govt;
 	short PriceMod;
-	long Salary;
-	long SalaryCap;
-	long Contributes0;
-	long Contributes1;
+	SInt32 Salary;
+	SInt32 SalaryCap;
+	SInt32 Contributes0;
+	SInt32 Contributes1;
 	short flags;
 	// ConvName: packed array[0..63] of char;
 	// ShortName: packed array[0..63] of char;
@@ -411,7 +427,7 @@ typedef struct RoidRec
 	short yieldType;
 	short yieldQty;
 	short partCount;
-	long partColor;
+	SInt32 partColor;
 	short fragType[2];
 	short fragCount;
 	short ExplodeType;
@@ -521,7 +537,7 @@ typedef struct ShipRec
 	short MaxGun;
 	short MaxTur;
 	short TechLevel;
-	long Cost;
+	SInt32 Cost;
 	short DeathDelay;
 	short ArmorRech;
 	short Explode1;
@@ -540,8 +556,8 @@ typedef struct ShipRec
 	short FuelRegen;
 	short SkillVar;
 	short Flags2;
-	long Contributes0;
-	long Contributes1;
+	SInt32 Contributes0;
+	SInt32 Contributes1;
 	// Availability: packed array[0..254] of char;
 	// AppearOn: packed array[0..254] of char;
 	// OnPurchase: packed array[0..255] of char;
@@ -553,8 +569,8 @@ typedef struct ShipRec
 	short KeyCarried;
 	short DefaultItems2[4];
 	short ItemCount2[4];
-	long Require0;
-	long Require1;
+	SInt32 Require0;
+	SInt32 Require1;
 
 	short BuyRandom;
 	short HireRandom;
@@ -578,8 +594,8 @@ typedef struct ShipRec
 	char cdata3[64];
 	short Flags3;
 	short UpgradeTo;
-	long EscUpgrdCost;
-	long EscSellValue;
+	SInt32 EscUpgrdCost;
+	SInt32 EscSellValue;
 	short EscortType;
 	short UnusedA[8];
 } ShipRec;
@@ -599,7 +615,7 @@ typedef struct SpobRec
 	short xPos;
 	short yPos;
 	short spobType;
-	long Flags;
+	SInt32 Flags;
 	short Tribute;
 	short TechLevel;
 	short SpecialTech1;
@@ -618,10 +634,10 @@ typedef struct SpobRec
 	// OnDominate: packed array[0..254] of char;
 	// OnRelease: packed array[0..254] of char;
 	char cdata[510];
-	long Fee;
+	SInt32 Fee;
 	short Gravity;
 	short Weapon;
-	long Strength;
+	SInt32 Strength;
 	short DeadType;
 	short DeadTime;
 	short ExplodType;
@@ -651,7 +667,7 @@ typedef struct SystRec
 	short Interference;
 	short Person[8];
 	short PersonProb[8];
-	long BkgndColor;
+	SInt32 BkgndColor;
 	short Murk;
 	short AstTypes;
 	char Visiblility[256];
@@ -685,12 +701,12 @@ typedef struct WeapRec
 	short PartVel;
 	short PartLifeMin;
 	short PartLifeMax;
-	long PartColor;
+	SInt32 PartColor;
 	short BeamLength;
 	short BeamWidth;
 	short Falloff;
-	long BeamColor;
-	long CoronaColor;
+	SInt32 BeamColor;
+	SInt32 CoronaColor;
 	short SubCount;
 	short SubType;
 	short SubTheta;
@@ -701,7 +717,7 @@ typedef struct WeapRec
 	short HitParticles;
 	short HitPartLife;
 	short HitPartVel;
-	long HitPartColor;
+	SInt32 HitPartColor;
 	short Recoil;
 	short ExitType;
 	short BurstCount;
@@ -716,7 +732,7 @@ typedef struct WeapRec
 	short MaxAmmo;
 	short LiDensity;
 	short LiAmplitude;
-	long IonizeColor;
+	SInt32 IonizeColor;
 	short UnusedA[8];
 } WeapRec;
 
@@ -729,4 +745,8 @@ typedef struct YearRec
 	char Suffix[15];
 } YearRec;
 
-#pragma options align=reset
\ No newline at end of file
+#if defined(__APPLE_CC__) || defined(__MWERKS__)
+#pragma options align=reset
+#endif
+
+#endif
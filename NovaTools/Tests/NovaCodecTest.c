@@ -0,0 +1,82 @@
+/*	Round-trip test for NovaCodec, buildable with any C compiler:
+	
+		cc -std=c99 -Wall -I.. NovaCodecTest.c ../NovaCodec.c -o NovaCodecTest && ./NovaCodecTest
+	
+	Every record is decoded from random big-endian bytes and encoded again, which must give back the same bytes;
+	a few fields are checked against values written by hand. Exits non-zero if anything fails. */
+
+#include "NovaCodec.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const NovaRecord *gRecords[] =
+{
+	&kNovaBoomRec, &kNovaCharRec, &kNovaColrRec, &kNovaCronRec, &kNovaDescCodaRec, &kNovaDeqtRec, &kNovaDudeRec,
+	&kNovaFletRec, &kNovaIntfRec, &kNovaJunkRec, &kNovaGovtRec, &kNovaMisnRec, &kNovaNebuRec, &kNovaOopsRec,
+	&kNovaOutfRec, &kNovaPersRec, &kNovaRankRec, &kNovaRoidRec, &kNovaShanRec, &kNovaShipRec, &kNovaSpinRec,
+	&kNovaSpobRec, &kNovaSystRec, &kNovaWeapRec, &kNovaYearRec
+};
+
+static int gFailures = 0;
+
+#define CHECK(condition, ...)	do { if(!(condition)) { printf(__VA_ARGS__); printf("\n"); gFailures++; } } while(0)
+
+static void TestRoundTrip(const NovaRecord *record)
+{
+	UInt32 i, pass;
+	UInt8 *bytes = malloc(record->diskSize), *again = malloc(record->diskSize);
+	void *native = malloc(record->nativeSize);
+	for(pass = 0; pass < 100; pass++)
+	{
+		for(i = 0; i < record->diskSize; i++)
+			bytes[i] = (UInt8) rand();
+		CHECK(NovaDecodeRecord(record, bytes, record->diskSize, native), "%s: complete data reported short", record->name);
+		NovaEncodeRecord(record, native, again);
+		CHECK(memcmp(bytes, again, record->diskSize) == 0, "%s: encoding the decoded record changed it", record->name);
+	}
+	
+	// short data decodes what there is and zeroes the rest
+	CHECK(!NovaDecodeRecord(record, bytes, record->diskSize - 1, native), "%s: short data reported complete", record->name);
+	NovaEncodeRecord(record, native, again);
+	for(i = record->diskSize - record->fields[record->fieldCount-1].width * record->fields[record->fieldCount-1].count; i < record->diskSize; i++)
+		CHECK(again[i] == 0, "%s: field beyond the data not zeroed", record->name);
+	free(bytes);
+	free(again);
+	free(native);
+}
+
+static void TestKnownValues(void)
+{
+	static const UInt8 boom[] = { 0x00, 0x64, 0xFF, 0xFF, 0x00, 0x05 };
+	static const UInt8 charStart[] = { 0x00, 0x01, 0x86, 0xA0, 0x00, 0x80 };
+	BoomRec boomRec;
+	CharRec charRec;
+	UInt8 charBytes[362];
+	
+	CHECK(NovaDecodeRecord(&kNovaBoomRec, boom, sizeof(boom), &boomRec), "boom: complete data reported short");
+	CHECK(boomRec.FrameAdvance == 100 && boomRec.SoundIndex == -1 && boomRec.GraphicIndex == 5, "boom: fields decoded as %d, %d, %d", boomRec.FrameAdvance, boomRec.SoundIndex, boomRec.GraphicIndex);
+	
+	memset(charBytes, 0, sizeof(charBytes));
+	memcpy(charBytes, charStart, sizeof(charStart));
+	NovaDecodeRecord(&kNovaCharRec, charBytes, sizeof(charBytes), &charRec);
+	CHECK(charRec.startCash == 100000 && charRec.startShipType == 128, "char: start decoded as %ld, %d", (long) charRec.startCash, charRec.startShipType);
+	
+	// the sizes and offsets resources are documented with
+	CHECK(kNovaCharRec.diskSize == 362 && kNovaShipRec.diskSize == 1860 && kNovaSystRec.diskSize == 428, "record sizes differ from the resources'");
+	CHECK(NovaDiskOffset(&kNovaSystRec, offsetof(SystRec, nav)) == 36, "syst nav at %lu", (unsigned long) NovaDiskOffset(&kNovaSystRec, offsetof(SystRec, nav)));
+	CHECK(NovaDiskOffset(&kNovaSystRec, offsetof(SystRec, nav) + 2*3) == 42, "syst nav[3] misplaced");
+	CHECK(NovaDiskOffset(&kNovaCharRec, offsetof(CharRec, OnStart)) == 50, "char OnStart at %lu", (unsigned long) NovaDiskOffset(&kNovaCharRec, offsetof(CharRec, OnStart)));
+}
+
+int main(void)
+{
+	unsigned i;
+	srand(1);
+	for(i = 0; i < sizeof(gRecords) / sizeof(gRecords[0]); i++)
+		TestRoundTrip(gRecords[i]);
+	TestKnownValues();
+	printf("%s: %d failure%s\n", gFailures? "FAILED":"passed", gFailures, gFailures == 1? "":"s");
+	return gFailures? EXIT_FAILURE : EXIT_SUCCESS;
+}
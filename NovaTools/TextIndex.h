@@ -0,0 +1,34 @@
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+
+/*	A full-text index over the dësc and STR# resources in all open documents, for finding every description that
+	mentions something. Text is split into lower-cased words, and each word maps to the resources containing it, with
+	the positions it appears at kept per resource for phrase queries. Documents are read on a background thread as they
+	open (queries meanwhile see what has been read so far); after that the index is kept up to date from ResKnife's
+	notifications, re-reading only the resource which changed, and queries never scan the documents.
+
+	Queries are words, all of which must appear; "quoted phrases", whose words must appear in that order; and words
+	ending in '*', which match any word starting that way. Results are ranked by how often the query appears in each
+	resource, weighted towards rare words and short texts. TextIndexDidReadNotification is posted each time the
+	background thread hands a batch of resources back, so queries run while indexing can be run again. */
+
+extern NSString *TextIndexDidReadNotification;
+
+@interface TextIndex : NSObject
+{
+	NSString *descType;
+	NSMutableDictionary *entries;	// non-retained resource -> [resource, owner, word -> NSData of positions or NSNull until read, NSNumber word count]
+	NSMutableDictionary *postings;	// word -> NSMutableSet of non-retained resources containing it
+	NSArray *vocabulary;			// postings' words sorted, for prefix queries; nil when out of date
+	NSMutableSet *documents;		// non-retained NSValues of the open documents we have scanned, removed as they close
+	unsigned long totalWords;		// in every resource read, for the average length
+	unsigned readCount;
+	unsigned pendingCount;			// resources waiting for the background thread
+}
+
++ (TextIndex *)sharedIndex;
+
+- (NSArray *)resourcesMatching:(NSString *)query inDocument:(NSDocument *)document;	// best first; nil document for every document
+- (BOOL)isIndexing;
+
+@end
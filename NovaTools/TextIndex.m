@@ -0,0 +1,506 @@
+#import "TextIndex.h"
+#include <math.h>
+
+NSString *TextIndexDidReadNotification = @"TextIndexDidReadNotification";
+
+static TextIndex *gSharedIndex = nil;
+
+enum
+{
+	kEntryResource,
+	kEntryOwner,
+	kEntryWords,
+	kEntryWordCount
+};
+
+// adds the words of some MacRoman text to words, numbering them from position; returns the position after the last
+static unsigned AddWords(NSMutableDictionary *words, const unsigned char *bytes, unsigned length, unsigned position)
+{
+	NSCharacterSet *letters = [NSCharacterSet alphanumericCharacterSet];
+	NSString *text = [[[[NSString alloc] initWithBytes:bytes length:length encoding:NSMacOSRomanStringEncoding] autorelease] lowercaseString];
+	unsigned i, start = 0, count = [text length];
+	unichar *characters = (unichar *) malloc( (count + 1) * sizeof(unichar) );
+	[text getCharacters:characters];
+	for( i = 0; i <= count; i++ )
+	{
+		if( i < count && [letters characterIsMember:characters[i]] ) continue;
+		if( i > start )
+		{
+			NSString *word = [NSString stringWithCharacters:characters + start length:i - start];
+			NSMutableData *positions = [words objectForKey:word];
+			UInt32 value = position++;
+			if( !positions ) [words setObject:(positions = [NSMutableData data]) forKey:word];
+			[positions appendBytes:&value length:sizeof(value)];
+		}
+		start = i + 1;
+	}
+	free( characters );
+	return position;
+}
+
+/* Returns the words of a dësc (a C string, then the coda) or STR# (a count, then Pascal strings) with their
+	positions in ascending order, and the number of words. Thread safe. */
+static NSArray *ReadWords(NSData *data, BOOL list)
+{
+	NSMutableDictionary *words = [NSMutableDictionary dictionary];
+	const unsigned char *bytes = [data bytes];
+	unsigned length = [data length], position = 0;
+	if( list )
+	{
+		unsigned i, offset = 2, count = (length >= 2)? (bytes[0] << 8) | bytes[1] : 0;
+		for( i = 0; i < count && offset < length; i++ )
+		{
+			unsigned stringLength = bytes[offset];
+			if( offset + 1 + stringLength > length ) stringLength = length - offset - 1;
+			// leave a gap, so phrases don't run from one string into the next
+			position = AddWords( words, bytes + offset + 1, stringLength, position ) + 1;
+			offset += 1 + stringLength;
+		}
+	}
+	else
+	{
+		unsigned textLength = 0;
+		while( textLength < length && bytes[textLength] ) textLength++;
+		position = AddWords( words, bytes, textLength, 0 );
+	}
+	return [NSArray arrayWithObjects:words, [NSNumber numberWithUnsignedInt:position], nil];
+}
+
+// each clause is an array of terms, which are [word, NSNumber of whether it's a prefix]
+static NSArray *ParseQuery(NSString *query)
+{
+	NSCharacterSet *letters = [NSCharacterSet alphanumericCharacterSet];
+	NSString *text = [query lowercaseString];
+	NSMutableArray *clauses = [NSMutableArray array];
+	NSMutableArray *phrase = nil;
+	unsigned i, start = 0, count = [text length];
+	for( i = 0; i <= count; i++ )
+	{
+		unichar c = (i < count)? [text characterAtIndex:i] : ' ';
+		if( i < count && [letters characterIsMember:c] ) continue;
+		if( i > start )
+		{
+			NSArray *term = [NSArray arrayWithObjects:[text substringWithRange:NSMakeRange(start, i - start)], [NSNumber numberWithBool:(c == '*')], nil];
+			if( phrase ) [phrase addObject:term];
+			else [clauses addObject:[NSArray arrayWithObject:term]];
+		}
+		if( c == '"' )
+		{
+			if( [phrase count] ) [clauses addObject:phrase];
+			phrase = phrase? nil : [NSMutableArray array];
+		}
+		start = i + 1;
+	}
+	if( [phrase count] ) [clauses addObject:phrase];	// an unclosed quote runs to the end
+	return clauses;
+}
+
+static int CompareWords(id first, id second, void *context)
+{
+	return [(NSString *)first compare:second options:NSLiteralSearch];
+}
+
+static int CompareScores(id first, id second, void *context)
+{
+	return [[second objectAtIndex:0] compare:[first objectAtIndex:0]];
+}
+
+static BOOL ContainsPosition(NSData *positions, UInt32 position)
+{
+	const UInt32 *values = [positions bytes];
+	unsigned low = 0, high = [positions length] / sizeof(UInt32);
+	while( low < high )
+	{
+		unsigned middle = (low + high) / 2;
+		if( values[middle] < position ) low = middle + 1;
+		else high = middle;
+	}
+	return low < [positions length] / sizeof(UInt32) && values[low] == position;
+}
+
+@interface TextIndex (Private)
+- (BOOL)isIndexedType:(NSString *)type;
+- (void)scanDocument:(NSDocument *)document;
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource ofDocument:(NSDocument *)document;
+- (void)removeResource:(id <ResKnifeResourceProtocol>)resource;
+- (void)setWords:(NSArray *)words forKey:(NSValue *)key;
+- (void)readResources:(NSArray *)jobs;
+- (void)finishReading:(NSArray *)jobsAndResults;
+- (NSArray *)wordsForTerm:(NSArray *)term;
+- (NSDictionary *)matchesForClause:(NSArray *)clause owner:(NSValue *)owner;
+@end
+
+@implementation TextIndex
+
++ (TextIndex *)sharedIndex
+{
+	if( !gSharedIndex ) gSharedIndex = [[TextIndex alloc] init];
+	return gSharedIndex;
+}
+
+- (id)init
+{
+	NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+	NSDocument *document;
+	NSEnumerator *enumerator = [[[NSDocumentController sharedDocumentController] documents] objectEnumerator];
+	self = [super init];
+	if( !self ) return nil;
+	descType = [[[NSBundle bundleForClass:[TextIndex class]] localizedStringForKey:@"desc" value:@"" table:@"Resource Types"] copy];
+	entries = [[NSMutableDictionary alloc] init];
+	postings = [[NSMutableDictionary alloc] init];
+	documents = [[NSMutableSet alloc] init];
+	while( document = [enumerator nextObject] )
+		[self scanDocument:document];
+
+	[center addObserver:self selector:@selector(documentDidOpen:) name:DocumentDidOpenNotification object:nil];
+	[center addObserver:self selector:@selector(documentWillClose:) name:DocumentWillCloseNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidAddResource:) name:DataSourceDidAddResourceNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidRemoveResource:) name:DataSourceDidRemoveResourceNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDidChange:) name:ResourceDidChangeNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[descType release];
+	[entries release];
+	[postings release];
+	[vocabulary release];
+	[documents release];
+	[super dealloc];
+}
+
+- (BOOL)isIndexedType:(NSString *)type
+{
+	return [type isEqualToString:descType] || [type isEqualToString:@"STR#"];
+}
+
+- (BOOL)isIndexing
+{
+	return pendingCount > 0;
+}
+
+#pragma mark -
+#pragma mark Queries
+
+- (NSArray *)resourcesMatching:(NSString *)query inDocument:(NSDocument *)document
+{
+	NSValue *owner = document? [NSValue valueWithNonretainedObject:document] : nil;
+	NSArray *clauses = ParseQuery( query );
+	NSMutableArray *clauseMatches = [NSMutableArray arrayWithCapacity:[clauses count]];
+	NSMutableSet *found = nil;
+	NSMutableArray *scores = [NSMutableArray array], *results;
+	double averageLength;
+	NSValue *key;
+	NSArray *clause;
+	NSEnumerator *enumerator;
+	if( [clauses count] == 0 ) return [NSArray array];
+
+	// every clause must match
+	enumerator = [clauses objectEnumerator];
+	while( clause = [enumerator nextObject] )
+	{
+		NSDictionary *matches = [self matchesForClause:clause owner:owner];
+		[clauseMatches addObject:matches];
+		if( !found ) found = [NSMutableSet setWithArray:[matches allKeys]];
+		else [found intersectSet:[NSSet setWithArray:[matches allKeys]]];
+	}
+
+	// BM25: occurrences count for less the more there are and the longer the text, and rare clauses count for more
+	averageLength = readCount? (double) totalWords / readCount : 1.0;
+	if( averageLength < 1.0 ) averageLength = 1.0;
+	enumerator = [found objectEnumerator];
+	while( key = [enumerator nextObject] )
+	{
+		unsigned i;
+		double score = 0.0, length = [[[entries objectForKey:key] objectAtIndex:kEntryWordCount] doubleValue];
+		for( i = 0; i < [clauseMatches count]; i++ )
+		{
+			NSDictionary *matches = [clauseMatches objectAtIndex:i];
+			double frequency = [[matches objectForKey:key] doubleValue];
+			double rarity = log( 1.0 + (double) readCount / [matches count] );
+			score += rarity * frequency * 2.2 / (frequency + 1.2 * (0.25 + 0.75 * length / averageLength));
+		}
+		[scores addObject:[NSArray arrayWithObjects:[NSNumber numberWithDouble:score], [[entries objectForKey:key] objectAtIndex:kEntryResource], nil]];
+	}
+	[scores sortUsingFunction:CompareScores context:NULL];
+
+	results = [NSMutableArray arrayWithCapacity:[scores count]];
+	enumerator = [scores objectEnumerator];
+	while( clause = [enumerator nextObject] )
+		[results addObject:[clause objectAtIndex:1]];
+	return results;
+}
+
+- (NSArray *)wordsForTerm:(NSArray *)term
+{
+	NSString *word = [term objectAtIndex:0];
+	NSMutableArray *words;
+	unsigned low = 0, high;
+	if( ![[term objectAtIndex:1] boolValue] )
+		return [postings objectForKey:word]? [NSArray arrayWithObject:word] : [NSArray array];
+
+	// words starting with a prefix sort together, from the first not less than it
+	if( !vocabulary ) vocabulary = [[[postings allKeys] sortedArrayUsingFunction:CompareWords context:NULL] retain];
+	high = [vocabulary count];
+	while( low < high )
+	{
+		unsigned middle = (low + high) / 2;
+		if( [[vocabulary objectAtIndex:middle] compare:word options:NSLiteralSearch] == NSOrderedAscending ) low = middle + 1;
+		else high = middle;
+	}
+	words = [NSMutableArray array];
+	for( ; low < [vocabulary count] && [[vocabulary objectAtIndex:low] hasPrefix:word]; low++ )
+		[words addObject:[vocabulary objectAtIndex:low]];
+	return words;
+}
+
+// non-retained resource -> NSNumber of how many times the clause appears in it
+- (NSDictionary *)matchesForClause:(NSArray *)clause owner:(NSValue *)owner
+{
+	unsigned i;
+	NSMutableArray *termWords = [NSMutableArray arrayWithCapacity:[clause count]];
+	NSMutableDictionary *matches = [NSMutableDictionary dictionary];
+	NSMutableSet *candidates = nil;
+	NSValue *key;
+	NSEnumerator *enumerator;
+
+	// resources with some form of every word in the clause
+	for( i = 0; i < [clause count]; i++ )
+	{
+		NSArray *words = [self wordsForTerm:[clause objectAtIndex:i]];
+		NSMutableSet *containing = [NSMutableSet set];
+		NSString *word;
+		enumerator = [words objectEnumerator];
+		while( word = [enumerator nextObject] )
+			[containing unionSet:[postings objectForKey:word]];
+		if( candidates ) [candidates intersectSet:containing];
+		else candidates = containing;
+		[termWords addObject:words];
+	}
+
+	// then count where they appear in order
+	enumerator = [candidates objectEnumerator];
+	while( key = [enumerator nextObject] )
+	{
+		NSArray *entry = [entries objectForKey:key];
+		NSDictionary *positions = [entry objectAtIndex:kEntryWords];
+		unsigned frequency = 0;
+		NSString *word;
+		NSEnumerator *wordEnumerator = [[termWords objectAtIndex:0] objectEnumerator];
+		if( owner && ![[entry objectAtIndex:kEntryOwner] isEqual:owner] ) continue;
+		while( word = [wordEnumerator nextObject] )
+		{
+			NSData *starts = [positions objectForKey:word];
+			const UInt32 *values = [starts bytes];
+			unsigned j, count = [starts length] / sizeof(UInt32);
+			if( [clause count] == 1 )
+			{
+				frequency += count;
+				continue;
+			}
+			for( j = 0; j < count; j++ )
+			{
+				unsigned k;
+				for( k = 1; k < [clause count]; k++ )
+				{
+					NSString *next;
+					NSEnumerator *nextEnumerator = [[termWords objectAtIndex:k] objectEnumerator];
+					while( next = [nextEnumerator nextObject] )
+						if( [positions objectForKey:next] && ContainsPosition( [positions objectForKey:next], values[j] + k ) )
+							break;
+					if( !next ) break;
+				}
+				if( k == [clause count] ) frequency++;
+			}
+		}
+		if( frequency ) [matches setObject:[NSNumber numberWithUnsignedInt:frequency] forKey:key];
+	}
+	return matches;
+}
+
+#pragma mark -
+#pragma mark Maintenance
+
+/* Queues a document's text for the background thread when it opens (or when we're created). */
+- (void)scanDocument:(NSDocument *)document
+{
+	unsigned i;
+	NSValue *owner = [NSValue valueWithNonretainedObject:document];
+	NSArray *types = [NSArray arrayWithObjects:descType, @"STR#", nil];
+	NSMutableArray *jobs = [NSMutableArray array];
+	if( [documents containsObject:owner] ) return;
+	for( i = 0; i < [types count]; i++ )
+	{
+		id <ResKnifeResourceProtocol> resource;
+		NSEnumerator *enumerator = [[NSClassFromString(@"Resource") allResourcesOfType:[types objectAtIndex:i] inDocument:document] objectEnumerator];
+		while( resource = [enumerator nextObject] )
+		{
+			NSData *data = [resource data];
+			NSValue *key = [NSValue valueWithNonretainedObject:resource];
+			if( [entries objectForKey:key] ) continue;
+			[entries setObject:[NSArray arrayWithObjects:resource, owner, [NSNull null], [NSNumber numberWithUnsignedInt:0], nil] forKey:key];
+			[jobs addObject:[NSArray arrayWithObjects:key, data? data : [NSData data], [NSNumber numberWithBool:(i == 1)], nil]];
+		}
+	}
+	[documents addObject:owner];
+
+	// resources are only touched on this thread; the background thread gets their data
+	if( [jobs count] )
+	{
+		pendingCount += [jobs count];
+		[NSThread detachNewThreadSelector:@selector(readResources:) toTarget:self withObject:jobs];
+	}
+}
+
+- (void)readResources:(NSArray *)jobs
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+	NSMutableArray *results = [NSMutableArray arrayWithCapacity:[jobs count]];
+	NSArray *job;
+	NSEnumerator *enumerator = [jobs objectEnumerator];
+	while( job = [enumerator nextObject] )
+		[results addObject:ReadWords( [job objectAtIndex:1], [[job objectAtIndex:2] boolValue] )];
+	[self performSelectorOnMainThread:@selector(finishReading:) withObject:[NSArray arrayWithObjects:jobs, results, nil] waitUntilDone:NO];
+	[pool release];
+}
+
+- (void)finishReading:(NSArray *)jobsAndResults
+{
+	unsigned i;
+	NSArray *jobs = [jobsAndResults objectAtIndex:0], *results = [jobsAndResults objectAtIndex:1];
+	for( i = 0; i < [jobs count]; i++ )
+	{
+		NSValue *key = [[jobs objectAtIndex:i] objectAtIndex:0];
+		NSArray *entry = [entries objectForKey:key];
+		// resources removed or given new data meanwhile have been dealt with already
+		if( entry && [(id <ResKnifeResourceProtocol>)[entry objectAtIndex:kEntryResource] data] == [[jobs objectAtIndex:i] objectAtIndex:1] )
+			[self setWords:[results objectAtIndex:i] forKey:key];
+	}
+	pendingCount -= [jobs count];
+	[[NSNotificationCenter defaultCenter] postNotificationName:TextIndexDidReadNotification object:self];
+}
+
+- (void)addResource:(id <ResKnifeResourceProtocol>)resource ofDocument:(NSDocument *)document
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	NSData *data = [resource data];
+	if( [entries objectForKey:key] ) return;
+	[entries setObject:[NSArray arrayWithObjects:resource, [NSValue valueWithNonretainedObject:document], [NSNull null], [NSNumber numberWithUnsignedInt:0], nil] forKey:key];
+	[self setWords:ReadWords( data? data : [NSData data], ![[resource type] isEqualToString:descType] ) forKey:key];
+}
+
+- (void)removeResource:(id <ResKnifeResourceProtocol>)resource
+{
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	if( ![entries objectForKey:key] ) return;
+	[self setWords:nil forKey:key];
+	[entries removeObjectForKey:key];
+}
+
+// replaces the words indexed for a resource; nil just removes them
+- (void)setWords:(NSArray *)words forKey:(NSValue *)key
+{
+	NSArray *entry = [[[entries objectForKey:key] retain] autorelease];
+	NSDictionary *old = [entry objectAtIndex:kEntryWords];
+	NSString *word;
+	NSEnumerator *enumerator;
+	if( old != (id) [NSNull null] )
+	{
+		enumerator = [old keyEnumerator];
+		while( word = [enumerator nextObject] )
+		{
+			NSMutableSet *containing = [postings objectForKey:word];
+			[containing removeObject:key];
+			if( [containing count] == 0 )
+			{
+				[postings removeObjectForKey:word];
+				[vocabulary release];
+				vocabulary = nil;
+			}
+		}
+		totalWords -= [[entry objectAtIndex:kEntryWordCount] unsignedIntValue];
+		readCount--;
+	}
+	if( !words )
+	{
+		[entries setObject:[NSArray arrayWithObjects:[entry objectAtIndex:kEntryResource], [entry objectAtIndex:kEntryOwner], [NSNull null], [NSNumber numberWithUnsignedInt:0], nil] forKey:key];
+		return;
+	}
+
+	enumerator = [[words objectAtIndex:0] keyEnumerator];
+	while( word = [enumerator nextObject] )
+	{
+		NSMutableSet *containing = [postings objectForKey:word];
+		if( !containing )
+		{
+			[postings setObject:(containing = [NSMutableSet set]) forKey:word];
+			[vocabulary release];
+			vocabulary = nil;
+		}
+		[containing addObject:key];
+	}
+	totalWords += [[words objectAtIndex:1] unsignedIntValue];
+	readCount++;
+	[entries setObject:[NSArray arrayWithObjects:[entry objectAtIndex:kEntryResource], [entry objectAtIndex:kEntryOwner], [words objectAtIndex:0], [words objectAtIndex:1], nil] forKey:key];
+}
+
+#pragma mark -
+#pragma mark Notifications
+
+- (void)documentDidOpen:(NSNotification *)notification
+{
+	[self scanDocument:[notification object]];
+}
+
+- (void)documentWillClose:(NSNotification *)notification
+{
+	// forget the document before it goes, so a new one at the same address isn't mistaken for it
+	NSValue *owner = [NSValue valueWithNonretainedObject:[notification object]];
+	NSArray *entry;
+	NSEnumerator *enumerator;
+	if( ![documents containsObject:owner] ) return;
+	[documents removeObject:owner];
+	enumerator = [[entries allValues] objectEnumerator];
+	while( entry = [enumerator nextObject] )
+		if( [[entry objectAtIndex:kEntryOwner] isEqual:owner] )
+			[self removeResource:[entry objectAtIndex:kEntryResource]];
+}
+
+- (void)dataSourceDidAddResource:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [[notification object] objectForKey:@"Resource"];
+	NSDocument *document;
+	if( ![self isIndexedType:[resource type]] ) return;
+	document = [resource document];
+	if( document && [documents containsObject:[NSValue valueWithNonretainedObject:document]] )
+		[self addResource:resource ofDocument:document];
+}
+
+- (void)dataSourceDidRemoveResource:(NSNotification *)notification
+{
+	[self removeResource:[[notification object] objectForKey:@"Resource"]];
+}
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [notification object];
+	NSValue *key = [NSValue valueWithNonretainedObject:resource];
+	if( [entries objectForKey:key] && [resource data] )
+		[self setWords:ReadWords( [resource data], ![[resource type] isEqualToString:descType] ) forKey:key];
+}
+
+// a resource's type may have changed to or from one we index
+- (void)resourceDidChange:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [notification object];
+	BOOL indexed = [entries objectForKey:[NSValue valueWithNonretainedObject:resource]] != nil;
+	if( indexed && ![self isIndexedType:[resource type]] )
+		[self removeResource:resource];
+	else if( !indexed && [self isIndexedType:[resource type]] && [resource document] && [documents containsObject:[NSValue valueWithNonretainedObject:[resource document]]] )
+		[self addResource:resource ofDocument:[resource document]];
+}
+
+@end
@@ -0,0 +1,19 @@
+#import <Cocoa/Cocoa.h>
+
+/*	The Find in Descriptions window: a query field over the TextIndex and a table of the dësc and STR# resources
+	matching it in all open documents, best first. Results update as the query is typed, since a query is a few
+	dictionary lookups, and double-clicking one opens it in its editor. There's one of these, built in code. */
+
+@interface TextSearchWindowController : NSWindowController
+{
+	NSArray *results;				// resources, as the index returned them
+	NSTextField *queryField;
+	NSTableView *resultsTable;
+	NSTextField *summaryField;
+}
+
++ (TextSearchWindowController *)sharedController;
+- (IBAction)runQuery:(id)sender;
+- (IBAction)openResult:(id)sender;
+
+@end
@@ -0,0 +1,166 @@
+#import "TextSearchWindowController.h"
+#import "TextIndex.h"
+#import "ResKnifeResourceProtocol.h"
+
+#define SearchString(s)	NSLocalizedStringFromTableInBundle(s, nil, [NSBundle bundleForClass:[TextSearchWindowController class]], nil)
+
+static TextSearchWindowController *gSharedController = nil;
+
+@interface TextSearchWindowController (Private)
+- (void)buildWindow;
+@end
+
+@implementation TextSearchWindowController
+
++ (TextSearchWindowController *)sharedController
+{
+	if( !gSharedController ) gSharedController = [[TextSearchWindowController alloc] init];
+	return gSharedController;
+}
+
+- (id)init
+{
+	NSWindow *window = [[[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 460, 320) styleMask:NSTitledWindowMask | NSClosableWindowMask | NSResizableWindowMask | NSUtilityWindowMask backing:NSBackingStoreBuffered defer:YES] autorelease];
+	self = [super initWithWindow:window];
+	if( !self ) return nil;
+	results = [[NSArray alloc] init];
+	[self buildWindow];
+	[window setTitle:SearchString(@"Find in Descriptions")];
+	[window setHidesOnDeactivate:YES];
+	[window setInitialFirstResponder:queryField];
+	[window center];
+
+	// the index hears of these too, so the query is run again once it has caught up (see -resourcesDidChange:)
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourcesDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(resourcesDidChange:) name:DocumentWillCloseNotification object:nil];
+	[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(indexDidRead:) name:TextIndexDidReadNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[resultsTable setDataSource:nil];
+	[results release];
+	[super dealloc];
+}
+
+- (void)buildWindow
+{
+	NSView *content = [[self window] contentView];
+	NSRect frame = [content frame];
+	NSScrollView *scrollView;
+	NSTableColumn *column;
+
+	queryField = [[[NSTextField alloc] initWithFrame:NSMakeRect(12, NSMaxY(frame) - 34, NSWidth(frame) - 24, 22)] autorelease];
+	[queryField setAutoresizingMask:NSViewMinYMargin | NSViewWidthSizable];
+	[queryField setTarget:self];
+	[queryField setAction:@selector(runQuery:)];
+	[queryField setDelegate:self];
+	[content addSubview:queryField];
+
+	scrollView = [[[NSScrollView alloc] initWithFrame:NSMakeRect(-1, 28, NSWidth(frame) + 2, NSHeight(frame) - 72)] autorelease];
+	[scrollView setHasVerticalScroller:YES];
+	[scrollView setBorderType:NSBezelBorder];
+	[scrollView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+	resultsTable = [[[NSTableView alloc] initWithFrame:[[scrollView contentView] bounds]] autorelease];
+	[resultsTable setUsesAlternatingRowBackgroundColors:YES];
+	[resultsTable setDataSource:self];
+	[resultsTable setTarget:self];
+	[resultsTable setDoubleAction:@selector(openResult:)];
+	column = [[[NSTableColumn alloc] initWithIdentifier:@"type"] autorelease];
+	[[column headerCell] setStringValue:SearchString(@"Type")];
+	[column setWidth:50];
+	[column setEditable:NO];
+	[resultsTable addTableColumn:column];
+	column = [[[NSTableColumn alloc] initWithIdentifier:@"resID"] autorelease];
+	[[column headerCell] setStringValue:SearchString(@"ID")];
+	[column setWidth:60];
+	[column setEditable:NO];
+	[resultsTable addTableColumn:column];
+	column = [[[NSTableColumn alloc] initWithIdentifier:@"name"] autorelease];
+	[[column headerCell] setStringValue:SearchString(@"Name")];
+	[column setWidth:200];
+	[column setEditable:NO];
+	[resultsTable addTableColumn:column];
+	column = [[[NSTableColumn alloc] initWithIdentifier:@"document"] autorelease];
+	[[column headerCell] setStringValue:SearchString(@"File")];
+	[column setWidth:120];
+	[column setEditable:NO];
+	[resultsTable addTableColumn:column];
+	[scrollView setDocumentView:resultsTable];
+	[content addSubview:scrollView];
+
+	summaryField = [[[NSTextField alloc] initWithFrame:NSMakeRect(12, 6, NSWidth(frame) - 24, 16)] autorelease];
+	[summaryField setEditable:NO];
+	[summaryField setBordered:NO];
+	[summaryField setDrawsBackground:NO];
+	[summaryField setFont:[NSFont systemFontOfSize:[NSFont smallSystemFontSize]]];
+	[summaryField setAutoresizingMask:NSViewWidthSizable | NSViewMaxYMargin];
+	[summaryField setStringValue:SearchString(@"Words, \"phrases\" and prefix* are all matched.")];
+	[content addSubview:summaryField];
+}
+
+#pragma mark -
+
+- (IBAction)runQuery:(id)sender
+{
+	TextIndex *index = [TextIndex sharedIndex];
+	id old = results;
+	results = [[index resourcesMatching:[queryField stringValue] inDocument:nil] retain];
+	[old release];
+	[resultsTable reloadData];
+	if( [[queryField stringValue] isEqualToString:@""] )
+		[summaryField setStringValue:SearchString(@"Words, \"phrases\" and prefix* are all matched.")];
+	else if( [index isIndexing] )
+		[summaryField setStringValue:[NSString stringWithFormat:SearchString(@"%u found so far; still reading the open files."), [results count]]];
+	else [summaryField setStringValue:[NSString stringWithFormat:SearchString(@"%u found."), [results count]]];
+}
+
+- (IBAction)openResult:(id)sender
+{
+	int row = [resultsTable clickedRow];
+	id <ResKnifeResourceProtocol> resource;
+	if( row < 0 || row >= (int) [results count] ) return;
+	resource = [results objectAtIndex:row];
+	[(id)[resource document] openResourceUsingEditor:resource];
+}
+
+- (void)controlTextDidChange:(NSNotification *)notification
+{
+	[self runQuery:nil];
+}
+
+// observers aren't called in any particular order, so wait for the next pass of the run loop
+- (void)resourcesDidChange:(NSNotification *)notification
+{
+	if( [[self window] isVisible] && ![[queryField stringValue] isEqualToString:@""] )
+		[self performSelector:@selector(runQuery:) withObject:nil afterDelay:0.0];
+}
+
+// posted once the index has what the background thread read, so the results and summary can be brought up to date now
+- (void)indexDidRead:(NSNotification *)notification
+{
+	if( [[self window] isVisible] && ![[queryField stringValue] isEqualToString:@""] )
+		[self runQuery:nil];
+}
+
+#pragma mark -
+#pragma mark Table Management
+
+- (int)numberOfRowsInTableView:(NSTableView *)tableView
+{
+	return [results count];
+}
+
+- (id)tableView:(NSTableView *)tableView objectValueForTableColumn:(NSTableColumn *)tableColumn row:(int)row
+{
+	id <ResKnifeResourceProtocol> resource = [results objectAtIndex:row];
+	NSString *identifier = [tableColumn identifier];
+	if( [identifier isEqualToString:@"type"] )		return [resource type];
+	if( [identifier isEqualToString:@"resID"] )		return [resource resID];
+	if( [identifier isEqualToString:@"name"] )		return [resource name];
+	return [[resource document] displayName];
+}
+
+@end
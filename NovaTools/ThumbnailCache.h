@@ -0,0 +1,27 @@
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+
+/*	Small bitmaps of PICTs, rlë sprites (their first frame) and spïns (their sprites, or the PICT used in their place),
+	made on a background thread so editors never decode whole images while the user waits. Thumbnails are kept by
+	document, type, ID and the data they were made from, so a resource given new data is redrawn the next time it's
+	asked for. Asking for one which isn't ready yet returns nil and queues it; ThumbnailCacheDidLoadNotification is
+	posted to the cache's own notification center once it is, with the type and ID in its userInfo, and the editor
+	asks again. */
+
+extern NSString *ThumbnailCacheDidLoadNotification;
+
+@interface ThumbnailCache : NSObject
+{
+	NSNotificationCenter *notificationCenter;
+	NSMutableDictionary *thumbnails;	// [document, type, ID] -> [data drawn, NSValue of size, NSImage, NSNull while queued, or NSNumber if it can't be drawn]
+	NSMutableArray *recent;				// keys of thumbnails, least recently used first
+	NSMutableArray *queue;				// jobs waiting for the background thread
+	NSConditionLock *queueLock;			// condition is whether the queue has anything in it
+}
+
++ (ThumbnailCache *)sharedCache;
+- (NSNotificationCenter *)notificationCenter;
+
+- (NSImage *)thumbnailOfType:(NSString *)type resID:(NSNumber *)resID inDocument:(NSDocument *)document size:(NSSize)size;
+
+@end
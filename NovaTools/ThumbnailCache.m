@@ -0,0 +1,269 @@
+#import "ThumbnailCache.h"
+#import "Structs.h"
+#import "NovaCodec.h"
+#import "RLEDecoder.h"
+#import "../PICT Editor/Classes/Parser.h"
+#import "../Cocoa/Classes/RKPaletteCache.h"
+
+NSString *ThumbnailCacheDidLoadNotification = @"ThumbnailCacheDidLoadNotification";
+
+enum
+{
+	kThumbnailCacheSize = 64,
+
+	kThumbnailPICT = 0,
+	kThumbnailSprite,
+
+	// thumbnails entries
+	kEntryData = 0,
+	kEntrySize,
+	kEntryImage,
+
+	// jobs for the background thread
+	kJobKey = 0,
+	kJobData,
+	kJobKind,
+	kJobColourTable,
+	kJobSize
+};
+
+static ThumbnailCache *gSharedCache = nil;
+
+static NSString *TypeName(NSString *key)
+{
+	return [[NSBundle bundleForClass:[ThumbnailCache class]] localizedStringForKey:key value:@"" table:@"Resource Types"];
+}
+
+@interface ThumbnailCache (Private)
+- (NSArray *)jobForType:(NSString *)type resID:(NSNumber *)resID inDocument:(NSDocument *)document;
+- (void)workThread:(id)unused;
+- (NSBitmapImageRep *)thumbnailForJob:(NSArray *)job;
+- (void)finishJob:(NSArray *)jobAndThumbnail;
+@end
+
+@implementation ThumbnailCache
+
++ (ThumbnailCache *)sharedCache
+{
+	if( !gSharedCache ) gSharedCache = [[ThumbnailCache alloc] init];
+	return gSharedCache;
+}
+
+- (id)init
+{
+	self = [super init];
+	if( !self ) return nil;
+	notificationCenter = [[NSNotificationCenter alloc] init];
+	thumbnails = [[NSMutableDictionary alloc] init];
+	recent = [[NSMutableArray alloc] init];
+	queue = [[NSMutableArray alloc] init];
+	queueLock = [[NSConditionLock alloc] initWithCondition:0];
+	[NSThread detachNewThreadSelector:@selector(workThread:) toTarget:self withObject:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[notificationCenter release];
+	[thumbnails release];
+	[recent release];
+	[queue release];
+	[queueLock release];
+	[super dealloc];
+}
+
+- (NSNotificationCenter *)notificationCenter
+{
+	return notificationCenter;
+}
+
+- (NSImage *)thumbnailOfType:(NSString *)type resID:(NSNumber *)resID inDocument:(NSDocument *)document size:(NSSize)size
+{
+	NSArray *key = [NSArray arrayWithObjects:[NSValue valueWithNonretainedObject:document], type, resID, nil];
+	NSArray *job = [self jobForType:type resID:resID inDocument:document];
+	NSArray *entry = [thumbnails objectForKey:key];
+	if( !job ) return nil;
+
+	[recent removeObject:key];
+	[recent addObject:key];
+	if( entry && [entry objectAtIndex:kEntryData] == [job objectAtIndex:kJobData] && NSEqualSizes( [[entry objectAtIndex:kEntrySize] sizeValue], size ) )
+	{
+		id image = [entry objectAtIndex:kEntryImage];
+		return [image isKindOfClass:[NSImage class]]? image : nil;
+	}
+
+	// new, or given new data since: queue it, newest first as that's what is being looked at
+	[thumbnails setObject:[NSArray arrayWithObjects:[job objectAtIndex:kJobData], [NSValue valueWithSize:size], [NSNull null], nil] forKey:key];
+	if( [recent count] > kThumbnailCacheSize )
+	{
+		[thumbnails removeObjectForKey:[recent objectAtIndex:0]];
+		[recent removeObjectAtIndex:0];
+	}
+	job = [NSArray arrayWithObjects:key, [job objectAtIndex:kJobData], [job objectAtIndex:kJobKind], [job objectAtIndex:kJobColourTable], [NSValue valueWithSize:size], nil];
+	[queueLock lock];
+	[queue addObject:job];
+	[queueLock unlockWithCondition:1];
+	return nil;
+}
+
+/* Finds the data to draw, on this thread as resources may only be touched here: [nil, data, kind, colour table]
+	with the key and size still to be filled in. The colour table is the one a sprite's drawn with, from the shared
+	RKPaletteCache, or empty. */
+- (NSArray *)jobForType:(NSString *)type resID:(NSNumber *)resID inDocument:(NSDocument *)document
+{
+	Class resourceClass = NSClassFromString(@"Resource");
+	id <ResKnifeResourceProtocol> resource = nil;
+	NSData *data, *table;
+	RLEHeader header;
+	if( [type isEqualToString:TypeName(@"spin")] )
+	{
+		SpinRec spinRec;
+		NSData *spinData = [(id <ResKnifeResourceProtocol>)[resourceClass resourceOfType:type andID:resID inDocument:document] data];
+		if( !spinData ) return nil;
+		NovaDecodeRecord( &kNovaSpinRec, [spinData bytes], [spinData length], &spinRec );
+		resID = [NSNumber numberWithShort:spinRec.SpritesID];
+		resource = [resourceClass resourceOfType:TypeName(@"rleD") andID:resID inDocument:document];
+		if( !resource ) resource = [resourceClass resourceOfType:TypeName(@"rle8") andID:resID inDocument:document];
+		if( !resource ) resource = [resourceClass resourceOfType:TypeName(@"PICT") andID:resID inDocument:document];
+	}
+	else resource = [resourceClass resourceOfType:type andID:resID inDocument:document];
+
+	data = [resource data];
+	if( !data ) return nil;
+	if( [[resource type] isEqualToString:TypeName(@"PICT")] )
+		return [NSArray arrayWithObjects:[NSNull null], data, [NSNumber numberWithInt:kThumbnailPICT], [NSData data], nil];
+	if( !RLEReadHeader( [data bytes], [data length], &header ) )
+		return nil;
+	table = [[NSClassFromString(@"RKPaletteCache") sharedCache] colourTableWithID:header.palette depth:8 inDocument:[resource document]];
+	return [NSArray arrayWithObjects:[NSNull null], data, [NSNumber numberWithInt:kThumbnailSprite], table, nil];
+}
+
+#pragma mark -
+
+- (void)workThread:(id)unused
+{
+	while( YES )
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		NSArray *job;
+		NSBitmapImageRep *thumbnail;
+		[queueLock lockWhenCondition:1];
+		job = [[[queue lastObject] retain] autorelease];
+		[queue removeLastObject];
+		[queueLock unlockWithCondition:[queue count]? 1:0];
+
+		thumbnail = [self thumbnailForJob:job];
+		[self performSelectorOnMainThread:@selector(finishJob:) withObject:[NSArray arrayWithObjects:job, thumbnail? (id) thumbnail : (id) [NSNull null], nil] waitUntilDone:NO];
+		[pool release];
+	}
+}
+
+/* Scales the image to fit the size asked for (never up), drawing with Quartz into the bitmap's own buffer. PICTs and
+	sprites are decoded to pixels first; only PICTs the decoder can't draw completely go through AppKit. */
+- (NSBitmapImageRep *)thumbnailForJob:(NSArray *)job
+{
+	NSData *data = [job objectAtIndex:kJobData];
+	NSSize size = [[job objectAtIndex:kJobSize] sizeValue];
+	NSSize imageSize;
+	NSPICTImageRep *picture = nil;
+	UInt8 *pixels = NULL;
+	RLEHeader header;
+	NSBitmapImageRep *thumbnail;
+	CGColorSpaceRef space;
+	CGContextRef context;
+	float scale;
+	int width, height;
+
+	if( [[job objectAtIndex:kJobKind] intValue] == kThumbnailPICT )
+	{
+		// text and QuickTime images need QuickDraw itself, so pictures with them are left to NSPICTImageRep
+		PictRect frame;
+		if( PictReadFrame( [data bytes], [data length], &frame ) == kPictNoError )
+		{
+			imageSize = NSMakeSize( frame.right - frame.left, frame.bottom - frame.top );
+			pixels = (UInt8 *) calloc( (frame.right - frame.left) * (frame.bottom - frame.top), 4 );
+			if( pixels && PictDraw( [data bytes], [data length], pixels, (frame.right - frame.left) * 4 ) != kPictNoError )
+			{
+				free( pixels );
+				pixels = NULL;
+			}
+		}
+		if( !pixels )
+		{
+			picture = [[[NSPICTImageRep alloc] initWithData:data] autorelease];
+			if( !picture ) return nil;
+			imageSize = [picture size];
+		}
+	}
+	else
+	{
+		NSData *table = [job objectAtIndex:kJobColourTable];
+		UInt32 offset;
+		if( !RLEReadHeader( [data bytes], [data length], &header ) ) return nil;
+		header.frameCount = 1;
+		if( RLEIndexFrames( [data bytes], [data length], &header, &offset ) == 0 ) return nil;
+		pixels = (UInt8 *) calloc( header.width * header.height, 4 );
+		RLEDecodeFrame( [data bytes], [data length], offset, &header, (const ColourTable *) [table bytes], pixels );
+		imageSize = NSMakeSize( header.width, header.height );
+	}
+	if( imageSize.width < 1.0 || imageSize.height < 1.0 )
+	{
+		free( pixels );
+		return nil;
+	}
+
+	scale = MIN( 1.0, MIN( size.width / imageSize.width, size.height / imageSize.height ) );
+	width = MAX( 1, (int) (imageSize.width * scale + 0.5) );
+	height = MAX( 1, (int) (imageSize.height * scale + 0.5) );
+	thumbnail = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:width pixelsHigh:height bitsPerSample:8 samplesPerPixel:4 hasAlpha:YES isPlanar:NO colorSpaceName:NSDeviceRGBColorSpace bytesPerRow:width * 4 bitsPerPixel:32] autorelease];
+	memset( [thumbnail bitmapData], 0, width * height * 4 );
+	space = CGColorSpaceCreateDeviceRGB();
+	context = CGBitmapContextCreate( [thumbnail bitmapData], width, height, 8, width * 4, space, kCGImageAlphaPremultipliedLast );
+	CGContextSetInterpolationQuality( context, kCGInterpolationHigh );
+
+	if( picture )
+	{
+		// the graphics context is this thread's own, so AppKit can draw into it here
+		[NSGraphicsContext saveGraphicsState];
+		[NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithGraphicsPort:context flipped:NO]];
+		[picture drawInRect:NSMakeRect( 0, 0, width, height )];
+		[NSGraphicsContext restoreGraphicsState];
+	}
+	else
+	{
+		size_t imageWidth = (size_t) imageSize.width, imageHeight = (size_t) imageSize.height;
+		CGDataProviderRef provider = CGDataProviderCreateWithData( NULL, pixels, imageWidth * imageHeight * 4, NULL );
+		CGImageRef image = CGImageCreate( imageWidth, imageHeight, 8, 32, imageWidth * 4, space, kCGImageAlphaPremultipliedLast, provider, NULL, true, kCGRenderingIntentDefault );
+		CGContextDrawImage( context, CGRectMake( 0, 0, width, height ), image );
+		CGImageRelease( image );
+		CGDataProviderRelease( provider );
+		free( pixels );
+	}
+	CGContextRelease( context );
+	CGColorSpaceRelease( space );
+	return thumbnail;
+}
+
+- (void)finishJob:(NSArray *)jobAndThumbnail
+{
+	NSArray *job = [jobAndThumbnail objectAtIndex:0];
+	id thumbnail = [jobAndThumbnail objectAtIndex:1];
+	NSArray *key = [job objectAtIndex:kJobKey];
+	NSArray *entry = [thumbnails objectForKey:key];
+	id image;
+
+	// dropped from the cache or asked for again with new data or another size in the meantime
+	if( !entry || [entry objectAtIndex:kEntryData] != [job objectAtIndex:kJobData] || ![[entry objectAtIndex:kEntrySize] isEqual:[job objectAtIndex:kJobSize]] )
+		return;
+	if( thumbnail != [NSNull null] )
+	{
+		image = [[[NSImage alloc] initWithSize:[thumbnail size]] autorelease];
+		[image addRepresentation:thumbnail];
+	}
+	else image = [NSNumber numberWithBool:NO];
+	[thumbnails setObject:[NSArray arrayWithObjects:[entry objectAtIndex:kEntryData], [entry objectAtIndex:kEntrySize], image, nil] forKey:key];
+	if( thumbnail != [NSNull null] )
+		[notificationCenter postNotificationName:ThumbnailCacheDidLoadNotification object:self userInfo:[NSDictionary dictionaryWithObjectsAndKeys:[key objectAtIndex:1], @"Type", [key objectAtIndex:2], @"ID", nil]];
+}
+
+@end
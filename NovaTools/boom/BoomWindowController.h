@@ -1,5 +1,6 @@
 #import <Cocoa/Cocoa.h>
 #import "NovaWindowController.h"
+#import "RLESprite.h"
 
 enum	// boom defaults
 {
@@ -31,9 +32,17 @@ enum	// boom defaults
 	NSNumber *sound;
 	NSNumber *frameRate;
 	BOOL silent;
+	
+	// animation
+	RLESprite *sprite;
+	NSTimer *animationTimer;
+	float frame;
 }
 
 - (void)update;
+- (void)loadSprite;
+- (void)thumbnailDidLoad:(NSNotification *)notification;
+- (void)animate:(NSTimer *)timer;
 - (void)controlTextDidChange:(NSNotification *)notification;
 - (IBAction)toggleSilence:(id)sender;
 - (IBAction)playSound:(id)sender;
@@ -1,4 +1,6 @@
 #import "BoomWindowController.h"
+#import "NovaValidator.h"
+#import "ThumbnailCache.h"
 
 @implementation BoomWindowController
 
@@ -8,7 +10,7 @@
 	if( !self ) return nil;
 	
 	boomRec = (BoomRec *) calloc( 1, sizeof(BoomRec) );
-	[[newResource data] getBytes:boomRec];
+	NovaDecodeRecord( &kNovaBoomRec, [[newResource data] bytes], [[newResource data] length], boomRec );
 	
 	// fill in default values if necessary
 	if( boomRec->GraphicIndex < 0 || boomRec->GraphicIndex > 63 )
@@ -41,9 +43,10 @@
 	[localCenter addObserver:self selector:@selector(comboBoxWillPopUp:) name:NSComboBoxWillPopUpNotification object:nil];
 	[localCenter addObserver:self selector:@selector(controlTextDidChange:) name:NSComboBoxWillDismissNotification object:nil];
 	[localCenter addObserver:self selector:@selector(controlTextDidChange:) name:NSControlTextDidChangeNotification object:nil];
+	[[[ThumbnailCache sharedCache] notificationCenter] addObserver:self selector:@selector(thumbnailDidLoad:) name:ThumbnailCacheDidLoadNotification object:nil];
 	
 	// mark window changed if initial values were invalid
-	if( ![[resource data] isEqualToData:[NSData dataWithBytes:boomRec length:sizeof(BoomRec)]] )
+	if( ![[resource data] isEqualToData:[NovaWindowController dataWithRecord:boomRec format:&kNovaBoomRec]] )
 	{
 		[resource touch];
 		[self setDocumentEdited:YES];
@@ -65,8 +68,66 @@
 	[soundField setEnabled:!silent];
 	[playButton setEnabled:!silent];
 	
-	// image well
-	[imageWell setImage:[[[NSImage alloc] initWithData:[(id <ResKnifeResourceProtocol>)[NSClassFromString(@"Resource") resourceOfType:[plugBundle localizedStringForKey:@"spin" value:@"" table:@"Resource Types"] andID:image inDocument:nil] data]] autorelease]];
+	[self loadSprite];
+}
+
+// fills the image well, animated if the spin's sprites are an rle
+- (void)loadSprite
+{
+	SpinRec spinRec;
+	NSData *spinData;
+	NSNumber *spritesID;
+	id <ResKnifeResourceProtocol> sprites;
+	
+	spinData = [(id <ResKnifeResourceProtocol>)[NSClassFromString(@"Resource") resourceOfType:[plugBundle localizedStringForKey:@"spin" value:@"" table:@"Resource Types"] andID:image inDocument:nil] data];
+	NovaDecodeRecord( &kNovaSpinRec, [spinData bytes], [spinData length], &spinRec );
+	spritesID = [NSNumber numberWithShort:spinRec.SpritesID];
+	sprites = [NSClassFromString(@"Resource") resourceOfType:[plugBundle localizedStringForKey:@"rleD" value:@"" table:@"Resource Types"] andID:spritesID inDocument:nil];
+	if( !sprites ) sprites = [NSClassFromString(@"Resource") resourceOfType:[plugBundle localizedStringForKey:@"rle8" value:@"" table:@"Resource Types"] andID:spritesID inDocument:nil];
+	[sprite release];
+	sprite = [[RLESprite spriteForResource:sprites] retain];
+	frame = 0.0;
+	if( sprite && [sprite frameCount] > 0 )
+	{
+		[imageWell setImage:[sprite imageForFrame:0]];
+		if( !animationTimer )
+			animationTimer = [[NSTimer scheduledTimerWithTimeInterval:1.0/30.0 target:self selector:@selector(animate:) userInfo:nil repeats:YES] retain];
+	}
+	else
+	{
+		// drawn in the background; thumbnailDidLoad: comes back here once it has been
+		[imageWell setImage:[[ThumbnailCache sharedCache] thumbnailOfType:[plugBundle localizedStringForKey:@"PICT" value:@"" table:@"Resource Types"] resID:spritesID inDocument:nil size:[imageWell bounds].size]];
+	}
+}
+
+// Nova runs at 30 frames a second, and the frame advance is a percentage of that
+- (void)animate:(NSTimer *)timer
+{
+	if( !sprite || [sprite frameCount] == 0 ) return;
+	if( [frameRate floatValue] > 0.0 ) frame += [frameRate floatValue] / 100.0;
+	while( frame >= [sprite frameCount] ) frame -= [sprite frameCount];
+	[imageWell setImage:[sprite imageForFrame:(unsigned) frame]];
+}
+
+- (void)thumbnailDidLoad:(NSNotification *)notification
+{
+	if( !sprite ) [self loadSprite];
+}
+
+- (void)windowWillClose:(NSNotification *)notification
+{
+	[[[ThumbnailCache sharedCache] notificationCenter] removeObserver:self];
+
+	// the timer retains us, so it must go before we can
+	[animationTimer invalidate];
+	[animationTimer release];
+	animationTimer = nil;
+}
+
+- (void)dealloc
+{
+	[sprite release];
+	[super dealloc];
 }
 
 - (void)comboBoxWillPopUp:(NSNotification *)notification
@@ -88,7 +149,11 @@
 	{
 		id old = image;
 		image = [[DataSource resIDFromStringValue:[sender stringValue]] retain];
-		if( ![image isEqualToNumber:old] ) [resource touch];
+		if( ![image isEqualToNumber:old] )
+		{
+			[resource touch];
+			[self loadSprite];
+		}
 		[old release];
 	}
 	else if( sender == soundField && [sender stringValue]  )
@@ -133,30 +198,20 @@
 
 - (NSDictionary *)validateValues
 {
-	NSMutableDictionary *errorValues = [NSMutableDictionary dictionary];
-	
 	// put current values into boomRec
 	boomRec->GraphicIndex = [image shortValue] - kMinBoomSpinID;
 	boomRec->SoundIndex = [sound shortValue] - kMinBoomSoundID;
 	boomRec->FrameAdvance = [frameRate shortValue];
 	if( silent ) boomRec->SoundIndex = -1;
 	
-	// verify values are valid
-	if( boomRec->GraphicIndex < 0 || boomRec->GraphicIndex > 63 )
-		[errorValues setObject:@"must match a spin resource with ID between 400 and 463." forKey:@"Graphics"];
-	if( boomRec->SoundIndex < -1 || boomRec->SoundIndex > 63 )
-		[errorValues setObject:@"must match a sound resource with ID between 300 and 363." forKey:@"Sound"];
-	if( boomRec->FrameAdvance < 1 || boomRec->FrameAdvance > 1000 )
-		[errorValues setObject:@"cannot be below 0% or above 1000%." forKey:@"Frame Advance"];
-	
-	// all values fell within acceptable range
-	return errorValues;
+	// verify values are valid, by the same rules used to check whole plug-ins
+	return [NovaValidator problemsWithData:[NovaWindowController dataWithRecord:boomRec format:&kNovaBoomRec] ofType:[resource type]];
 }
 
 - (void)saveResource
 {
 	// save new data into resource structure (should have already been validated, and boomRec filled out correctly)
-	[resource setData:[NSData dataWithBytes:boomRec length:sizeof(BoomRec)]];
+	[resource setData:[NovaWindowController dataWithRecord:boomRec format:&kNovaBoomRec]];
 }
 
 @end
@@ -117,6 +117,9 @@
 - (IBAction)stepDate:(id)sender;
 - (IBAction)togglePrincipalChar:(id)sender;
 - (void)rotateIntroPict:(NSTimer *)timer;
+- (void)showIntroPict:(NSNumber *)resID;
+- (void)showIntroPict:(NSNumber *)resID prefetch:(BOOL)prefetch;
+- (void)thumbnailDidLoad:(NSNotification *)notification;
 - (void)comboBoxWillPopUp:(NSNotification *)notification;
 - (void)controlTextDidChange:(NSNotification *)notification;
 
@@ -1,4 +1,6 @@
 #import "CharWindowController.h"
+#import "NovaValidator.h"
+#import "ThumbnailCache.h"
 
 @implementation CharWindowController
 
@@ -13,7 +15,7 @@
 	
 	// load data from resource
 	charRec = (CharRec *) calloc( 1, sizeof(CharRec) );
-	[[newResource data] getBytes:charRec];
+	NovaDecodeRecord( &kNovaCharRec, [[newResource data] bytes], [[newResource data] length], charRec );
 	
 	// fill in default values if necessary
 	if( charRec->startYear == 0 || charRec->startMonth == 0 || charRec->startDay == 0 )
@@ -106,6 +108,7 @@
 
 - (void)dealloc
 {
+	[[[ThumbnailCache sharedCache] notificationCenter] removeObserver:self];
 	// bug: release everything
 	[super dealloc];
 }
@@ -150,13 +153,17 @@
 	[localCenter addObserver:self selector:@selector(controlTextDidChange:) name:NSControlTextDidChangeNotification object:nil];
 	
 	// mark window changed if initial values were invalid
-	if( ![[resource data] isEqualToData:[NSData dataWithBytes:charRec length:sizeof(CharRec)]] )
+	if( ![[resource data] isEqualToData:[NovaWindowController dataWithRecord:charRec format:&kNovaCharRec]] )
 	{
 		[resource touch];
 		[self setDocumentEdited:YES];
 	}
 	
-	// set initial picture
+	// set initial picture, and have the others drawn in the background ready for when they come round
+	[[[ThumbnailCache sharedCache] notificationCenter] addObserver:self selector:@selector(thumbnailDidLoad:) name:ThumbnailCacheDidLoadNotification object:nil];
+	[self showIntroPict:introPict4 prefetch:YES];	// the cache draws the newest first, so these go in backwards
+	[self showIntroPict:introPict3 prefetch:YES];
+	[self showIntroPict:introPict2 prefetch:YES];
 	[self rotateIntroPict:nil];
 	
 	// finally, show the window
@@ -267,33 +274,54 @@
 			// install new timer
 			introPictTimer = [NSTimer scheduledTimerWithTimeInterval:(NSTimeInterval)[introDelay1 doubleValue] target:self selector:@selector(rotateIntroPict:) userInfo:nil repeats:NO];
 			// set next picture
-			[introImageView setImage:[[[NSImage alloc] initWithData:[(id <ResKnifeResourceProtocol>)[NSClassFromString(@"Resource") getResourceOfType:[plugBundle localizedStringForKey:@"PICT" value:@"" table:@"Resource Types"] andID:introPict1 inDocument:nil] data]] autorelease]];
+			[self showIntroPict:introPict1];
 			break;
 	
 		case 2:
 			// install new timer
 			introPictTimer = [NSTimer scheduledTimerWithTimeInterval:(NSTimeInterval)[introDelay2 doubleValue] target:self selector:@selector(rotateIntroPict:) userInfo:nil repeats:NO];
 			// set next picture
-			[introImageView setImage:[[[NSImage alloc] initWithData:[(id <ResKnifeResourceProtocol>)[NSClassFromString(@"Resource") getResourceOfType:[plugBundle localizedStringForKey:@"PICT" value:@"" table:@"Resource Types"] andID:introPict2 inDocument:nil] data]] autorelease]];
+			[self showIntroPict:introPict2];
 			break;
 	
 		case 3:
 			// install new timer
 			introPictTimer = [NSTimer scheduledTimerWithTimeInterval:(NSTimeInterval)[introDelay3 doubleValue] target:self selector:@selector(rotateIntroPict:) userInfo:nil repeats:NO];
 			// set next picture
-			[introImageView setImage:[[[NSImage alloc] initWithData:[(id <ResKnifeResourceProtocol>)[NSClassFromString(@"Resource") getResourceOfType:[plugBundle localizedStringForKey:@"PICT" value:@"" table:@"Resource Types"] andID:introPict3 inDocument:nil] data]] autorelease]];
+			[self showIntroPict:introPict3];
 			break;
 	
 		case 4:
 			// install new timer
 			introPictTimer = [NSTimer scheduledTimerWithTimeInterval:(NSTimeInterval)[introDelay4 doubleValue] target:self selector:@selector(rotateIntroPict:) userInfo:nil repeats:NO];
 			// set next picture
-			[introImageView setImage:[[[NSImage alloc] initWithData:[(id <ResKnifeResourceProtocol>)[NSClassFromString(@"Resource") getResourceOfType:[plugBundle localizedStringForKey:@"PICT" value:@"" table:@"Resource Types"] andID:introPict4 inDocument:nil] data]] autorelease]];
+			[self showIntroPict:introPict4];
 			break;
 	
 	}
 }
 
+- (void)showIntroPict:(NSNumber *)resID
+{
+	[self showIntroPict:resID prefetch:NO];
+}
+
+// only thumbnails already drawn are shown; the rest are drawn in the background, then thumbnailDidLoad: comes back here
+- (void)showIntroPict:(NSNumber *)resID prefetch:(BOOL)prefetch
+{
+	NSImage *picture;
+	if( [resID intValue] == -1 ) return;
+	picture = [[ThumbnailCache sharedCache] thumbnailOfType:[plugBundle localizedStringForKey:@"PICT" value:@"" table:@"Resource Types"] resID:resID inDocument:nil size:[introImageView bounds].size];
+	if( !prefetch ) [introImageView setImage:picture];
+}
+
+- (void)thumbnailDidLoad:(NSNotification *)notification
+{
+	NSNumber *shown[4] = { introPict1, introPict2, introPict3, introPict4 };
+	if( currentPict >= 1 && currentPict <= 4 && [[[notification userInfo] objectForKey:@"ID"] isEqual:shown[currentPict-1]] )
+		[self showIntroPict:shown[currentPict-1]];
+}
+
 - (void)comboBoxWillPopUp:(NSNotification *)notification
 {
 	id sender = [notification object];
@@ -558,8 +586,6 @@
 
 - (NSDictionary *)validateValues
 {
-	NSMutableDictionary *errorValues = [NSMutableDictionary dictionary];
-	
 	// put current values into boomRec
 	charRec->Flags = 0x0000;
 	charRec->Flags |= principalChar? 0x0001:0;
@@ -598,27 +624,14 @@
 	BlockMoveData( [onStart cString], charRec->OnStart, [onStart cStringLength] <= 255? [onStart cStringLength]+1:256 );
 	BlockZero( charRec->UnusedA, 8*sizeof(short) );
 	
-	// verify values are valid
-	if(charRec->startDay < 1 || charRec->startDay > 31 )
-		[errorValues setObject:@"must be between 1 and 31." forKey:@"Start Day"];
-	if( charRec->startMonth < 1 || charRec->startMonth > 12 )
-		[errorValues setObject:@"must be between 1 and 12." forKey:@"Start Month"];
-	if( charRec->startYear < 1 )
-		[errorValues setObject:@"must be above zero." forKey:@"Start Year"];
-	if(((charRec->introPictDelay[0] < 1 || charRec->introPictDelay[0] > 300) && (charRec->introPictDelay[0] != -1))
-	|| ((charRec->introPictDelay[1] < 1 || charRec->introPictDelay[1] > 300) && (charRec->introPictDelay[1] != -1))
-	|| ((charRec->introPictDelay[2] < 1 || charRec->introPictDelay[2] > 300) && (charRec->introPictDelay[2] != -1))
-	|| ((charRec->introPictDelay[3] < 1 || charRec->introPictDelay[3] > 300) && (charRec->introPictDelay[3] != -1)))
-		[errorValues setObject:@"valid delays are 1 to 300 seconds, or -1 for unused values." forKey:@"Intro Picture Delays"];
-	
-	// all values fell within acceptable range
-	return errorValues;
+	// verify values are valid, by the same rules used to check whole plug-ins
+	return [NovaValidator problemsWithData:[NovaWindowController dataWithRecord:charRec format:&kNovaCharRec] ofType:[resource type]];
 }
 
 - (void)saveResource
 {
 	// save new data into resource structure (should have already been validated, and charRec filled out correctly)
-	[resource setData:[NSData dataWithBytes:charRec length:sizeof(CharRec)]];
+	[resource setData:[NovaWindowController dataWithRecord:charRec format:&kNovaCharRec]];
 }
 
 @end
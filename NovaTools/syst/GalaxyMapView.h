@@ -0,0 +1,63 @@
+#import <Cocoa/Cocoa.h>
+#import "ResKnifeResourceProtocol.h"
+#import "GalaxyQuadtree.h"
+
+/*	Draws every sÿst in a document at its galaxy position, with its hyperlinks, and lets them be dragged about.
+	Systems are found through a GalaxyQuadtree, so drawing only visits those in view, and when zoomed out cells of the
+	tree smaller than a couple of pixels are drawn as one dot (their hyperlinks are left out, being just as crowded).
+	Hyperlinks are resolved to indexes when a system is read, and stroked as one batch of line segments. Names appear
+	once few enough systems are in view, and the names of their spöbs when zoomed further in. */
+
+typedef struct GalaxySystem
+{
+	SInt16	resID;
+	SInt16	x, y;
+	SInt16	con[16];	// hyperlinked systems' IDs
+	SInt32	links[16];	// their indexes in systems, or -1
+	SInt16	nav[16];	// spöb IDs
+} GalaxySystem;
+
+typedef struct GalaxyHit
+{
+	UInt32	item;		// index in systems, or kGalaxyAggregate
+	SInt16	x, y;
+	UInt32	count;
+} GalaxyHit;
+
+typedef struct GalaxyHitList
+{
+	UInt32		count;
+	UInt32		capacity;
+	GalaxyHit	*hits;
+} GalaxyHitList;
+
+@interface GalaxyMapView : NSView
+{
+	NSDocument *document;			// not retained
+	NSUndoManager *undoManager;
+	NSString *systemType;
+	NSString *planetType;
+	NSMutableArray *systems;		// every sÿst resource in the document
+	NSMutableDictionary *indexForID;	// resID -> index in systems
+	GalaxySystem *info;				// parallel to systems
+	unsigned infoCapacity;
+	GalaxyQuadtree *tree;			// of indexes in systems
+	GalaxyHitList hitList;			// reused by every redraw
+	float longestLink;				// in galaxy units, to widen the search for links crossing the view
+
+	NSPoint origin;					// galaxy position of the top-left corner
+	float scale;					// pixels per galaxy unit
+	int selection;					// index in systems, or -1
+	NSPoint dragStart;
+	NSPoint dragOrigin;
+	BOOL movingSystem;
+	SInt16 dragX, dragY;			// the selected system's position when the drag started
+}
+
+- (id)initWithFrame:(NSRect)frame document:(NSDocument *)owner;
+- (void)centreOnSystem:(id <ResKnifeResourceProtocol>)system;
+- (id <ResKnifeResourceProtocol>)selectedSystem;
+- (IBAction)zoomIn:(id)sender;
+- (IBAction)zoomOut:(id)sender;
+
+@end
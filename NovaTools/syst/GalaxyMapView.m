@@ -0,0 +1,477 @@
+#import "GalaxyMapView.h"
+#import "Structs.h"
+#import "NovaCodec.h"
+#import "ResourceCatalog.h"
+#include <stddef.h>
+#include <math.h>
+
+enum
+{
+	kMinimumCellPixels = 3,		// cells of the quadtree smaller than this on screen are drawn as one dot
+	kHitPixels = 6,				// how far from a system a click may be
+	kMaxLabels = 400,			// names are only drawn with fewer systems than this in view
+	kMaxPlanetLabels = 40
+};
+
+#define kMinimumScale		(1.0f / 64.0f)
+#define kMaximumScale		16.0f
+#define kLabelScale			0.5f
+#define kPlanetLabelScale	2.0f
+
+static void CollectHit(void *context, UInt32 item, SInt16 x, SInt16 y, UInt32 count)
+{
+	GalaxyHitList *list = (GalaxyHitList *) context;
+	if( list->count == list->capacity )
+	{
+		list->capacity = list->capacity? list->capacity * 2 : 256;
+		list->hits = (GalaxyHit *) realloc( list->hits, list->capacity * sizeof(GalaxyHit) );
+	}
+	list->hits[list->count].item = item;
+	list->hits[list->count].x = x;
+	list->hits[list->count].y = y;
+	list->hits[list->count].count = count;
+	list->count++;
+}
+
+static SInt16 ClampCoordinate(float value)
+{
+	if( value < -32768.0f ) return -32768;
+	if( value > 32767.0f ) return 32767;
+	return (SInt16) floorf( value + 0.5f );
+}
+
+@interface GalaxyMapView (Private)
+- (void)loadSystems;
+- (void)addSystem:(id <ResKnifeResourceProtocol>)system;
+- (void)readSystemAtIndex:(unsigned)index;
+- (void)resolveLinksOfSystemAtIndex:(unsigned)index;
+- (void)resolveAllLinks;
+- (void)setScale:(float)newScale aroundPoint:(NSPoint)point;
+- (void)setData:(NSData *)data forSystem:(id <ResKnifeResourceProtocol>)system;
+@end
+
+@implementation GalaxyMapView
+
+- (id)initWithFrame:(NSRect)frame document:(NSDocument *)owner
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[GalaxyMapView class]];
+	NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+	self = [super initWithFrame:frame];
+	if( !self ) return nil;
+
+	document = owner;
+	undoManager = [[owner undoManager] retain];
+	systemType = [[bundle localizedStringForKey:@"syst" value:@"" table:@"Resource Types"] retain];
+	planetType = [[bundle localizedStringForKey:@"spob" value:@"" table:@"Resource Types"] retain];
+	systems = [[NSMutableArray alloc] init];
+	indexForID = [[NSMutableDictionary alloc] init];
+	scale = 1.0f;
+	selection = -1;
+	[self loadSystems];
+
+	[center addObserver:self selector:@selector(resourceDataDidChange:) name:ResourceDataDidChangeNotification object:nil];
+	[center addObserver:self selector:@selector(resourceDidChange:) name:ResourceDidChangeNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidAddResource:) name:DataSourceDidAddResourceNotification object:nil];
+	[center addObserver:self selector:@selector(dataSourceDidRemoveResource:) name:DataSourceDidRemoveResourceNotification object:nil];
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+	[undoManager removeAllActionsWithTarget:self];
+	[undoManager release];
+	[systemType release];
+	[planetType release];
+	[systems release];
+	[indexForID release];
+	free( info );
+	free( hitList.hits );
+	GalaxyQuadtreeDispose( tree );
+	[super dealloc];
+}
+
+- (BOOL)isFlipped
+{
+	return YES;		// as Nova's y-axis is
+}
+
+- (BOOL)isOpaque
+{
+	return YES;
+}
+
+- (BOOL)acceptsFirstResponder
+{
+	return YES;
+}
+
+#pragma mark -
+#pragma mark Systems
+
+- (void)loadSystems
+{
+	id <ResKnifeResourceProtocol> system;
+	NSEnumerator *enumerator = [[NSClassFromString(@"Resource") allResourcesOfType:systemType inDocument:document] objectEnumerator];
+	id selected = [[[self selectedSystem] retain] autorelease];
+
+	GalaxyQuadtreeDispose( tree );
+	tree = GalaxyQuadtreeCreate();
+	[systems removeAllObjects];
+	while( system = [enumerator nextObject] )
+		[self addSystem:system];
+	[self resolveAllLinks];
+	selection = selected? (int) [systems indexOfObjectIdenticalTo:selected] : -1;
+	if( selection == (int) NSNotFound ) selection = -1;
+	[self setNeedsDisplay:YES];
+}
+
+- (void)addSystem:(id <ResKnifeResourceProtocol>)system
+{
+	unsigned index = [systems count];
+	if( index == infoCapacity )
+	{
+		infoCapacity = infoCapacity? infoCapacity * 2 : 256;
+		info = (GalaxySystem *) realloc( info, infoCapacity * sizeof(GalaxySystem) );
+	}
+	[systems addObject:system];
+	[self readSystemAtIndex:index];
+	GalaxyQuadtreeInsert( tree, index, info[index].x, info[index].y );
+}
+
+/* Updates the cached copy of the fields the map uses, but not the quadtree or the links. */
+- (void)readSystemAtIndex:(unsigned)index
+{
+	SystRec rec;
+	id <ResKnifeResourceProtocol> system = [systems objectAtIndex:index];
+	NSData *data = [system data];
+	NovaDecodeRecord( &kNovaSystRec, [data bytes], [data length], &rec );
+	info[index].resID = [[system resID] shortValue];
+	info[index].x = rec.xPos;
+	info[index].y = rec.yPos;
+	memcpy( info[index].con, rec.con, sizeof(rec.con) );
+	memcpy( info[index].nav, rec.nav, sizeof(rec.nav) );
+}
+
+- (void)resolveLinksOfSystemAtIndex:(unsigned)index
+{
+	unsigned k;
+	GalaxySystem *system = &info[index];
+	for( k = 0; k < 16; k++ )
+	{
+		NSNumber *target = system->con[k] >= 128? [indexForID objectForKey:[NSNumber numberWithShort:system->con[k]]] : nil;
+		system->links[k] = target? [target intValue] : -1;
+		if( target )
+		{
+			GalaxySystem *other = &info[system->links[k]];
+			float length = hypotf( other->x - system->x, other->y - system->y );
+			if( length > longestLink ) longestLink = length;
+		}
+	}
+}
+
+- (void)resolveAllLinks
+{
+	unsigned i;
+	[indexForID removeAllObjects];
+	for( i = 0; i < [systems count]; i++ )
+		[indexForID setObject:[NSNumber numberWithUnsignedInt:i] forKey:[NSNumber numberWithShort:info[i].resID]];
+	longestLink = 0.0f;
+	for( i = 0; i < [systems count]; i++ )
+		[self resolveLinksOfSystemAtIndex:i];
+}
+
+- (id <ResKnifeResourceProtocol>)selectedSystem
+{
+	return selection < 0? nil : [systems objectAtIndex:selection];
+}
+
+- (void)centreOnSystem:(id <ResKnifeResourceProtocol>)system
+{
+	unsigned index = [systems indexOfObjectIdenticalTo:system];
+	NSSize size = [self bounds].size;
+	if( index == NSNotFound ) return;
+	selection = index;
+	origin.x = info[index].x - size.width / 2 / scale;
+	origin.y = info[index].y - size.height / 2 / scale;
+	[self setNeedsDisplay:YES];
+}
+
+// registers the reverse with the document's undo manager, so undo and redo both come back through here
+- (void)setData:(NSData *)data forSystem:(id <ResKnifeResourceProtocol>)system
+{
+	[[undoManager prepareWithInvocationTarget:self] setData:[system data] forSystem:system];
+	[undoManager setActionName:NSLocalizedStringFromTableInBundle(@"Move System", nil, [NSBundle bundleForClass:[GalaxyMapView class]], nil)];
+	[system setData:data];
+}
+
+#pragma mark -
+#pragma mark Drawing
+
+- (void)drawRect:(NSRect)rect
+{
+	unsigned i, k, labels = 0, segmentCount = 0;
+	UInt32 minimumSize = (UInt32) (kMinimumCellPixels / scale);
+	float radius = scale * 3.0f;
+	GalaxyRect visible, search;
+	CGPoint *segments;
+	NSRect *dots;
+	unsigned dotCount = 0;
+	CGContextRef context = (CGContextRef) [[NSGraphicsContext currentContext] graphicsPort];
+
+	[[NSColor blackColor] set];
+	NSRectFill( rect );
+	if( radius < 1.5f ) radius = 1.5f;
+	if( radius > 4.0f ) radius = 4.0f;
+
+	// links may cross the view without either end being in it, so look a link's length further for those
+	visible.left = (SInt32) floorf( origin.x + NSMinX(rect) / scale );
+	visible.top = (SInt32) floorf( origin.y + NSMinY(rect) / scale );
+	visible.right = (SInt32) ceilf( origin.x + NSMaxX(rect) / scale );
+	visible.bottom = (SInt32) ceilf( origin.y + NSMaxY(rect) / scale );
+	search.left = visible.left - (SInt32) longestLink;
+	search.top = visible.top - (SInt32) longestLink;
+	search.right = visible.right + (SInt32) longestLink;
+	search.bottom = visible.bottom + (SInt32) longestLink;
+	hitList.count = 0;
+	GalaxyQuadtreeVisit( tree, &search, minimumSize, CollectHit, &hitList );
+
+	// hyperlinks, as a single batch of segments
+	segments = (CGPoint *) malloc( hitList.count * 16 * 2 * sizeof(CGPoint) + 1 );
+	for( i = 0; i < hitList.count; i++ )
+	{
+		GalaxySystem *system;
+		if( hitList.hits[i].item == kGalaxyAggregate ) continue;
+		system = &info[hitList.hits[i].item];
+		for( k = 0; k < 16; k++ )
+		{
+			GalaxySystem *other;
+			if( system->links[k] < 0 ) continue;
+			other = &info[system->links[k]];
+			if( MAX(system->x, other->x) < visible.left || MIN(system->x, other->x) > visible.right || MAX(system->y, other->y) < visible.top || MIN(system->y, other->y) > visible.bottom )
+				continue;
+			segments[segmentCount++] = CGPointMake( (system->x - origin.x) * scale, (system->y - origin.y) * scale );
+			segments[segmentCount++] = CGPointMake( (other->x - origin.x) * scale, (other->y - origin.y) * scale );
+		}
+	}
+	if( segmentCount )
+	{
+		[[NSColor colorWithCalibratedWhite:0.35f alpha:1.0f] set];
+		CGContextSetLineWidth( context, 1.0f );
+		CGContextStrokeLineSegments( context, segments, segmentCount );
+	}
+	free( segments );
+
+	// systems, and cells standing in for several, as a single batch of rects
+	dots = (NSRect *) malloc( hitList.count * sizeof(NSRect) + 1 );
+	for( i = 0; i < hitList.count; i++ )
+	{
+		GalaxyHit *hit = &hitList.hits[i];
+		if( hit->x < visible.left || hit->x > visible.right || hit->y < visible.top || hit->y > visible.bottom ) continue;
+		dots[dotCount++] = NSMakeRect( (hit->x - origin.x) * scale - radius, (hit->y - origin.y) * scale - radius, radius * 2, radius * 2 );
+		if( hit->item != kGalaxyAggregate ) labels++;
+	}
+	[[NSColor colorWithCalibratedRed:0.5f green:0.8f blue:1.0f alpha:1.0f] set];
+	NSRectFillList( dots, dotCount );
+	free( dots );
+
+	if( selection >= 0 )
+	{
+		NSPoint point = NSMakePoint( (info[selection].x - origin.x) * scale, (info[selection].y - origin.y) * scale );
+		[[NSColor yellowColor] set];
+		[[NSBezierPath bezierPathWithOvalInRect:NSMakeRect( point.x - radius - 3, point.y - radius - 3, radius * 2 + 6, radius * 2 + 6 )] stroke];
+	}
+
+	// names only once they stop overlapping
+	if( scale >= kLabelScale && labels <= kMaxLabels )
+	{
+		NSDictionary *attributes = [NSDictionary dictionaryWithObjectsAndKeys:[NSFont labelFontOfSize:10.0f], NSFontAttributeName, [NSColor whiteColor], NSForegroundColorAttributeName, nil];
+		NSDictionary *planetAttributes = [NSDictionary dictionaryWithObjectsAndKeys:[NSFont labelFontOfSize:9.0f], NSFontAttributeName, [NSColor lightGrayColor], NSForegroundColorAttributeName, nil];
+		NSDictionary *planetNames = (scale >= kPlanetLabelScale && labels <= kMaxPlanetLabels)? [[ResourceCatalog catalogForType:planetType] names] : nil;
+		for( i = 0; i < hitList.count; i++ )
+		{
+			GalaxyHit *hit = &hitList.hits[i];
+			NSPoint point;
+			if( hit->item == kGalaxyAggregate || hit->x < visible.left || hit->x > visible.right || hit->y < visible.top || hit->y > visible.bottom ) continue;
+			point = NSMakePoint( (hit->x - origin.x) * scale + radius + 2, (hit->y - origin.y) * scale - 6 );
+			[[[systems objectAtIndex:hit->item] name] drawAtPoint:point withAttributes:attributes];
+			if( planetNames ) for( k = 0; k < 16; k++ )
+			{
+				NSString *name = info[hit->item].nav[k] >= 128? [planetNames objectForKey:[NSNumber numberWithShort:info[hit->item].nav[k]]] : nil;
+				if( !name ) continue;
+				point.y += 11;
+				[name drawAtPoint:point withAttributes:planetAttributes];
+			}
+		}
+	}
+}
+
+#pragma mark -
+#pragma mark Events
+
+- (void)mouseDown:(NSEvent *)event
+{
+	NSPoint point = [self convertPoint:[event locationInWindow] fromView:nil];
+	UInt32 hit = GalaxyQuadtreeNearest( tree, ClampCoordinate( origin.x + point.x / scale ), ClampCoordinate( origin.y + point.y / scale ), (UInt32) (kHitPixels / scale) + 1 );
+	selection = (hit == kGalaxyAggregate)? -1 : (int) hit;
+	movingSystem = (selection >= 0);
+	if( movingSystem )
+	{
+		dragX = info[selection].x;
+		dragY = info[selection].y;
+	}
+	dragStart = point;
+	dragOrigin = origin;
+	[self setNeedsDisplay:YES];
+}
+
+- (void)mouseDragged:(NSEvent *)event
+{
+	NSPoint point = [self convertPoint:[event locationInWindow] fromView:nil];
+	if( movingSystem )
+	{
+		// the quadtree follows the drag, but the resource is only changed once it's dropped
+		GalaxySystem *system = &info[selection];
+		SInt16 x = ClampCoordinate( dragX + (point.x - dragStart.x) / scale );
+		SInt16 y = ClampCoordinate( dragY + (point.y - dragStart.y) / scale );
+		GalaxyQuadtreeMove( tree, selection, system->x, system->y, x, y );
+		longestLink += hypotf( x - system->x, y - system->y );	// other systems' links to this one may have stretched
+		system->x = x;
+		system->y = y;
+		[self resolveLinksOfSystemAtIndex:selection];
+	}
+	else
+	{
+		origin.x = dragOrigin.x - (point.x - dragStart.x) / scale;
+		origin.y = dragOrigin.y - (point.y - dragStart.y) / scale;
+	}
+	[self setNeedsDisplay:YES];
+}
+
+- (void)mouseUp:(NSEvent *)event
+{
+	GalaxySystem *system;
+	id <ResKnifeResourceProtocol> resource;
+	NSMutableData *data;
+	unsigned char *bytes;
+	UInt32 xOffset = NovaDiskOffset( &kNovaSystRec, offsetof(SystRec, xPos) );
+	UInt32 yOffset = NovaDiskOffset( &kNovaSystRec, offsetof(SystRec, yPos) );
+	if( !movingSystem ) return;
+	movingSystem = NO;
+	system = &info[selection];
+	if( system->x == dragX && system->y == dragY ) return;
+
+	// patch just the position, leaving the rest of the data (and its length) alone
+	resource = [systems objectAtIndex:selection];
+	data = [[[resource data] mutableCopy] autorelease];
+	if( [data length] < MAX(xOffset, yOffset) + 2 )
+	{
+		NSBeep();
+		GalaxyQuadtreeMove( tree, selection, system->x, system->y, dragX, dragY );
+		system->x = dragX;
+		system->y = dragY;
+		[self setNeedsDisplay:YES];
+		return;
+	}
+	bytes = [data mutableBytes];
+	bytes[xOffset] = (system->x >> 8) & 0xFF;
+	bytes[xOffset+1] = system->x & 0xFF;
+	bytes[yOffset] = (system->y >> 8) & 0xFF;
+	bytes[yOffset+1] = system->y & 0xFF;
+	[self setData:data forSystem:resource];
+}
+
+- (void)scrollWheel:(NSEvent *)event
+{
+	[self setScale:scale * powf( 1.1f, [event deltaY] ) aroundPoint:[self convertPoint:[event locationInWindow] fromView:nil]];
+}
+
+- (void)keyDown:(NSEvent *)event
+{
+	NSString *characters = [event charactersIgnoringModifiers];
+	if( [characters isEqualToString:@"+"] || [characters isEqualToString:@"="] )
+		[self zoomIn:self];
+	else if( [characters isEqualToString:@"-"] )
+		[self zoomOut:self];
+	else [super keyDown:event];
+}
+
+- (IBAction)zoomIn:(id)sender
+{
+	NSRect bounds = [self bounds];
+	[self setScale:scale * 2 aroundPoint:NSMakePoint( NSMidX(bounds), NSMidY(bounds) )];
+}
+
+- (IBAction)zoomOut:(id)sender
+{
+	NSRect bounds = [self bounds];
+	[self setScale:scale / 2 aroundPoint:NSMakePoint( NSMidX(bounds), NSMidY(bounds) )];
+}
+
+// keeps the galaxy position under the point where it is
+- (void)setScale:(float)newScale aroundPoint:(NSPoint)point
+{
+	if( newScale < kMinimumScale ) newScale = kMinimumScale;
+	if( newScale > kMaximumScale ) newScale = kMaximumScale;
+	origin.x += point.x / scale - point.x / newScale;
+	origin.y += point.y / scale - point.y / newScale;
+	scale = newScale;
+	[self setNeedsDisplay:YES];
+}
+
+#pragma mark -
+#pragma mark Notifications
+
+- (void)resourceDataDidChange:(NSNotification *)notification
+{
+	unsigned index = [systems indexOfObjectIdenticalTo:[notification object]];
+	SInt16 x, y;
+	if( index == NSNotFound ) return;
+	x = info[index].x;
+	y = info[index].y;
+	[self readSystemAtIndex:index];
+	GalaxyQuadtreeMove( tree, index, x, y, info[index].x, info[index].y );
+	longestLink += hypotf( info[index].x - x, info[index].y - y );
+	[self resolveLinksOfSystemAtIndex:index];
+	[self setNeedsDisplay:YES];
+}
+
+- (void)resourceDidChange:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [notification object];
+	unsigned index = [systems indexOfObjectIdenticalTo:resource];
+	if( index == NSNotFound )
+	{
+		// a resource whose type was changed to sÿst
+		if( [[resource type] isEqualToString:systemType] && [resource document] == document )
+			[self loadSystems];
+	}
+	else if( ![[resource type] isEqualToString:systemType] )
+		[self loadSystems];
+	else if( [[resource resID] shortValue] != info[index].resID )
+	{
+		// other systems' links to it, and its to others of the same ID, change
+		info[index].resID = [[resource resID] shortValue];
+		[self resolveAllLinks];
+		[self setNeedsDisplay:YES];
+	}
+}
+
+- (void)dataSourceDidAddResource:(NSNotification *)notification
+{
+	id <ResKnifeResourceProtocol> resource = [[notification object] objectForKey:@"Resource"];
+	if( [[resource type] isEqualToString:systemType] && [resource document] == document )
+	{
+		[self addSystem:resource];
+		[self resolveAllLinks];
+		[self setNeedsDisplay:YES];
+	}
+}
+
+- (void)dataSourceDidRemoveResource:(NSNotification *)notification
+{
+	if( [systems indexOfObjectIdenticalTo:[[notification object] objectForKey:@"Resource"]] != NSNotFound )
+		[self loadSystems];
+}
+
+@end
@@ -0,0 +1,271 @@
+#include "GalaxyQuadtree.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+	kBucketSize = 8,
+	kRootOrigin = -32768,
+	kRootSize = 65536
+};
+
+typedef struct GalaxyEntry
+{
+	UInt32	item;
+	SInt16	x, y;
+} GalaxyEntry;
+
+typedef struct GalaxyNode
+{
+	struct GalaxyNode	*children;		// four of them, or NULL for a leaf
+	UInt32				count;			// entries in this subtree
+	SInt64				sumX, sumY;		// of their coordinates
+	UInt32				entryCount;		// leaves only
+	UInt32				entryCapacity;
+	GalaxyEntry			*entries;
+} GalaxyNode;
+
+struct GalaxyQuadtree
+{
+	GalaxyNode			root;
+};
+
+/* Which quarter of the cell at (left,top) of the given size holds (x,y): bit 0 for the right half, bit 1 for the bottom. */
+static int Quadrant(SInt32 left, SInt32 top, UInt32 size, SInt16 x, SInt16 y)
+{
+	SInt32 half = size / 2;
+	return (x >= left + half) | ((y >= top + half) << 1);
+}
+
+static void ChildOrigin(SInt32 left, SInt32 top, UInt32 size, int quadrant, SInt32 *childLeft, SInt32 *childTop)
+{
+	*childLeft = left + ((quadrant & 1)? (SInt32) size / 2 : 0);
+	*childTop = top + ((quadrant & 2)? (SInt32) size / 2 : 0);
+}
+
+static void AppendEntry(GalaxyNode *node, const GalaxyEntry *entry)
+{
+	if( node->entryCount == node->entryCapacity )
+	{
+		node->entryCapacity = node->entryCapacity? node->entryCapacity * 2 : kBucketSize + 1;
+		node->entries = (GalaxyEntry *) realloc( node->entries, node->entryCapacity * sizeof(GalaxyEntry) );
+	}
+	node->entries[node->entryCount++] = *entry;
+}
+
+static void FreeChildren(GalaxyNode *node)
+{
+	int i;
+	if( !node->children ) return;
+	for( i = 0; i < 4; i++ )
+	{
+		FreeChildren( &node->children[i] );
+		free( node->children[i].entries );
+	}
+	free( node->children );
+	node->children = NULL;
+}
+
+static Boolean AllInOneSpot(const GalaxyNode *node)
+{
+	UInt32 i;
+	for( i = 1; i < node->entryCount; i++ )
+		if( node->entries[i].x != node->entries[0].x || node->entries[i].y != node->entries[0].y )
+			return false;
+	return true;
+}
+
+static void InsertEntry(GalaxyNode *node, SInt32 left, SInt32 top, UInt32 size, const GalaxyEntry *entry)
+{
+	for(;;)
+	{
+		int quadrant;
+		node->count++;
+		node->sumX += entry->x;
+		node->sumY += entry->y;
+		if( !node->children ) break;
+		quadrant = Quadrant( left, top, size, entry->x, entry->y );
+		ChildOrigin( left, top, size, quadrant, &left, &top );
+		node = &node->children[quadrant];
+		size /= 2;
+	}
+	AppendEntry( node, entry );
+
+	// split a full leaf, unless its entries are all in one spot
+	if( node->entryCount > kBucketSize && size > 1 && !AllInOneSpot( node ) )
+	{
+		UInt32 i, count = node->entryCount;
+		GalaxyEntry *entries = node->entries;
+		node->children = (GalaxyNode *) calloc( 4, sizeof(GalaxyNode) );
+		node->entries = NULL;
+		node->entryCount = node->entryCapacity = 0;
+		for( i = 0; i < count; i++ )
+		{
+			int quadrant = Quadrant( left, top, size, entries[i].x, entries[i].y );
+			SInt32 childLeft, childTop;
+			ChildOrigin( left, top, size, quadrant, &childLeft, &childTop );
+			InsertEntry( &node->children[quadrant], childLeft, childTop, size / 2, &entries[i] );
+		}
+		free( entries );
+	}
+}
+
+static void GatherEntries(GalaxyNode *node, GalaxyNode *into)
+{
+	UInt32 i;
+	if( node->children )
+	{
+		for( i = 0; i < 4; i++ )
+			GatherEntries( &node->children[i], into );
+	}
+	else for( i = 0; i < node->entryCount; i++ )
+		AppendEntry( into, &node->entries[i] );
+}
+
+static Boolean RemoveEntry(GalaxyNode *node, SInt32 left, SInt32 top, UInt32 size, UInt32 item, SInt16 x, SInt16 y)
+{
+	if( node->children )
+	{
+		int quadrant = Quadrant( left, top, size, x, y );
+		SInt32 childLeft, childTop;
+		ChildOrigin( left, top, size, quadrant, &childLeft, &childTop );
+		if( !RemoveEntry( &node->children[quadrant], childLeft, childTop, size / 2, item, x, y ) )
+			return false;
+
+		// merge the children back once they would fit in one leaf
+		if( node->count - 1 <= kBucketSize )
+		{
+			GatherEntries( node, node );
+			FreeChildren( node );
+		}
+	}
+	else
+	{
+		UInt32 i;
+		for( i = 0; i < node->entryCount; i++ )
+			if( node->entries[i].item == item ) break;
+		if( i == node->entryCount ) return false;
+		node->entries[i] = node->entries[--node->entryCount];
+	}
+	node->count--;
+	node->sumX -= x;
+	node->sumY -= y;
+	return true;
+}
+
+static void VisitNode(const GalaxyNode *node, SInt32 left, SInt32 top, UInt32 size, const GalaxyRect *rect, UInt32 minimumSize, GalaxyVisitor visitor, void *context)
+{
+	UInt32 i;
+	if( node->count == 0 ) return;
+	if( left > rect->right || top > rect->bottom || left + (SInt32) size - 1 < rect->left || top + (SInt32) size - 1 < rect->top )
+		return;
+
+	if( size <= minimumSize && node->count > 1 )
+		visitor( context, kGalaxyAggregate, (SInt16) (node->sumX / (SInt64) node->count), (SInt16) (node->sumY / (SInt64) node->count), node->count );
+	else if( node->children )
+	{
+		for( i = 0; i < 4; i++ )
+		{
+			SInt32 childLeft, childTop;
+			ChildOrigin( left, top, size, i, &childLeft, &childTop );
+			VisitNode( &node->children[i], childLeft, childTop, size / 2, rect, minimumSize, visitor, context );
+		}
+	}
+	else for( i = 0; i < node->entryCount; i++ )
+	{
+		const GalaxyEntry *entry = &node->entries[i];
+		if( entry->x >= rect->left && entry->x <= rect->right && entry->y >= rect->top && entry->y <= rect->bottom )
+			visitor( context, entry->item, entry->x, entry->y, 1 );
+	}
+}
+
+static SInt64 DistanceToCell(SInt32 left, SInt32 top, UInt32 size, SInt16 x, SInt16 y)
+{
+	SInt64 dx = 0, dy = 0;
+	if( x < left ) dx = left - x;
+	else if( x > left + (SInt32) size - 1 ) dx = x - (left + (SInt32) size - 1);
+	if( y < top ) dy = top - y;
+	else if( y > top + (SInt32) size - 1 ) dy = y - (top + (SInt32) size - 1);
+	return dx*dx + dy*dy;
+}
+
+static void NearestInNode(const GalaxyNode *node, SInt32 left, SInt32 top, UInt32 size, SInt16 x, SInt16 y, SInt64 *best, UInt32 *item)
+{
+	UInt32 i;
+	if( node->count == 0 || DistanceToCell( left, top, size, x, y ) > *best ) return;
+	if( node->children )
+	{
+		// the quarter holding the point first, which usually shrinks the search before the others are tried
+		int first = Quadrant( left, top, size, x, y );
+		for( i = 0; i < 4; i++ )
+		{
+			int quadrant = first ^ i;
+			SInt32 childLeft, childTop;
+			ChildOrigin( left, top, size, quadrant, &childLeft, &childTop );
+			NearestInNode( &node->children[quadrant], childLeft, childTop, size / 2, x, y, best, item );
+		}
+	}
+	else for( i = 0; i < node->entryCount; i++ )
+	{
+		SInt64 dx = node->entries[i].x - x, dy = node->entries[i].y - y;
+		if( dx*dx + dy*dy <= *best )
+		{
+			*best = dx*dx + dy*dy;
+			*item = node->entries[i].item;
+		}
+	}
+}
+
+#pragma mark -
+
+GalaxyQuadtree *GalaxyQuadtreeCreate(void)
+{
+	return (GalaxyQuadtree *) calloc( 1, sizeof(GalaxyQuadtree) );
+}
+
+void GalaxyQuadtreeDispose(GalaxyQuadtree *tree)
+{
+	if( !tree ) return;
+	FreeChildren( &tree->root );
+	free( tree->root.entries );
+	free( tree );
+}
+
+UInt32 GalaxyQuadtreeCount(const GalaxyQuadtree *tree)
+{
+	return tree->root.count;
+}
+
+void GalaxyQuadtreeInsert(GalaxyQuadtree *tree, UInt32 item, SInt16 x, SInt16 y)
+{
+	GalaxyEntry entry;
+	entry.item = item;
+	entry.x = x;
+	entry.y = y;
+	InsertEntry( &tree->root, kRootOrigin, kRootOrigin, kRootSize, &entry );
+}
+
+Boolean GalaxyQuadtreeRemove(GalaxyQuadtree *tree, UInt32 item, SInt16 x, SInt16 y)
+{
+	return RemoveEntry( &tree->root, kRootOrigin, kRootOrigin, kRootSize, item, x, y );
+}
+
+void GalaxyQuadtreeMove(GalaxyQuadtree *tree, UInt32 item, SInt16 x, SInt16 y, SInt16 newX, SInt16 newY)
+{
+	if( x == newX && y == newY ) return;
+	if( GalaxyQuadtreeRemove( tree, item, x, y ) )
+		GalaxyQuadtreeInsert( tree, item, newX, newY );
+}
+
+void GalaxyQuadtreeVisit(const GalaxyQuadtree *tree, const GalaxyRect *rect, UInt32 minimumSize, GalaxyVisitor visitor, void *context)
+{
+	VisitNode( &tree->root, kRootOrigin, kRootOrigin, kRootSize, rect, minimumSize, visitor, context );
+}
+
+UInt32 GalaxyQuadtreeNearest(const GalaxyQuadtree *tree, SInt16 x, SInt16 y, UInt32 radius)
+{
+	SInt64 best = (SInt64) radius * radius;
+	UInt32 item = kGalaxyAggregate;
+	NearestInNode( &tree->root, kRootOrigin, kRootOrigin, kRootSize, x, y, &best, &item );
+	return item;
+}
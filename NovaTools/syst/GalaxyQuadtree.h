@@ -0,0 +1,53 @@
+/* Galaxy spatial index */
+
+/*	A point quadtree over the whole range of Nova's 16-bit coordinates, holding one entry per system. Leaves hold up to
+	eight entries before splitting, and merge back into their parent as entries are removed, so a system can be moved
+	by removing and re-inserting it without the tree degrading. Each node keeps the count and coordinate sum of the
+	entries below it, which lets a zoomed-out view draw a whole cell as one dot instead of visiting every system in it. */
+
+#ifndef GALAXY_QUADTREE_H
+#define GALAXY_QUADTREE_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct GalaxyQuadtree GalaxyQuadtree;
+
+typedef struct GalaxyRect
+{
+	SInt32	left, top, right, bottom;	// inclusive
+} GalaxyRect;
+
+#define kGalaxyAggregate	((UInt32) 0xFFFFFFFF)	// the item passed for a cell drawn as one dot
+
+/* Called with an entry's item and position, or with kGalaxyAggregate, the centroid and number of entries in a cell. */
+typedef void (*GalaxyVisitor)(void *context, UInt32 item, SInt16 x, SInt16 y, UInt32 count);
+
+GalaxyQuadtree *GalaxyQuadtreeCreate(void);
+void GalaxyQuadtreeDispose(GalaxyQuadtree *tree);
+UInt32 GalaxyQuadtreeCount(const GalaxyQuadtree *tree);
+
+void GalaxyQuadtreeInsert(GalaxyQuadtree *tree, UInt32 item, SInt16 x, SInt16 y);
+Boolean GalaxyQuadtreeRemove(GalaxyQuadtree *tree, UInt32 item, SInt16 x, SInt16 y);	// false if the item isn't at (x,y)
+void GalaxyQuadtreeMove(GalaxyQuadtree *tree, UInt32 item, SInt16 x, SInt16 y, SInt16 newX, SInt16 newY);
+
+/*!
+@function	GalaxyQuadtreeVisit
+@abstract	Calls visitor for every entry within rect, except that cells no larger than minimumSize are passed as a single aggregate.
+*/
+void GalaxyQuadtreeVisit(const GalaxyQuadtree *tree, const GalaxyRect *rect, UInt32 minimumSize, GalaxyVisitor visitor, void *context);
+
+/*!
+@function	GalaxyQuadtreeNearest
+@abstract	Returns the item closest to (x,y) no further than radius away, or kGalaxyAggregate if there is none.
+*/
+UInt32 GalaxyQuadtreeNearest(const GalaxyQuadtree *tree, SInt16 x, SInt16 y, UInt32 radius);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
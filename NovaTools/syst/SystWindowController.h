@@ -0,0 +1,14 @@
+#import <Cocoa/Cocoa.h>
+#import "NovaWindowController.h"
+
+@class GalaxyMapView;
+
+/*	Opens sÿst resources on a map of the whole galaxy in their document, centred on the one chosen. The window is
+	built here rather than in a nib, as it holds nothing but the map. Moving a system changes its resource at once,
+	undoably, so there is never anything to save when the window closes. */
+
+@interface SystWindowController : NovaWindowController
+{
+	GalaxyMapView *mapView;
+}
+@end
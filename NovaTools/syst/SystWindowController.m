@@ -0,0 +1,46 @@
+#import "SystWindowController.h"
+#import "GalaxyMapView.h"
+
+@implementation SystWindowController
+
+- (id)initWithResource:(id <ResKnifeResourceProtocol>)newResource
+{
+	NSWindow *window = [[[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 640, 480) styleMask:NSTitledWindowMask | NSClosableWindowMask | NSMiniaturizableWindowMask | NSResizableWindowMask backing:NSBackingStoreBuffered defer:YES] autorelease];
+	self = [self initWithWindow:window];
+	if( !self ) return nil;
+
+	[window setTitle:NSLocalizedStringFromTableInBundle(@"Galaxy", nil, [NSBundle bundleForClass:[SystWindowController class]], nil)];
+	[window setMinSize:NSMakeSize(200, 150)];
+	[window setDelegate:self];
+	mapView = [[GalaxyMapView alloc] initWithFrame:[[window contentView] bounds] document:[newResource document]];
+	[mapView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+	[[window contentView] addSubview:mapView];
+	[window setInitialFirstResponder:mapView];
+	[mapView centreOnSystem:newResource];
+	[window center];
+	[self showWindow:self];
+	return self;
+}
+
+- (void)dealloc
+{
+	[mapView release];
+	[super dealloc];
+}
+
+// moves go straight into the resources, so they are undone with the document
+- (NSUndoManager *)windowWillReturnUndoManager:(NSWindow *)sender
+{
+	return [[resource document] undoManager];
+}
+
+- (NSDictionary *)validateValues
+{
+	return [NSDictionary dictionary];
+}
+
+- (void)saveResource
+{
+}
+
+@end
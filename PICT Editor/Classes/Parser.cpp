@@ -0,0 +1,1243 @@
+#include "Parser.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+enum
+{
+	kFileHeaderSize		= 512,
+	kMaximumSide		= 0x4000,
+	kMaximumRowBytes	= 0x4000,
+	kMaximumCrossings	= 0x4000,
+
+	// transfer modes
+	kSrcCopy			= 0,
+	kSrcOr				= 1,
+	kSrcXor				= 2,
+	kSrcBic				= 3,
+	kNotSource			= 4,
+	kPatCopy			= 8,
+	kArithmeticModes	= 32,
+	kTransparent		= 36,
+	kDitherCopy			= 64,
+
+	// what the shape opcodes do, in their bottom three bits
+	kFrame				= 0,
+	kPaint				= 1,
+	kErase				= 2,
+	kInvert				= 3,
+	kFill				= 4
+};
+
+static const UInt8 kBlack[4] = { 0, 0, 0, 255 };
+static const UInt8 kWhite[4] = { 255, 255, 255, 255 };
+
+/*** PICTURE VERSION ***/
+// 1 or 2 if a version opcode is at this offset, 0 if not
+static int PictureVersion( const UInt8 *bytes, UInt32 length, UInt32 at )
+{
+	if( length < at + 4 ) return 0;
+	if( bytes[at] == 0x11 && bytes[at+1] == 0x01 ) return 1;
+	if( bytes[at] == 0x00 && bytes[at+1] == 0x11 && bytes[at+2] == 0x02 && bytes[at+3] == 0xFF ) return 2;
+	return 0;
+}
+
+static inline void SetPixel( UInt8 *pixel, const UInt8 colour[4] )
+{
+	pixel[0] = colour[0];
+	pixel[1] = colour[1];
+	pixel[2] = colour[2];
+	pixel[3] = 255;
+}
+
+// pixels nothing has been drawn in yet count as white, as they would in a window
+static inline void InvertPixel( UInt8 *pixel )
+{
+	if( pixel[3] == 0 )
+		pixel[0] = pixel[1] = pixel[2] = 0;
+	else
+	{
+		pixel[0] = 255 - pixel[0];
+		pixel[1] = 255 - pixel[1];
+		pixel[2] = 255 - pixel[2];
+	}
+	pixel[3] = 255;
+}
+
+static inline Boolean IsWhite( const UInt8 colour[4] )
+{
+	return colour[0] == 255 && colour[1] == 255 && colour[2] == 255;
+}
+
+  /***************/
+ /* C INTERFACE */
+/***************/
+
+/*** READ FRAME ***/
+int PictReadFrame( const UInt8 *bytes, UInt32 length, PictRect *frame )
+{
+	PictParser parser( bytes, length );
+	int error = parser.ReadHeader();
+	if( !error ) *frame = parser.Frame();
+	return error;
+}
+
+/*** DRAW ***/
+int PictDraw( const UInt8 *bytes, UInt32 length, UInt8 *pixels, UInt32 rowBytes )
+{
+	PictParser parser( bytes, length );
+	return parser.Draw( pixels, rowBytes );
+}
+
+  /**********/
+ /* PARSER */
+/**********/
+
+/*** CONSTRUCTOR ***/
+PictParser::PictParser( const UInt8 *data, UInt32 dataLength )
+{
+	bytes = data;
+	length = dataLength;
+	offset = 0;
+	version2 = false;
+	incomplete = false;
+	memset( &frame, 0, sizeof(frame) );
+	pixels = NULL;
+	clip = shape = row = NULL;
+	crossings = NULL;
+}
+
+/*** READ HEADER ***/
+int PictParser::ReadHeader( void )
+{
+	int version = PictureVersion( bytes, length, 10 );
+	if( !version && PictureVersion( bytes, length, kFileHeaderSize + 10 ) )
+	{
+		// a file, whose first 512 bytes are the application's own
+		bytes += kFileHeaderSize;
+		length -= kFileHeaderSize;
+		version = PictureVersion( bytes, length, 10 );
+	}
+	if( !version ) return kPictNotAPicture;
+
+	frame = Rect( 2 );
+	version2 = (version == 2);
+	offset = version2? 14:12;
+
+	// extended version 2 pictures are drawn at their own resolution, in their source rectangle
+	if( version2 && Has( 26 ) && Short( offset ) == 0x0C00 && Short( offset + 2 ) == -2 )
+	{
+		PictRect source = Rect( offset + 14 );
+		if( source.bottom > source.top && source.right > source.left )
+			frame = source;
+	}
+
+	if( frame.bottom <= frame.top || frame.right <= frame.left ) return kPictNotAPicture;
+	if( frame.bottom - frame.top > kMaximumSide || frame.right - frame.left > kMaximumSide ) return kPictTooLarge;
+	return kPictNoError;
+}
+
+/*** DRAW ***/
+int PictParser::Draw( UInt8 *buffer, UInt32 bufferRowBytes )
+{
+	int error = ReadHeader();
+	if( error ) return error;
+
+	pixels = buffer;
+	pixelRowBytes = bufferRowBytes;
+	width = frame.right - frame.left;
+	height = frame.bottom - frame.top;
+
+	// one block for everything: polygon crossings, a pixel map row, and the clip and shape masks
+	UInt8 *memory = (UInt8 *) malloc( kMaximumCrossings * sizeof(float) + kMaximumRowBytes + width * height * 2 );
+	if( !memory ) return kPictMemoryFull;
+	crossings = (float *) memory;
+	row = memory + kMaximumCrossings * sizeof(float);
+	clip = row + kMaximumRowBytes;
+	shape = clip + width * height;
+	memset( clip, 1, width * height );
+
+	// a new port
+	originH = originV = 0;
+	penH = frame.left;
+	penV = frame.top;
+	penWidth = penHeight = 1;
+	penMode = kPatCopy;
+	ovalWidth = ovalHeight = 0;
+	memcpy( foreColour, kBlack, 4 );
+	memcpy( backColour, kWhite, 4 );
+	memset( &penPattern, 0, sizeof(Pattern) );
+	memset( penPattern.bits, 0xFF, 8 );
+	fillPattern = penPattern;
+	memset( &backPattern, 0, sizeof(Pattern) );
+	memset( &lastRect, 0, sizeof(PictRect) );
+	lastRoundRect = lastOval = lastArc = lastRect;
+	lastStartAngle = lastArcAngle = 0;
+	lastPolygon = lastRegion = 0;
+
+	while( !error )
+	{
+		// version 2 opcodes are words, and start on word boundaries
+		UInt16 opcode;
+		if( version2 ) offset = (offset + 1) & ~1UL;
+		if( !Has( version2? 2:1 ) )
+		{
+			error = kPictTruncated;
+			break;
+		}
+		opcode = version2? (UInt16) Short( offset ) : Byte( offset );
+		offset += version2? 2:1;
+		if( opcode == 0x00FF ) break;	// OpEndPic
+		error = DoOpcode( opcode );
+	}
+
+	free( memory );
+	pixels = clip = shape = row = NULL;
+	crossings = NULL;
+	if( !error && incomplete ) error = kPictIncomplete;
+	return error;
+}
+
+/*** RECT ***/
+PictRect PictParser::Rect( UInt32 at ) const
+{
+	PictRect rect;
+	rect.top = Short( at );
+	rect.left = Short( at + 2 );
+	rect.bottom = Short( at + 4 );
+	rect.right = Short( at + 6 );
+	return rect;
+}
+
+/*** SKIP ***/
+int PictParser::Skip( UInt32 count )
+{
+	if( !Has( count ) ) return kPictTruncated;
+	offset += count;
+	return kPictNoError;
+}
+
+/*** SKIP WITH LENGTH ***/
+// skips data preceeded by its length, in a word or a long
+int PictParser::SkipWithLength( UInt32 lengthSize )
+{
+	UInt32 count;
+	if( !Has( lengthSize ) ) return kPictTruncated;
+	count = (lengthSize == 2)? (UInt16) Short( offset ) : Long( offset );
+	offset += lengthSize;
+	return Skip( count );
+}
+
+/*** SKIP SIZED ***/
+// skips a region or polygon, whose size word counts itself, returning where it was
+int PictParser::SkipSized( UInt32 *at )
+{
+	UInt32 size;
+	if( !Has( 10 ) ) return kPictTruncated;
+	size = (UInt16) Short( offset );
+	if( size < 10 || !Has( size ) ) return kPictTruncated;
+	*at = offset;
+	offset += size;
+	return kPictNoError;
+}
+
+/*** DO OPCODE ***/
+int PictParser::DoOpcode( UInt16 opcode )
+{
+	switch( opcode )
+	{
+		case 0x0000:	// NOP
+		case 0x0017:
+		case 0x0018:
+		case 0x0019:
+		case 0x001C:	// HiliteMode
+		case 0x001E:	// DefHilite
+			return kPictNoError;
+
+		case 0x0001:	// Clip
+		{
+			UInt32 at;
+			int error = SkipSized( &at );
+			if( error ) return error;
+			memset( clip, 0, width * height );
+			RegionShape( at, clip );
+			return kPictNoError;
+		}
+
+		case 0x0002:	// BkPat
+		case 0x0009:	// PnPat
+		case 0x000A:	// FillPat
+			if( !Has( 8 ) ) return kPictTruncated;
+			SetPattern( opcode == 0x0002? &backPattern : opcode == 0x0009? &penPattern : &fillPattern, offset );
+			return Skip( 8 );
+
+		case 0x0003:	// TxFont
+		case 0x0005:	// TxMode
+		case 0x000D:	// TxSize
+		case 0x0015:	// PnLocHFrac
+		case 0x0016:	// ChExtra
+		case 0x00A0:	// ShortComment
+			return Skip( 2 );
+
+		case 0x0004:	// TxFace
+			return Skip( 1 );
+
+		case 0x0006:	// SpExtra
+			return Skip( 4 );
+
+		case 0x0007:	// PnSize
+			if( !Has( 4 ) ) return kPictTruncated;
+			penHeight = Short( offset );
+			penWidth = Short( offset + 2 );
+			return Skip( 4 );
+
+		case 0x0008:	// PnMode
+			if( !Has( 2 ) ) return kPictTruncated;
+			penMode = Short( offset );
+			return Skip( 2 );
+
+		case 0x000B:	// OvSize
+			if( !Has( 4 ) ) return kPictTruncated;
+			ovalHeight = Short( offset );
+			ovalWidth = Short( offset + 2 );
+			return Skip( 4 );
+
+		case 0x000C:	// Origin
+			if( !Has( 4 ) ) return kPictTruncated;
+			originH += Short( offset );
+			originV += Short( offset + 2 );
+			return Skip( 4 );
+
+		case 0x000E:	// FgColor
+		case 0x000F:	// BkColor
+			if( !Has( 4 ) ) return kPictTruncated;
+			SetOldColour( Long( offset ), opcode == 0x000E? foreColour : backColour );
+			return Skip( 4 );
+
+		case 0x0010:	// TxRatio
+			return Skip( 8 );
+
+		case 0x0011:	// VersionOp
+			return Skip( version2? 2:1 );
+
+		case 0x0012:	// BkPixPat
+			return ReadPixelPattern( &backPattern );
+		case 0x0013:	// PnPixPat
+			return ReadPixelPattern( &penPattern );
+		case 0x0014:	// FillPixPat
+			return ReadPixelPattern( &fillPattern );
+
+		case 0x001A:	// RGBFgCol
+		case 0x001B:	// RGBBkCol
+		{
+			UInt8 *colour = (opcode == 0x001A)? foreColour : backColour;
+			if( !Has( 6 ) ) return kPictTruncated;
+			colour[0] = Byte( offset );
+			colour[1] = Byte( offset + 2 );
+			colour[2] = Byte( offset + 4 );
+			colour[3] = 255;
+			return Skip( 6 );
+		}
+
+		case 0x001D:	// HiliteColor
+		case 0x001F:	// OpColor
+			return Skip( 6 );
+
+		case 0x0020:	// Line
+			if( !Has( 8 ) ) return kPictTruncated;
+			penV = Short( offset );
+			penH = Short( offset + 2 );
+			offset += 8;
+			return DrawLine( Short( offset - 2 ), Short( offset - 4 ) );
+
+		case 0x0021:	// LineFrom
+			if( !Has( 4 ) ) return kPictTruncated;
+			offset += 4;
+			return DrawLine( Short( offset - 2 ), Short( offset - 4 ) );
+
+		case 0x0022:	// ShortLine
+			if( !Has( 6 ) ) return kPictTruncated;
+			penV = Short( offset );
+			penH = Short( offset + 2 );
+			offset += 6;
+			return DrawLine( penH + (SInt8) Byte( offset - 2 ), penV + (SInt8) Byte( offset - 1 ) );
+
+		case 0x0023:	// ShortLineFrom
+			if( !Has( 2 ) ) return kPictTruncated;
+			offset += 2;
+			return DrawLine( penH + (SInt8) Byte( offset - 2 ), penV + (SInt8) Byte( offset - 1 ) );
+
+		// text needs the fonts, so only the pen is moved
+		case 0x0028:	// LongText
+			if( !Has( 5 ) ) return kPictTruncated;
+			incomplete = true;
+			penV = Short( offset );
+			penH = Short( offset + 2 );
+			return Skip( 5 + Byte( offset + 4 ) );
+
+		case 0x0029:	// DHText
+		case 0x002A:	// DVText
+			if( !Has( 2 ) ) return kPictTruncated;
+			incomplete = true;
+			if( opcode == 0x0029 )	penH += Byte( offset );
+			else					penV += Byte( offset );
+			return Skip( 2 + Byte( offset + 1 ) );
+
+		case 0x002B:	// DHDVText
+			if( !Has( 3 ) ) return kPictTruncated;
+			incomplete = true;
+			penH += Byte( offset );
+			penV += Byte( offset + 1 );
+			return Skip( 3 + Byte( offset + 2 ) );
+
+		case 0x0090:	// BitsRect
+		case 0x0091:	// BitsRgn
+		case 0x0098:	// PackBitsRect
+		case 0x0099:	// PackBitsRgn
+		case 0x009A:	// DirectBitsRect
+		case 0x009B:	// DirectBitsRgn
+			return DrawBits( opcode );
+
+		case 0x00A1:	// LongComment
+		{
+			int error = Skip( 2 );
+			if( error ) return error;
+			return SkipWithLength( 2 );
+		}
+
+		case 0x8200:	// CompressedQuickTime
+		case 0x8201:	// UncompressedQuickTime
+			incomplete = true;
+			return SkipWithLength( 4 );
+	}
+
+	// shapes
+	if( opcode >= 0x0030 && opcode <= 0x008F )
+		return DrawShape( opcode );
+
+	// reserved opcodes, whose sizes are given by their range
+	if( (opcode >= 0x0024 && opcode <= 0x0027) || (opcode >= 0x002C && opcode <= 0x002F) || (opcode >= 0x0092 && opcode <= 0x0097) || (opcode >= 0x009C && opcode <= 0x009F) || (opcode >= 0x00A2 && opcode <= 0x00AF) )
+		return SkipWithLength( 2 );
+	if( opcode >= 0x00B0 && opcode <= 0x00CF ) return kPictNoError;
+	if( opcode >= 0x00D0 && opcode <= 0x00FE ) return SkipWithLength( 4 );
+	if( opcode >= 0x0100 && opcode <= 0x7FFF ) return Skip( (opcode >> 8) * 2 );	// including HeaderOp
+	if( opcode >= 0x8000 && opcode <= 0x80FF ) return kPictNoError;
+	return SkipWithLength( 4 );
+}
+
+  /*********/
+ /* STATE */
+/*********/
+
+/*** SET PATTERN ***/
+void PictParser::SetPattern( Pattern *pattern, UInt32 at )
+{
+	memcpy( pattern->bits, bytes + at, 8 );
+	pattern->colour = false;
+}
+
+/*** SET OLD COLOUR ***/
+// the eight colours of the original QuickDraw
+void PictParser::SetOldColour( UInt32 colour, UInt8 rgba[4] )
+{
+	UInt8 red = 0, green = 0, blue = 0;
+	switch( colour )
+	{
+		case 30:	red = green = blue = 255;	break;	// whiteColor
+		case 69:	red = green = 255;			break;	// yellowColor
+		case 137:	red = blue = 255;			break;	// magentaColor
+		case 205:	red = 255;					break;	// redColor
+		case 273:	green = blue = 255;			break;	// cyanColor
+		case 341:	green = 255;				break;	// greenColor
+		case 409:	blue = 255;					break;	// blueColor
+	}
+	rgba[0] = red;
+	rgba[1] = green;
+	rgba[2] = blue;
+	rgba[3] = 255;
+}
+
+/*** READ PIXEL PATTERN ***/
+int PictParser::ReadPixelPattern( Pattern *pattern )
+{
+	PixelMap map;
+	SInt16 type;
+	SInt32 mapWidth, mapHeight, x, y;
+	int error;
+
+	if( !Has( 10 ) ) return kPictTruncated;
+	type = Short( offset );
+	SetPattern( pattern, offset + 2 );
+	offset += 10;
+
+	// dither patterns are a colour QuickDraw approximates with the old pattern; one is good enough here
+	if( type == 2 )
+	{
+		if( !Has( 6 ) ) return kPictTruncated;
+		for( y = 0; y < 8; y++ ) for( x = 0; x < 8; x++ )
+		{
+			pattern->pixels[y][x][0] = Byte( offset );
+			pattern->pixels[y][x][1] = Byte( offset + 2 );
+			pattern->pixels[y][x][2] = Byte( offset + 4 );
+			pattern->pixels[y][x][3] = 255;
+		}
+		pattern->colour = true;
+		return Skip( 6 );
+	}
+	if( type != 1 ) return kPictNotAPicture;
+
+	// full colour patterns: keep the top left 8x8 pixels, repeating smaller ones to fill them
+	error = ReadPixelMap( &map, false );
+	if( error ) return error;
+	mapWidth = map.bounds.right - map.bounds.left;
+	mapHeight = map.bounds.bottom - map.bounds.top;
+	for( y = 0; y < mapHeight; y++ )
+	{
+		error = ReadRow( &map );
+		if( error ) return error;
+		if( y < 8 ) for( x = 0; x < 8 && x < mapWidth; x++ )
+			PixelColour( &map, x, pattern->pixels[y][x] );
+	}
+	for( y = 0; y < 8; y++ ) for( x = 0; x < 8; x++ )
+		if( y >= mapHeight || x >= mapWidth )
+			memcpy( pattern->pixels[y][x], pattern->pixels[y % mapHeight][x % mapWidth], 4 );
+	pattern->colour = true;
+	return kPictNoError;
+}
+
+/*** READ PIXEL MAP ***/
+// reads a bit or pixel map's header and colour table, leaving the offset at its source rect
+int PictParser::ReadPixelMap( PixelMap *map, Boolean direct )
+{
+	UInt16 rowBytes;
+	SInt32 mapWidth;
+
+	if( direct && Skip( 4 ) ) return kPictTruncated;	// baseAddr
+	if( !Has( 10 ) ) return kPictTruncated;
+	rowBytes = (UInt16) Short( offset );
+	map->rowBytes = rowBytes & 0x3FFF;
+	map->bounds = Rect( offset + 2 );
+	offset += 10;
+	mapWidth = map->bounds.right - map->bounds.left;
+
+	if( rowBytes & 0x8000 )
+	{
+		if( !Has( 36 ) ) return kPictTruncated;
+		map->packType = Short( offset + 2 );
+		map->pixelSize = Short( offset + 18 );
+		map->componentCount = Short( offset + 20 );
+		offset += 36;
+	}
+	else
+	{
+		// a bit map, drawn in the foreground and background colours
+		map->packType = 0;
+		map->pixelSize = 1;
+		map->componentCount = 1;
+	}
+
+	// the colour table; pixels it doesn't give a colour for are black
+	memset( map->palette, 0, sizeof(map->palette) );
+	if( !(rowBytes & 0x8000) )
+	{
+		memcpy( map->palette[0], backColour, 4 );
+		memcpy( map->palette[1], foreColour, 4 );
+	}
+	else if( !direct )
+	{
+		UInt16 flags;
+		UInt32 count, entry;
+		if( !Has( 8 ) ) return kPictTruncated;
+		flags = (UInt16) Short( offset + 4 );
+		count = (UInt16) Short( offset + 6 ) + 1UL;
+		offset += 8;
+		if( !Has( count * 8 ) ) return kPictTruncated;
+		for( entry = 0; entry < count; entry++ )
+		{
+			UInt32 at = offset + entry * 8;
+			UInt32 index = (flags & 0x8000)? entry : (UInt16) Short( at );	// device tables are in order
+			if( index > 255 ) continue;
+			map->palette[index][0] = Byte( at + 2 );
+			map->palette[index][1] = Byte( at + 4 );
+			map->palette[index][2] = Byte( at + 6 );
+		}
+		offset += count * 8;
+	}
+	for( UInt32 index = 0; index < 256; index++ )
+		map->palette[index][3] = 255;
+
+	// how the rows are stored: rows under 8 bytes are never packed
+	map->packed = (map->rowBytes >= 8);
+	map->planar = false;
+	map->unit = 1;
+	map->unpackedBytes = map->rowBytes;
+	switch( map->pixelSize )
+	{
+		case 1: case 2: case 4: case 8:
+			break;
+
+		case 16:
+			if( map->packType == 1 ) map->packed = false;
+			map->unit = 2;
+			break;
+
+		case 32:
+			if( map->packType == 1 || !map->packed ) map->packed = false;
+			else if( map->packType == 2 )
+			{
+				// high bytes dropped, but not otherwise packed
+				map->packed = false;
+				map->unpackedBytes = mapWidth * 3;
+			}
+			else
+			{
+				map->planar = true;
+				if( map->componentCount != 4 ) map->componentCount = 3;
+				map->unpackedBytes = mapWidth * map->componentCount;
+			}
+			break;
+
+		default:
+			return kPictNotAPicture;
+	}
+	if( mapWidth <= 0 || map->bounds.bottom <= map->bounds.top ) return kPictNotAPicture;
+	if( (UInt32) mapWidth * map->pixelSize > map->rowBytes * 8UL || map->unpackedBytes > kMaximumRowBytes ) return kPictNotAPicture;
+	return kPictNoError;
+}
+
+/*** READ ROW ***/
+// unpacks the next row of a pixel map into the row buffer
+int PictParser::ReadRow( const PixelMap *map )
+{
+	UInt32 count, at, end, out = 0;
+	if( !map->packed )
+	{
+		if( !Has( map->unpackedBytes ) ) return kPictTruncated;
+		memcpy( row, bytes + offset, map->unpackedBytes );
+		offset += map->unpackedBytes;
+		return kPictNoError;
+	}
+
+	// the packed row's byte count is a word if the row could pack to over 250 bytes
+	if( map->rowBytes > 250 )
+	{
+		if( !Has( 2 ) ) return kPictTruncated;
+		count = (UInt16) Short( offset );
+		offset += 2;
+	}
+	else
+	{
+		if( !Has( 1 ) ) return kPictTruncated;
+		count = Byte( offset );
+		offset += 1;
+	}
+	if( !Has( count ) ) return kPictTruncated;
+
+	// PackBits: a flag byte, then n+1 units as they are for positive n, or one unit 1-n times for negative n
+	at = offset;
+	end = offset + count;
+	while( at < end && out < map->unpackedBytes )
+	{
+		SInt8 flag = (SInt8) bytes[at++];
+		if( flag >= 0 )
+		{
+			UInt32 run = (flag + 1) * map->unit;
+			UInt32 copy = run;
+			if( copy > end - at ) copy = end - at;
+			if( copy > map->unpackedBytes - out ) copy = map->unpackedBytes - out;
+			memcpy( row + out, bytes + at, copy );
+			at += run;
+			out += copy;
+		}
+		else if( flag != -128 )
+		{
+			UInt32 run = (1 - flag) * map->unit;
+			if( at + map->unit > end ) break;
+			if( run > map->unpackedBytes - out ) run = map->unpackedBytes - out;
+			if( map->unit == 1 ) memset( row + out, bytes[at], run );
+			else
+			{
+				// copy the first unit, then double what's been written until the run is full
+				UInt32 filled = map->unit < run? map->unit : run;
+				memcpy( row + out, bytes + at, filled );
+				while( filled < run )
+				{
+					UInt32 copy = (filled < run - filled)? filled : run - filled;
+					memcpy( row + out + filled, row + out, copy );
+					filled += copy;
+				}
+			}
+			at += map->unit;
+			out += run;
+		}
+	}
+	if( out < map->unpackedBytes ) memset( row + out, 0, map->unpackedBytes - out );
+	offset = end;
+	return kPictNoError;
+}
+
+/*** PIXEL COLOUR ***/
+// the colour of one pixel of the row buffer
+void PictParser::PixelColour( const PixelMap *map, SInt32 column, UInt8 colour[4] ) const
+{
+	switch( map->pixelSize )
+	{
+		case 1: case 2: case 4: case 8:
+		{
+			UInt32 bit = column * map->pixelSize;
+			UInt8 index = (row[bit >> 3] >> (8 - map->pixelSize - (bit & 7))) & ((1 << map->pixelSize) - 1);
+			memcpy( colour, map->palette[index], 4 );
+			return;
+		}
+
+		case 16:
+		{
+			// xRRRRRGGGGGBBBBB
+			UInt16 pixel = (UInt16) ((row[column * 2] << 8) | row[column * 2 + 1]);
+			UInt8 red = (pixel >> 10) & 0x1F, green = (pixel >> 5) & 0x1F, blue = pixel & 0x1F;
+			colour[0] = (red << 3) | (red >> 2);
+			colour[1] = (green << 3) | (green >> 2);
+			colour[2] = (blue << 3) | (blue >> 2);
+			break;
+		}
+
+		case 32:
+			if( map->planar )
+			{
+				// alpha, if there is any, comes first and QuickDraw ignores it
+				SInt32 mapWidth = map->bounds.right - map->bounds.left;
+				const UInt8 *red = row + (map->componentCount == 4? mapWidth : 0) + column;
+				colour[0] = red[0];
+				colour[1] = red[mapWidth];
+				colour[2] = red[mapWidth * 2];
+			}
+			else if( map->packType == 2 && map->rowBytes >= 8 )
+			{
+				colour[0] = row[column * 3];
+				colour[1] = row[column * 3 + 1];
+				colour[2] = row[column * 3 + 2];
+			}
+			else
+			{
+				colour[0] = row[column * 4 + 1];
+				colour[1] = row[column * 4 + 2];
+				colour[2] = row[column * 4 + 3];
+			}
+			break;
+	}
+	colour[3] = 255;
+}
+
+  /**********/
+ /* SHAPES */
+/**********/
+
+/*** DEVICE BOX ***/
+// the part of the buffer a rectangle in picture coordinates covers
+PictParser::Box PictParser::DeviceBox( PictRect rect ) const
+{
+	Box box;
+	box.top = rect.top - frame.top - originV;
+	box.left = rect.left - frame.left - originH;
+	box.bottom = rect.bottom - frame.top - originV;
+	box.right = rect.right - frame.left - originH;
+	if( box.top < 0 ) box.top = 0;
+	if( box.left < 0 ) box.left = 0;
+	if( box.bottom > height ) box.bottom = height;
+	if( box.right > width ) box.right = width;
+	if( box.bottom < box.top ) box.bottom = box.top;
+	if( box.right < box.left ) box.right = box.left;
+	return box;
+}
+
+/*** PEN BOX ***/
+// the part of the buffer a line covers, the pen hanging below and to the right of it
+PictParser::Box PictParser::PenBox( SInt16 fromH, SInt16 fromV, SInt16 toH, SInt16 toV ) const
+{
+	PictRect rect;
+	rect.top = fromV < toV? fromV : toV;
+	rect.left = fromH < toH? fromH : toH;
+	rect.bottom = (fromV > toV? fromV : toV) + penHeight;
+	rect.right = (fromH > toH? fromH : toH) + penWidth;
+	return DeviceBox( rect );
+}
+
+/*** CLEAR SHAPE ***/
+void PictParser::ClearShape( const Box &box )
+{
+	for( SInt32 y = box.top; y < box.bottom; y++ )
+		memset( shape + y * width + box.left, 0, box.right - box.left );
+}
+
+/*** ROUND RECT SHAPE ***/
+// sets the pixels whose centres are inside the round rect to the value; zero corners make a rect and full ones an oval
+void PictParser::RoundRectShape( PictRect rect, SInt32 cornerWidth, SInt32 cornerHeight, UInt8 value )
+{
+	Box box = DeviceBox( rect );
+	double top = rect.top - frame.top - originV, bottom = rect.bottom - frame.top - originV;
+	double left = rect.left - frame.left - originH, right = rect.right - frame.left - originH;
+	double radiusH = ((cornerWidth < right - left)? cornerWidth : right - left) / 2.0;
+	double radiusV = ((cornerHeight < bottom - top)? cornerHeight : bottom - top) / 2.0;
+
+	for( SInt32 y = box.top; y < box.bottom; y++ )
+	{
+		double centre = y + 0.5, inset = 0.0;
+		SInt32 start, end;
+		if( radiusH > 0.0 && radiusV > 0.0 )
+		{
+			double distance = 0.0;
+			if( centre < top + radiusV )			distance = top + radiusV - centre;
+			else if( centre > bottom - radiusV )	distance = centre - (bottom - radiusV);
+			distance /= radiusV;
+			inset = radiusH - radiusH * sqrt( distance < 1.0? 1.0 - distance * distance : 0.0 );
+		}
+		start = (SInt32) ceil( left + inset - 0.5 );
+		end = (SInt32) ceil( right - inset - 0.5 );
+		if( start < box.left ) start = box.left;
+		if( end > box.right ) end = box.right;
+		if( end > start ) memset( shape + y * width + start, value, end - start );
+	}
+}
+
+/*** ARC SHAPE ***/
+// clears what's outside the wedge; angles are clockwise from 12 o'clock, and stretched with the rect, so 45 is a corner
+void PictParser::ArcShape( PictRect rect, const Box &box, SInt32 startAngle, SInt32 arcAngle )
+{
+	double centreH = (rect.left + rect.right) / 2.0 - frame.left - originH;
+	double centreV = (rect.top + rect.bottom) / 2.0 - frame.top - originV;
+	double radiusH = (rect.right - rect.left) / 2.0, radiusV = (rect.bottom - rect.top) / 2.0;
+
+	if( arcAngle < 0 )
+	{
+		startAngle += arcAngle;
+		arcAngle = -arcAngle;
+	}
+	if( arcAngle >= 360 || radiusH <= 0.0 || radiusV <= 0.0 ) return;
+	startAngle %= 360;
+	if( startAngle < 0 ) startAngle += 360;
+
+	for( SInt32 y = box.top; y < box.bottom; y++ )
+		for( SInt32 x = box.left; x < box.right; x++ )
+		{
+			UInt8 *pixel = shape + y * width + x;
+			double angle;
+			if( !*pixel ) continue;
+			angle = atan2( (x + 0.5 - centreH) / radiusH, (centreV - y - 0.5) / radiusV ) * 180.0 / 3.14159265358979323846 - startAngle;
+			while( angle < 0.0 ) angle += 360.0;
+			if( angle >= arcAngle ) *pixel = 0;
+		}
+}
+
+/*** POLYGON SHAPE ***/
+// fills the polygon, closed, with the even-odd rule; returns the part of the buffer it covers
+PictParser::Box PictParser::PolygonShape( UInt32 at )
+{
+	UInt32 count = ((UInt16) Short( at ) - 10) / 4;
+	UInt32 points = at + 10;
+	Box box = DeviceBox( Rect( at + 2 ) );
+	ClearShape( box );
+	if( count < 2 ) return box;
+
+	for( SInt32 y = box.top; y < box.bottom; y++ )
+	{
+		double v = y + 0.5 + frame.top + originV;
+		UInt32 found = 0, point, next, index;
+		for( point = 0; point < count; point++ )
+		{
+			double fromV, toV, fromH, toH;
+			next = (point + 1 == count)? 0 : point + 1;
+			fromV = Short( points + point * 4 );
+			fromH = Short( points + point * 4 + 2 );
+			toV = Short( points + next * 4 );
+			toH = Short( points + next * 4 + 2 );
+			if( (fromV > v) != (toV > v) && found < kMaximumCrossings )
+				crossings[found++] = (float) (fromH + (v - fromV) * (toH - fromH) / (toV - fromV) - frame.left - originH);
+		}
+
+		// there are rarely more than a few, so an insertion sort will do
+		for( index = 1; index < found; index++ )
+		{
+			float crossing = crossings[index];
+			for( point = index; point > 0 && crossings[point-1] > crossing; point-- )
+				crossings[point] = crossings[point-1];
+			crossings[point] = crossing;
+		}
+		for( index = 0; index + 1 < found; index += 2 )
+		{
+			SInt32 start = (SInt32) ceil( crossings[index] - 0.5 );
+			SInt32 end = (SInt32) ceil( crossings[index+1] - 0.5 );
+			if( start < box.left ) start = box.left;
+			if( end > box.right ) end = box.right;
+			if( end > start ) memset( shape + y * width + start, 1, end - start );
+		}
+	}
+	return box;
+}
+
+/*** REGION SHAPE ***/
+// sets the region's pixels in the mask, which must be clear; returns the part of the buffer it covers
+PictParser::Box PictParser::RegionShape( UInt32 at, UInt8 *mask )
+{
+	UInt32 size = (UInt16) Short( at );
+	UInt32 end = at + size, scan = at + 10;
+	Box box = DeviceBox( Rect( at + 2 ) );
+	SInt32 boxWidth = box.right - box.left, y = box.top;
+	UInt8 *state = row;
+
+	for( SInt32 line = box.top; line < box.bottom; line++ )
+		memset( mask + line * width + box.left, size <= 10? 1:0, boxWidth );
+	if( size <= 10 || boxWidth == 0 ) return box;
+
+	/* The rest is scan lines: a v coordinate, then pairs of h coordinates where whether each pixel is in the region
+		changes from the line above, then 0x7FFF. Another 0x7FFF ends the region. */
+	memset( state, 0, boxWidth );
+	while( scan + 2 <= end )
+	{
+		SInt32 v = Short( scan );
+		scan += 2;
+		if( v == 0x7FFF ) break;
+		v -= frame.top + originV;
+		for( ; y < v && y < box.bottom; y++ )
+			memcpy( mask + y * width + box.left, state, boxWidth );
+
+		while( scan + 4 <= end )
+		{
+			SInt32 start = Short( scan ), stop;
+			if( start == 0x7FFF ) break;
+			stop = Short( scan + 2 );
+			scan += 4;
+			start -= frame.left + originH + box.left;
+			stop -= frame.left + originH + box.left;
+			if( start < 0 ) start = 0;
+			if( stop > boxWidth ) stop = boxWidth;
+			for( SInt32 x = start; x < stop; x++ )
+				state[x] ^= 1;
+		}
+		scan += 2;
+	}
+	return box;
+}
+
+/*** FRAME SHAPE ***/
+// leaves only the pixels within a pen's width or height of the shape's edge
+void PictParser::FrameShape( const Box &box )
+{
+	SInt32 x, y;
+	for( y = box.top; y < box.bottom; y++ )
+		for( x = box.left; x < box.right; x++ )
+		{
+			UInt8 *pixel = shape + y * width + x;
+			if( !*pixel ) continue;
+			if( x - penWidth >= box.left && x + penWidth < box.right && y - penHeight >= box.top && y + penHeight < box.bottom
+				&& pixel[-penWidth] && pixel[penWidth] && pixel[-penHeight * width] && pixel[penHeight * width] )
+				*pixel = 2;		// inside; still counts as in the shape for its neighbours
+		}
+	for( y = box.top; y < box.bottom; y++ )
+		for( x = box.left; x < box.right; x++ )
+			if( shape[y * width + x] == 2 )
+				shape[y * width + x] = 0;
+}
+
+/*** LINE SHAPE ***/
+// moves the pen along the line, setting every pixel it covers
+void PictParser::LineShape( SInt16 fromH, SInt16 fromV, SInt16 toH, SInt16 toV )
+{
+	SInt32 x = fromH - frame.left - originH, y = fromV - frame.top - originV;
+	SInt32 endX = toH - frame.left - originH, endY = toV - frame.top - originV;
+	SInt32 deltaX = abs( endX - x ), deltaY = -abs( endY - y );
+	SInt32 stepX = x < endX? 1:-1, stepY = y < endY? 1:-1;
+	SInt32 error = deltaX + deltaY, twice;
+	if( penWidth <= 0 || penHeight <= 0 ) return;
+
+	while( true )
+	{
+		SInt32 top = y < 0? 0 : y, left = x < 0? 0 : x;
+		SInt32 bottom = y + penHeight > height? height : y + penHeight;
+		SInt32 right = x + penWidth > width? width : x + penWidth;
+		for( SInt32 line = top; line < bottom; line++ )
+			if( right > left ) memset( shape + line * width + left, 1, right - left );
+
+		if( x == endX && y == endY ) break;
+		twice = error * 2;
+		if( twice >= deltaY )
+		{
+			error += deltaY;
+			x += stepX;
+		}
+		if( twice <= deltaX )
+		{
+			error += deltaX;
+			y += stepY;
+		}
+	}
+}
+
+  /***********/
+ /* DRAWING */
+/***********/
+
+/*** DRAW SHAPE ***/
+// the rect, round rect, oval, arc, polygon and region opcodes: read the shape (or use the last), then draw it
+int PictParser::DrawShape( UInt16 opcode )
+{
+	UInt16 verb = opcode & 7;
+	Boolean same = (opcode & 8) != 0;
+	Box box;
+	int error;
+
+	switch( opcode & 0xF0 )
+	{
+		case 0x30:		// rect
+		case 0x40:		// round rect
+		case 0x50:		// oval
+		case 0x60:		// arc
+		{
+			PictRect *last = (opcode & 0xF0) == 0x30? &lastRect : (opcode & 0xF0) == 0x40? &lastRoundRect : (opcode & 0xF0) == 0x50? &lastOval : &lastArc;
+			PictRect rect, inner;
+			SInt32 cornerWidth, cornerHeight;
+			if( !same )
+			{
+				if( !Has( 8 ) ) return kPictTruncated;
+				*last = Rect( offset );
+				offset += 8;
+			}
+			if( (opcode & 0xF0) == 0x60 )
+			{
+				if( !Has( 4 ) ) return kPictTruncated;
+				lastStartAngle = Short( offset );
+				lastArcAngle = Short( offset + 2 );
+				offset += 4;
+			}
+			if( verb > kFill ) return kPictNoError;
+
+			rect = *last;
+			box = DeviceBox( rect );
+			cornerWidth = (opcode & 0xF0) == 0x30? 0 : (opcode & 0xF0) == 0x40? ovalWidth : rect.right - rect.left;
+			cornerHeight = (opcode & 0xF0) == 0x30? 0 : (opcode & 0xF0) == 0x40? ovalHeight : rect.bottom - rect.top;
+			ClearShape( box );
+			RoundRectShape( rect, cornerWidth, cornerHeight, 1 );
+			if( verb == kFrame )
+			{
+				inner.top = rect.top + penHeight;
+				inner.left = rect.left + penWidth;
+				inner.bottom = rect.bottom - penHeight;
+				inner.right = rect.right - penWidth;
+				if( inner.bottom > inner.top && inner.right > inner.left )
+					RoundRectShape( inner, cornerWidth - penWidth * 2, cornerHeight - penHeight * 2, 0 );
+			}
+			if( (opcode & 0xF0) == 0x60 )
+				ArcShape( rect, box, lastStartAngle, lastArcAngle );
+			break;
+		}
+
+		case 0x70:		// polygon
+			if( !same && (error = SkipSized( &lastPolygon )) ) return error;
+			if( verb > kFill || !lastPolygon ) return kPictNoError;
+			if( verb == kFrame )
+			{
+				// the edges as they are, closed only if the last point is the first
+				UInt32 count = ((UInt16) Short( lastPolygon ) - 10) / 4, points = lastPolygon + 10;
+				PictRect bounds = Rect( lastPolygon + 2 );
+				bounds.bottom += penHeight;
+				bounds.right += penWidth;
+				box = DeviceBox( bounds );
+				ClearShape( box );
+				for( UInt32 point = 1; point < count; point++ )
+					LineShape( Short( points + point * 4 - 2 ), Short( points + point * 4 - 4 ), Short( points + point * 4 + 2 ), Short( points + point * 4 ) );
+			}
+			else box = PolygonShape( lastPolygon );
+			break;
+
+		case 0x80:		// region
+			if( !same && (error = SkipSized( &lastRegion )) ) return error;
+			if( verb > kFill || !lastRegion ) return kPictNoError;
+			box = RegionShape( lastRegion, shape );
+			if( verb == kFrame ) FrameShape( box );
+			break;
+
+		default:
+			return kPictNoError;
+	}
+
+	switch( verb )
+	{
+		case kFrame:
+		case kPaint:	FillShape( box, &penPattern, penMode );		break;
+		case kErase:	FillShape( box, &backPattern, kPatCopy );	break;
+		case kInvert:	InvertShape( box );							break;
+		case kFill:		FillShape( box, &fillPattern, kPatCopy );	break;
+	}
+	return kPictNoError;
+}
+
+/*** FILL SHAPE ***/
+// draws the pattern through the shape and clip masks with a pattern transfer mode
+void PictParser::FillShape( const Box &box, const Pattern *pattern, SInt16 mode )
+{
+	Boolean notPattern = (mode & kNotSource) != 0;
+	SInt16 operation = mode & 3;
+	if( mode >= kArithmeticModes )
+	{
+		// blends and hiliting need the colours of the port; copying is the nearest
+		notPattern = false;
+		operation = kSrcCopy;
+	}
+
+	for( SInt32 y = box.top; y < box.bottom; y++ )
+	{
+		const UInt8 *shapeRow = shape + y * width, *clipRow = clip + y * width;
+		UInt8 *pixel = pixels + y * pixelRowBytes + box.left * 4;
+		UInt32 patternRow = (y + frame.top) & 7;
+		for( SInt32 x = box.left; x < box.right; x++, pixel += 4 )
+		{
+			UInt32 patternColumn = (x + frame.left) & 7;
+			Boolean set;
+			if( !shapeRow[x] || !clipRow[x] ) continue;
+			if( pattern->colour )
+			{
+				switch( operation )
+				{
+					case kSrcCopy:
+					case kSrcOr:	SetPixel( pixel, pattern->pixels[patternRow][patternColumn] );	break;
+					case kSrcXor:	InvertPixel( pixel );											break;
+					case kSrcBic:	SetPixel( pixel, backColour );									break;
+				}
+				continue;
+			}
+			set = ((pattern->bits[patternRow] >> (7 - patternColumn)) & 1) != notPattern;
+			switch( operation )
+			{
+				case kSrcCopy:	SetPixel( pixel, set? foreColour : backColour );	break;
+				case kSrcOr:	if( set ) SetPixel( pixel, foreColour );			break;
+				case kSrcXor:	if( set ) InvertPixel( pixel );						break;
+				case kSrcBic:	if( set ) SetPixel( pixel, backColour );			break;
+			}
+		}
+	}
+}
+
+/*** INVERT SHAPE ***/
+void PictParser::InvertShape( const Box &box )
+{
+	for( SInt32 y = box.top; y < box.bottom; y++ )
+		for( SInt32 x = box.left; x < box.right; x++ )
+			if( shape[y * width + x] && clip[y * width + x] )
+				InvertPixel( pixels + y * pixelRowBytes + x * 4 );
+}
+
+/*** TRANSFER PIXEL ***/
+// one source pixel with a source transfer mode; white is what's 'off' in colour pixels
+void PictParser::TransferPixel( UInt8 *pixel, const UInt8 colour[4], SInt16 mode ) const
+{
+	UInt8 source[4];
+	mode &= ~kDitherCopy;
+	if( mode == kTransparent )
+	{
+		if( colour[0] != backColour[0] || colour[1] != backColour[1] || colour[2] != backColour[2] )
+			SetPixel( pixel, colour );
+		return;
+	}
+	if( mode >= kArithmeticModes )
+	{
+		SetPixel( pixel, colour );
+		return;
+	}
+
+	memcpy( source, colour, 4 );
+	if( mode & kNotSource )
+	{
+		source[0] = 255 - source[0];
+		source[1] = 255 - source[1];
+		source[2] = 255 - source[2];
+	}
+	switch( mode & 3 )
+	{
+		case kSrcCopy:	SetPixel( pixel, source );							break;
+		case kSrcOr:	if( !IsWhite( source ) ) SetPixel( pixel, source );		break;
+		case kSrcXor:	if( !IsWhite( source ) ) InvertPixel( pixel );			break;
+		case kSrcBic:	if( !IsWhite( source ) ) SetPixel( pixel, backColour );	break;
+	}
+}
+
+/*** DRAW LINE ***/
+int PictParser::DrawLine( SInt16 toH, SInt16 toV )
+{
+	Box box = PenBox( penH, penV, toH, toV );
+	ClearShape( box );
+	LineShape( penH, penV, toH, toV );
+	penH = toH;
+	penV = toV;
+	FillShape( box, &penPattern, penMode );
+	return kPictNoError;
+}
+
+/*** DRAW BITS ***/
+// copies a bit or pixel map from its source rect to its destination rect, scaling by repeating or dropping pixels
+int PictParser::DrawBits( UInt16 opcode )
+{
+	Boolean direct = (opcode >= 0x009A), masked = (opcode & 1) != 0;
+	PixelMap map;
+	PictRect source, destination;
+	SInt16 mode;
+	SInt32 mapWidth, mapHeight, sourceWidth, sourceHeight, destinationWidth, destinationHeight, destinationTop, destinationLeft, y;
+	Box box;
+	int error = ReadPixelMap( &map, direct );
+	if( error ) return error;
+	if( opcode == 0x0090 || opcode == 0x0091 )
+	{
+		// BitsRect and BitsRgn are never packed, however long their rows
+		map.packed = false;
+		map.planar = false;
+		map.unpackedBytes = map.rowBytes;
+	}
+
+	if( !Has( 18 ) ) return kPictTruncated;
+	source = Rect( offset );
+	destination = Rect( offset + 8 );
+	mode = Short( offset + 16 );
+	offset += 18;
+	box = DeviceBox( destination );
+	if( masked )
+	{
+		UInt32 at;
+		if( (error = SkipSized( &at )) ) return error;
+		ClearShape( box );
+		RegionShape( at, shape );
+	}
+
+	mapWidth = map.bounds.right - map.bounds.left;
+	mapHeight = map.bounds.bottom - map.bounds.top;
+	sourceWidth = source.right - source.left;
+	sourceHeight = source.bottom - source.top;
+	destinationWidth = destination.right - destination.left;
+	destinationHeight = destination.bottom - destination.top;
+	destinationTop = destination.top - frame.top - originV;
+	destinationLeft = destination.left - frame.left - originH;
+	if( sourceWidth <= 0 || sourceHeight <= 0 || destinationWidth <= 0 || destinationHeight <= 0 )
+		box.bottom = box.top;	// nothing to draw, but the rows must still be read
+
+	// rows are unpacked one at a time, and drawn in every destination row they end up in
+	y = box.top;
+	for( SInt32 line = 0; line < mapHeight; line++ )
+	{
+		SInt32 sourceRow = map.bounds.top + line;
+		if( (error = ReadRow( &map )) ) return error;
+		for( ; y < box.bottom; y++ )
+		{
+			SInt32 wanted = source.top + (y - destinationTop) * sourceHeight / destinationHeight;
+			const UInt8 *clipRow = clip + y * width, *shapeRow = shape + y * width;
+			UInt8 *pixel = pixels + y * pixelRowBytes;
+			if( wanted > sourceRow ) break;
+			if( wanted < sourceRow ) continue;
+			for( SInt32 x = box.left; x < box.right; x++ )
+			{
+				SInt32 column = (sourceWidth == destinationWidth? x - destinationLeft : (x - destinationLeft) * sourceWidth / destinationWidth) + source.left - map.bounds.left;
+				UInt8 colour[4];
+				if( !clipRow[x] || (masked && !shapeRow[x]) || column < 0 || column >= mapWidth ) continue;
+				PixelColour( &map, column, colour );
+				TransferPixel( pixel + x * 4, colour, mode );
+			}
+		}
+	}
+	return kPictNoError;
+}
@@ -0,0 +1,188 @@
+/* QuickDraw picture decoder */
+
+/*	Draws version 1 and 2 PICTs into RGBA buffers without QuickDraw, so pictures can be shown where QuickDraw isn't
+	available and drawn on any thread. The opcodes are read straight out of the picture's data, one at a time, with no
+	copies made; the only memory used is allocated once per picture, for the clip and shape masks and one row of pixels.
+
+	Shapes (rects, round rects, ovals, arcs, polygons and regions) are framed, painted, filled, erased and inverted with
+	8x8 patterns, black and white or colour, through the pattern transfer modes. Bit maps and pixel maps are copied
+	with the source transfer modes, scaling from their source to destination rectangles, through a mask region if they
+	have one: 1, 2, 4 and 8-bit indexed pixels through their colour tables, and 16 and 32-bit direct pixels. PackBits
+	rows are expanded a run at a time with memset and memcpy. Clip regions are followed. Text and QuickTime-compressed
+	images can't be drawn without the Toolbox; they are skipped and the picture reported as incomplete, so callers can
+	fall back to the system's own picture drawing where there is one.
+
+	Pixels are written as R, G, B, A bytes; where nothing is drawn the buffer is left as it was. */
+
+#ifndef _ResKnife_PictParser_
+#define _ResKnife_PictParser_
+
+#include <CoreFoundation/CoreFoundation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+	kPictNoError = 0,
+	kPictIncomplete,		// drawn, but it has text or QuickTime images which were left out
+	kPictTruncated,			// the data ends part way through an opcode; what came before is drawn
+	kPictNotAPicture,
+	kPictTooLarge,
+	kPictMemoryFull
+};
+
+typedef struct PictRect
+{
+	SInt16	top;
+	SInt16	left;
+	SInt16	bottom;
+	SInt16	right;
+} PictRect;
+
+/*!
+@function	PictReadFrame
+@abstract	Gets the rectangle the picture draws in, at its own resolution; the buffer PictDraw draws into is this size.
+@discussion	Handles PICT files as well as resources, skipping the 512 byte header files have.
+*/
+int PictReadFrame(const UInt8 *bytes, UInt32 length, PictRect *frame);
+
+/*!
+@function	PictDraw
+@abstract	Draws the picture into a buffer of 32-bit RGBA pixels the size of its frame.
+*/
+int PictDraw(const UInt8 *bytes, UInt32 length, UInt8 *pixels, UInt32 rowBytes);
+
+#ifdef __cplusplus
+}
+
+/*!
+	@class			PictParser
+	@abstract		Reads one picture's opcodes and draws them.
+	@discussion		The picture's data must stay around as long as the parser does; nothing is copied out of it.
+*/
+class PictParser
+{
+	// a pattern, expanded to one colour per pixel when it's a pixel pattern
+	struct Pattern
+	{
+		UInt8		bits[8];
+		Boolean		colour;
+		UInt8		pixels[8][8][4];
+	};
+
+	// a rectangle in the buffer's pixels, with the bottom and right exclusive
+	struct Box
+	{
+		SInt32		top, left, bottom, right;
+	};
+
+	// a bit or pixel map's layout, as read from its header, and how its rows are stored
+	struct PixelMap
+	{
+		UInt16		rowBytes;
+		PictRect	bounds;
+		UInt16		packType;
+		UInt16		pixelSize;
+		UInt16		componentCount;
+		Boolean		packed;			// rows have a byte count and are PackBits compressed
+		Boolean		planar;			// 32-bit rows are stored as a run of each component in turn
+		UInt32		unit;			// bytes in each PackBits unit
+		UInt32		unpackedBytes;	// bytes in each row once unpacked
+		UInt8		palette[256][4];
+	};
+
+	const UInt8		*bytes;
+	UInt32			length;
+	UInt32			offset;
+	Boolean			version2;
+	Boolean			incomplete;
+	PictRect		frame;
+
+	// the buffer being drawn into and the masks the same size as it
+	UInt8			*pixels;
+	UInt32			pixelRowBytes;
+	SInt32			width, height;
+	UInt8			*clip;
+	UInt8			*shape;
+	UInt8			*row;			// one row of a pixel map, unpacked
+	float			*crossings;		// where a polygon's edges cross a row
+
+	// graphics state
+	SInt16			originH, originV;
+	SInt16			penH, penV;
+	SInt16			penWidth, penHeight;
+	SInt16			penMode;
+	SInt16			ovalWidth, ovalHeight;
+	UInt8			foreColour[4];
+	UInt8			backColour[4];
+	Pattern			penPattern;
+	Pattern			fillPattern;
+	Pattern			backPattern;
+
+	// the shapes the 'same' opcodes draw again
+	PictRect		lastRect, lastRoundRect, lastOval, lastArc;
+	SInt16			lastStartAngle, lastArcAngle;
+	UInt32			lastPolygon, lastRegion;		// offsets of their data, 0 if none yet
+
+	/* methods */
+public:
+					PictParser( const UInt8 *data, UInt32 dataLength );
+
+/*!
+	@function		ReadHeader
+	@discussion		Checks the picture's version and finds its frame; Draw calls this itself.
+*/
+	int				ReadHeader( void );
+	PictRect		Frame( void ) const		{ return frame; }
+
+/*!
+	@function		Draw
+	@discussion		Plays every opcode into the buffer, which must be the size of the frame.
+*/
+	int				Draw( UInt8 *buffer, UInt32 bufferRowBytes );
+
+private:
+	// reading
+	Boolean			Has( UInt32 count ) const	{ return count <= length && offset <= length - count; }
+	UInt8			Byte( UInt32 at ) const		{ return bytes[at]; }
+	SInt16			Short( UInt32 at ) const	{ return (SInt16) ((bytes[at] << 8) | bytes[at+1]); }
+	UInt32			Long( UInt32 at ) const		{ return ((UInt32) bytes[at] << 24) | ((UInt32) bytes[at+1] << 16) | ((UInt32) bytes[at+2] << 8) | bytes[at+3]; }
+	PictRect		Rect( UInt32 at ) const;
+	int				Skip( UInt32 count );
+	int				SkipWithLength( UInt32 lengthSize );
+	int				SkipSized( UInt32 *at );
+	int				DoOpcode( UInt16 opcode );
+
+	// state
+	void			SetPattern( Pattern *pattern, UInt32 at );
+	void			SetOldColour( UInt32 colour, UInt8 rgba[4] );
+	int				ReadPixelPattern( Pattern *pattern );
+	int				ReadPixelMap( PixelMap *map, Boolean direct );
+	int				ReadRow( const PixelMap *map );
+	void			PixelColour( const PixelMap *map, SInt32 column, UInt8 colour[4] ) const;
+
+	// shapes
+	Box				DeviceBox( PictRect rect ) const;
+	Box				PenBox( SInt16 fromH, SInt16 fromV, SInt16 toH, SInt16 toV ) const;
+	void			ClearShape( const Box &box );
+	void			RoundRectShape( PictRect rect, SInt32 cornerWidth, SInt32 cornerHeight, UInt8 value );
+	void			ArcShape( PictRect rect, const Box &box, SInt32 startAngle, SInt32 arcAngle );
+	Box				PolygonShape( UInt32 at );
+	Box				RegionShape( UInt32 at, UInt8 *mask );
+	void			FrameShape( const Box &box );
+	void			LineShape( SInt16 fromH, SInt16 fromV, SInt16 toH, SInt16 toV );
+
+	// drawing
+	int				DrawShape( UInt16 opcode );
+	void			FillShape( const Box &box, const Pattern *pattern, SInt16 mode );
+	void			InvertShape( const Box &box );
+	void			TransferPixel( UInt8 *pixel, const UInt8 colour[4], SInt16 mode ) const;
+	int				DrawLine( SInt16 toH, SInt16 toV );
+	int				DrawBits( UInt16 opcode );
+};
+
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+/*	Decode benchmark for the QuickDraw picture decoder, buildable with any C++ compiler:
+
+		c++ -O2 -Wall -I../Classes -I../../Cocoa/Tests PictDecoderBench.cpp ../Classes/Parser.cpp -o PictDecoderBench && ./PictDecoderBench
+
+	Cocoa/Tests supplies just the MacTypes the decoder needs in place of CoreFoundation, so this builds the same anywhere.
+	It makes extended version 2 pictures the size of a typical screenshot PICT, one an 8-bit PackBitsRect with a colour
+	table and one a 32-bit DirectBitsRect packed a component at a time, each row a mix of flat runs and noise, then draws
+	each over and over for a couple of seconds, reporting pictures and megapixels per second. */
+
+#include "Parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum
+{
+	kWidth = 512,
+	kHeight = 384,
+	kSeconds = 2
+};
+
+static UInt8 *PutShort( UInt8 *p, UInt16 value )
+{
+	p[0] = (UInt8) (value >> 8); p[1] = (UInt8) value;
+	return p + 2;
+}
+
+static UInt8 *PutLong( UInt8 *p, UInt32 value )
+{
+	return PutShort( PutShort( p, (UInt16) (value >> 16) ), (UInt16) value );
+}
+
+static UInt8 *PutRect( UInt8 *p, SInt16 top, SInt16 left, SInt16 bottom, SInt16 right )
+{
+	p = PutShort( p, top ); p = PutShort( p, left );
+	p = PutShort( p, bottom ); return PutShort( p, right );
+}
+
+// PackBits: runs of three or more bytes repeated, everything else literal, at most 128 of either at once
+static UInt32 PackBits( const UInt8 *in, UInt32 count, UInt8 *out )
+{
+	UInt32 at = 0, written = 0;
+	while( at < count )
+	{
+		UInt32 run = 1;
+		while( at + run < count && run < 128 && in[at + run] == in[at] ) run++;
+		if( run >= 3 )
+		{
+			out[written++] = (UInt8) (1 - (SInt32) run);
+			out[written++] = in[at];
+			at += run;
+		}
+		else
+		{
+			UInt32 literal = 0;
+			while( at + literal < count && literal < 128 &&
+				!(at + literal + 2 < count && in[at + literal] == in[at + literal + 1] && in[at + literal] == in[at + literal + 2]) )
+				literal++;
+			out[written++] = (UInt8) (literal - 1);
+			memcpy( out + written, in + at, literal );
+			written += literal;
+			at += literal;
+		}
+	}
+	return written;
+}
+
+// a band of flat colour either side, and noise in the middle that moves along a little each row
+static void MakeRow( UInt8 *row, UInt32 y, UInt32 component )
+{
+	UInt32 x, edge = 64 + (y % 64);
+	for( x = 0; x < kWidth; x++ )
+	{
+		if( x < edge )					row[x] = (UInt8) (component * 60 + y / 32);
+		else if( x >= kWidth - edge )	row[x] = (UInt8) (200 - component * 40);
+		else							row[x] = (UInt8) rand();
+	}
+}
+
+// the extended version 2 header, a clip region of the whole frame, then the pixels and the end opcode
+static UInt32 MakePicture( UInt8 *bytes, UInt16 depth )
+{
+	UInt8 row[kWidth], *p = bytes;
+	UInt32 y, component, entry;
+	srand( 1 );
+	p = PutShort( p, 0 );
+	p = PutRect( p, 0, 0, kHeight, kWidth );
+	p = PutLong( p, 0x001102FF );
+	p = PutShort( p, 0x0C00 );
+	p = PutShort( p, 0xFFFE ); p = PutShort( p, 0 );
+	p = PutLong( p, 0x00480000 ); p = PutLong( p, 0x00480000 );
+	p = PutRect( p, 0, 0, kHeight, kWidth );
+	p = PutLong( p, 0 );
+	p = PutShort( p, 0x001E );
+	p = PutShort( p, 0x0001 );
+	p = PutShort( p, 10 ); p = PutRect( p, 0, 0, kHeight, kWidth );
+
+	if( depth == 8 )
+	{
+		p = PutShort( p, 0x0098 );
+		p = PutShort( p, 0x8000 | kWidth );
+	}
+	else
+	{
+		p = PutShort( p, 0x009A );
+		p = PutLong( p, 0x000000FF );
+		p = PutShort( p, 0x8000 | kWidth * 4 );
+	}
+	p = PutRect( p, 0, 0, kHeight, kWidth );
+	p = PutShort( p, 0 );							// version
+	p = PutShort( p, depth == 8? 0:4 );				// pack type
+	p = PutLong( p, 0 );
+	p = PutLong( p, 0x00480000 ); p = PutLong( p, 0x00480000 );
+	p = PutShort( p, depth == 8? 0:16 );			// pixel type
+	p = PutShort( p, depth );
+	p = PutShort( p, depth == 8? 1:3 );				// components
+	p = PutShort( p, 8 );
+	p = PutLong( p, 0 ); p = PutLong( p, 0 ); p = PutLong( p, 0 );
+	if( depth == 8 )
+	{
+		p = PutLong( p, 0 );
+		p = PutShort( p, 0x8000 );
+		p = PutShort( p, 255 );
+		for( entry = 0; entry < 256; entry++ )
+		{
+			p = PutShort( p, (UInt16) entry );
+			p = PutShort( p, (UInt16) (entry * 0x0101) );
+			p = PutShort( p, (UInt16) ((255 - entry) * 0x0101) );
+			p = PutShort( p, (UInt16) ((entry * 7 & 0xFF) * 0x0101) );
+		}
+	}
+	p = PutRect( p, 0, 0, kHeight, kWidth );
+	p = PutRect( p, 0, 0, kHeight, kWidth );
+	p = PutShort( p, 0 );							// srcCopy
+
+	for( y = 0; y < kHeight; y++ )
+	{
+		// the byte count is a word, since the rows are over 250 bytes
+		UInt8 *count = p;
+		UInt32 packed = 0;
+		p += 2;
+		for( component = 0; component < (depth == 8? 1UL:3UL); component++ )
+		{
+			MakeRow( row, y, component );
+			packed += PackBits( row, kWidth, p + packed );
+		}
+		PutShort( count, (UInt16) packed );
+		p += packed;
+	}
+	if( (p - bytes) & 1 ) *p++ = 0;
+	p = PutShort( p, 0x00FF );
+	PutShort( bytes, (UInt16) (p - bytes) );
+	return (UInt32) (p - bytes);
+}
+
+static void Bench( UInt16 depth )
+{
+	UInt8 *bytes = (UInt8 *) malloc( kHeight * (kWidth * 4 + 16) + 4096 );
+	UInt8 *pixels = (UInt8 *) malloc( kWidth * kHeight * 4 );
+	UInt32 length = MakePicture( bytes, depth );
+	unsigned long drawn = 0;
+	PictRect frame;
+	clock_t start, elapsed;
+	double seconds;
+	int error;
+
+	if( PictReadFrame( bytes, length, &frame ) != kPictNoError || frame.right - frame.left != kWidth || frame.bottom - frame.top != kHeight )
+	{
+		printf( "pict%u: the test picture didn't parse\n", depth );
+		exit( 1 );
+	}
+	start = clock();
+	do
+	{
+		memset( pixels, 0, kWidth * kHeight * 4 );
+		if( (error = PictDraw( bytes, length, pixels, kWidth * 4 )) != kPictNoError )
+		{
+			printf( "pict%u: the test picture didn't draw (error %d)\n", depth, error );
+			exit( 1 );
+		}
+		drawn++;
+		elapsed = clock() - start;
+	}
+	while( elapsed < kSeconds * CLOCKS_PER_SEC );
+
+	seconds = (double) elapsed / CLOCKS_PER_SEC;
+	printf( "pict%-2u %dx%d: %7.0f pictures/s, %7.1f Mpixels/s, %7.1f MB/s of opcodes\n", depth, kWidth, kHeight, drawn / seconds,
+		drawn * (double) kWidth * kHeight / seconds / 1e6, drawn * (double) length / seconds / 1e6 );
+	free( bytes );
+	free( pixels );
+}
+
+int main( void )
+{
+	Bench( 8 );
+	Bench( 32 );
+	return 0;
+}